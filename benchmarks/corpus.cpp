@@ -0,0 +1,210 @@
+#include "corpus.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace Flux::Bench {
+    namespace {
+        // Bump when generated content changes, so cached corpora are rebuilt
+        constexpr int GENERATOR_VERSION = 1;
+
+        constexpr std::array<CorpusKind, 5> ALL_CORPORA = {
+            CorpusKind::SMALL_FILES,
+            CorpusKind::LARGE_FILES,
+            CorpusKind::MIXED,
+            CorpusKind::TEXT,
+            CorpusKind::INCOMPRESSIBLE
+        };
+
+        constexpr std::array<std::string_view, 32> WORDS = {
+            "auto", "const", "return", "if", "else", "for", "while", "std::vector", "size_t", "buffer",
+            "archive", "entry", "path", "result", "options", "stream", "compress", "level", "thread", "index",
+            "=", "==", "+", "->", "(", ")", "{", "}", "0", "1", "nullptr", "data"
+        };
+
+        /**
+         * Writes files of generated content; mt19937_64 output is fixed by the
+         * standard, and only raw draws are used so every platform produces the same bytes
+         */
+        class Generator {
+        public:
+            explicit Generator(uint64_t seed) : m_rng(seed) {}
+
+            uint64_t between(uint64_t low, uint64_t high) {
+                return low + m_rng() % (high - low + 1);
+            }
+
+            void randomFile(const std::filesystem::path& path, uint64_t size) {
+                std::ofstream file = open(path);
+                std::vector<uint64_t> block(8192);
+                for (uint64_t written = 0; written < size;) {
+                    std::generate(block.begin(), block.end(), [this] { return m_rng(); });
+                    const auto chunk = std::min<uint64_t>(size - written, block.size() * sizeof(uint64_t));
+                    file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(chunk));
+                    written += chunk;
+                }
+                m_bytes += size;
+            }
+
+            // Source-code-like lines from a small vocabulary
+            void textFile(const std::filesystem::path& path, uint64_t size) {
+                std::ofstream file = open(path);
+                std::string text;
+                text.reserve(size);
+                while (text.size() < size) {
+                    text.append(static_cast<size_t>(m_rng() % 4) * 4, ' ');
+                    const auto words = 3 + m_rng() % 9;
+                    for (uint64_t i = 0; i < words; ++i) {
+                        text.append(WORDS[m_rng() % WORDS.size()]);
+                        text.push_back(' ');
+                    }
+                    text.append(";\n");
+                }
+                text.resize(size);
+                file.write(text.data(), static_cast<std::streamsize>(text.size()));
+                m_bytes += size;
+            }
+
+            // Fixed-layout records with a few random fields, like a database or log dump
+            void recordFile(const std::filesystem::path& path, uint64_t size) {
+                std::ofstream file = open(path);
+                std::vector<uint64_t> block(8192);
+                uint64_t sequence = 0;
+                for (uint64_t written = 0; written < size;) {
+                    for (size_t i = 0; i < block.size(); i += 4) {
+                        block[i] = sequence++;
+                        block[i + 1] = 0x464C5558;
+                        block[i + 2] = m_rng() % 1000;
+                        block[i + 3] = m_rng();
+                    }
+                    const auto chunk = std::min<uint64_t>(size - written, block.size() * sizeof(uint64_t));
+                    file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(chunk));
+                    written += chunk;
+                }
+                m_bytes += size;
+            }
+
+            uint64_t bytes() const noexcept { return m_bytes; }
+            uint64_t files() const noexcept { return m_files; }
+
+        private:
+            std::ofstream open(const std::filesystem::path& path) {
+                std::filesystem::create_directories(path.parent_path());
+                std::ofstream file(path, std::ios::binary | std::ios::trunc);
+                if (!file) {
+                    throw std::runtime_error("Cannot create corpus file " + path.string());
+                }
+                ++m_files;
+                return file;
+            }
+
+            std::mt19937_64 m_rng;
+            uint64_t m_bytes = 0;
+            uint64_t m_files = 0;
+        };
+
+        uint64_t scaled(uint64_t value, double scale) {
+            return std::max<uint64_t>(1, static_cast<uint64_t>(static_cast<double>(value) * scale));
+        }
+
+        void generate(CorpusKind kind, const std::filesystem::path& root, double scale, Generator& gen) {
+            constexpr uint64_t KB = 1024;
+            constexpr uint64_t MB = 1024 * KB;
+            switch (kind) {
+                case CorpusKind::SMALL_FILES:
+                    for (uint64_t i = 0, count = scaled(4000, scale); i < count; ++i) {
+                        const auto dir = root / ("group_" + std::to_string(i / 200)) / ("sub_" + std::to_string(i % 10));
+                        if (i % 4 == 3) {
+                            gen.recordFile(dir / ("file_" + std::to_string(i) + ".dat"), gen.between(512, 8 * KB));
+                        } else {
+                            gen.textFile(dir / ("file_" + std::to_string(i) + ".txt"), gen.between(512, 8 * KB));
+                        }
+                    }
+                    break;
+                case CorpusKind::LARGE_FILES:
+                    gen.textFile(root / "large.log", scaled(64 * MB, scale));
+                    gen.recordFile(root / "large.db", scaled(64 * MB, scale));
+                    gen.randomFile(root / "large.bin", scaled(32 * MB, scale));
+                    break;
+                case CorpusKind::MIXED:
+                    for (uint64_t i = 0, count = scaled(1000, scale); i < count; ++i) {
+                        gen.textFile(root / "docs" / ("note_" + std::to_string(i) + ".md"), gen.between(256, 16 * KB));
+                    }
+                    for (uint64_t i = 0, count = scaled(50, scale); i < count; ++i) {
+                        const uint64_t size = gen.between(64 * KB, 2 * MB);
+                        if (i % 2 == 0) {
+                            gen.recordFile(root / "data" / ("table_" + std::to_string(i) + ".dat"), size);
+                        } else {
+                            // Already-compressed media: ZIP's AUTO strategy stores these
+                            gen.randomFile(root / "media" / ("photo_" + std::to_string(i) + ".jpg"), size);
+                        }
+                    }
+                    gen.recordFile(root / "data" / "archive.db", scaled(32 * MB, scale));
+                    break;
+                case CorpusKind::TEXT:
+                    for (uint64_t i = 0, count = scaled(200, scale); i < count; ++i) {
+                        gen.textFile(root / ("module_" + std::to_string(i / 20)) / ("source_" + std::to_string(i) + ".cpp"),
+                                     gen.between(16 * KB, 256 * KB));
+                    }
+                    break;
+                case CorpusKind::INCOMPRESSIBLE:
+                    for (uint64_t i = 0, count = scaled(64, scale); i < count; ++i) {
+                        gen.randomFile(root / ("blob_" + std::to_string(i) + ".bin"), MB);
+                    }
+                    break;
+            }
+        }
+    }
+
+    std::string_view corpusName(CorpusKind kind) noexcept {
+        switch (kind) {
+            case CorpusKind::SMALL_FILES: return "small";
+            case CorpusKind::LARGE_FILES: return "large";
+            case CorpusKind::MIXED: return "mixed";
+            case CorpusKind::TEXT: return "text";
+            case CorpusKind::INCOMPRESSIBLE: return "incompressible";
+        }
+        return "unknown";
+    }
+
+    std::span<const CorpusKind> allCorpora() noexcept {
+        return ALL_CORPORA;
+    }
+
+    Corpus prepareCorpus(CorpusKind kind, const std::filesystem::path& base_dir, double scale) {
+        const std::string name(corpusName(kind));
+        Corpus corpus{kind, base_dir / name};
+
+        std::ostringstream expected;
+        expected << GENERATOR_VERSION << ' ' << scale;
+        const auto stamp_path = base_dir / (name + ".stamp");
+
+        // Stamp: "<version> <scale> <files> <bytes>"
+        if (std::ifstream stamp(stamp_path); stamp) {
+            int version = 0;
+            double stamp_scale = 0;
+            stamp >> version >> stamp_scale >> corpus.file_count >> corpus.total_bytes;
+            std::ostringstream found;
+            found << version << ' ' << stamp_scale;
+            if (stamp && found.str() == expected.str() && std::filesystem::is_directory(corpus.root)) {
+                return corpus;
+            }
+        }
+
+        std::filesystem::remove_all(corpus.root);
+        std::filesystem::remove(stamp_path);
+        Generator gen(uint64_t{0x464C5558'00000000} + static_cast<uint64_t>(std::to_underlying(kind)));
+        generate(kind, corpus.root, scale, gen);
+        corpus.file_count = gen.files();
+        corpus.total_bytes = gen.bytes();
+
+        std::ofstream stamp(stamp_path, std::ios::trunc);
+        stamp << expected.str() << ' ' << corpus.file_count << ' ' << corpus.total_bytes << '\n';
+        return corpus;
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Flux::Bench {
+    /**
+     * Synthetic input sets, generated from fixed seeds
+     */
+    enum class CorpusKind {
+        SMALL_FILES,     // Thousands of 512B-8KB files in nested directories
+        LARGE_FILES,     // A few files of tens of MB
+        MIXED,           // Small, medium and large files, text and binary
+        TEXT,            // Source-code-like text (compresses well)
+        INCOMPRESSIBLE   // Random bytes
+    };
+
+    struct Corpus {
+        CorpusKind kind;
+        std::filesystem::path root;   // Directory holding the files
+        uint64_t total_bytes = 0;
+        uint64_t file_count = 0;
+    };
+
+    [[nodiscard]] std::string_view corpusName(CorpusKind kind) noexcept;
+
+    [[nodiscard]] std::span<const CorpusKind> allCorpora() noexcept;
+
+    /**
+     * Generate a corpus under base_dir, or reuse one generated earlier
+     *
+     * Content depends only on kind and scale (sizes and file counts are
+     * multiplied by scale), so runs on different machines and releases
+     * measure identical inputs. A stamp file records what was generated;
+     * a mismatch regenerates the directory.
+     */
+    [[nodiscard]] Corpus prepareCorpus(CorpusKind kind, const std::filesystem::path& base_dir, double scale);
+}
@@ -0,0 +1,477 @@
+#include <benchmark/benchmark.h>
+#include "corpus.h"
+#include "regression_compare.h"
+#include <flux-core/flux.h>
+#include <algorithm>
+#include <charconv>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+/*
+ * flux-bench: pack, extract, list and verify for every ArchiveFormat over
+ * deterministic synthetic corpora
+ *
+ * Cases are named <operation>/<format>/<corpus>[/level:N][/threads:N] and
+ * report MB/s (bytes_per_second), files/s, process CPU time and peak RSS.
+ * Google Benchmark's --benchmark_out=<file> --benchmark_out_format=json
+ * writes results for comparison between releases.
+ *
+ * --compare=<baseline.json> reruns the cases found in a baseline recorded
+ * with repetitions and exits with status 2 if any is slower by more than
+ * --threshold with Mann-Whitney significance below --alpha.
+ */
+
+namespace {
+    using Flux::Bench::Corpus;
+    using Flux::Bench::CorpusKind;
+
+    struct Settings {
+        std::filesystem::path work_dir = std::filesystem::temp_directory_path() / "flux_bench";
+        double scale = 1.0;
+        std::vector<Flux::ArchiveFormat> formats;
+        std::vector<CorpusKind> corpora;
+        std::vector<int> levels = {1, 5, 9};
+        std::vector<int> threads;
+        bool scale_given = false;
+        std::filesystem::path baseline_path;   // Compare mode when set
+        double threshold = 0.05;
+        double alpha = 0.05;
+    };
+
+    // Repetitions per case in compare mode, unless --benchmark_repetitions is given
+    constexpr int COMPARE_REPETITIONS = 10;
+
+    Settings g_settings;
+
+    template <typename T>
+    bool parseList(std::string_view text, std::vector<T>& out, auto&& parse_item) {
+        out.clear();
+        while (!text.empty()) {
+            const auto comma = text.find(',');
+            const auto item = text.substr(0, comma);
+            T value{};
+            if (!parse_item(item, value)) {
+                return false;
+            }
+            out.push_back(value);
+            text = comma == std::string_view::npos ? std::string_view{} : text.substr(comma + 1);
+        }
+        return !out.empty();
+    }
+
+    bool parseInt(std::string_view text, int& value) {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc{} && end == text.data() + text.size();
+    }
+
+    bool parseFormat(std::string_view text, Flux::ArchiveFormat& format) {
+        const auto parsed = Flux::stringToFormat(text);
+        if (parsed) {
+            format = *parsed;
+        }
+        return parsed.has_value();
+    }
+
+    bool parseCorpus(std::string_view text, CorpusKind& kind) {
+        const auto corpora = Flux::Bench::allCorpora();
+        const auto found = std::find_if(corpora.begin(), corpora.end(),
+                                        [text](CorpusKind k) { return Flux::Bench::corpusName(k) == text; });
+        if (found != corpora.end()) {
+            kind = *found;
+        }
+        return found != corpora.end();
+    }
+
+    void printUsage() {
+        std::cerr << "flux-bench [google benchmark flags] [options]\n"
+                     "  --work_dir=<dir>       Corpora and archives (default: <temp>/flux_bench)\n"
+                     "  --scale=<factor>       Corpus size multiplier (default: 1.0)\n"
+                     "  --formats=<list>       zip,tar.zst,tar.gz,tar.xz,7z,fxd (default: all)\n"
+                     "  --corpora=<list>       small,large,mixed,text,incompressible (default: all)\n"
+                     "  --levels=<list>        Compression levels for pack cases (default: 1,5,9)\n"
+                     "  --threads=<list>       Thread counts (default: 1,<hardware threads>)\n"
+                     "  --compare=<json>       Rerun the cases of a baseline and report regressions\n"
+                     "  --threshold=<percent>  Slowdown counted as a regression (default: 5)\n"
+                     "  --alpha=<p>            Significance level (default: 0.05)\n";
+    }
+
+    bool parseDouble(std::string_view text, double& value) {
+        const std::string copy(text);
+        char* end = nullptr;
+        value = std::strtod(copy.c_str(), &end);
+        return !copy.empty() && *end == '\0';
+    }
+
+    // Options Google Benchmark left in argv
+    bool parseSettings(int argc, char** argv) {
+        const auto formats = Flux::getSupportedFormats();
+        g_settings.formats.assign(formats.begin(), formats.end());
+        const auto corpora = Flux::Bench::allCorpora();
+        g_settings.corpora.assign(corpora.begin(), corpora.end());
+        g_settings.threads = {1, static_cast<int>(std::max(2u, std::thread::hardware_concurrency()))};
+
+        for (int i = 1; i < argc; ++i) {
+            const std::string_view arg = argv[i];
+            const auto equals = arg.find('=');
+            const auto key = arg.substr(0, equals);
+            const auto value = equals == std::string_view::npos ? std::string_view{} : arg.substr(equals + 1);
+            bool ok = true;
+            if (key == "--work_dir") {
+                g_settings.work_dir = std::filesystem::path(value);
+                ok = !value.empty();
+            } else if (key == "--scale") {
+                ok = parseDouble(value, g_settings.scale) && g_settings.scale > 0;
+                g_settings.scale_given = true;
+            } else if (key == "--formats") {
+                ok = parseList(value, g_settings.formats, parseFormat);
+            } else if (key == "--corpora") {
+                ok = parseList(value, g_settings.corpora, parseCorpus);
+            } else if (key == "--levels") {
+                ok = parseList(value, g_settings.levels, parseInt);
+            } else if (key == "--threads") {
+                ok = parseList(value, g_settings.threads, parseInt);
+            } else if (key == "--compare") {
+                g_settings.baseline_path = std::filesystem::path(value);
+                ok = !value.empty();
+            } else if (key == "--threshold") {
+                ok = parseDouble(value, g_settings.threshold) && g_settings.threshold >= 0;
+                g_settings.threshold /= 100.0;
+            } else if (key == "--alpha") {
+                ok = parseDouble(value, g_settings.alpha) && g_settings.alpha > 0 && g_settings.alpha < 1;
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                std::cerr << "Invalid argument: " << arg << "\n";
+                printUsage();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Start a new peak RSS measurement (Linux only; elsewhere the peak is since process start)
+    void resetPeakRss() {
+#ifdef __linux__
+        std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    uint64_t peakRssBytes() {
+#if defined(__linux__)
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+            }
+        }
+        return 0;
+#elif defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters{};
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize;
+#else
+        return 0;
+#endif
+    }
+
+    const Corpus& corpus(CorpusKind kind) {
+        static std::map<CorpusKind, Corpus> corpora;
+        auto found = corpora.find(kind);
+        if (found == corpora.end()) {
+            found = corpora.emplace(kind, Flux::Bench::prepareCorpus(kind, g_settings.work_dir / "corpora",
+                                                                     g_settings.scale)).first;
+        }
+        return found->second;
+    }
+
+    std::filesystem::path archivePath(Flux::ArchiveFormat format, CorpusKind kind, std::string_view tag) {
+        return g_settings.work_dir / "archives" /
+               (std::string(Flux::Bench::corpusName(kind)) + std::string(tag) + "." + std::string(Flux::formatToString(format)));
+    }
+
+    // Archive at the default level for the extract, list and verify cases, packed once per run
+    const std::filesystem::path* sourceArchive(Flux::ArchiveFormat format, CorpusKind kind, std::string& error) {
+        static std::map<std::pair<Flux::ArchiveFormat, CorpusKind>, std::filesystem::path> archives;
+        const auto key = std::make_pair(format, kind);
+        if (const auto found = archives.find(key); found != archives.end()) {
+            return &found->second;
+        }
+
+        const auto& input = corpus(kind);
+        const auto path = archivePath(format, kind, "");
+        std::filesystem::create_directories(path.parent_path());
+        Flux::PackOptions options;
+        options.format = format;
+        const std::vector<std::filesystem::path> inputs = {input.root};
+        const auto result = Flux::createPacker(format)->pack(inputs, path, options);
+        if (!result.success) {
+            error = result.error_message;
+            return nullptr;
+        }
+        return &archives.emplace(key, path).first->second;
+    }
+
+    void reportCorpus(benchmark::State& state, const Corpus& input, uint64_t peak_rss) {
+        const auto iterations = static_cast<uint64_t>(state.iterations());
+        state.SetBytesProcessed(static_cast<int64_t>(iterations * input.total_bytes));
+        state.counters["files_per_second"] = benchmark::Counter(
+            static_cast<double>(iterations * input.file_count), benchmark::Counter::kIsRate);
+        state.counters["peak_rss_mb"] = static_cast<double>(peak_rss) / (1024.0 * 1024.0);
+    }
+
+    void packCase(benchmark::State& state, Flux::ArchiveFormat format, CorpusKind kind, int level, int threads) {
+        const auto& input = corpus(kind);
+        const auto output = archivePath(format, kind, "-pack");
+        std::filesystem::create_directories(output.parent_path());
+        Flux::PackOptions options;
+        options.format = format;
+        options.compression_level = level;
+        options.num_threads = threads;
+        const std::vector<std::filesystem::path> inputs = {input.root};
+        auto packer = Flux::createPacker(format);
+
+        resetPeakRss();
+        uint64_t compressed = 0;
+        for (auto _ : state) {
+            const auto result = packer->pack(inputs, output, options);
+            if (!result.success) {
+                state.SkipWithError(result.error_message.c_str());
+                break;
+            }
+            compressed = std::filesystem::file_size(output);
+        }
+
+        reportCorpus(state, input, peakRssBytes());
+        state.counters["ratio"] = input.total_bytes > 0 ? static_cast<double>(compressed) / static_cast<double>(input.total_bytes) : 0.0;
+        std::filesystem::remove(output);
+    }
+
+    void extractCase(benchmark::State& state, Flux::ArchiveFormat format, CorpusKind kind, int threads) {
+        std::string error;
+        const auto* archive = sourceArchive(format, kind, error);
+        if (!archive) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        const auto& input = corpus(kind);
+        const auto output = g_settings.work_dir / "extracted";
+        Flux::ExtractOptions options;
+        options.overwrite_mode = Flux::OverwriteMode::OVERWRITE;
+        options.num_threads = threads;
+        auto extractor = Flux::createExtractor(format);
+
+        resetPeakRss();
+        for (auto _ : state) {
+            // Every iteration writes into an empty directory
+            state.PauseTiming();
+            std::filesystem::remove_all(output);
+            state.ResumeTiming();
+            const auto result = extractor->extract(*archive, output, options);
+            if (!result.success) {
+                state.SkipWithError(result.error_message.c_str());
+                break;
+            }
+        }
+
+        reportCorpus(state, input, peakRssBytes());
+        std::filesystem::remove_all(output);
+    }
+
+    void listCase(benchmark::State& state, Flux::ArchiveFormat format, CorpusKind kind) {
+        std::string error;
+        const auto* archive = sourceArchive(format, kind, error);
+        if (!archive) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        auto extractor = Flux::createExtractor(format);
+
+        resetPeakRss();
+        uint64_t entries = 0;
+        for (auto _ : state) {
+            const auto listed = extractor->listContents(*archive);
+            if (!listed) {
+                state.SkipWithError(listed.error().c_str());
+                break;
+            }
+            entries += listed->size();
+        }
+
+        state.counters["entries_per_second"] = benchmark::Counter(static_cast<double>(entries), benchmark::Counter::kIsRate);
+        state.counters["peak_rss_mb"] = static_cast<double>(peakRssBytes()) / (1024.0 * 1024.0);
+    }
+
+    void verifyCase(benchmark::State& state, Flux::ArchiveFormat format, CorpusKind kind) {
+        std::string error;
+        const auto* archive = sourceArchive(format, kind, error);
+        if (!archive) {
+            state.SkipWithError(error.c_str());
+            return;
+        }
+        const auto& input = corpus(kind);
+        auto extractor = Flux::createExtractor(format);
+
+        resetPeakRss();
+        for (auto _ : state) {
+            const auto verified = extractor->verifyIntegrity(*archive);
+            if (!verified) {
+                state.SkipWithError(verified.error().c_str());
+                break;
+            }
+        }
+
+        reportCorpus(state, input, peakRssBytes());
+    }
+
+    template <typename Run>
+    bool runFailed(const Run& run) {
+        if constexpr (requires { run.skipped; }) {
+            return static_cast<bool>(run.skipped);
+        } else {
+            return run.error_occurred;
+        }
+    }
+
+    /**
+     * Console output, plus the per-repetition wall times kept for comparison
+     */
+    class SampleReporter : public benchmark::ConsoleReporter {
+    public:
+        void ReportRuns(const std::vector<Run>& runs) override {
+            for (const auto& run : runs) {
+                if (run.run_type == Run::RT_Iteration && !runFailed(run)) {
+                    m_samples[run.run_name.str()].push_back(run.GetAdjustedRealTime() /
+                                                            benchmark::GetTimeUnitMultiplier(run.time_unit));
+                }
+            }
+            ConsoleReporter::ReportRuns(runs);
+        }
+
+        const Flux::Bench::RunSamples& samples() const noexcept { return m_samples; }
+
+    private:
+        Flux::Bench::RunSamples m_samples;
+    };
+
+    // Registered names are prefixes of run names, which add "/process_time/real_time"
+    bool inBaseline(const std::string& name, const std::set<std::string>& baseline_names) {
+        const auto candidate = baseline_names.lower_bound(name + "/");
+        return candidate != baseline_names.end() && candidate->starts_with(name + "/");
+    }
+
+    void registerCases(const std::set<std::string>& baseline_names) {
+        const bool comparing = !baseline_names.empty();
+        auto wanted = [&](const std::string& name) { return !comparing || inBaseline(name, baseline_names); };
+        for (const auto format : g_settings.formats) {
+            const std::string format_name(Flux::formatToString(format));
+            for (const auto kind : g_settings.corpora) {
+                const std::string base = format_name + "/" + std::string(Flux::Bench::corpusName(kind));
+
+                for (const int level : g_settings.levels) {
+                    for (const int threads : g_settings.threads) {
+                        const auto name = "pack/" + base + "/level:" + std::to_string(level) + "/threads:" + std::to_string(threads);
+                        if (!wanted(name)) {
+                            continue;
+                        }
+                        benchmark::RegisterBenchmark(name.c_str(), packCase, format, kind, level, threads)
+                            ->Unit(benchmark::kMillisecond)->UseRealTime()->MeasureProcessCPUTime();
+                    }
+                }
+                for (const int threads : g_settings.threads) {
+                    const auto name = "extract/" + base + "/threads:" + std::to_string(threads);
+                    if (!wanted(name)) {
+                        continue;
+                    }
+                    benchmark::RegisterBenchmark(name.c_str(), extractCase, format, kind, threads)
+                        ->Unit(benchmark::kMillisecond)->UseRealTime()->MeasureProcessCPUTime();
+                }
+                if (wanted("list/" + base)) {
+                    benchmark::RegisterBenchmark(("list/" + base).c_str(), listCase, format, kind)
+                        ->Unit(benchmark::kMillisecond)->UseRealTime()->MeasureProcessCPUTime();
+                }
+                if (wanted("verify/" + base)) {
+                    benchmark::RegisterBenchmark(("verify/" + base).c_str(), verifyCase, format, kind)
+                        ->Unit(benchmark::kMillisecond)->UseRealTime()->MeasureProcessCPUTime();
+                }
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    // Comparisons need several samples per case
+    std::vector<char*> args(argv, argv + argc);
+    std::string repetitions_flag = "--benchmark_repetitions=" + std::to_string(COMPARE_REPETITIONS);
+    const auto has_flag = [&](std::string_view prefix) {
+        return std::any_of(args.begin() + 1, args.end(), [prefix](const char* arg) { return std::string_view(arg).starts_with(prefix); });
+    };
+    if (has_flag("--compare=") && !has_flag("--benchmark_repetitions")) {
+        args.push_back(repetitions_flag.data());
+    }
+    int arg_count = static_cast<int>(args.size());
+    args.push_back(nullptr);
+
+    benchmark::Initialize(&arg_count, args.data());
+    if (!parseSettings(arg_count, args.data())) {
+        return 1;
+    }
+
+    Flux::Bench::Baseline baseline;
+    std::set<std::string> baseline_names;
+    if (!g_settings.baseline_path.empty()) {
+        try {
+            baseline = Flux::Bench::loadBaseline(g_settings.baseline_path);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        for (const auto& [name, samples] : baseline.samples) {
+            baseline_names.insert(name);
+        }
+        // Same inputs as the baseline unless asked otherwise
+        if (baseline.corpus_scale && !g_settings.scale_given) {
+            g_settings.scale = *baseline.corpus_scale;
+        } else if (baseline.corpus_scale && *baseline.corpus_scale != g_settings.scale) {
+            std::cerr << "Warning: baseline corpus scale is " << *baseline.corpus_scale << ", running with "
+                      << g_settings.scale << "\n";
+        }
+    }
+
+    benchmark::AddCustomContext("flux_version", Flux::Version::toString());
+    benchmark::AddCustomContext("corpus_scale", std::to_string(g_settings.scale));
+
+    registerCases(baseline_names);
+    SampleReporter reporter;
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+    benchmark::Shutdown();
+
+    if (baseline_names.empty()) {
+        return 0;
+    }
+    const auto comparisons = Flux::Bench::compareRuns(baseline.samples, reporter.samples(),
+                                                      g_settings.threshold, g_settings.alpha);
+    std::cout << "\nComparison with " << g_settings.baseline_path.string() << "\n";
+    Flux::Bench::printComparison(std::cout, comparisons, baseline.samples, reporter.samples());
+    const auto regressions = std::count_if(comparisons.begin(), comparisons.end(),
+                                           [](const auto& comparison) { return comparison.regression; });
+    if (regressions > 0) {
+        std::cout << regressions << " regression(s) beyond " << g_settings.threshold * 100.0 << "%\n";
+        return 2;
+    }
+    return 0;
+}
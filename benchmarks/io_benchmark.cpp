@@ -0,0 +1,117 @@
+#include <benchmark/benchmark.h>
+#include "io/buffered_io.h"
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr size_t SOURCE_FILE_SIZE = 256 * 1024 * 1024;   // 256MB, past LARGE_FILE_THRESHOLD
+
+    std::filesystem::path benchmarkDir() {
+        auto dir = std::filesystem::temp_directory_path() / "flux_io_benchmark";
+        std::filesystem::create_directories(dir);
+        return dir;
+    }
+
+    // Random content so filesystems with compression or dedup cannot shortcut I/O
+    const std::filesystem::path& sourceFile(size_t size) {
+        static std::filesystem::path path;
+        static size_t created_size = 0;
+        if (created_size < size) {
+            path = benchmarkDir() / "source.bin";
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            std::mt19937_64 rng(42);
+            std::vector<uint64_t> block(1 << 16);
+            for (size_t written = 0; written < size; written += block.size() * sizeof(uint64_t)) {
+                for (auto& word : block) {
+                    word = rng();
+                }
+                file.write(reinterpret_cast<const char*>(block.data()),
+                           static_cast<std::streamsize>(block.size() * sizeof(uint64_t)));
+            }
+            created_size = size;
+        }
+        return path;
+    }
+
+    std::vector<int64_t> bufferSizes() {
+        std::vector<int64_t> sizes;
+        for (int64_t size = 4 * 1024; size <= 16 * 1024 * 1024; size *= 4) {
+            sizes.push_back(size);
+        }
+        sizes.push_back(0);    // Adaptive: chooseBufferSize
+        return sizes;
+    }
+}
+
+// Sequential read throughput by block size (0 = adaptive)
+static void BM_BufferedRead(benchmark::State& state) {
+    const auto& path = sourceFile(SOURCE_FILE_SIZE);
+    const auto buffer_size = static_cast<size_t>(state.range(0));
+
+    for (auto _ : state) {
+        Flux::IO::BufferedReader reader(path, buffer_size);
+        size_t total = 0;
+        for (auto block = reader.read(); !block.empty(); block = reader.read()) {
+            total += block.size();
+        }
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(SOURCE_FILE_SIZE));
+    state.SetLabel(buffer_size == 0 ? "adaptive" : std::to_string(buffer_size / 1024) + "KB");
+}
+BENCHMARK(BM_BufferedRead)->ArgsProduct({bufferSizes()})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Sequential write throughput by block size, with producers filling 64KB chunks
+static void BM_BufferedWrite(benchmark::State& state) {
+    const auto path = benchmarkDir() / "output.bin";
+    const auto buffer_size = static_cast<size_t>(state.range(0));
+    constexpr size_t WRITE_SIZE = 64 * 1024 * 1024;
+    const std::vector<std::byte> chunk(64 * 1024, std::byte{0x5A});
+
+    for (auto _ : state) {
+        Flux::IO::BufferedWriter writer(path, WRITE_SIZE, buffer_size);
+        for (size_t written = 0; written < WRITE_SIZE; written += chunk.size()) {
+            writer.write(chunk);
+        }
+        writer.close();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(WRITE_SIZE));
+    state.SetLabel(buffer_size == 0 ? "adaptive" : std::to_string(buffer_size / 1024) + "KB");
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_BufferedWrite)->ArgsProduct({bufferSizes()})->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Adaptive sizing across file sizes around SMALL_FILE_THRESHOLD and LARGE_FILE_THRESHOLD
+static void BM_AdaptiveReadByFileSize(benchmark::State& state) {
+    const auto file_size = static_cast<size_t>(state.range(0));
+    const auto path = benchmarkDir() / ("sized_" + std::to_string(file_size) + ".bin");
+    {
+        std::ifstream source(sourceFile(SOURCE_FILE_SIZE), std::ios::binary);
+        std::vector<char> data(file_size);
+        source.read(data.data(), static_cast<std::streamsize>(data.size()));
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    for (auto _ : state) {
+        Flux::IO::BufferedReader reader(path);
+        size_t total = 0;
+        for (auto block = reader.read(); !block.empty(); block = reader.read()) {
+            total += block.size();
+        }
+        benchmark::DoNotOptimize(total);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(file_size));
+    state.counters["buffer_kb"] = static_cast<double>(Flux::IO::chooseBufferSize(file_size)) / 1024.0;
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_AdaptiveReadByFileSize)->RangeMultiplier(8)->Range(4 * 1024, 128 * 1024 * 1024)
+    ->Unit(benchmark::kMicrosecond)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,201 @@
+#include "regression_compare.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+namespace Flux::Bench {
+    namespace {
+        // Above this many outcomes (n1 * n2) the normal approximation is accurate enough
+        constexpr size_t EXACT_TEST_LIMIT = 400;
+
+        double unitSeconds(const std::string& unit) {
+            if (unit == "ns") return 1e-9;
+            if (unit == "us") return 1e-6;
+            if (unit == "ms") return 1e-3;
+            if (unit == "s") return 1.0;
+            throw std::runtime_error("Unknown time unit in baseline: " + unit);
+        }
+
+        double median(std::vector<double> values) {
+            std::sort(values.begin(), values.end());
+            const size_t mid = values.size() / 2;
+            return values.size() % 2 ? values[mid] : (values[mid - 1] + values[mid]) / 2.0;
+        }
+
+        /**
+         * P(U <= u) without ties, U counting pairs where an element of the first sample is larger
+         *
+         * ways[m][k] is the number of orderings of m first-sample and j second-sample
+         * elements giving U == k, built up one second-sample element j at a time.
+         */
+        double exactLowerTail(size_t n1, size_t n2, double u) {
+            const size_t max_u = n1 * n2;
+            // ways[m] for the current j, each a distribution over U
+            std::vector<std::vector<double>> ways(n1 + 1, std::vector<double>(max_u + 1, 0.0));
+            for (size_t m = 0; m <= n1; ++m) {
+                ways[m][0] = 1.0;    // j == 0: a single ordering with U == 0
+            }
+            for (size_t j = 1; j <= n2; ++j) {
+                std::vector<std::vector<double>> next(n1 + 1, std::vector<double>(max_u + 1, 0.0));
+                next[0][0] = 1.0;
+                for (size_t m = 1; m <= n1; ++m) {
+                    for (size_t k = 0; k <= m * j; ++k) {
+                        // Largest element from the first sample: it beats all j second-sample elements
+                        const double largest_first = k >= j ? next[m - 1][k - j] : 0.0;
+                        // Largest element from the second sample: it adds nothing
+                        next[m][k] = largest_first + ways[m][k];
+                    }
+                }
+                ways = std::move(next);
+            }
+            const auto& distribution = ways[n1];
+            const double total = std::accumulate(distribution.begin(), distribution.end(), 0.0);
+            double below = 0.0;
+            for (size_t k = 0; k <= max_u && static_cast<double>(k) <= u; ++k) {
+                below += distribution[k];
+            }
+            return below / total;
+        }
+    }
+
+    Baseline loadBaseline(const std::filesystem::path& path) {
+        std::ifstream file(path);
+        if (!file) {
+            throw std::runtime_error("Cannot open baseline " + path.string());
+        }
+        nlohmann::json json;
+        try {
+            file >> json;
+        } catch (const nlohmann::json::exception& e) {
+            throw std::runtime_error("Cannot parse baseline " + path.string() + ": " + e.what());
+        }
+
+        Baseline baseline;
+        if (const auto context = json.find("context"); context != json.end() && context->contains("corpus_scale")) {
+            baseline.corpus_scale = std::stod(context->at("corpus_scale").get<std::string>());
+        }
+        for (const auto& run : json.value("benchmarks", nlohmann::json::array())) {
+            if (run.value("run_type", "iteration") != "iteration" || run.value("error_occurred", false) ||
+                run.value("skipped", false) || !run.contains("real_time")) {
+                continue;
+            }
+            const std::string name = run.value("run_name", run.value("name", ""));
+            baseline.samples[name].push_back(run.at("real_time").get<double>() * unitSeconds(run.value("time_unit", "ns")));
+        }
+        if (baseline.samples.empty()) {
+            throw std::runtime_error("Baseline " + path.string() + " has no per-repetition results");
+        }
+        return baseline;
+    }
+
+    double mannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b) {
+        const size_t n1 = a.size();
+        const size_t n2 = b.size();
+        if (n1 == 0 || n2 == 0) {
+            return 1.0;
+        }
+
+        // Rank the pooled sample, ties sharing their average rank
+        std::vector<std::pair<double, bool>> pooled;
+        pooled.reserve(n1 + n2);
+        for (const double value : a) pooled.emplace_back(value, true);
+        for (const double value : b) pooled.emplace_back(value, false);
+        std::sort(pooled.begin(), pooled.end());
+
+        const size_t n = pooled.size();
+        double rank_sum_a = 0.0;
+        double tie_term = 0.0;    // Sum of t^3 - t over groups of t tied values
+        for (size_t i = 0; i < n;) {
+            size_t j = i;
+            while (j < n && pooled[j].first == pooled[i].first) {
+                ++j;
+            }
+            const double average_rank = (static_cast<double>(i + 1) + static_cast<double>(j)) / 2.0;
+            for (size_t k = i; k < j; ++k) {
+                if (pooled[k].second) {
+                    rank_sum_a += average_rank;
+                }
+            }
+            const auto t = static_cast<double>(j - i);
+            tie_term += t * t * t - t;
+            i = j;
+        }
+
+        const double u = rank_sum_a - static_cast<double>(n1 * (n1 + 1)) / 2.0;
+        const double mean = static_cast<double>(n1 * n2) / 2.0;
+
+        if (tie_term == 0.0 && n1 * n2 <= EXACT_TEST_LIMIT) {
+            // U is symmetric around its mean, so the smaller tail doubled is the two-sided p-value
+            const double lower = exactLowerTail(n1, n2, std::min(u, 2.0 * mean - u));
+            return std::min(1.0, 2.0 * lower);
+        }
+
+        const auto total = static_cast<double>(n);
+        const double variance = static_cast<double>(n1 * n2) / 12.0 *
+                                ((total + 1.0) - tie_term / (total * (total - 1.0)));
+        if (variance <= 0.0) {
+            return 1.0;
+        }
+        const double distance = std::max(0.0, std::abs(u - mean) - 0.5);
+        return std::erfc(distance / std::sqrt(variance) / std::sqrt(2.0));
+    }
+
+    std::vector<Comparison> compareRuns(const RunSamples& baseline, const RunSamples& current,
+                                        double threshold, double alpha) {
+        std::vector<Comparison> comparisons;
+        for (const auto& [name, before] : baseline) {
+            const auto after = current.find(name);
+            if (after == current.end() || before.empty() || after->second.empty()) {
+                continue;
+            }
+            Comparison comparison;
+            comparison.name = name;
+            comparison.baseline_median = median(before);
+            comparison.current_median = median(after->second);
+            comparison.change = comparison.current_median / comparison.baseline_median - 1.0;
+            comparison.p_value = mannWhitneyPValue(before, after->second);
+            comparison.regression = comparison.change > threshold && comparison.p_value < alpha;
+            comparisons.push_back(std::move(comparison));
+        }
+        return comparisons;
+    }
+
+    void printComparison(std::ostream& out, const std::vector<Comparison>& comparisons,
+                         const RunSamples& baseline, const RunSamples& current) {
+        size_t width = 9;
+        for (const auto& comparison : comparisons) {
+            width = std::max(width, comparison.name.size());
+        }
+
+        const auto flags = out.flags();
+        out << std::left << std::setw(static_cast<int>(width)) << "Benchmark"
+            << std::right << std::setw(14) << "Baseline ms" << std::setw(14) << "Current ms"
+            << std::setw(10) << "Change" << std::setw(10) << "p" << "\n";
+        out << std::string(width + 48, '-') << "\n";
+        for (const auto& comparison : comparisons) {
+            out << std::left << std::setw(static_cast<int>(width)) << comparison.name << std::right << std::fixed
+                << std::setprecision(3) << std::setw(14) << comparison.baseline_median * 1e3
+                << std::setw(14) << comparison.current_median * 1e3
+                << std::showpos << std::setprecision(1) << std::setw(9) << comparison.change * 100.0 << "%"
+                << std::noshowpos << std::setprecision(4) << std::setw(10) << comparison.p_value
+                << (comparison.regression ? "  REGRESSION" : "") << "\n";
+        }
+        out.flags(flags);
+
+        for (const auto& [name, samples] : baseline) {
+            if (!current.contains(name)) {
+                out << "Not rerun: " << name << "\n";
+            }
+        }
+        for (const auto& [name, samples] : current) {
+            if (!baseline.contains(name)) {
+                out << "Not in baseline: " << name << "\n";
+            }
+        }
+    }
+}
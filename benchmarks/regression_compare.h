@@ -0,0 +1,60 @@
+#pragma once
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace Flux::Bench {
+    /**
+     * Per-repetition wall times in seconds, by run name
+     * (as Google Benchmark names runs, e.g. "pack/zip/small/level:1/threads:1/process_time/real_time")
+     */
+    using RunSamples = std::map<std::string, std::vector<double>>;
+
+    struct Baseline {
+        RunSamples samples;
+        std::optional<double> corpus_scale;   // From the run context, if recorded
+    };
+
+    /**
+     * Load a Google Benchmark JSON result file (--benchmark_out_format=json)
+     *
+     * Only per-repetition entries are used, so the baseline must be recorded
+     * with --benchmark_repetitions and without --benchmark_report_aggregates_only.
+     * @throws std::runtime_error if the file cannot be read or parsed
+     */
+    [[nodiscard]] Baseline loadBaseline(const std::filesystem::path& path);
+
+    /**
+     * Two-sided p-value of the Mann-Whitney U test for a and b coming from the same distribution
+     *
+     * Exact for small samples without ties, normal approximation with tie and
+     * continuity correction otherwise.
+     */
+    [[nodiscard]] double mannWhitneyPValue(const std::vector<double>& a, const std::vector<double>& b);
+
+    struct Comparison {
+        std::string name;
+        double baseline_median = 0;   // Seconds
+        double current_median = 0;    // Seconds
+        double change = 0;            // current / baseline - 1
+        double p_value = 1;
+        bool regression = false;      // Slower by more than the threshold, and significant
+    };
+
+    /**
+     * Compare every run present in both sets
+     * @param threshold Relative slowdown that counts (0.05 = 5%)
+     * @param alpha Significance level
+     */
+    [[nodiscard]] std::vector<Comparison> compareRuns(const RunSamples& baseline, const RunSamples& current,
+                                                      double threshold, double alpha);
+
+    /**
+     * Table of comparisons, followed by runs found on only one side
+     */
+    void printComparison(std::ostream& out, const std::vector<Comparison>& comparisons,
+                         const RunSamples& baseline, const RunSamples& current);
+}
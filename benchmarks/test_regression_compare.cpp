@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "regression_compare.h"
+#include <vector>
+
+using Flux::Bench::mannWhitneyPValue;
+
+// Exact values count the orderings with U at most the observed one: C(n1 + n2, n1) in all
+
+TEST(MannWhitneyTest, ExactSeparatedSamples) {
+    // U = 0, 1 of 20 orderings is as extreme on each side
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({1, 2, 3}, {4, 5, 6}), 0.1);
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({4, 5, 6}, {1, 2, 3}), 0.1);
+}
+
+TEST(MannWhitneyTest, ExactSmallSamples) {
+    // U = 1: 2 of 20 orderings
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({1, 2, 4}, {3, 5, 6}), 0.2);
+    // U = 2: 4 of 252 orderings
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({1, 2, 3, 4, 7}, {5, 6, 8, 9, 10}), 8.0 / 252.0);
+    // Unequal sizes, unsorted input; U = 1: 2 of 35 orderings
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({3, 1, 2, 5}, {4, 7, 6}), 4.0 / 35.0);
+}
+
+TEST(MannWhitneyTest, ExactTailIsCappedAtOne) {
+    // U sits at its mean, so both tails together exceed one
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({1, 4}, {2, 3}), 1.0);
+}
+
+TEST(MannWhitneyTest, TiesUseCorrectedNormalApproximation) {
+    // Ranks 1, 3, 3, 5.5, 8 give U = 5.5 against a mean of 12.5. The tie groups
+    // of three and two shrink the variance to 25/12 * (11 - 30/90) = 200/9, and
+    // the continuity correction leaves |U - mean| = 6.5: z = 1.378858, p = 0.167938
+    EXPECT_NEAR(mannWhitneyPValue({1, 2, 2, 3, 5}, {2, 3, 4, 6, 7}), 0.16793847098801243, 1e-12);
+}
+
+TEST(MannWhitneyTest, LargeSamplesUseNormalApproximation) {
+    // 21 * 21 outcomes is past the exact limit; U = 0, z = (220.5 - 0.5) / sqrt(441 / 12 * 43)
+    std::vector<double> low;
+    std::vector<double> high;
+    for (int i = 0; i < 21; ++i) {
+        low.push_back(i);
+        high.push_back(100 + i);
+    }
+    EXPECT_NEAR(mannWhitneyPValue(low, high), 3.1253999984e-8, 1e-16);
+}
+
+TEST(MannWhitneyTest, IdenticalSamples) {
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({1, 2, 3}, {1, 2, 3}), 1.0);
+    // Every value tied leaves no variance
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({5, 5, 5}, {5, 5, 5}), 1.0);
+}
+
+TEST(MannWhitneyTest, EmptySample) {
+    EXPECT_DOUBLE_EQ(mannWhitneyPValue({}, {1, 2, 3}), 1.0);
+}
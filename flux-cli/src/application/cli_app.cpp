@@ -10,10 +10,12 @@
 
 #include <flux-core/flux.h>
 #include <flux-core/exceptions.h>
+#include <flux-core/trace.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <iostream>
 #include <iomanip>
 #include <chrono>
+#include <cstdlib>
 #include <sstream>
 
 #ifdef _WIN32
@@ -27,6 +29,20 @@ namespace Flux {
 
 namespace FluxCLI {
 
+namespace {
+    // Commands leave through std::exit on failure, so the trace is written at exit
+    std::filesystem::path g_trace_path;
+
+    void writeTrace() {
+        auto written = Flux::Trace::writeChromeTrace(g_trace_path);
+        if (written) {
+            spdlog::info("Wrote {} trace spans to {}", *written, g_trace_path.string());
+        } else {
+            spdlog::error("{}", written.error());
+        }
+    }
+}
+
 CLIApp::CLIApp() {
     // Initialize Flux core library
     Flux::initialize();
@@ -99,6 +115,10 @@ void CLIApp::setupGlobalOptions() {
     // Version information
     m_app->add_flag("--version", m_version, "Show version information");
     
+    // Trace spans of the run; option callbacks run before the subcommand's
+    m_app->add_option_function<std::string>("--trace", [](const std::string& path) { startTracing(path); },
+                                            "Write a Chrome trace-event file (chrome://tracing, ui.perfetto.dev)");
+    
     // Mutually exclusive options: verbose and quiet cannot be used together
     m_app->add_flag("-v,--verbose", m_verbose, "Enable verbose output mode")
          ->excludes(m_app->add_flag("-q,--quiet", m_quiet, "Quiet mode, only output error messages"));
@@ -132,6 +152,18 @@ void CLIApp::setupCommands() {
     Commands::setupSmartCommand(smart_cmd, m_verbose, m_quiet);
 }
 
+void CLIApp::startTracing(const std::filesystem::path& path) {
+    if (!Flux::Trace::compiled_in) {
+        spdlog::warn("This build has no trace spans; {} will be empty", path.string());
+    }
+    const bool first = g_trace_path.empty();
+    g_trace_path = path;
+    if (first) {
+        std::atexit(writeTrace);
+    }
+    Flux::Trace::start();
+}
+
 void CLIApp::setupLogging() {
     // Set log level based on global flags
     if (m_quiet) {
@@ -2,6 +2,7 @@
 
 #include <CLI/CLI.hpp>
 #include <spdlog/spdlog.h>
+#include <filesystem>
 #include <memory>
 #include <string>
 #include <functional>
@@ -49,6 +50,7 @@ namespace FluxCLI {
         void setupGlobalOptions();
         void setupCommands();
         void setupLogging();
+        static void startTracing(const std::filesystem::path& path);
         void printVersion() const;
         void printHelp() const;
         
@@ -6,6 +6,7 @@
 #include <flux-core/extractor.h>
 #include <flux-core/packer.h>
 #include <flux-core/exceptions.h>
+#include <flux-core/trace.h>
 #include <spdlog/spdlog.h>
 #include <iostream>
 #include <algorithm>
@@ -124,6 +125,7 @@ void setupAutoCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executeAutoCommand(const AutoConfig& config) {
+    FLUX_TRACE_SPAN("cli.auto");
     try {
         spdlog::info("Starting auto operation");
         
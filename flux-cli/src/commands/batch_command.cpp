@@ -2,8 +2,10 @@
 #include "auto_command.h"
 #include "../utils/format_utils.h"
 #include "../utils/progress_bar.h"
+#include <flux-core/codec_pool.h>
 #include <flux-core/extractor.h>
 #include <flux-core/packer.h>
+#include <flux-core/trace.h>
 #include <flux-core/exceptions.h>
 #include <spdlog/spdlog.h>
 #include <iostream>
@@ -103,6 +105,7 @@ void setupBatchCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executeBatchCommand(const BatchConfig& config) {
+    FLUX_TRACE_SPAN("cli.batch", config.operation);
     try {
         spdlog::info("Starting batch {} operation", config.operation);
         spdlog::info("Max parallel operations: {}", config.max_parallel);
@@ -118,6 +121,8 @@ int executeBatchCommand(const BatchConfig& config) {
         }
         
         printBatchSummary(results);
+        const auto pool_stats = Flux::codecPoolStats();
+        spdlog::debug("Codec pools: {} allocated, {} reused", pool_stats.created, pool_stats.reused);
         
         // Count failures
         int failures = std::count_if(results.begin(), results.end(),
@@ -162,6 +167,7 @@ std::vector<BatchResult> batchExtract(const BatchConfig& config) {
         futures.emplace_back(std::async(std::launch::async, [&, i, end_idx]() {
             for (size_t idx = i; idx < end_idx && !should_stop.load(); ++idx) {
                 const auto& archive_path = archive_files[idx];
+                FLUX_TRACE_SPAN("batch.extract_archive", archive_path);
                 
                 auto start_time = std::chrono::steady_clock::now();
                 
@@ -225,6 +231,7 @@ std::vector<BatchResult> batchPack(const BatchConfig& config) {
     
     // For pack operation, each input becomes one archive
     for (const auto& input : config.inputs) {
+        FLUX_TRACE_SPAN("batch.pack_input", input);
         BatchResult result;
         result.input_path = input;
         
@@ -284,6 +291,7 @@ std::vector<BatchResult> batchConvert(const BatchConfig& config) {
     std::vector<BatchResult> results;
     
     for (const auto& archive_path : archive_files) {
+        FLUX_TRACE_SPAN("batch.convert_archive", archive_path);
         BatchResult result;
         result.input_path = archive_path;
         
@@ -3,6 +3,7 @@
 #include "../utils/progress_bar.h"
 #include <flux-core/extractor.h>
 #include <flux-core/exceptions.h>
+#include <flux-core/trace.h>
 #include <spdlog/spdlog.h>
 #include <iostream>
 
@@ -42,6 +43,7 @@ Flux::ExtractOptions ExtractConfig::toFluxOptions() const {
         options.password = password;
     options.include_patterns = include_patterns;
     options.exclude_patterns = exclude_patterns;
+    options.chunk_store = chunk_store;
     
     return options;
 }
@@ -80,6 +82,11 @@ void setupExtractCommand(CLI::App* app, bool& verbose, bool& quiet) {
     app->add_option("--include", config.include_patterns, "Only extract files matching patterns");
     app->add_option("--exclude", config.exclude_patterns, "Exclude files matching patterns");
     
+    // Chunk store of deduplicating archives
+    app->add_option("--chunk-store", config.chunk_store,
+                    "Read chunks from this store instead of the one recorded in the archive (fxd)")
+       ->check(CLI::ExistingDirectory);
+    
     // Permissions and timestamps
     app->add_flag("--no-permissions", [&config](size_t) { config.preserve_permissions = false; },
                   "Do not preserve file permissions");
@@ -118,6 +125,7 @@ void setupExtractCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executeExtractCommand(const ExtractConfig& config) {
+    FLUX_TRACE_SPAN("cli.extract", config.archive);
     try {
         spdlog::info("Starting extract operation");
         spdlog::debug("Archive file: {}", config.archive.string());
@@ -20,6 +20,7 @@ namespace FluxCLI::Commands {
         std::vector<std::string> exclude_patterns;    // 排除模式
         bool preserve_permissions = true;             // 保留权限
         bool preserve_timestamps = true;              // 保留时间戳
+        std::filesystem::path chunk_store;            // 覆盖归档记录的分块存储目录 (fxd 格式)
         bool verbose = false;                         // 详细模式
         bool quiet = false;                           // 静默模式
         
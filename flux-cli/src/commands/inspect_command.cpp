@@ -2,6 +2,7 @@
 #include "../utils/format_utils.h"
 #include <flux-core/exceptions.h>
 #include <flux-core/packer.h>
+#include <flux-core/trace.h>
 #include <spdlog/spdlog.h>
 #include <nlohmann/json.hpp>
 #include <iostream>
@@ -98,6 +99,7 @@ void setupInspectCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executeInspectCommand(const InspectConfig& config) {
+    FLUX_TRACE_SPAN("cli.inspect", config.archive);
     try {
         if (!config.quiet) {
             spdlog::info("Inspecting archive: {}", config.archive.string());
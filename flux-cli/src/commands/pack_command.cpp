@@ -3,6 +3,7 @@
 #include "../utils/progress_bar.h"
 #include <flux-core/packer.h>
 #include <flux-core/exceptions.h>
+#include <flux-core/trace.h>
 #include <spdlog/spdlog.h>
 #include <algorithm>
 #include <set>
@@ -74,6 +75,24 @@ Flux::PackOptions PackConfig::toFluxOptions() const {
     options.preserve_permissions = preserve_permissions;
     options.preserve_timestamps = preserve_timestamps;
         options.password = password;
+    options.exclude_patterns = exclude_patterns;
+    if (strategy == "store") {
+        options.compression_strategy = Flux::CompressionStrategy::STORE;
+    } else if (strategy == "compress") {
+        options.compression_strategy = Flux::CompressionStrategy::COMPRESS;
+    }
+
+    options.seekable = seekable;
+    options.incremental_base = incremental_base;
+    options.chunk_size = chunk_size;
+    options.chunk_store = chunk_store;
+    options.zstd_dictionary = dictionary;
+    options.train_dictionary = train_dictionary;
+    if (index_mode == "sidecar") {
+        options.index_mode = Flux::IndexMode::SIDECAR;
+    } else if (index_mode == "embedded") {
+        options.index_mode = Flux::IndexMode::EMBEDDED;
+    }
 
     return options;
 }
@@ -108,7 +127,8 @@ void setupPackCommand(CLI::App* app, bool& verbose, bool& quiet) {
     app->add_option("--exclude", config.exclude_patterns, "Exclude file patterns (supports glob)");
     
     // Compression strategy
-    app->add_option("--strategy", config.strategy, "Compression strategy")
+    app->add_option("--strategy", config.strategy,
+                    "Compression strategy: auto stores already-compressed files, store and compress apply to all (zip)")
        ->check(CLI::IsMember({"auto", "store", "compress"}));
     
     // Password protection
@@ -120,6 +140,29 @@ void setupPackCommand(CLI::App* app, bool& verbose, bool& quiet) {
     app->add_flag("--no-timestamps", [&config](size_t) { config.preserve_timestamps = false; },
                   "Do not preserve file timestamps");
     
+    // Archive index
+    app->add_option("--index", config.index_mode, "Write an index for fast listing (TAR formats)")
+       ->check(CLI::IsMember({"none", "sidecar", "embedded"}));
+    app->add_flag("--seekable", config.seekable,
+                  "Write independent zstd frames with a seek table for fast partial extraction (tar.zst)");
+    app->add_option("--incremental", config.incremental_base,
+                    "Only pack what changed since this archive or index (TAR formats)")
+       ->check(CLI::ExistingFile);
+    
+    // Deduplicating archives
+    app->add_option("--chunk-size", config.chunk_size, "Average chunk size in bytes for deduplication (fxd)")
+       ->check(CLI::Range(size_t{4096}, size_t{4} * 1024 * 1024));
+    app->add_option("--chunk-store", config.chunk_store,
+                    "Keep chunks in this directory, shared between archives, instead of in the archive (fxd)");
+    
+    // zstd dictionaries for many small files
+    auto* dictionary_option = app->add_option("--dictionary", config.dictionary,
+                                              "Compress with this zstd dictionary (tar.zst, fxd)")
+       ->check(CLI::ExistingFile);
+    app->add_flag("--train-dictionary", config.train_dictionary,
+                  "Train a zstd dictionary on the small input files and embed it (tar.zst, fxd)")
+       ->excludes(dictionary_option);
+    
     // Command callback
     app->callback([&config, &input_strings, &output_string, &verbose, &quiet]() {
         // Convert input paths
@@ -144,6 +187,7 @@ void setupPackCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executePackCommand(const PackConfig& config) {
+    FLUX_TRACE_SPAN("cli.pack", config.output);
     try {
         spdlog::info("Starting pack operation");
         spdlog::debug("Output file: {}", config.output.string());
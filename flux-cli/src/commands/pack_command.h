@@ -22,6 +22,13 @@ namespace FluxCLI::Commands {
         std::string password;                         // 密码保护
         bool preserve_permissions = true;             // 保留权限
         bool preserve_timestamps = true;              // 保留时间戳
+        std::string index_mode = "none";              // 归档索引 (none/sidecar/embedded)
+        bool seekable = false;                        // 可随机访问的 zstd 帧 (TAR_ZSTD)
+        std::filesystem::path incremental_base;       // 增量打包的基准归档或索引 (TAR 格式)
+        size_t chunk_size = 0;                        // 平均分块大小 (fxd 格式, 0 表示默认)
+        std::filesystem::path chunk_store;            // 跨归档共享的分块存储目录 (fxd 格式)
+        std::filesystem::path dictionary;             // zstd 字典文件 (tar.zst / fxd 格式)
+        bool train_dictionary = false;                // 从小文件训练 zstd 字典 (tar.zst / fxd 格式)
         bool verbose = false;                         // 详细模式
         bool quiet = false;                           // 静默模式
         
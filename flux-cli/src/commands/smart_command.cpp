@@ -4,6 +4,7 @@
 #include "../utils/progress_bar.h"
 #include <flux-core/functional/operations.h>
 #include <flux-core/error/error_handling.h>
+#include <flux-core/trace.h>
 #include <spdlog/spdlog.h>
 #include <iostream>
 #include <algorithm>
@@ -85,6 +86,7 @@ void setupSmartCommand(CLI::App* app, bool& verbose, bool& quiet) {
 }
 
 int executeSmartCommand(const SmartConfig& config) {
+    FLUX_TRACE_SPAN("cli.smart");
     // Convert to modern execution config
     SmartExecutionConfig execConfig{
         .inputs = config.inputs,
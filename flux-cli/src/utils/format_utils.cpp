@@ -30,6 +30,8 @@ Flux::ArchiveFormat FormatUtils::detectFormatFromExtension(const std::filesystem
         return Flux::ArchiveFormat::ZIP;
     } else if (ext == ".7z") {
         return Flux::ArchiveFormat::SEVEN_ZIP;
+    } else if (ext == ".fxd") {
+        return Flux::ArchiveFormat::FLUX_DEDUP;
     } else if (ext == ".tgz") {
         return Flux::ArchiveFormat::TAR_GZ;
     } else if (ext == ".txz") {
@@ -73,6 +75,11 @@ Flux::ArchiveFormat FormatUtils::detectFormatFromContent(const std::filesystem::
         return Flux::ArchiveFormat::SEVEN_ZIP;
     }
     
+    // Flux dedup archive detection
+    if (bytes_read >= 8 && std::string(header, 8) == "FLUXDDP1") {
+        return Flux::ArchiveFormat::FLUX_DEDUP;
+    }
+    
     // TAR format detection (check POSIX tar header)
     if (bytes_read >= 8) {
         // TAR files have "ustar" identifier at offset 257, but we first check if it might be TAR
@@ -129,6 +136,8 @@ Flux::ArchiveFormat FormatUtils::parseFormatString(const std::string& format_str
         return Flux::ArchiveFormat::TAR_ZSTD;
     } else if (lower_format == "7z") {
         return Flux::ArchiveFormat::SEVEN_ZIP;
+    } else if (lower_format == "fxd" || lower_format == "dedup") {
+        return Flux::ArchiveFormat::FLUX_DEDUP;
     } else {
         throw Flux::UnsupportedFormatException(format_str);
     }
@@ -146,13 +155,15 @@ std::string FormatUtils::getDefaultExtension(Flux::ArchiveFormat format) {
             return ".tar.zst";
         case Flux::ArchiveFormat::SEVEN_ZIP:
             return ".7z";
+        case Flux::ArchiveFormat::FLUX_DEDUP:
+            return ".fxd";
         default:
             return ".unknown";
     }
 }
 
 std::vector<std::string> FormatUtils::getSupportedFormatStrings() {
-    return {"zip", "tar.gz", "tgz", "tar.xz", "txz", "tar.zst", "tar.zstd", "7z"};
+    return {"zip", "tar.gz", "tgz", "tar.xz", "txz", "tar.zst", "tar.zstd", "7z", "fxd"};
 }
 
 bool FormatUtils::isCompressionLevelValid(Flux::ArchiveFormat format, int level) {
@@ -172,6 +183,8 @@ std::tuple<int, int, int> FormatUtils::getCompressionLevelRange(Flux::ArchiveFor
             return {1, 22, 3}; // Zstd: 1-22, default 3
         case Flux::ArchiveFormat::SEVEN_ZIP:
             return {0, 9, 5};  // 7-Zip: 0-9, default 5
+        case Flux::ArchiveFormat::FLUX_DEDUP:
+            return {1, 9, 3};  // Per-chunk zstd: 1-9, default 3
         default:
             return {0, 9, 3};
     }
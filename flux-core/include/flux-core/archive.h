@@ -1,4 +1,6 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <filesystem>
@@ -12,7 +14,8 @@ namespace Flux {
         TAR_ZSTD,   // TAR + Zstandard compression
         TAR_GZ,     // TAR + Gzip compression
         TAR_XZ,     // TAR + XZ compression
-        SEVEN_ZIP   // 7-Zip format
+        SEVEN_ZIP,  // 7-Zip format
+        FLUX_DEDUP  // Deduplicating chunk archive (.fxd)
     };
 
     /**
@@ -24,6 +27,24 @@ namespace Flux {
         PROMPT      // Prompt user for choice
     };
 
+    /**
+     * Where to store an archive index (see archive_index.h)
+     */
+    enum class IndexMode {
+        NONE,       // Do not write an index
+        SIDECAR,    // Separate "<archive>.fidx" file
+        EMBEDDED    // Trailing skippable frame (TAR_ZSTD; sidecar otherwise)
+    };
+
+    /**
+     * Whether files are compressed (ZIP)
+     */
+    enum class CompressionStrategy {
+        AUTO,       // Store already-compressed content, compress the rest
+        STORE,      // Store every file
+        COMPRESS    // Compress every file at the chosen level
+    };
+
     /**
      * Compression options configuration
      */
@@ -34,6 +55,19 @@ namespace Flux {
         bool preserve_permissions = true;                 // Preserve file permissions
         bool preserve_timestamps = true;                  // Preserve timestamps
         std::string password;                            // Password protection (optional)
+        CompressionStrategy compression_strategy = CompressionStrategy::AUTO;  // Per-file store or compress (ZIP)
+        bool solid = true;                               // Compress files together in solid blocks (7z)
+        uint64_t solid_block_size = 0;                   // Max bytes per solid block (0 = automatic)
+        IndexMode index_mode = IndexMode::NONE;          // Archive index for fast listing (TAR formats)
+        bool seekable = false;                           // Independent zstd frames plus a seek table (TAR_ZSTD; implies an index)
+        std::filesystem::path incremental_base;          // Previous archive or its index: pack only changes since then (TAR formats)
+        size_t chunk_size = 0;                           // Average content-defined chunk size (FLUX_DEDUP; 0 = 64 KiB)
+        std::filesystem::path chunk_store;               // Shared chunk directory instead of storing chunks inline (FLUX_DEDUP)
+        std::filesystem::path zstd_dictionary;           // zstd dictionary to compress with, embedded in the archive (TAR_ZSTD, FLUX_DEDUP)
+        bool train_dictionary = false;                   // Train a zstd dictionary from the small input files (TAR_ZSTD, FLUX_DEDUP)
+        std::vector<std::string> include_patterns;       // Only pack files matching these (directories are still walked)
+        std::vector<std::string> exclude_patterns;       // Skip files and whole directories matching these
+        bool collect_metrics = false;                    // Fill PackResult::metrics
         
         // Validate compression level
         bool isCompressionLevelValid() const {
@@ -46,12 +80,41 @@ namespace Flux {
      */
     struct ExtractOptions {
         OverwriteMode overwrite_mode = OverwriteMode::SKIP;  // Overwrite mode
+        int num_threads = 0;                                 // Thread count (0 = auto)
         bool hoist_single_folder = false;                   // Hoist single folder
         bool preserve_permissions = true;                    // Preserve file permissions
         bool preserve_timestamps = true;                     // Preserve timestamps
         std::string password;                               // Password (if required)
+        std::filesystem::path chunk_store;                  // Chunk store to read from instead of the one recorded (FLUX_DEDUP)
         std::vector<std::string> include_patterns;          // Include patterns
         std::vector<std::string> exclude_patterns;          // Exclude patterns
+        bool collect_metrics = false;                       // Fill ExtractResult::metrics
+    };
+
+    /**
+     * Where a pack or extract operation spent its time, and what it did
+     *
+     * Each moment of a thread is charged to one phase, the innermost one
+     * running, and phase times are summed over all threads taking part, so
+     * with parallel work they can add up to more than the duration. Time in
+     * none of the phases (planning, waiting on other threads) is not counted.
+     * Phases that do not apply to an operation stay zero.
+     */
+    struct OperationMetrics {
+        std::chrono::nanoseconds directory_scan{0};   // Walking input directories
+        std::chrono::nanoseconds header_parse{0};     // Reading archive headers, directories and entry metadata
+        std::chrono::nanoseconds disk_read{0};        // Reading input files or the archive
+        std::chrono::nanoseconds codec{0};            // Compression or decompression
+        std::chrono::nanoseconds disk_write{0};       // Writing output files or the archive
+        std::chrono::nanoseconds metadata_apply{0};   // Restoring directories, permissions and times
+        std::chrono::nanoseconds callbacks{0};        // Inside on_progress and on_error
+        uint64_t syscalls{0};             // I/O calls issued by flux-core (open, read, write, close, mmap, io_uring submits);
+                                          // libzip and libarchive's own file I/O is not seen
+        uint64_t bytes_read{0};           // Bytes read from input files or the archive
+        uint64_t entries_skipped{0};      // Entries left out by filters, overwrite mode or read errors
+        uint64_t peak_buffer_bytes{0};    // Most I/O buffer and queued output memory held at once
+
+        auto operator<=>(const OperationMetrics&) const = default;
     };
 
     /**
@@ -0,0 +1,101 @@
+#pragma once
+#include "archive.h"
+#include "compat.h"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Flux {
+    /**
+     * Entry recorded in an archive index
+     */
+    struct IndexEntry {
+        std::string path;                    // Path stored in the archive
+        uint64_t size = 0;                   // Uncompressed size
+        uint32_t permissions = 0;            // Permission bits
+        int64_t mtime = 0;                   // Modification time (seconds since epoch)
+        bool is_directory = false;           // Whether is directory
+        uint64_t offset = 0;                 // Offset of the entry header in the uncompressed stream
+    };
+
+    /**
+     * Point where decompression can start without reading earlier data
+     */
+    struct SeekPoint {
+        uint64_t compressed_offset = 0;      // Offset in the archive file
+        uint64_t uncompressed_offset = 0;    // Matching offset in the uncompressed stream
+    };
+
+    /**
+     * Table of contents of an archive, stored next to it or inside it
+     *
+     * Lets listing and partial extraction of TAR.* archives skip
+     * decompressing the whole stream.
+     */
+    struct ArchiveIndex {
+        ArchiveFormat format = ArchiveFormat::TAR_ZSTD;
+        std::vector<IndexEntry> entries;     // In archive order
+        std::vector<SeekPoint> seek_points;  // Ascending; empty if the stream is not seekable
+
+        /**
+         * Entries in the form returned by Extractor::listContents
+         */
+        [[nodiscard]] std::vector<ArchiveEntry> toArchiveEntries() const;
+
+        /**
+         * Sum of entry sizes
+         */
+        [[nodiscard]] uint64_t uncompressedSize() const noexcept;
+    };
+
+    /**
+     * Path of the sidecar index for an archive ("<archive>.fidx")
+     */
+    [[nodiscard]] std::filesystem::path indexSidecarPath(const std::filesystem::path& archive_path);
+
+    /**
+     * Store an index for a freshly written archive
+     *
+     * IndexMode::EMBEDDED appends the index as a skippable zstd frame, which
+     * zstd decoders ignore; it is only used for TAR_ZSTD and falls back to a
+     * sidecar for other formats.
+     * @param archive_path Complete archive the index describes
+     * @param index Index to store
+     * @param mode Where to store it (IndexMode::NONE does nothing)
+     * @return Error message on I/O failure
+     */
+    [[nodiscard]] Flux::expected<void, std::string> writeArchiveIndex(
+        const std::filesystem::path& archive_path,
+        const ArchiveIndex& index,
+        IndexMode mode);
+
+    /**
+     * Serialize an index without tying it to an archive file
+     *
+     * Used where an index travels inside an archive, such as the tree state
+     * of an incremental archive (see incremental.h).
+     */
+    [[nodiscard]] std::vector<uint8_t> encodeArchiveIndex(const ArchiveIndex& index);
+
+    /**
+     * Parse an index serialized by encodeArchiveIndex or stored in a sidecar
+     *
+     * Unlike readArchiveIndex, nothing is checked against an archive file.
+     * @param data Serialized index
+     * @return Index, or why it cannot be parsed
+     */
+    [[nodiscard]] Flux::expected<ArchiveIndex, std::string> decodeArchiveIndex(std::span<const uint8_t> data);
+
+    /**
+     * Load the index of an archive, embedded or from its sidecar
+     *
+     * Sidecars are rejected once the archive's size or modification time
+     * no longer match the values recorded when the index was written.
+     * @param archive_path Archive file path
+     * @return Index, or why none is usable
+     */
+    [[nodiscard]] Flux::expected<ArchiveIndex, std::string> readArchiveIndex(
+        const std::filesystem::path& archive_path);
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+
+namespace Flux {
+    /**
+     * Counters of the codec context and I/O buffer pools
+     *
+     * flux-core reuses zstd, zlib and liblzma contexts and large I/O buffers
+     * across entries, archives and operations instead of allocating them
+     * each time; these tell how well that works for a workload.
+     */
+    struct CodecPoolStats {
+        uint64_t created = 0;    // Contexts and buffers allocated
+        uint64_t reused = 0;     // Acquisitions served from a pool
+        uint64_t cached = 0;     // Objects currently held in the shared pools
+    };
+
+    /**
+     * Counters since process start (cached is a snapshot)
+     */
+    [[nodiscard]] CodecPoolStats codecPoolStats() noexcept;
+
+    /**
+     * Free everything cached by the shared pools and by the calling thread
+     *
+     * For long-running hosts that have finished a batch of work; objects in
+     * use are unaffected and return to the pools as usual.
+     */
+    void releaseCodecPools() noexcept;
+}
@@ -31,8 +31,8 @@ namespace Flux::Constants {
     inline constexpr auto PROGRESS_UPDATE_TIME = std::chrono::milliseconds(100);
 
     // Archive format extensions
-    inline constexpr std::array<std::string_view, 5> ARCHIVE_EXTENSIONS = {
-        ".zip", ".tar.zst", ".tar.gz", ".tar.xz", ".7z"
+    inline constexpr std::array<std::string_view, 6> ARCHIVE_EXTENSIONS = {
+        ".zip", ".tar.zst", ".tar.gz", ".tar.xz", ".7z", ".fxd"
     };
 
     // Compression ratio estimates (for size estimation)
@@ -42,6 +42,7 @@ namespace Flux::Constants {
         inline constexpr double TAR_GZ = 0.5;
         inline constexpr double TAR_XZ = 0.3;
         inline constexpr double SEVEN_ZIP = 0.35;
+        inline constexpr double FLUX_DEDUP = 0.3;
         inline constexpr double DEFAULT = 0.5;
     }
 
@@ -81,5 +82,10 @@ namespace Flux::Constants {
         inline constexpr int MAX_WORKER_THREADS = 16;
         inline constexpr int IO_QUEUE_DEPTH = 32;
         inline constexpr size_t MEMORY_LIMIT_MB = 512;  // 512MB default memory limit
+        inline constexpr size_t SEEKABLE_FRAME_SIZE = 4 * 1024 * 1024;  // Uncompressed bytes per seekable zstd frame
+        inline constexpr size_t DICTIONARY_SIZE = 112 * 1024;           // Trained zstd dictionary size (zstd's default)
+        inline constexpr size_t DICTIONARY_SAMPLE_FILE_SIZE = 64 * 1024;  // Files up to this size are dictionary samples
+        inline constexpr size_t DICTIONARY_SAMPLE_BUDGET = 100 * DICTIONARY_SIZE;  // Sample bytes read for training
+        inline constexpr size_t ENTROPY_SAMPLE_SIZE = 4 * 1024;         // Bytes read to judge whether a file compresses
     }
 }
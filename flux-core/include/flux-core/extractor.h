@@ -20,6 +20,7 @@ namespace Flux {
         size_t total_size{0};                         // Total extracted size
         std::chrono::milliseconds duration{0};        // Processing duration
         std::vector<std::string> skipped_files{};     // List of skipped files
+        std::optional<OperationMetrics> metrics{};    // Per-phase timing, with ExtractOptions::collect_metrics
         
         // Modern C++20 spaceship operator for comparison
         auto operator<=>(const ExtractResult&) const = default;
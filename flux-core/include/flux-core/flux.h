@@ -30,6 +30,18 @@
 // Extractor interface
 #include "extractor.h"
 
+// Archive index for fast listing
+#include "archive_index.h"
+
+// Incremental archives
+#include "incremental.h"
+
+// Codec context and buffer pools
+#include "codec_pool.h"
+
+// Trace spans
+#include "trace.h"
+
 namespace Flux {
     /**
      * Library version information
@@ -0,0 +1,53 @@
+#pragma once
+#include "archive.h"
+#include "archive_index.h"
+#include "compat.h"
+#include "extractor.h"
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace Flux {
+    /**
+     * Name of the member that starts every incremental TAR archive
+     *
+     * Its content is an encoded ArchiveIndex (encodeArchiveIndex) listing the
+     * complete tree state at packing time, unchanged entries included, with
+     * all offsets zero. Paths missing from it compared to the previous state
+     * were deleted. Flux's extractors skip it; other tools extract it as a
+     * small file.
+     */
+    inline constexpr std::string_view INCREMENTAL_MANIFEST_NAME = ".flux-incremental";
+
+    /**
+     * Tree state an archive leaves behind, to pack the next incremental against
+     *
+     * - Incremental archives: the state stored in their manifest member
+     * - Full archives: their index if they have one, otherwise their listing
+     * - ".fidx" files: the index they hold (of a full archive; the index of an
+     *   incremental archive only lists the members it contains)
+     * @param base Previous archive or its index
+     * @return State with directory paths ending in '/', or why none is usable
+     */
+    [[nodiscard]] Flux::expected<ArchiveIndex, std::string> readTreeState(const std::filesystem::path& base);
+
+    /**
+     * Restore a full archive followed by incrementals packed against each other
+     *
+     * Each archive is extracted over the previous ones, then files and
+     * directories its manifest no longer lists are removed from output_dir.
+     * @param archives Full archive first, then incrementals in packing order
+     * @param output_dir Output directory
+     * @param options Extraction options (existing files are always overwritten)
+     * @param on_progress Progress callback, per archive (optional)
+     * @param on_error Error callback (optional)
+     * @return Totals over the chain; fails at the first archive that does
+     */
+    [[nodiscard]] ExtractResult extractIncrementalChain(
+        std::span<const std::filesystem::path> archives,
+        const std::filesystem::path& output_dir,
+        const ExtractOptions& options,
+        const ProgressCallback& on_progress = nullptr,
+        const ErrorCallback& on_error = nullptr);
+}
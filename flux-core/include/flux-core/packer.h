@@ -16,6 +16,11 @@ namespace Flux {
     /**
      * Progress callback function type
      * Parameters: (current file name, progress 0.0-1.0, processed bytes, total bytes)
+     *
+     * Pack and extract operations sample their progress about every
+     * Constants::PROGRESS_UPDATE_TIME rather than calling per entry. The
+     * callback may run on a reporting thread, never concurrently with itself,
+     * and gets one final call when the operation ends.
      */
     using ProgressCallback = std::function<void(std::string_view, float, size_t, size_t)>;
 
@@ -36,6 +41,7 @@ namespace Flux {
         size_t total_uncompressed_size{0};            // Total original size  
         double compression_ratio{0.0};                // Compression ratio
         std::chrono::milliseconds duration{0};        // Processing duration
+        std::optional<OperationMetrics> metrics{};    // Per-phase timing, with PackOptions::collect_metrics
         
         // Modern C++20 spaceship operator for comparison
         auto operator<=>(const PackResult&) const = default;
@@ -109,13 +115,14 @@ namespace Flux {
      * Get list of all supported formats
      * @return List of supported formats
      */
-    [[nodiscard]] constexpr std::array<ArchiveFormat, 5> getSupportedFormats() noexcept {
+    [[nodiscard]] constexpr std::array<ArchiveFormat, 6> getSupportedFormats() noexcept {
         return {
             ArchiveFormat::ZIP,
             ArchiveFormat::TAR_ZSTD,
             ArchiveFormat::TAR_GZ,
             ArchiveFormat::TAR_XZ,
-            ArchiveFormat::SEVEN_ZIP
+            ArchiveFormat::SEVEN_ZIP,
+            ArchiveFormat::FLUX_DEDUP
         };
     }
 
@@ -132,6 +139,7 @@ namespace Flux {
             case TAR_GZ: return "tar.gz";
             case TAR_XZ: return "tar.xz";
             case SEVEN_ZIP: return "7z";
+            case FLUX_DEDUP: return "fxd";
             default: return "unknown";
         }
     }
@@ -0,0 +1,130 @@
+#pragma once
+#include "compat.h"
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/**
+ * Trace spans for diagnosing where individual entries and operations spend time
+ *
+ * FLUX_TRACE_SPAN(name) or FLUX_TRACE_SPAN(name, label) times the rest of
+ * the enclosing scope. name must be a string literal; label (an entry path,
+ * say) is copied. Spans go to per-thread ring buffers while recording is on
+ * and are written out with writeChromeTrace.
+ *
+ * Building with FLUX_ENABLE_TRACING=0 (CMake option of the same name)
+ * removes the spans entirely; start() and writeChromeTrace() still work and
+ * produce an empty trace.
+ */
+
+#ifndef FLUX_ENABLE_TRACING
+#define FLUX_ENABLE_TRACING 1
+#endif
+
+namespace Flux::Trace {
+    /**
+     * Whether this build records spans
+     */
+    inline constexpr bool compiled_in = FLUX_ENABLE_TRACING != 0;
+
+    /**
+     * Begin recording, discarding spans from any previous recording
+     *
+     * Call while no operation is running.
+     */
+    void start();
+
+    /**
+     * Stop recording; spans already recorded are kept for writeChromeTrace
+     */
+    void stop() noexcept;
+
+    /**
+     * Write the recorded spans as a Chrome trace-event JSON file
+     *
+     * The file opens in chrome://tracing and ui.perfetto.dev. Call after
+     * the traced operations have finished.
+     * @return Number of spans written
+     */
+    Flux::expected<size_t, std::string> writeChromeTrace(const std::filesystem::path& path);
+
+    namespace detail {
+        inline std::atomic<bool> g_recording{false};
+        inline constexpr size_t MAX_LABEL_SIZE = 40;    // Longer labels are cut
+
+        int64_t now() noexcept;
+        void record(const char* name, int64_t start, const char* label, size_t label_size) noexcept;
+    }
+
+    /**
+     * One span, from construction to destruction; use FLUX_TRACE_SPAN
+     *
+     * While not recording this costs a relaxed load and a branch.
+     */
+    class Span {
+    public:
+        explicit Span(const char* name) noexcept : Span(name, std::string_view{}) {}
+
+        Span(const char* name, std::string_view label) noexcept {
+            if (!detail::g_recording.load(std::memory_order_relaxed)) {
+                return;
+            }
+            m_name = name;
+            setLabel(label);
+            m_start = detail::now();
+        }
+
+        /**
+         * Labelled with a file path, converted only while recording
+         */
+        template <typename Path>
+            requires std::same_as<Path, std::filesystem::path>
+        Span(const char* name, const Path& path) noexcept {
+            if (!detail::g_recording.load(std::memory_order_relaxed)) {
+                return;
+            }
+            m_name = name;
+            setLabel(path);
+            m_start = detail::now();
+        }
+
+        ~Span() {
+            if (m_name) {
+                detail::record(m_name, m_start, m_label, m_label_size);
+            }
+        }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        void setLabel(std::string_view label) noexcept {
+            m_label_size = std::min(label.size(), sizeof(m_label));
+            if (m_label_size > 0) {
+                std::memcpy(m_label, label.data(), m_label_size);
+            }
+        }
+
+        void setLabel(const std::filesystem::path& path) noexcept;
+
+        const char* m_name = nullptr;
+        int64_t m_start = 0;
+        size_t m_label_size = 0;
+        char m_label[detail::MAX_LABEL_SIZE];
+    };
+}
+
+#define FLUX_TRACE_CONCAT_IMPL(a, b) a##b
+#define FLUX_TRACE_CONCAT(a, b) FLUX_TRACE_CONCAT_IMPL(a, b)
+
+#if FLUX_ENABLE_TRACING
+#define FLUX_TRACE_SPAN(...) ::Flux::Trace::Span FLUX_TRACE_CONCAT(flux_trace_span_, __LINE__)(__VA_ARGS__)
+#else
+#define FLUX_TRACE_SPAN(...) static_cast<void>(0)
+#endif
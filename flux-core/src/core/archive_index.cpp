@@ -0,0 +1,441 @@
+#include "flux-core/archive_index.h"
+#include <zlib.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace Flux {
+    namespace {
+        /*
+         * Index layout (little endian, numbers are LEB128 varints):
+         *   "FLUXIDX1", format byte, archive size, archive mtime,
+         *   entry count, entries (path front-coded against the previous one,
+         *   header offsets delta-coded), seek point count, seek points
+         *   (delta-coded), CRC32 of everything before it (4 bytes).
+         *
+         * Embedded indexes are wrapped in a skippable zstd frame whose content
+         * ends with the index size and EMBEDDED_TRAILER_MAGIC, so readers can
+         * find it from the end of the file. In seekable archives the frame goes
+         * right before the seek table, which has to stay last.
+         */
+        constexpr std::string_view INDEX_MAGIC = "FLUXIDX1";
+        constexpr uint32_t SKIPPABLE_FRAME_MAGIC = 0x184D2A5E;
+        constexpr uint32_t EMBEDDED_TRAILER_MAGIC = 0x58495846;  // "FXIX"
+        constexpr uint32_t SEEKABLE_MAGIC = 0x8F92EAB1;
+        constexpr size_t FRAME_HEADER_SIZE = 8;
+        constexpr size_t FRAME_TRAILER_SIZE = 8;
+        constexpr size_t SEEK_TABLE_FOOTER_SIZE = 9;
+
+        class IndexWriter {
+        public:
+            void bytes(std::string_view data) {
+                m_data.insert(m_data.end(), data.begin(), data.end());
+            }
+
+            void byte(uint8_t value) {
+                m_data.push_back(value);
+            }
+
+            void number(uint64_t value) {
+                while (value >= 0x80) {
+                    m_data.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                m_data.push_back(static_cast<uint8_t>(value));
+            }
+
+            void signedNumber(int64_t value) {
+                number((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+            }
+
+            void u32(uint32_t value) {
+                for (int i = 0; i < 4; ++i) {
+                    m_data.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            std::vector<uint8_t>& data() { return m_data; }
+
+        private:
+            std::vector<uint8_t> m_data;
+        };
+
+        class IndexReader {
+        public:
+            explicit IndexReader(std::span<const uint8_t> data) : m_data(data) {}
+
+            std::string_view bytes(size_t size) {
+                need(size);
+                std::string_view result(reinterpret_cast<const char*>(m_data.data() + m_pos), size);
+                m_pos += size;
+                return result;
+            }
+
+            uint8_t byte() {
+                need(1);
+                return m_data[m_pos++];
+            }
+
+            uint64_t number() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    const uint8_t b = byte();
+                    value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        return value;
+                    }
+                }
+                throw std::runtime_error("malformed number");
+            }
+
+            int64_t signedNumber() {
+                const uint64_t value = number();
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            size_t remaining() const { return m_data.size() - m_pos; }
+
+        private:
+            void need(size_t size) const {
+                if (size > remaining()) {
+                    throw std::runtime_error("truncated index");
+                }
+            }
+
+            std::span<const uint8_t> m_data;
+            size_t m_pos = 0;
+        };
+
+        uint32_t loadU32(const uint8_t* data) {
+            return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                   (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+
+        uint32_t checksum(std::span<const uint8_t> data) {
+            return static_cast<uint32_t>(crc32(0L, data.data(), static_cast<uInt>(data.size())));
+        }
+
+        int64_t fileTimeTicks(const std::filesystem::path& path) {
+            return static_cast<int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count());
+        }
+
+        /**
+         * Serialize an index; archive_size and archive_mtime identify the archive it belongs to
+         */
+        std::vector<uint8_t> encodeIndex(const ArchiveIndex& index, uint64_t archive_size, int64_t archive_mtime) {
+            IndexWriter out;
+            out.bytes(INDEX_MAGIC);
+            out.byte(static_cast<uint8_t>(index.format));
+            out.number(archive_size);
+            out.signedNumber(archive_mtime);
+
+            out.number(index.entries.size());
+            std::string_view previous_path;
+            uint64_t previous_offset = 0;
+            for (const auto& entry : index.entries) {
+                const auto mismatch = std::ranges::mismatch(previous_path, entry.path);
+                const size_t shared = static_cast<size_t>(mismatch.in1 - previous_path.begin());
+                out.number(shared);
+                out.number(entry.path.size() - shared);
+                out.bytes(std::string_view(entry.path).substr(shared));
+                out.number(entry.size);
+                out.number(entry.permissions);
+                out.signedNumber(entry.mtime);
+                out.byte(entry.is_directory ? 1 : 0);
+                out.signedNumber(static_cast<int64_t>(entry.offset - previous_offset));
+                previous_path = entry.path;
+                previous_offset = entry.offset;
+            }
+
+            out.number(index.seek_points.size());
+            SeekPoint previous_point;
+            for (const auto& point : index.seek_points) {
+                out.number(point.compressed_offset - previous_point.compressed_offset);
+                out.number(point.uncompressed_offset - previous_point.uncompressed_offset);
+                previous_point = point;
+            }
+
+            out.u32(checksum(out.data()));
+            return std::move(out.data());
+        }
+
+        struct DecodedIndex {
+            ArchiveIndex index;
+            uint64_t archive_size = 0;
+            int64_t archive_mtime = 0;
+        };
+
+        DecodedIndex decodeIndex(std::span<const uint8_t> data) {
+            if (data.size() < INDEX_MAGIC.size() + 4) {
+                throw std::runtime_error("truncated index");
+            }
+            const auto body = data.first(data.size() - 4);
+            if (checksum(body) != loadU32(data.data() + body.size())) {
+                throw std::runtime_error("index checksum mismatch");
+            }
+
+            IndexReader in(body);
+            if (in.bytes(INDEX_MAGIC.size()) != INDEX_MAGIC) {
+                throw std::runtime_error("not a Flux index");
+            }
+
+            DecodedIndex decoded;
+            const uint8_t format = in.byte();
+            if (format > static_cast<uint8_t>(ArchiveFormat::SEVEN_ZIP)) {
+                throw std::runtime_error("unknown archive format");
+            }
+            decoded.index.format = static_cast<ArchiveFormat>(format);
+            decoded.archive_size = in.number();
+            decoded.archive_mtime = in.signedNumber();
+
+            const uint64_t entry_count = in.number();
+            // Every entry takes at least 7 bytes; guards the reservation against corrupt counts
+            if (entry_count > in.remaining() / 7) {
+                throw std::runtime_error("bad entry count");
+            }
+            decoded.index.entries.reserve(static_cast<size_t>(entry_count));
+            std::string previous_path;
+            uint64_t previous_offset = 0;
+            for (uint64_t i = 0; i < entry_count; ++i) {
+                IndexEntry entry;
+                const uint64_t shared = in.number();
+                const uint64_t suffix = in.number();
+                if (shared > previous_path.size()) {
+                    throw std::runtime_error("bad path prefix");
+                }
+                if (suffix > in.remaining()) {
+                    throw std::runtime_error("truncated index");
+                }
+                entry.path.assign(previous_path, 0, static_cast<size_t>(shared));
+                entry.path += in.bytes(static_cast<size_t>(suffix));
+                entry.size = in.number();
+                entry.permissions = static_cast<uint32_t>(in.number());
+                entry.mtime = in.signedNumber();
+                entry.is_directory = in.byte() != 0;
+                entry.offset = previous_offset + static_cast<uint64_t>(in.signedNumber());
+                previous_path = entry.path;
+                previous_offset = entry.offset;
+                decoded.index.entries.push_back(std::move(entry));
+            }
+
+            const uint64_t point_count = in.number();
+            if (point_count > in.remaining() / 2) {
+                throw std::runtime_error("bad seek point count");
+            }
+            SeekPoint point;
+            for (uint64_t i = 0; i < point_count; ++i) {
+                point.compressed_offset += in.number();
+                point.uncompressed_offset += in.number();
+                decoded.index.seek_points.push_back(point);
+            }
+            return decoded;
+        }
+
+        std::vector<uint8_t> readRange(std::ifstream& file, uint64_t offset, size_t size) {
+            std::vector<uint8_t> data(size);
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(file.gcount()) != size) {
+                throw std::runtime_error("cannot read index");
+            }
+            return data;
+        }
+
+        /**
+         * Size of the zstd seekable-format seek table ending the file, or 0 if there is none
+         */
+        uint64_t trailingSeekTableSize(std::ifstream& file, uint64_t file_size) {
+            if (file_size < FRAME_HEADER_SIZE + SEEK_TABLE_FOOTER_SIZE) {
+                return 0;
+            }
+            const auto footer = readRange(file, file_size - SEEK_TABLE_FOOTER_SIZE, SEEK_TABLE_FOOTER_SIZE);
+            if (loadU32(footer.data() + 5) != SEEKABLE_MAGIC) {
+                return 0;
+            }
+            // Entries carry a 4-byte checksum when the descriptor's top bit is set
+            const uint64_t entry_size = (footer[4] & 0x80) ? 12 : 8;
+            const uint64_t table_size = FRAME_HEADER_SIZE + loadU32(footer.data()) * entry_size + SEEK_TABLE_FOOTER_SIZE;
+            if (table_size > file_size) {
+                throw std::runtime_error("bad seek table");
+            }
+            return table_size;
+        }
+
+        /**
+         * Index from a trailing skippable frame, if the archive has one
+         */
+        std::optional<ArchiveIndex> readEmbeddedIndex(const std::filesystem::path& archive_path) {
+            std::error_code ec;
+            const uint64_t file_size = std::filesystem::file_size(archive_path, ec);
+            if (ec) {
+                return std::nullopt;
+            }
+
+            std::ifstream file(archive_path, std::ios::binary);
+            if (!file) {
+                return std::nullopt;
+            }
+            const uint64_t end = file_size - trailingSeekTableSize(file, file_size);
+            if (end < FRAME_HEADER_SIZE + FRAME_TRAILER_SIZE) {
+                return std::nullopt;
+            }
+            const auto trailer = readRange(file, end - FRAME_TRAILER_SIZE, FRAME_TRAILER_SIZE);
+            if (loadU32(trailer.data() + 4) != EMBEDDED_TRAILER_MAGIC) {
+                return std::nullopt;
+            }
+            const uint64_t index_size = loadU32(trailer.data());
+            if (index_size > end - FRAME_HEADER_SIZE - FRAME_TRAILER_SIZE) {
+                throw std::runtime_error("bad embedded index size");
+            }
+
+            const uint64_t frame_offset = end - FRAME_TRAILER_SIZE - index_size - FRAME_HEADER_SIZE;
+            const auto header = readRange(file, frame_offset, FRAME_HEADER_SIZE);
+            if (loadU32(header.data()) != SKIPPABLE_FRAME_MAGIC ||
+                loadU32(header.data() + 4) != index_size + FRAME_TRAILER_SIZE) {
+                throw std::runtime_error("bad embedded index frame");
+            }
+
+            auto decoded = decodeIndex(readRange(file, frame_offset + FRAME_HEADER_SIZE, static_cast<size_t>(index_size)));
+            // The index records where the compressed data it describes ends
+            if (decoded.archive_size != frame_offset) {
+                throw std::runtime_error("embedded index does not match archive");
+            }
+            return std::move(decoded.index);
+        }
+    }
+
+    std::vector<ArchiveEntry> ArchiveIndex::toArchiveEntries() const {
+        std::vector<ArchiveEntry> result;
+        result.reserve(entries.size());
+        for (const auto& entry : entries) {
+            ArchiveEntry archive_entry{};
+            archive_entry.name = std::filesystem::path(entry.path).filename().string();
+            archive_entry.path = entry.path;
+            archive_entry.is_directory = entry.is_directory;
+            archive_entry.uncompressed_size = static_cast<size_t>(entry.size);
+            archive_entry.compressed_size = archive_entry.uncompressed_size;
+            archive_entry.modification_time = std::to_string(entry.mtime);
+            archive_entry.permissions = entry.permissions;
+            result.push_back(std::move(archive_entry));
+        }
+        return result;
+    }
+
+    uint64_t ArchiveIndex::uncompressedSize() const noexcept {
+        uint64_t total = 0;
+        for (const auto& entry : entries) {
+            total += entry.size;
+        }
+        return total;
+    }
+
+    std::vector<uint8_t> encodeArchiveIndex(const ArchiveIndex& index) {
+        return encodeIndex(index, 0, 0);
+    }
+
+    Flux::expected<ArchiveIndex, std::string> decodeArchiveIndex(std::span<const uint8_t> data) {
+        try {
+            return std::move(decodeIndex(data).index);
+        } catch (const std::exception& e) {
+            return Flux::unexpected<std::string>(fmt::format("Unusable archive index: {}", e.what()));
+        }
+    }
+
+    std::filesystem::path indexSidecarPath(const std::filesystem::path& archive_path) {
+        auto sidecar = archive_path;
+        sidecar += ".fidx";
+        return sidecar;
+    }
+
+    Flux::expected<void, std::string> writeArchiveIndex(
+        const std::filesystem::path& archive_path,
+        const ArchiveIndex& index,
+        IndexMode mode) {
+
+        if (mode == IndexMode::NONE) {
+            return {};
+        }
+
+        try {
+            if (mode == IndexMode::EMBEDDED && index.format == ArchiveFormat::TAR_ZSTD) {
+                const uint64_t file_size = std::filesystem::file_size(archive_path);
+                std::vector<uint8_t> seek_table;
+                {
+                    std::ifstream in(archive_path, std::ios::binary);
+                    const uint64_t table_size = trailingSeekTableSize(in, file_size);
+                    seek_table = readRange(in, file_size - table_size, static_cast<size_t>(table_size));
+                }
+                const uint64_t archive_size = file_size - seek_table.size();
+                const auto data = encodeIndex(index, archive_size, 0);
+                if (data.size() > UINT32_MAX - FRAME_TRAILER_SIZE) {
+                    return Flux::unexpected<std::string>("Archive index too large to embed");
+                }
+
+                IndexWriter frame;
+                frame.u32(SKIPPABLE_FRAME_MAGIC);
+                frame.u32(static_cast<uint32_t>(data.size() + FRAME_TRAILER_SIZE));
+                frame.data().insert(frame.data().end(), data.begin(), data.end());
+                frame.u32(static_cast<uint32_t>(data.size()));
+                frame.u32(EMBEDDED_TRAILER_MAGIC);
+                frame.data().insert(frame.data().end(), seek_table.begin(), seek_table.end());
+
+                if (!seek_table.empty()) {
+                    std::filesystem::resize_file(archive_path, archive_size);
+                }
+                std::ofstream file(archive_path, std::ios::binary | std::ios::app);
+                file.write(reinterpret_cast<const char*>(frame.data().data()),
+                           static_cast<std::streamsize>(frame.data().size()));
+                if (!file.flush()) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot append index to {}", archive_path.string()));
+                }
+                spdlog::debug("Embedded index with {} entries in {}", index.entries.size(), archive_path.string());
+                return {};
+            }
+
+            const auto sidecar = indexSidecarPath(archive_path);
+            const auto data = encodeIndex(index, std::filesystem::file_size(archive_path), fileTimeTicks(archive_path));
+            std::ofstream file(sidecar, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+            if (!file.flush()) {
+                return Flux::unexpected<std::string>(fmt::format("Cannot write index {}", sidecar.string()));
+            }
+            spdlog::debug("Wrote index with {} entries to {}", index.entries.size(), sidecar.string());
+            return {};
+        } catch (const std::exception& e) {
+            return Flux::unexpected<std::string>(fmt::format("Cannot write archive index: {}", e.what()));
+        }
+    }
+
+    Flux::expected<ArchiveIndex, std::string> readArchiveIndex(const std::filesystem::path& archive_path) {
+        try {
+            if (auto embedded = readEmbeddedIndex(archive_path)) {
+                return std::move(*embedded);
+            }
+
+            const auto sidecar = indexSidecarPath(archive_path);
+            std::error_code ec;
+            const uint64_t sidecar_size = std::filesystem::file_size(sidecar, ec);
+            if (ec) {
+                return Flux::unexpected<std::string>("Archive has no index");
+            }
+
+            std::ifstream file(sidecar, std::ios::binary);
+            if (!file) {
+                return Flux::unexpected<std::string>(fmt::format("Cannot open index {}", sidecar.string()));
+            }
+            auto decoded = decodeIndex(readRange(file, 0, static_cast<size_t>(sidecar_size)));
+            if (decoded.archive_size != std::filesystem::file_size(archive_path) ||
+                decoded.archive_mtime != fileTimeTicks(archive_path)) {
+                return Flux::unexpected<std::string>(fmt::format("Index {} is out of date", sidecar.string()));
+            }
+            return std::move(decoded.index);
+        } catch (const std::exception& e) {
+            return Flux::unexpected<std::string>(fmt::format("Unusable archive index: {}", e.what()));
+        }
+    }
+}
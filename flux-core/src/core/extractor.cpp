@@ -2,6 +2,7 @@
 #include "flux-core/exceptions.h"
 #include "flux-core/constants.h"
 #include "flux-core/packer.h"  // For formatToString function
+#include "utils/operation_metrics.h"
 #include <filesystem>
 #include <ranges>
 #include <algorithm>
@@ -14,27 +15,99 @@ namespace Flux::Formats {
     std::unique_ptr<Extractor> createZipExtractor();
     std::unique_ptr<Extractor> createTarExtractor();
     std::unique_ptr<Extractor> createSevenZipExtractor();
+    std::unique_ptr<Extractor> createDedupExtractor();
 }
 
 // Note: Format implementations should be linked separately, not included as .cpp files
 // This is a temporary solution until proper library structure is implemented
 
 namespace Flux {
+    namespace {
+        /**
+         * Fills ExtractResult::metrics around a format extractor when ExtractOptions::collect_metrics is set
+         */
+        class MeteredExtractor final : public Extractor {
+        public:
+            explicit MeteredExtractor(std::unique_ptr<Extractor> inner) : m_inner(std::move(inner)) {}
+
+            ExtractResult extract(const std::filesystem::path& archive_path,
+                                  const std::filesystem::path& output_dir,
+                                  const ExtractOptions& options,
+                                  const ProgressCallback& on_progress,
+                                  const ErrorCallback& on_error) override {
+                if (!options.collect_metrics) {
+                    return m_inner->extract(archive_path, output_dir, options, on_progress, on_error);
+                }
+                return Utils::runWithMetrics(on_progress, on_error, [&](const auto& progress, const auto& error) {
+                    return m_inner->extract(archive_path, output_dir, options, progress, error);
+                });
+            }
+
+            ExtractResult extractPartial(const std::filesystem::path& archive_path,
+                                         const std::filesystem::path& output_dir,
+                                         std::span<const std::string> file_patterns,
+                                         const ExtractOptions& options,
+                                         const ProgressCallback& on_progress,
+                                         const ErrorCallback& on_error) override {
+                if (!options.collect_metrics) {
+                    return m_inner->extractPartial(archive_path, output_dir, file_patterns, options,
+                                                   on_progress, on_error);
+                }
+                return Utils::runWithMetrics(on_progress, on_error, [&](const auto& progress, const auto& error) {
+                    return m_inner->extractPartial(archive_path, output_dir, file_patterns, options, progress, error);
+                });
+            }
+
+            Flux::expected<std::vector<ArchiveEntry>, std::string> listContents(
+                const std::filesystem::path& archive_path, std::string_view password) override {
+                return m_inner->listContents(archive_path, password);
+            }
+
+            Flux::expected<ArchiveInfo, std::string> getArchiveInfo(
+                const std::filesystem::path& archive_path, std::string_view password) override {
+                return m_inner->getArchiveInfo(archive_path, password);
+            }
+
+            Flux::expected<void, std::string> verifyIntegrity(
+                const std::filesystem::path& archive_path, std::string_view password) override {
+                return m_inner->verifyIntegrity(archive_path, password);
+            }
+
+            Flux::expected<ArchiveFormat, std::string> detectFormat(
+                const std::filesystem::path& archive_path) override {
+                return m_inner->detectFormat(archive_path);
+            }
+
+            void cancel() override { m_inner->cancel(); }
+
+            bool supportsFormat(ArchiveFormat format) const override { return m_inner->supportsFormat(format); }
+
+        private:
+            std::unique_ptr<Extractor> m_inner;
+        };
+
+        std::unique_ptr<Extractor> createFormatExtractor(ArchiveFormat format) {
+            switch (format) {
+                case ArchiveFormat::ZIP:
+                    return Formats::createZipExtractor();
+                case ArchiveFormat::TAR_GZ:
+                case ArchiveFormat::TAR_XZ:
+                case ArchiveFormat::TAR_ZSTD:
+                    return Formats::createTarExtractor();
+                case ArchiveFormat::SEVEN_ZIP:
+                    return Formats::createSevenZipExtractor();
+                case ArchiveFormat::FLUX_DEDUP:
+                    return Formats::createDedupExtractor();
+                default:
+                    throw UnsupportedFormatException(std::format("Unsupported format: {}", 
+                                                                formatToString(format)));
+            }
+        }
+    }
+
     // Factory function implementation
     std::unique_ptr<Extractor> createExtractor(ArchiveFormat format) {
-        switch (format) {
-            case ArchiveFormat::ZIP:
-                return Formats::createZipExtractor();
-            case ArchiveFormat::TAR_GZ:
-            case ArchiveFormat::TAR_XZ:
-            case ArchiveFormat::TAR_ZSTD:
-                return Formats::createTarExtractor();
-            case ArchiveFormat::SEVEN_ZIP:
-                return Formats::createSevenZipExtractor();
-            default:
-                throw UnsupportedFormatException(std::format("Unsupported format: {}", 
-                                                            formatToString(format)));
-        }
+        return std::make_unique<MeteredExtractor>(createFormatExtractor(format));
     }
 
     Flux::expected<std::unique_ptr<Extractor>, std::string> createExtractorAuto(
@@ -53,6 +126,7 @@ namespace Flux {
         constexpr std::array extension_mappings = {
             std::pair{".zip", ArchiveFormat::ZIP},
             std::pair{".7z", ArchiveFormat::SEVEN_ZIP},
+            std::pair{".fxd", ArchiveFormat::FLUX_DEDUP},
             std::pair{".tar.gz", ArchiveFormat::TAR_GZ},
             std::pair{".tgz", ArchiveFormat::TAR_GZ},
             std::pair{".tar.xz", ArchiveFormat::TAR_XZ},
@@ -90,6 +164,12 @@ namespace Flux {
                 if (std::memcmp(header, "\x28\xb5\x2f\xfd", 4) == 0) { // ZSTD magic
                     return ArchiveFormat::TAR_ZSTD;
                 }
+                if (std::memcmp(header, "\x5d\x2a\x4d\x18", 4) == 0) { // ZSTD dictionary frame
+                    return ArchiveFormat::TAR_ZSTD;
+                }
+                if (std::memcmp(header, "FLUXDDP1", 8) == 0) { // Dedup archive signature
+                    return ArchiveFormat::FLUX_DEDUP;
+                }
             }
             return Flux::unexpected<std::string>{std::format("{}: {}", 
                                              Constants::ErrorMessages::UNSUPPORTED_FORMAT,
@@ -42,7 +42,8 @@ namespace Flux {
             {ArchiveFormat::TAR_ZSTD, "TAR+ZSTD - High-performance compression, recommended format"},
             {ArchiveFormat::TAR_GZ, "TAR+GZIP - Traditional Unix compression format"},
             {ArchiveFormat::TAR_XZ, "TAR+XZ - High compression ratio format"},
-            {ArchiveFormat::SEVEN_ZIP, "7-Zip - High compression ratio professional format"}
+            {ArchiveFormat::SEVEN_ZIP, "7-Zip - High compression ratio professional format"},
+            {ArchiveFormat::FLUX_DEDUP, "FXD - Deduplicating chunk archive, optionally sharing a chunk store"}
         };
     }
 }
@@ -0,0 +1,271 @@
+#include "flux-core/incremental.h"
+#include "flux-core/exceptions.h"
+#include "io/decompression_source.h"
+#include "io/zstd_dictionary.h"
+#include <archive.h>
+#include <archive_entry.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <optional>
+#include <unordered_set>
+
+namespace Flux {
+    namespace {
+        la_ssize_t readSource(struct archive* a, void* client_data, const void** buffer) {
+            auto* source = static_cast<IO::DecompressionSource*>(client_data);
+            try {
+                const auto chunk = source->read();
+                *buffer = chunk.data();
+                return static_cast<la_ssize_t>(chunk.size());
+            } catch (const std::exception& e) {
+                archive_set_error(a, EIO, "%s", e.what());
+                return ARCHIVE_FATAL;
+            }
+        }
+
+        /**
+         * Tree state from the manifest member, if the archive starts with one
+         */
+        std::optional<ArchiveIndex> readManifestMember(const std::filesystem::path& archive_path) {
+            // libarchive cannot decode zstd frames that need a dictionary
+            std::unique_ptr<IO::DecompressionSource> source;
+            if (auto dictionary = IO::readEmbeddedDictionary(archive_path)) {
+                source = IO::createZstdFrameSource(archive_path, 0, 0, IO::createDDict(*dictionary));
+            }
+
+            struct archive* a = archive_read_new();
+            archive_read_support_format_all(a);
+            archive_read_support_filter_all(a);
+            const int opened = source
+                ? archive_read_open(a, source.get(), nullptr, &readSource, nullptr)
+                : archive_read_open_filename(a, archive_path.string().c_str(), 64 * 1024);
+            if (opened != ARCHIVE_OK) {
+                std::string error = archive_error_string(a);
+                archive_read_free(a);
+                throw CorruptedArchiveException(fmt::format("Cannot open {}: {}", archive_path.string(), error));
+            }
+
+            std::optional<std::vector<uint8_t>> data;
+            struct archive_entry* entry;
+            if (archive_read_next_header(a, &entry) == ARCHIVE_OK &&
+                archive_entry_pathname(entry) == INCREMENTAL_MANIFEST_NAME) {
+                // Only the first member is decompressed
+                data.emplace(static_cast<size_t>(archive_entry_size(entry)));
+                size_t filled = 0;
+                while (filled < data->size()) {
+                    const la_ssize_t bytes_read = archive_read_data(a, data->data() + filled, data->size() - filled);
+                    if (bytes_read <= 0) {
+                        break;
+                    }
+                    filled += static_cast<size_t>(bytes_read);
+                }
+                data->resize(filled);
+            }
+            archive_read_free(a);
+
+            if (!data) {
+                return std::nullopt;
+            }
+            auto state = decodeArchiveIndex(*data);
+            if (!state.has_value()) {
+                throw CorruptedArchiveException(fmt::format("Bad incremental manifest in {}: {}",
+                                                            archive_path.string(), state.error()));
+            }
+            return std::move(*state);
+        }
+
+        /**
+         * Tree state from an ordinary listing, for full archives without an index
+         */
+        Flux::expected<ArchiveIndex, std::string> stateFromListing(const std::filesystem::path& archive_path) {
+            auto extractor = createExtractorAuto(archive_path);
+            if (!extractor.has_value()) {
+                return Flux::unexpected<std::string>(extractor.error());
+            }
+            auto entries = (*extractor)->listContents(archive_path);
+            if (!entries.has_value()) {
+                return Flux::unexpected<std::string>(entries.error());
+            }
+
+            ArchiveIndex state;
+            if (auto format = (*extractor)->detectFormat(archive_path)) {
+                state.format = *format;
+            }
+            state.entries.reserve(entries->size());
+            for (const auto& entry : *entries) {
+                IndexEntry state_entry;
+                state_entry.path = entry.path.generic_string();
+                state_entry.is_directory = entry.is_directory;
+                if (state_entry.is_directory && !state_entry.path.ends_with('/')) {
+                    state_entry.path += '/';
+                }
+                state_entry.size = entry.uncompressed_size;
+                state_entry.permissions = entry.permissions;
+                // Listings carry seconds since the epoch; anything else counts as changed
+                const auto& mtime = entry.modification_time;
+                std::from_chars(mtime.data(), mtime.data() + mtime.size(), state_entry.mtime);
+                state.entries.push_back(std::move(state_entry));
+            }
+            return state;
+        }
+
+        /**
+         * Where a path from a manifest lives under the output directory
+         *
+         * The lexical check alone is not enough: a directory symlink extracted
+         * earlier in the chain would carry the removal out of the tree, so the
+         * parent is resolved and must still be inside the canonical root.
+         * @param root Canonical output directory
+         * @return Path to remove, or nothing if it would leave the root
+         */
+        std::optional<std::filesystem::path> containedPath(std::string_view path, const std::filesystem::path& root) {
+            const auto normal = std::filesystem::path(path).lexically_normal();
+            if (normal.empty() || !normal.is_relative() || *normal.begin() == "..") {
+                return std::nullopt;
+            }
+            auto target = root / normal;
+            if (!target.has_filename()) {
+                target = target.parent_path();    // Directory entries end in '/'
+            }
+            std::error_code ec;
+            const auto parent = std::filesystem::weakly_canonical(target.parent_path(), ec);
+            if (ec) {
+                return std::nullopt;
+            }
+            const auto relative = parent.lexically_relative(root);
+            if (relative.empty() || *relative.begin() == "..") {
+                return std::nullopt;
+            }
+            return target;
+        }
+
+        /**
+         * Remove what the previous state had and the current one does not
+         * @return Number of paths removed
+         */
+        size_t removeDeleted(const ArchiveIndex& previous,
+                             const ArchiveIndex& current,
+                             const std::filesystem::path& output_dir,
+                             const ErrorCallback& on_error) {
+            std::unordered_set<std::string_view> kept;
+            kept.reserve(current.entries.size());
+            for (const auto& entry : current.entries) {
+                kept.insert(entry.path);
+            }
+
+            std::vector<std::string_view> deleted;
+            for (const auto& entry : previous.entries) {
+                if (!kept.contains(entry.path)) {
+                    deleted.push_back(entry.path);
+                }
+            }
+            // Descending order puts the contents of a directory before the directory
+            std::ranges::sort(deleted, std::ranges::greater{});
+
+            std::error_code ec;
+            const auto root = std::filesystem::canonical(output_dir, ec);
+            if (ec) {
+                spdlog::warn("Not removing deleted entries: cannot resolve {}: {}", output_dir.string(), ec.message());
+                return 0;
+            }
+
+            size_t removed = 0;
+            for (const auto path : deleted) {
+                const auto target = containedPath(path, root);
+                if (!target) {
+                    spdlog::warn("Not removing {}: outside the output directory", path);
+                    continue;
+                }
+                if (std::filesystem::remove(*target, ec)) {
+                    ++removed;
+                } else if (ec) {
+                    const auto error = fmt::format("Cannot remove deleted entry {}: {}", path, ec.message());
+                    spdlog::warn("{}", error);
+                    if (on_error) {
+                        on_error(error, false);
+                    }
+                }
+            }
+            return removed;
+        }
+    }
+
+    Flux::expected<ArchiveIndex, std::string> readTreeState(const std::filesystem::path& base) {
+        try {
+            if (base.extension() == ".fidx") {
+                std::ifstream file(base, std::ios::binary);
+                if (!file) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot open index {}", base.string()));
+                }
+                const std::vector<uint8_t> data{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+                return decodeArchiveIndex(data);
+            }
+
+            if (auto state = readManifestMember(base)) {
+                return std::move(*state);
+            }
+            if (auto index = readArchiveIndex(base)) {
+                return std::move(*index);
+            }
+            return stateFromListing(base);
+        } catch (const std::exception& e) {
+            return Flux::unexpected<std::string>(fmt::format("Cannot read tree state of {}: {}", base.string(), e.what()));
+        }
+    }
+
+    ExtractResult extractIncrementalChain(
+        std::span<const std::filesystem::path> archives,
+        const std::filesystem::path& output_dir,
+        const ExtractOptions& options,
+        const ProgressCallback& on_progress,
+        const ErrorCallback& on_error) {
+
+        const auto start_time = std::chrono::steady_clock::now();
+        ExtractResult result;
+
+        // Later archives hold newer versions of files the earlier ones restored
+        ExtractOptions chain_options = options;
+        chain_options.overwrite_mode = OverwriteMode::OVERWRITE;
+
+        std::optional<ArchiveIndex> previous;
+        for (const auto& archive_path : archives) {
+            auto extractor = createExtractorAuto(archive_path);
+            if (!extractor.has_value()) {
+                result.error_message = extractor.error();
+                return result;
+            }
+
+            auto step = (*extractor)->extract(archive_path, output_dir, chain_options, on_progress, on_error);
+            result.files_extracted += step.files_extracted;
+            result.total_size += step.total_size;
+            result.skipped_files.insert(result.skipped_files.end(),
+                                        std::make_move_iterator(step.skipped_files.begin()),
+                                        std::make_move_iterator(step.skipped_files.end()));
+            if (!step.success) {
+                result.error_message = fmt::format("{}: {}", archive_path.string(), step.error_message);
+                return result;
+            }
+
+            auto state = readTreeState(archive_path);
+            if (!state.has_value()) {
+                result.error_message = state.error();
+                return result;
+            }
+            if (previous) {
+                const size_t removed = removeDeleted(*previous, *state, output_dir, on_error);
+                spdlog::info("Applied {}: {} entries removed", archive_path.string(), removed);
+            }
+            previous = std::move(*state);
+        }
+
+        result.success = true;
+        result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start_time);
+        return result;
+    }
+}
@@ -1,6 +1,9 @@
 #include "flux-core/packer.h"
 #include "flux-core/exceptions.h"
 #include "flux-core/constants.h"
+#include "io/file_scanner.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
 #include <filesystem>
 #include <iostream>
 #include <ranges>
@@ -24,6 +27,7 @@ namespace Flux::Formats {
     std::unique_ptr<Packer> createZipPacker();
     std::unique_ptr<Packer> createTarPacker();
     std::unique_ptr<Packer> createSevenZipPacker();
+    std::unique_ptr<Packer> createDedupPacker();
 }
 
 namespace Flux {
@@ -69,35 +73,10 @@ namespace Flux {
         std::span<const std::filesystem::path> inputs,
         ArchiveFormat format) const {
         
-        // Calculate total size using functional programming approach
-        auto calculate_file_size = [](const std::filesystem::path& path) -> size_t {
-            std::error_code ec;
-            if (std::filesystem::is_regular_file(path, ec) && !ec) {
-                return std::filesystem::file_size(path, ec);
-            } else if (std::filesystem::is_directory(path, ec) && !ec) {
-                return Flux::fold_left(
-                    std::filesystem::recursive_directory_iterator(path, ec)
-                    | std::views::filter([](const auto& entry) {
-                        std::error_code ec;
-                        return entry.is_regular_file(ec);
-                    })
-                    | std::views::transform([](const auto& entry) {
-            std::error_code ec;
-                        return entry.file_size(ec);
-                    }),
-                    size_t{0},
-                    std::plus<size_t>{}
-                );
-            }
-            return 0;
-        };
-
         try {
-            auto total_size = std::ranges::fold_left(
-                inputs | std::views::transform(calculate_file_size),
-                size_t{0},
-                std::plus<size_t>{}
-            );
+            // Same scan the packers use, so estimating and packing see the same files
+            const auto total_size = IO::scanInputs(inputs, Utils::PathFilter{},
+                                                   Utils::resolveThreadCount(Constants::DEFAULT_THREAD_COUNT)).totalFileSize();
 
             // Estimate compression ratio based on format using constants
             constexpr auto get_compression_ratio = [](ArchiveFormat fmt) constexpr -> double {
@@ -108,31 +87,78 @@ namespace Flux {
                     case TAR_GZ: return Constants::CompressionRatios::TAR_GZ;
                     case TAR_XZ: return Constants::CompressionRatios::TAR_XZ;
                     case SEVEN_ZIP: return Constants::CompressionRatios::SEVEN_ZIP;
+                    case FLUX_DEDUP: return Constants::CompressionRatios::FLUX_DEDUP;
                     default: return Constants::CompressionRatios::DEFAULT;
                 }
             };
 
             return static_cast<size_t>(total_size * get_compression_ratio(format));
-        } catch (const std::filesystem::filesystem_error&) {
+        } catch (const std::exception&) {
             return std::nullopt;
         }
     }
 
+    namespace {
+        /**
+         * Fills PackResult::metrics around a format packer when PackOptions::collect_metrics is set
+         */
+        class MeteredPacker final : public Packer {
+        public:
+            explicit MeteredPacker(std::unique_ptr<Packer> inner) : m_inner(std::move(inner)) {}
+
+            PackResult pack(std::span<const std::filesystem::path> inputs,
+                            const std::filesystem::path& output,
+                            const PackOptions& options,
+                            const ProgressCallback& on_progress,
+                            const ErrorCallback& on_error) override {
+                if (!options.collect_metrics) {
+                    return m_inner->pack(inputs, output, options, on_progress, on_error);
+                }
+                return Utils::runWithMetrics(on_progress, on_error, [&](const auto& progress, const auto& error) {
+                    return m_inner->pack(inputs, output, options, progress, error);
+                });
+            }
+
+            Flux::expected<void, std::string> validateInputs(
+                std::span<const std::filesystem::path> inputs) const override {
+                return m_inner->validateInputs(inputs);
+            }
+
+            std::optional<size_t> estimateCompressedSize(
+                std::span<const std::filesystem::path> inputs, ArchiveFormat format) const override {
+                return m_inner->estimateCompressedSize(inputs, format);
+            }
+
+            void cancel() override { m_inner->cancel(); }
+
+            bool supportsFormat(ArchiveFormat format) const override { return m_inner->supportsFormat(format); }
+
+        private:
+            std::unique_ptr<Packer> m_inner;
+        };
+
+        std::unique_ptr<Packer> createFormatPacker(ArchiveFormat format) {
+            switch (format) {
+                case ArchiveFormat::ZIP:
+                    return Formats::createZipPacker();
+                case ArchiveFormat::TAR_GZ:
+                case ArchiveFormat::TAR_XZ:
+                case ArchiveFormat::TAR_ZSTD:
+                    return Formats::createTarPacker();
+                case ArchiveFormat::SEVEN_ZIP:
+                    return Formats::createSevenZipPacker();
+                case ArchiveFormat::FLUX_DEDUP:
+                    return Formats::createDedupPacker();
+                default:
+                    throw UnsupportedFormatException(Flux::format("Unsupported format: {}", 
+                                                                formatToString(format)));
+            }
+        }
+    }
+
     // Factory function implementation
     std::unique_ptr<Packer> createPacker(ArchiveFormat format) {
-        switch (format) {
-            case ArchiveFormat::ZIP:
-                return Formats::createZipPacker();
-            case ArchiveFormat::TAR_GZ:
-            case ArchiveFormat::TAR_XZ:
-            case ArchiveFormat::TAR_ZSTD:
-                return Formats::createTarPacker();
-            case ArchiveFormat::SEVEN_ZIP:
-                return Formats::createSevenZipPacker();
-            default:
-                throw UnsupportedFormatException(Flux::format("Unsupported format: {}", 
-                                                            formatToString(format)));
-        }
+        return std::make_unique<MeteredPacker>(createFormatPacker(format));
     }
 
     // String to format conversion with error handling using C++23 features
@@ -160,7 +186,9 @@ namespace Flux {
             std::pair{"txz", TAR_XZ},
             std::pair{"xz", TAR_XZ},
             std::pair{"7z", SEVEN_ZIP},
-            std::pair{"7zip", SEVEN_ZIP}
+            std::pair{"7zip", SEVEN_ZIP},
+            std::pair{"fxd", FLUX_DEDUP},
+            std::pair{"dedup", FLUX_DEDUP}
         };
 
         auto it = std::ranges::find_if(format_mappings, 
@@ -0,0 +1,98 @@
+#include "formats/dedup/chunker.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+
+namespace Flux::Formats::Dedup {
+    namespace {
+        /**
+         * Random 64-bit value per byte value; fixed, since it decides where
+         * chunks are cut and so which chunks archives can share
+         */
+        constexpr std::array<uint64_t, 256> makeGearTable() {
+            std::array<uint64_t, 256> table{};
+            uint64_t seed = 0x464C55584344430AULL;   // "FLUXCDC\n"
+            for (auto& value : table) {
+                // splitmix64
+                seed += 0x9E3779B97F4A7C15ULL;
+                uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                value = z ^ (z >> 31);
+            }
+            return table;
+        }
+
+        constexpr std::array<uint64_t, 256> GEAR = makeGearTable();
+
+        // Pre-shifted table for the first byte of each two-byte step
+        constexpr std::array<uint64_t, 256> GEAR_SHIFTED = [] {
+            std::array<uint64_t, 256> table{};
+            for (size_t i = 0; i < table.size(); ++i) {
+                table[i] = GEAR[i] << 1;
+            }
+            return table;
+        }();
+
+        /**
+         * Mask of high bits of the hash, which depend on the most input bytes;
+         * the top bit is left out so the mask survives the shift in the two-byte step
+         */
+        constexpr uint64_t highBits(int count) noexcept {
+            return count <= 0 ? 0 : (~uint64_t{0} << (64 - count)) >> 1;
+        }
+
+        inline uint8_t at(std::span<const std::byte> data, size_t i) noexcept {
+            return static_cast<uint8_t>(data[i]);
+        }
+    }
+
+    ChunkParams ChunkParams::forAverage(size_t avg_size) noexcept {
+        ChunkParams params;
+        params.avg_size = std::bit_ceil(std::clamp<size_t>(avg_size, 4 * 1024, 4 * 1024 * 1024));
+        params.min_size = params.avg_size / 4;
+        params.max_size = params.avg_size * 4;
+        // Normalization level 2: two bits stricter before the average, two looser after
+        const int bits = std::countr_zero(params.avg_size);
+        params.mask_small = highBits(bits + 2);
+        params.mask_large = highBits(bits - 2);
+        return params;
+    }
+
+    size_t findChunkBoundary(std::span<const std::byte> data, const ChunkParams& params) noexcept {
+        const size_t size = std::min(data.size(), params.max_size);
+        if (size <= params.min_size) {
+            return size;
+        }
+        const size_t normal = std::min(size, params.avg_size);
+
+        // Shifting once per byte, a pair of bytes shifts the hash by two; the
+        // first byte's table is pre-shifted and its check uses the mask shifted
+        // to match, halving the loop-carried shifts
+        const uint64_t mask_small_shifted = params.mask_small << 1;
+        const uint64_t mask_large_shifted = params.mask_large << 1;
+        uint64_t hash = 0;
+        size_t i = params.min_size;
+        for (; i + 1 < normal; i += 2) {
+            hash = (hash << 2) + GEAR_SHIFTED[at(data, i)];
+            if (!(hash & mask_small_shifted)) {
+                return i + 1;
+            }
+            hash += GEAR[at(data, i + 1)];
+            if (!(hash & params.mask_small)) {
+                return i + 2;
+            }
+        }
+        for (; i + 1 < size; i += 2) {
+            hash = (hash << 2) + GEAR_SHIFTED[at(data, i)];
+            if (!(hash & mask_large_shifted)) {
+                return i + 1;
+            }
+            hash += GEAR[at(data, i + 1)];
+            if (!(hash & params.mask_large)) {
+                return i + 2;
+            }
+        }
+        return size;
+    }
+}
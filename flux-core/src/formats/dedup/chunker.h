@@ -0,0 +1,40 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Flux::Formats::Dedup {
+    inline constexpr size_t DEFAULT_AVERAGE_CHUNK_SIZE = 64 * 1024;
+
+    /**
+     * Chunk size limits for content-defined chunking
+     */
+    struct ChunkParams {
+        size_t min_size = 0;
+        size_t avg_size = 0;
+        size_t max_size = 0;
+        uint64_t mask_small = 0;    // Harder cut condition, used below avg_size
+        uint64_t mask_large = 0;    // Easier cut condition, used above it
+
+        /**
+         * Limits around an average size: a quarter of it to four times it
+         * @param avg_size Average chunk size, rounded to a power of two in [4 KiB, 4 MiB]
+         */
+        [[nodiscard]] static ChunkParams forAverage(size_t avg_size) noexcept;
+    };
+
+    /**
+     * Length of the next chunk at the start of data (FastCDC)
+     *
+     * A gear hash rolls over the data two bytes per step and a cut is made
+     * where its masked top bits are zero. Nothing is hashed in the first
+     * min_size bytes, and normalized chunking (a stricter mask before
+     * avg_size, a looser one after) keeps sizes close to the average.
+     * Boundaries depend only on nearby content, so an insertion shifts at
+     * most the chunks around it.
+     * @param data Remaining data; if shorter than max_size it is taken as the end of the stream
+     * @param params Chunk size limits
+     * @return Chunk length, in (0, max_size]; 0 only for empty data
+     */
+    [[nodiscard]] size_t findChunkBoundary(std::span<const std::byte> data, const ChunkParams& params) noexcept;
+}
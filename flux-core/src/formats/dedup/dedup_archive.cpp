@@ -0,0 +1,447 @@
+#include "formats/dedup/dedup_archive.h"
+#include "flux-core/exceptions.h"
+#include "utils/operation_metrics.h"
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+namespace Flux::Formats::Dedup {
+    namespace {
+        class CatalogWriter {
+        public:
+            void number(uint64_t value) {
+                while (value >= 0x80) {
+                    m_data.push_back(static_cast<uint8_t>(value | 0x80));
+                    value >>= 7;
+                }
+                m_data.push_back(static_cast<uint8_t>(value));
+            }
+
+            void signedNumber(int64_t value) {
+                number((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+            }
+
+            void bytes(std::span<const uint8_t> data) {
+                m_data.insert(m_data.end(), data.begin(), data.end());
+            }
+
+            void string(std::string_view value) {
+                number(value.size());
+                bytes({reinterpret_cast<const uint8_t*>(value.data()), value.size()});
+            }
+
+            std::vector<uint8_t>& data() { return m_data; }
+
+        private:
+            std::vector<uint8_t> m_data;
+        };
+
+        class CatalogReader {
+        public:
+            explicit CatalogReader(std::span<const uint8_t> data) : m_data(data) {}
+
+            uint64_t number() {
+                uint64_t value = 0;
+                for (int shift = 0; shift < 64; shift += 7) {
+                    const uint8_t b = byte();
+                    value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                    if (!(b & 0x80)) {
+                        return value;
+                    }
+                }
+                throw CorruptedArchiveException("Malformed number in dedup catalog");
+            }
+
+            int64_t signedNumber() {
+                const uint64_t value = number();
+                return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+            }
+
+            uint8_t byte() {
+                need(1);
+                return m_data[m_pos++];
+            }
+
+            std::span<const uint8_t> bytes(uint64_t size) {
+                need(size);
+                auto result = m_data.subspan(m_pos, static_cast<size_t>(size));
+                m_pos += static_cast<size_t>(size);
+                return result;
+            }
+
+            std::string string() {
+                const auto data = bytes(number());
+                return {reinterpret_cast<const char*>(data.data()), data.size()};
+            }
+
+            uint64_t remaining() const noexcept { return m_data.size() - m_pos; }
+
+        private:
+            void need(uint64_t size) const {
+                if (size > remaining()) {
+                    throw CorruptedArchiveException("Truncated dedup catalog");
+                }
+            }
+
+            std::span<const uint8_t> m_data;
+            size_t m_pos = 0;
+        };
+
+        void storeU32(uint8_t* out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+        void storeU64(uint8_t* out, uint64_t value) {
+            for (int i = 0; i < 8; ++i) {
+                out[i] = static_cast<uint8_t>(value >> (8 * i));
+            }
+        }
+
+        uint64_t loadLittleEndian(const uint8_t* data, int size) {
+            uint64_t value = 0;
+            for (int i = size - 1; i >= 0; --i) {
+                value = (value << 8) | data[i];
+            }
+            return value;
+        }
+
+        std::vector<std::byte> readRange(std::ifstream& file, uint64_t offset, size_t size, std::vector<std::byte>&& buffer = {}) {
+            Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+            Utils::countSyscalls(2);    // seek and read
+            Utils::countBytesRead(size);
+            buffer.resize(size);
+            file.seekg(static_cast<std::streamoff>(offset));
+            file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(size));
+            if (static_cast<size_t>(file.gcount()) != size) {
+                file.clear();
+                throw CorruptedArchiveException("Dedup archive is truncated");
+            }
+            return std::move(buffer);
+        }
+    }
+
+    std::vector<uint8_t> encodeCatalog(const Catalog& catalog) {
+        CatalogWriter out;
+        out.number(CATALOG_VERSION);
+        out.string(catalog.chunk_store.generic_string());
+        out.number(catalog.dictionary.size());
+        out.bytes({reinterpret_cast<const uint8_t*>(catalog.dictionary.data()), catalog.dictionary.size()});
+
+        out.number(catalog.chunks.size());
+        for (const auto& chunk : catalog.chunks) {
+            out.bytes(chunk.hash);
+            out.number(chunk.size);
+            out.number(chunk.stored_size);
+            out.number(chunk.offset);
+        }
+
+        out.number(catalog.files.size());
+        std::string_view previous_path;
+        for (const auto& file : catalog.files) {
+            const auto mismatch = std::ranges::mismatch(previous_path, file.path);
+            const size_t shared = static_cast<size_t>(mismatch.in1 - previous_path.begin());
+            out.number(shared);
+            out.string(std::string_view(file.path).substr(shared));
+            out.number(static_cast<uint8_t>(file.type));
+            out.number(file.mode);
+            out.signedNumber(file.mtime_ns);
+            out.number(file.size);
+            if (file.type == EntryType::Symlink) {
+                out.string(file.link_target);
+            }
+            out.number(file.chunks.size());
+            for (const uint32_t chunk : file.chunks) {
+                out.number(chunk);
+            }
+            previous_path = file.path;
+        }
+        return std::move(out.data());
+    }
+
+    Catalog decodeCatalog(std::span<const uint8_t> data) {
+        CatalogReader in(data);
+        const uint64_t version = in.number();
+        if (version < 1 || version > CATALOG_VERSION) {
+            throw CorruptedArchiveException("Unsupported dedup catalog version");
+        }
+
+        Catalog catalog;
+        catalog.chunk_store = in.string();
+        if (version >= 2) {
+            const auto dictionary = in.bytes(in.number());
+            const auto* begin = reinterpret_cast<const std::byte*>(dictionary.data());
+            catalog.dictionary.assign(begin, begin + dictionary.size());
+        }
+
+        const uint64_t chunk_count = in.number();
+        // Every chunk takes at least 35 bytes; guards the reservation against corrupt counts
+        if (chunk_count > in.remaining() / 35) {
+            throw CorruptedArchiveException("Bad chunk count in dedup catalog");
+        }
+        catalog.chunks.resize(static_cast<size_t>(chunk_count));
+        for (auto& chunk : catalog.chunks) {
+            const auto hash = in.bytes(chunk.hash.size());
+            std::copy(hash.begin(), hash.end(), chunk.hash.begin());
+            chunk.size = static_cast<uint32_t>(in.number());
+            chunk.stored_size = static_cast<uint32_t>(in.number());
+            chunk.offset = in.number();
+        }
+
+        const uint64_t file_count = in.number();
+        if (file_count > in.remaining() / 7) {
+            throw CorruptedArchiveException("Bad file count in dedup catalog");
+        }
+        catalog.files.resize(static_cast<size_t>(file_count));
+        std::string previous_path;
+        for (auto& file : catalog.files) {
+            const uint64_t shared = in.number();
+            if (shared > previous_path.size()) {
+                throw CorruptedArchiveException("Bad path prefix in dedup catalog");
+            }
+            file.path.assign(previous_path, 0, static_cast<size_t>(shared));
+            file.path += in.string();
+            const uint64_t type = in.number();
+            if (type > static_cast<uint8_t>(EntryType::Symlink)) {
+                throw CorruptedArchiveException("Bad entry type in dedup catalog");
+            }
+            file.type = static_cast<EntryType>(type);
+            file.mode = static_cast<uint32_t>(in.number());
+            file.mtime_ns = in.signedNumber();
+            file.size = in.number();
+            if (file.type == EntryType::Symlink) {
+                file.link_target = in.string();
+            }
+            const uint64_t chunks = in.number();
+            if (chunks > in.remaining()) {
+                throw CorruptedArchiveException("Bad chunk list in dedup catalog");
+            }
+            file.chunks.resize(static_cast<size_t>(chunks));
+            for (auto& chunk : file.chunks) {
+                const uint64_t index = in.number();
+                if (index >= catalog.chunks.size()) {
+                    throw CorruptedArchiveException("Bad chunk reference in dedup catalog");
+                }
+                chunk = static_cast<uint32_t>(index);
+            }
+            previous_path = file.path;
+        }
+        return catalog;
+    }
+
+    Catalog readCatalog(const std::filesystem::path& archive_path) {
+        Utils::PhaseTimer timer(Utils::Phase::HeaderParse);
+        std::error_code ec;
+        const uint64_t file_size = std::filesystem::file_size(archive_path, ec);
+        if (ec) {
+            throw FileNotFoundException(archive_path.string());
+        }
+        if (file_size < SIGNATURE.size() + TRAILER_SIZE) {
+            throw CorruptedArchiveException("Not a dedup archive");
+        }
+
+        std::ifstream file(archive_path, std::ios::binary);
+        const auto signature = readRange(file, 0, SIGNATURE.size());
+        if (std::memcmp(signature.data(), SIGNATURE.data(), SIGNATURE.size()) != 0) {
+            throw CorruptedArchiveException("Not a dedup archive");
+        }
+        const auto trailer = readRange(file, file_size - TRAILER_SIZE, TRAILER_SIZE);
+        const auto* trailer_bytes = reinterpret_cast<const uint8_t*>(trailer.data());
+        if (loadLittleEndian(trailer_bytes + 12, 4) != TRAILER_MAGIC) {
+            throw CorruptedArchiveException("Dedup archive has no trailer; it may be truncated");
+        }
+        const uint64_t catalog_offset = loadLittleEndian(trailer_bytes, 8);
+        const uint64_t catalog_size = loadLittleEndian(trailer_bytes + 8, 4);
+        if (catalog_offset < SIGNATURE.size() || catalog_offset + catalog_size > file_size - TRAILER_SIZE) {
+            throw CorruptedArchiveException("Bad catalog location in dedup archive");
+        }
+
+        const auto frame = readRange(file, catalog_offset, static_cast<size_t>(catalog_size));
+        const unsigned long long content_size = ZSTD_getFrameContentSize(frame.data(), frame.size());
+        if (content_size == ZSTD_CONTENTSIZE_ERROR || content_size == ZSTD_CONTENTSIZE_UNKNOWN) {
+            throw CorruptedArchiveException("Bad dedup catalog frame");
+        }
+        std::vector<uint8_t> data(static_cast<size_t>(content_size));
+        const size_t decoded = ZSTD_decompress(data.data(), data.size(), frame.data(), frame.size());
+        if (ZSTD_isError(decoded) || decoded != data.size()) {
+            throw CorruptedArchiveException(fmt::format("Cannot decompress dedup catalog: {}",
+                                                        ZSTD_isError(decoded) ? ZSTD_getErrorName(decoded) : "short"));
+        }
+        return decodeCatalog(data);
+    }
+
+    ChunkStore::ChunkStore(std::filesystem::path root) : m_root(std::move(root)) {}
+
+    std::filesystem::path ChunkStore::chunkPath(const ChunkHash& hash) const {
+        const std::string hex = toHex(hash);
+        return m_root / hex.substr(0, 2) / hex;
+    }
+
+    bool ChunkStore::contains(const ChunkHash& hash) const {
+        std::error_code ec;
+        return std::filesystem::is_regular_file(chunkPath(hash), ec);
+    }
+
+    void ChunkStore::put(const ChunkHash& hash, std::span<const std::byte> frame) const {
+        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+        Utils::countSyscalls(5);    // stat, open, write, close, rename
+        const auto path = chunkPath(hash);
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(path, ec)) {
+            return;
+        }
+        std::filesystem::create_directories(path.parent_path(), ec);
+
+        // Unique per writer, so two packers adding the same chunk do not share a file
+        static std::atomic<uint64_t> sequence{0};
+        auto temporary = path;
+        temporary += fmt::format(".{}.{}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()), sequence++);
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+            if (!file.flush()) {
+                std::filesystem::remove(temporary, ec);
+                throw FluxException(fmt::format("Cannot write chunk {}", path.string()));
+            }
+        }
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            std::filesystem::remove(temporary, ec);
+            if (!std::filesystem::is_regular_file(path, ec)) {
+                throw FluxException(fmt::format("Cannot store chunk {}", path.string()));
+            }
+        }
+    }
+
+    ArchiveWriter::ArchiveWriter(const std::filesystem::path& path)
+        : m_file(path, std::ios::binary | std::ios::trunc) {
+        if (!m_file) {
+            throw FluxException(fmt::format("Cannot create {}", path.string()));
+        }
+        m_file.write(reinterpret_cast<const char*>(SIGNATURE.data()), SIGNATURE.size());
+        m_offset = SIGNATURE.size();
+    }
+
+    uint64_t ArchiveWriter::appendChunk(std::span<const std::byte> frame) {
+        std::lock_guard lock(m_mutex);
+        const uint64_t offset = m_offset;
+        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+        Utils::countSyscalls();
+        m_file.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame.size()));
+        if (!m_file) {
+            throw FluxException("Cannot write dedup archive");
+        }
+        m_offset += frame.size();
+        return offset;
+    }
+
+    void ArchiveWriter::finish(const Catalog& catalog, int level) {
+        std::lock_guard lock(m_mutex);
+        const auto data = encodeCatalog(catalog);
+        std::vector<std::byte> frame(ZSTD_compressBound(data.size()));
+        size_t frame_size = 0;
+        {
+            Utils::PhaseTimer timer(Utils::Phase::Codec);
+            frame_size = ZSTD_compress(frame.data(), frame.size(), data.data(), data.size(), level);
+        }
+        if (ZSTD_isError(frame_size) || frame_size > UINT32_MAX) {
+            throw CompressionException("Cannot compress dedup catalog");
+        }
+
+        std::array<uint8_t, TRAILER_SIZE> trailer{};
+        storeU64(trailer.data(), m_offset);
+        storeU32(trailer.data() + 8, static_cast<uint32_t>(frame_size));
+        storeU32(trailer.data() + 12, TRAILER_MAGIC);
+
+        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+        Utils::countSyscalls(3);
+        m_file.write(reinterpret_cast<const char*>(frame.data()), static_cast<std::streamsize>(frame_size));
+        m_file.write(reinterpret_cast<const char*>(trailer.data()), trailer.size());
+        m_file.close();
+        if (!m_file) {
+            throw FluxException("Cannot finish dedup archive");
+        }
+        m_offset += frame_size + trailer.size();
+    }
+
+    ChunkReader::ChunkReader(const std::filesystem::path& archive_path,
+                             const IO::MappedFile* mapping,
+                             const Catalog& catalog,
+                             const std::optional<ChunkStore>& store,
+                             const ZSTD_DDict* dictionary)
+        : m_archive_path(archive_path), m_mapping(mapping), m_catalog(catalog), m_store(store),
+          m_dctx(IO::acquireZstdDCtx()) {
+        if (dictionary && ZSTD_isError(ZSTD_DCtx_refDDict(m_dctx.get(), dictionary))) {
+            throw FluxException("Cannot load zstd dictionary");
+        }
+    }
+
+    std::span<const std::byte> ChunkReader::read(uint32_t chunk) {
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        const ChunkRecord& record = m_catalog.chunks.at(chunk);
+        const auto compressed = frame(record);
+        m_content.resize(record.size);
+        const size_t decoded = ZSTD_decompressDCtx(m_dctx.get(), m_content.data(), m_content.size(),
+                                                   compressed.data(), compressed.size());
+        if (ZSTD_isError(decoded) || decoded != record.size) {
+            throw CorruptedArchiveException(fmt::format("Chunk {} is damaged: {}", toHex(record.hash),
+                                                        ZSTD_isError(decoded) ? ZSTD_getErrorName(decoded) : "wrong size"));
+        }
+        return m_content;
+    }
+
+    std::span<const std::byte> ChunkReader::frame(const ChunkRecord& record) {
+        if (m_store) {
+            const auto path = m_store->chunkPath(record.hash);
+            Utils::countSyscalls();
+            std::ifstream file(path, std::ios::binary);
+            if (!file) {
+                throw FileNotFoundException(fmt::format("Chunk missing from store: {}", path.string()));
+            }
+            std::error_code ec;
+            const auto size = std::filesystem::file_size(path, ec);
+            m_frame = readRange(file, 0, static_cast<size_t>(ec ? 0 : size), std::move(m_frame));
+            return m_frame;
+        }
+
+        if (m_mapping) {
+            if (record.offset + record.stored_size > m_mapping->size()) {
+                throw CorruptedArchiveException("Chunk lies outside the dedup archive");
+            }
+            Utils::countBytesRead(record.stored_size);
+            return m_mapping->bytes().subspan(static_cast<size_t>(record.offset), record.stored_size);
+        }
+        if (!m_file.is_open()) {
+            m_file.open(m_archive_path, std::ios::binary);
+        }
+        m_frame = readRange(m_file, record.offset, record.stored_size, std::move(m_frame));
+        return m_frame;
+    }
+
+    void compressChunk(ZSTD_CCtx* cctx, std::span<const std::byte> chunk, int level, std::vector<std::byte>& frame) {
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, std::min(level, ZSTD_maxCLevel()));
+        ZSTD_CCtx_setParameter(cctx, ZSTD_c_checksumFlag, 1);
+        frame.resize(ZSTD_compressBound(chunk.size()));
+        const size_t size = ZSTD_compress2(cctx, frame.data(), frame.size(), chunk.data(), chunk.size());
+        if (ZSTD_isError(size)) {
+            throw CompressionException(fmt::format("Cannot compress chunk: {}", ZSTD_getErrorName(size)));
+        }
+        frame.resize(size);
+    }
+
+    std::string toHex(const ChunkHash& hash) {
+        static constexpr char DIGITS[] = "0123456789abcdef";
+        std::string hex(hash.size() * 2, '0');
+        for (size_t i = 0; i < hash.size(); ++i) {
+            hex[2 * i] = DIGITS[hash[i] >> 4];
+            hex[2 * i + 1] = DIGITS[hash[i] & 0x0F];
+        }
+        return hex;
+    }
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include "io/codec_pool.h"
+#include "io/mapped_file.h"
+#include "utils/sha256.h"
+#include <zstd.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Flux::Formats::Dedup {
+    /*
+     * Archive layout (little endian):
+     *   SIGNATURE
+     *   chunk frames, one zstd frame per unique chunk (absent with a chunk store)
+     *   catalog, one zstd frame (see encodeCatalog)
+     *   trailer: catalog offset (8 bytes), catalog size (4), TRAILER_MAGIC (4)
+     */
+    inline constexpr std::array<uint8_t, 8> SIGNATURE = {'F', 'L', 'U', 'X', 'D', 'D', 'P', '1'};
+    inline constexpr uint32_t TRAILER_MAGIC = 0x45445846;    // "FXDE"
+    inline constexpr size_t TRAILER_SIZE = 16;
+    inline constexpr uint64_t CATALOG_VERSION = 2;          // 2 added the dictionary; 1 is still read
+    inline constexpr int CATALOG_LEVEL = 9;                 // zstd level of the catalog frame
+
+    using ChunkHash = Utils::Sha256Digest;
+
+    /**
+     * A unique chunk of content
+     */
+    struct ChunkRecord {
+        ChunkHash hash{};                    // SHA-256 of the uncompressed chunk
+        uint32_t size = 0;                   // Uncompressed size
+        uint32_t stored_size = 0;            // Size of its zstd frame in the archive (0 if in the chunk store)
+        uint64_t offset = 0;                 // Offset of that frame in the archive
+    };
+
+    enum class EntryType : uint8_t {
+        File,
+        Directory,
+        Symlink
+    };
+
+    /**
+     * A file, directory or symlink and the chunks that make up its content
+     */
+    struct FileRecord {
+        std::string path;                    // Path stored in the archive, '/'-separated
+        EntryType type = EntryType::File;
+        uint32_t mode = 0;                   // Permission bits
+        int64_t mtime_ns = 0;                // Modification time (0 = not stored)
+        uint64_t size = 0;                   // Content size
+        std::string link_target;             // For symlinks
+        std::vector<uint32_t> chunks;        // Indices into Catalog::chunks, in content order
+    };
+
+    /**
+     * Everything about an archive except chunk data
+     */
+    struct Catalog {
+        std::filesystem::path chunk_store;   // Where chunks live; empty if inside the archive
+        std::vector<std::byte> dictionary;   // zstd dictionary the chunk frames need (never with a store)
+        std::vector<ChunkRecord> chunks;
+        std::vector<FileRecord> files;
+
+        [[nodiscard]] bool usesChunkStore() const noexcept { return !chunk_store.empty(); }
+    };
+
+    /**
+     * Serialize a catalog (uncompressed)
+     *
+     * Version, chunk store path, dictionary, chunks (hash, size, stored size, offset),
+     * then files (path front-coded against the previous one, type, mode,
+     * mtime, size, link target for symlinks, chunk indices), with numbers
+     * as LEB128 varints.
+     */
+    [[nodiscard]] std::vector<uint8_t> encodeCatalog(const Catalog& catalog);
+
+    /**
+     * @throws CorruptedArchiveException on malformed input
+     */
+    [[nodiscard]] Catalog decodeCatalog(std::span<const uint8_t> data);
+
+    /**
+     * Read the catalog of an archive
+     * @throws CorruptedArchiveException, FileNotFoundException
+     */
+    [[nodiscard]] Catalog readCatalog(const std::filesystem::path& archive_path);
+
+    /**
+     * Content-addressed directory of compressed chunks shared between archives
+     *
+     * Each chunk is a file holding one zstd frame, named by the hex SHA-256
+     * of its content under a directory of the first two hex digits. Files are
+     * written under a temporary name and renamed into place, so concurrent
+     * packers can share a store.
+     */
+    class ChunkStore {
+    public:
+        explicit ChunkStore(std::filesystem::path root);
+
+        [[nodiscard]] const std::filesystem::path& root() const noexcept { return m_root; }
+        [[nodiscard]] std::filesystem::path chunkPath(const ChunkHash& hash) const;
+        [[nodiscard]] bool contains(const ChunkHash& hash) const;
+
+        /**
+         * Add a compressed chunk unless the store already has it
+         * @throws FluxException on I/O failure
+         */
+        void put(const ChunkHash& hash, std::span<const std::byte> frame) const;
+
+    private:
+        std::filesystem::path m_root;
+    };
+
+    /**
+     * Writes the archive file; chunk frames may be appended from any thread
+     */
+    class ArchiveWriter {
+    public:
+        explicit ArchiveWriter(const std::filesystem::path& path);
+
+        /**
+         * Append a chunk frame
+         * @return Offset it was written at
+         */
+        uint64_t appendChunk(std::span<const std::byte> frame);
+
+        /**
+         * Write the catalog and trailer and close the file
+         * @param level zstd level for the catalog
+         */
+        void finish(const Catalog& catalog, int level);
+
+        [[nodiscard]] uint64_t bytesWritten() const noexcept { return m_offset; }
+
+    private:
+        std::mutex m_mutex;
+        std::ofstream m_file;
+        uint64_t m_offset = 0;
+    };
+
+    /**
+     * Per-thread access to chunk content
+     *
+     * Frames in the archive are read from a shared memory mapping when one is
+     * available; the decompression context and buffers are reused across chunks.
+     */
+    class ChunkReader {
+    public:
+        /**
+         * @param dictionary Digested Catalog::dictionary, or null if it is empty; must outlive the reader
+         */
+        ChunkReader(const std::filesystem::path& archive_path,
+                    const IO::MappedFile* mapping,
+                    const Catalog& catalog,
+                    const std::optional<ChunkStore>& store,
+                    const ZSTD_DDict* dictionary = nullptr);
+
+        /**
+         * Decompressed content of a chunk, valid until the next call
+         * @throws CorruptedArchiveException, FluxException
+         */
+        std::span<const std::byte> read(uint32_t chunk);
+
+    private:
+        std::span<const std::byte> frame(const ChunkRecord& record);
+
+        const std::filesystem::path& m_archive_path;
+        const IO::MappedFile* m_mapping;
+        const Catalog& m_catalog;
+        const std::optional<ChunkStore>& m_store;
+        IO::PooledZstdDCtx m_dctx;
+        std::ifstream m_file;
+        std::vector<std::byte> m_frame;
+        std::vector<std::byte> m_content;
+    };
+
+    /**
+     * Compress one chunk as a checksummed zstd frame with a reusable context
+     * @throws CompressionException
+     */
+    void compressChunk(ZSTD_CCtx* cctx, std::span<const std::byte> chunk, int level, std::vector<std::byte>& frame);
+
+    /**
+     * Lowercase hex form of a hash
+     */
+    [[nodiscard]] std::string toHex(const ChunkHash& hash);
+}
@@ -0,0 +1,532 @@
+#include "flux-core/extractor.h"
+#include "flux-core/exceptions.h"
+#include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "formats/dedup/dedup_archive.h"
+#include "io/async_file_writer.h"
+#include "io/buffered_io.h"
+#include "io/mapped_file.h"
+#include "io/zstd_dictionary.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace Flux {
+    namespace Formats {
+        /**
+         * Deduplicating chunk archive extractor (FLUX_DEDUP)
+         *
+         * The catalog lists every file's chunks, so files are independent and
+         * are restored in parallel, each worker decompressing chunks from a
+         * shared memory mapping of the archive (or from the chunk store).
+         */
+        class DedupExtractorImpl : public Extractor {
+        private:
+            std::atomic<bool> m_cancelled{false};
+
+        public:
+            ExtractResult extract(
+                const std::filesystem::path& archive_path,
+                const std::filesystem::path& output_dir,
+                const ExtractOptions& options,
+                const ProgressCallback& on_progress,
+                const ErrorCallback& on_error) override {
+
+                return extractMatching(archive_path, output_dir, {}, options, on_progress, on_error);
+            }
+
+            ExtractResult extractPartial(
+                const std::filesystem::path& archive_path,
+                const std::filesystem::path& output_dir,
+                std::span<const std::string> file_patterns,
+                const ExtractOptions& options,
+                const ProgressCallback& on_progress,
+                const ErrorCallback& on_error) override {
+
+                if (file_patterns.empty()) {
+                    ExtractResult result;
+                    result.success = true;
+                    return result;
+                }
+                return extractMatching(archive_path, output_dir, file_patterns, options, on_progress, on_error);
+            }
+
+            Flux::expected<std::vector<ArchiveEntry>, std::string> listContents(
+                const std::filesystem::path& archive_path,
+                std::string_view password) override {
+
+                try {
+                    const Dedup::Catalog catalog = Dedup::readCatalog(archive_path);
+
+                    std::vector<ArchiveEntry> entries;
+                    entries.reserve(catalog.files.size());
+                    for (const auto& file : catalog.files) {
+                        ArchiveEntry entry{};
+                        entry.name = std::filesystem::path(file.path).filename().string();
+                        entry.path = file.path;
+                        entry.is_directory = file.type == Dedup::EntryType::Directory;
+                        entry.uncompressed_size = static_cast<size_t>(file.size);
+                        // Shared chunks count toward every file that uses them
+                        for (const uint32_t chunk : file.chunks) {
+                            entry.compressed_size += catalog.chunks[chunk].stored_size;
+                        }
+                        entry.permissions = file.mode & 07777;
+                        if (file.mtime_ns != 0) {
+                            entry.modification_time = std::to_string(file.mtime_ns / 1'000'000'000);
+                        }
+                        entries.push_back(std::move(entry));
+                    }
+
+                    spdlog::debug("Listed {} entries from dedup archive", entries.size());
+                    return entries;
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot list dedup archive contents: {}", e.what()));
+                }
+            }
+
+            Flux::expected<ArchiveInfo, std::string> getArchiveInfo(
+                const std::filesystem::path& archive_path,
+                std::string_view password) override {
+
+                try {
+                    const Dedup::Catalog catalog = Dedup::readCatalog(archive_path);
+
+                    ArchiveInfo info;
+                    info.path = archive_path;
+                    info.format = ArchiveFormat::FLUX_DEDUP;
+                    info.compressed_size = static_cast<size_t>(std::filesystem::file_size(archive_path));
+                    info.uncompressed_size = 0;
+                    info.file_count = 0;
+                    for (const auto& file : catalog.files) {
+                        if (file.type == Dedup::EntryType::File) {
+                            info.uncompressed_size += static_cast<size_t>(file.size);
+                            info.file_count++;
+                        }
+                    }
+                    info.is_encrypted = false;
+                    info.creation_time = "Unknown";
+                    return info;
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot get dedup archive info: {}", e.what()));
+                }
+            }
+
+            Flux::expected<void, std::string> verifyIntegrity(
+                const std::filesystem::path& archive_path,
+                std::string_view password) override {
+
+                try {
+                    const Dedup::Catalog catalog = Dedup::readCatalog(archive_path);
+                    for (const auto& file : catalog.files) {
+                        uint64_t size = 0;
+                        for (const uint32_t chunk : file.chunks) {
+                            size += catalog.chunks[chunk].size;
+                        }
+                        if (size != file.size) {
+                            return Flux::unexpected<std::string>(fmt::format("Chunk list does not match size of {}", file.path));
+                        }
+                    }
+
+                    // Decompress every chunk and compare its hash with the catalog
+                    const auto store = chunkStore(catalog, {});
+                    std::unique_ptr<IO::MappedFile> mapping;
+                    if (!store) {
+                        mapping = IO::mapFile(archive_path, IO::AccessPattern::Normal);
+                    }
+                    const auto dictionary = catalog.dictionary.empty() ? nullptr : IO::createDDict(catalog.dictionary);
+                    std::atomic<size_t> next_chunk{0};
+                    std::mutex error_mutex;
+                    std::string first_error;
+                    auto worker = [&]() {
+                        Dedup::ChunkReader reader(archive_path, mapping.get(), catalog, store, dictionary.get());
+                        for (size_t i = next_chunk++; i < catalog.chunks.size(); i = next_chunk++) {
+                            std::string error;
+                            try {
+                                if (Utils::sha256(reader.read(static_cast<uint32_t>(i))) != catalog.chunks[i].hash) {
+                                    error = fmt::format("Chunk {} does not match its hash", Dedup::toHex(catalog.chunks[i].hash));
+                                }
+                            } catch (const std::exception& e) {
+                                error = e.what();
+                            }
+                            if (!error.empty()) {
+                                std::lock_guard<std::mutex> lock(error_mutex);
+                                if (first_error.empty()) {
+                                    first_error = std::move(error);
+                                }
+                                next_chunk = catalog.chunks.size();
+                            }
+                        }
+                    };
+                    runWorkers(std::min<size_t>(Utils::resolveThreadCount(0), catalog.chunks.size()), worker);
+
+                    if (!first_error.empty()) {
+                        return Flux::unexpected<std::string>(first_error);
+                    }
+                    return {};
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Integrity verification failed: {}", e.what()));
+                }
+            }
+
+            Flux::expected<ArchiveFormat, std::string> detectFormat(
+                const std::filesystem::path& archive_path) override {
+
+                std::ifstream file(archive_path, std::ios::binary);
+                if (!file.is_open()) {
+                    return Flux::unexpected<std::string>{"Cannot open archive file"};
+                }
+
+                std::array<uint8_t, Dedup::SIGNATURE.size()> signature{};
+                file.read(reinterpret_cast<char*>(signature.data()), static_cast<std::streamsize>(signature.size()));
+                if (static_cast<size_t>(file.gcount()) != signature.size() || signature != Dedup::SIGNATURE) {
+                    return Flux::unexpected<std::string>{"Invalid dedup file signature"};
+                }
+                return ArchiveFormat::FLUX_DEDUP;
+            }
+
+            void cancel() override {
+                m_cancelled = true;
+                spdlog::info("Dedup extraction cancellation requested");
+            }
+
+            bool supportsFormat(ArchiveFormat format) const override {
+                return format == ArchiveFormat::FLUX_DEDUP;
+            }
+
+        private:
+            // Shared extraction state; counters are updated by all workers
+            struct ExtractProgress {
+                ExtractProgress(uint64_t bytes, const ProgressCallback& progress_cb, const ErrorCallback& error_cb)
+                    : channel(progress_cb, "Extracting", bytes), on_error(error_cb) {}
+
+                Utils::ProgressChannel channel;  // Counts bytes restored
+                const ErrorCallback& on_error;
+                std::atomic<size_t> files_extracted{0};
+                std::atomic<size_t> total_size{0};
+                std::mutex callback_mutex;       // Serializes error callbacks and first_error
+                std::string first_error;         // First data or write failure
+            };
+
+            // An entry selected for extraction and where it goes
+            struct Target {
+                const Dedup::FileRecord* file;
+                std::filesystem::path path;
+            };
+
+            /**
+             * Extract all entries, or those matching one of the patterns, subject
+             * to the include/exclude patterns of the options
+             *
+             * Directories are created first and files restored in parallel;
+             * symlinks follow once all files exist, so no file is written through
+             * one, and directory modes and times are applied last, deepest first.
+             */
+            ExtractResult extractMatching(const std::filesystem::path& archive_path,
+                                          const std::filesystem::path& output_dir,
+                                          std::span<const std::string> file_patterns,
+                                          const ExtractOptions& options,
+                                          const ProgressCallback& on_progress,
+                                          const ErrorCallback& on_error) {
+                auto start_time = std::chrono::high_resolution_clock::now();
+                ExtractResult result;
+                result.success = false;
+                result.files_extracted = 0;
+                result.total_size = 0;
+
+                try {
+                    const Dedup::Catalog catalog = Dedup::readCatalog(archive_path);
+                    const auto store = chunkStore(catalog, options.chunk_store);
+                    std::unique_ptr<IO::MappedFile> mapping;
+                    if (!store) {
+                        mapping = IO::mapFile(archive_path, IO::AccessPattern::Normal);
+                    }
+                    const auto dictionary = catalog.dictionary.empty() ? nullptr : IO::createDDict(catalog.dictionary);
+                    std::filesystem::create_directories(output_dir);
+
+                    spdlog::info("Extracting {} entries ({} unique chunks) from dedup archive: {}",
+                                 catalog.files.size(), catalog.chunks.size(), archive_path.string());
+
+                    const Utils::PathMatcher selected(file_patterns);
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
+
+                    std::vector<Target> directories;
+                    std::vector<Target> files;
+                    std::vector<Target> symlinks;
+                    uint64_t total_bytes = 0;
+                    for (const auto& file : catalog.files) {
+                        if ((!file_patterns.empty() && !selected.matches(file.path)) || !filter.accepts(file.path)) {
+                            Utils::countSkippedEntry();
+                            continue;
+                        }
+                        auto target = outputPath(output_dir, file.path);
+                        if (!target) {
+                            spdlog::warn("Skipping unsafe path in archive: {}", file.path);
+                            result.skipped_files.push_back(file.path);
+                            continue;
+                        }
+                        switch (file.type) {
+                            case Dedup::EntryType::Directory:
+                                createDirectories(*target);
+                                directories.push_back({&file, std::move(*target)});
+                                break;
+                            case Dedup::EntryType::File:
+                                total_bytes += file.size;
+                                files.push_back({&file, std::move(*target)});
+                                break;
+                            case Dedup::EntryType::Symlink:
+                                symlinks.push_back({&file, std::move(*target)});
+                                break;
+                        }
+                    }
+
+                    ExtractProgress progress(total_bytes, on_progress, on_error);
+                    std::atomic<size_t> next_file{0};
+                    auto worker = [&, metrics = Utils::currentMetrics()]() {
+                        Utils::MetricsScope scope(metrics);
+                        Dedup::ChunkReader reader(archive_path, mapping.get(), catalog, store, dictionary.get());
+                        auto writer = IO::createAsyncFileWriter(
+                            [&progress](const IO::FileWriteRequest& request, std::string_view error) {
+                                if (!error.empty()) {
+                                    spdlog::warn("{}", error);
+                                    recordError(progress, std::string(error));
+                                    return;
+                                }
+                                progress.files_extracted++;
+                                progress.total_size += request.data.size();
+                            });
+                        std::filesystem::path last_parent;
+
+                        for (size_t i = next_file++; i < files.size() && !m_cancelled; i = next_file++) {
+                            try {
+                                restoreFile(files[i], reader, *writer, last_parent, options, progress);
+                            } catch (const std::exception& e) {
+                                const std::string message = fmt::format("Cannot extract {}: {}", files[i].file->path, e.what());
+                                spdlog::warn("{}", message);
+                                recordError(progress, message);
+                            }
+                        }
+                        writer->drain();
+                    };
+                    runWorkers(std::min<size_t>(Utils::resolveThreadCount(options.num_threads), files.size()), worker);
+                    progress.channel.finish();
+
+                    for (const auto& link : symlinks) {
+                        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                        Utils::countSyscalls(3);
+                        std::error_code ec;
+                        std::filesystem::create_directories(link.path.parent_path(), ec);
+                        std::filesystem::remove(link.path, ec);
+                        std::filesystem::create_symlink(link.file->link_target, link.path, ec);
+                        if (ec) {
+                            recordError(progress, fmt::format("Cannot create symlink {}: {}", link.path.string(), ec.message()));
+                        }
+                    }
+
+                    for (auto it = directories.rbegin(); it != directories.rend(); ++it) {
+                        applyMetadata(*it, options);
+                    }
+
+                    result.files_extracted = progress.files_extracted;
+                    result.total_size = progress.total_size;
+
+                    if (m_cancelled) {
+                        result.error_message = "Extraction cancelled by user";
+                        spdlog::info("Dedup extraction cancelled");
+                    } else if (!progress.first_error.empty()) {
+                        result.error_message = progress.first_error;
+                    } else {
+                        result.success = true;
+                        spdlog::info("Successfully extracted {} files from dedup archive", result.files_extracted);
+                    }
+
+                } catch (const std::exception& e) {
+                    result.error_message = fmt::format("Dedup extraction failed: {}", e.what());
+                    spdlog::error("Dedup extraction error: {}", e.what());
+                    if (on_error) {
+                        on_error(result.error_message, true);
+                    }
+                }
+
+                auto end_time = std::chrono::high_resolution_clock::now();
+                result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+                return result;
+            }
+
+            /**
+             * Reassemble one file from its chunks
+             *
+             * Small files are gathered in memory for the batched writer; larger
+             * ones stream through a BufferedWriter one chunk at a time.
+             */
+            void restoreFile(const Target& target,
+                             Dedup::ChunkReader& reader,
+                             IO::AsyncFileWriter& writer,
+                             std::filesystem::path& last_parent,
+                             const ExtractOptions& options,
+                             ExtractProgress& progress) {
+                const Dedup::FileRecord& file = *target.file;
+                FLUX_TRACE_SPAN("dedup.extract_entry", file.path);
+                progress.channel.entry(file.path);
+
+                // Files of one directory are usually adjacent; skip the repeated stat
+                if (target.path.parent_path() != last_parent) {
+                    last_parent = target.path.parent_path();
+                    std::error_code ec;
+                    createDirectories(last_parent, ec);
+                }
+
+                std::optional<uint32_t> permissions;
+                if (options.preserve_permissions) {
+                    permissions = file.mode & IO::RESTORABLE_MODE_BITS;
+                }
+                std::optional<std::chrono::system_clock::time_point> mtime;
+                if (options.preserve_timestamps && file.mtime_ns != 0) {
+                    mtime = modificationTime(file);
+                }
+
+                if (file.size < Constants::SMALL_FILE_THRESHOLD) {
+                    IO::FileWriteRequest request;
+                    request.path = target.path;
+                    request.data.reserve(static_cast<size_t>(file.size));
+                    for (const uint32_t chunk : file.chunks) {
+                        const auto data = reader.read(chunk);
+                        request.data.insert(request.data.end(), data.begin(), data.end());
+                    }
+                    request.permissions = permissions;
+                    request.mtime = mtime;
+                    progress.channel.advance(file.size);
+                    writer.submit(std::move(request));
+                    return;
+                }
+
+                IO::BufferedWriter output(target.path, file.size);
+                for (const uint32_t chunk : file.chunks) {
+                    if (m_cancelled) {
+                        return;
+                    }
+                    const auto data = reader.read(chunk);
+                    output.write(data);
+                    progress.channel.advance(data.size());
+                }
+                output.close();
+
+                Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+                Utils::countSyscalls((permissions ? 1u : 0u) + (mtime ? 1u : 0u));
+                std::error_code ec;
+                if (permissions) {
+                    std::filesystem::permissions(target.path, static_cast<std::filesystem::perms>(*permissions),
+                                                 std::filesystem::perm_options::replace, ec);
+                }
+                if (mtime) {
+                    std::filesystem::last_write_time(target.path, std::filesystem::file_time_type::clock::from_sys(*mtime), ec);
+                }
+                progress.files_extracted++;
+                progress.total_size += static_cast<size_t>(file.size);
+                spdlog::debug("Extracted file: {} ({} bytes)", file.path, file.size);
+            }
+
+            static void applyMetadata(const Target& target, const ExtractOptions& options) {
+                Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+                std::error_code ec;
+                if (options.preserve_permissions) {
+                    std::filesystem::permissions(target.path, static_cast<std::filesystem::perms>(target.file->mode & IO::RESTORABLE_MODE_BITS),
+                                                 std::filesystem::perm_options::replace, ec);
+                }
+                if (options.preserve_timestamps && target.file->mtime_ns != 0) {
+                    std::filesystem::last_write_time(
+                        target.path, std::filesystem::file_time_type::clock::from_sys(modificationTime(*target.file)), ec);
+                }
+            }
+
+            static void createDirectories(const std::filesystem::path& path) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                Utils::countSyscalls();
+                std::filesystem::create_directories(path);
+            }
+
+            static void createDirectories(const std::filesystem::path& path, std::error_code& ec) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                Utils::countSyscalls();
+                std::filesystem::create_directories(path, ec);
+            }
+
+            static std::chrono::system_clock::time_point modificationTime(const Dedup::FileRecord& file) {
+                return std::chrono::system_clock::time_point{
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{file.mtime_ns})};
+            }
+
+            /**
+             * Store to read chunks from: the override if given, else the one the
+             * archive was packed against; nothing if chunks are inline
+             */
+            static std::optional<Dedup::ChunkStore> chunkStore(const Dedup::Catalog& catalog,
+                                                               const std::filesystem::path& override_path) {
+                if (!catalog.usesChunkStore()) {
+                    return std::nullopt;
+                }
+                return Dedup::ChunkStore(override_path.empty() ? catalog.chunk_store : override_path);
+            }
+
+            template <typename Worker>
+            static void runWorkers(size_t count, Worker& worker) {
+                if (count <= 1) {
+                    worker();
+                    return;
+                }
+                std::vector<std::future<void>> tasks;
+                tasks.reserve(count);
+                for (size_t i = 0; i < count; ++i) {
+                    tasks.emplace_back(std::async(std::launch::async, std::ref(worker)));
+                }
+                for (auto& task : tasks) {
+                    task.get();
+                }
+            }
+
+            /**
+             * Output path for an archive name, or nothing if it would escape output_dir
+             */
+            static std::optional<std::filesystem::path> outputPath(const std::filesystem::path& output_dir,
+                                                                   const std::string& name) {
+                const std::filesystem::path relative = std::filesystem::path(name).lexically_normal();
+                if (name.empty() || relative.has_root_path() ||
+                    (!relative.empty() && *relative.begin() == "..")) {
+                    return std::nullopt;
+                }
+                return output_dir / relative;
+            }
+
+            static void recordError(ExtractProgress& progress, const std::string& message) {
+                std::lock_guard<std::mutex> lock(progress.callback_mutex);
+                if (progress.first_error.empty()) {
+                    progress.first_error = message;
+                }
+                if (progress.on_error) {
+                    progress.on_error(message, false);
+                }
+            }
+        };
+
+        // Factory function to create the dedup extractor
+        std::unique_ptr<Extractor> createDedupExtractor() {
+            return std::make_unique<DedupExtractorImpl>();
+        }
+    }
+}
@@ -1,17 +1,40 @@
 #include "flux-core/extractor.h"
 #include "flux-core/exceptions.h"
+#include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "formats/sevenzip/sevenzip_archive.h"
+#include "io/async_file_writer.h"
+#include "io/buffered_io.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
+#include <lzma.h>
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <vector>
 
 namespace Flux {
     namespace Formats {
         /**
-         * 7-Zip format extractor implementation (Stub)
-         * TODO: Implement with 7-Zip SDK or p7zip library
+         * Native 7-Zip format extractor
+         *
+         * Headers are parsed directly and folders are decoded with liblzma raw
+         * decoders. Folders (solid blocks) are independent, so several are
+         * decoded at once, each streaming straight into its output files.
          */
         class SevenZipExtractorImpl : public Extractor {
         private:
-            bool m_cancelled = false;
+            std::atomic<bool> m_cancelled{false};
 
         public:
             ExtractResult extract(
@@ -20,12 +43,8 @@ namespace Flux {
                 const ExtractOptions& options,
                 const ProgressCallback& on_progress,
                 const ErrorCallback& on_error) override {
-                
-                ExtractResult result;
-                result.success = false;
-                result.error_message = "7-Zip extraction requires 7-Zip SDK or p7zip library - not yet implemented";
-                spdlog::error("7-Zip extraction not implemented yet");
-                return result;
+
+                return extractMatching(archive_path, output_dir, {}, options, on_progress, on_error);
             }
 
             ExtractResult extractPartial(
@@ -35,47 +54,594 @@ namespace Flux {
                 const ExtractOptions& options,
                 const ProgressCallback& on_progress,
                 const ErrorCallback& on_error) override {
-                
-                ExtractResult result;
-                result.success = false;
-                result.error_message = "7-Zip partial extraction not yet implemented";
-                return result;
+
+                if (file_patterns.empty()) {
+                    ExtractResult result;
+                    result.success = true;
+                    return result;
+                }
+                return extractMatching(archive_path, output_dir, file_patterns, options, on_progress, on_error);
             }
 
             Flux::expected<std::vector<ArchiveEntry>, std::string> listContents(
                 const std::filesystem::path& archive_path,
                 std::string_view password) override {
-                
-                return Flux::unexpected<std::string>{"7-Zip content listing not yet implemented"};
+
+                try {
+                    SevenZip::ArchiveInput input(archive_path);
+                    const SevenZip::Database db = SevenZip::readDatabase(input);
+
+                    std::vector<ArchiveEntry> entries;
+                    entries.reserve(db.files.size());
+                    for (const auto& file : db.files) {
+                        if (file.is_anti) {
+                            continue;
+                        }
+                        ArchiveEntry entry{};
+                        entry.name = std::filesystem::path(file.name).filename().string();
+                        entry.path = file.name;
+                        entry.is_directory = file.is_directory;
+                        entry.uncompressed_size = file.size;
+                        // Solid folders have no per-file packed size; apportion the folder's packed size by unpacked size
+                        if (file.folder != SevenZip::NO_FOLDER) {
+                            const uint64_t folder_size = db.folders[file.folder].unpackSize();
+                            entry.compressed_size = folder_size == 0 ? 0 : static_cast<size_t>(
+                                static_cast<double>(db.packSize(file.folder)) * static_cast<double>(file.size) /
+                                static_cast<double>(folder_size));
+                        }
+                        if (auto mode = file.unixMode()) {
+                            entry.permissions = *mode & 07777;
+                        }
+                        if (auto mtime = file.modificationTime()) {
+                            entry.modification_time = std::to_string(std::chrono::system_clock::to_time_t(*mtime));
+                        }
+                        entries.push_back(std::move(entry));
+                    }
+
+                    spdlog::debug("Listed {} entries from 7z archive", entries.size());
+                    return entries;
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot list 7z contents: {}", e.what()));
+                }
             }
 
             Flux::expected<ArchiveInfo, std::string> getArchiveInfo(
                 const std::filesystem::path& archive_path,
                 std::string_view password) override {
-                
-                return Flux::unexpected<std::string>{"7-Zip archive info not yet implemented"};
+
+                try {
+                    SevenZip::ArchiveInput input(archive_path);
+                    const SevenZip::Database db = SevenZip::readDatabase(input);
+
+                    ArchiveInfo info;
+                    info.path = archive_path;
+                    info.format = ArchiveFormat::SEVEN_ZIP;
+                    info.compressed_size = input.size();
+                    info.uncompressed_size = 0;
+                    info.file_count = 0;
+                    for (const auto& file : db.files) {
+                        if (!file.is_directory && !file.is_anti) {
+                            info.uncompressed_size += file.size;
+                            info.file_count++;
+                        }
+                    }
+                    info.is_encrypted = db.isEncrypted();
+                    info.creation_time = "Unknown"; // 7z stores no archive creation time
+                    return info;
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Cannot get 7z archive info: {}", e.what()));
+                }
             }
 
             Flux::expected<void, std::string> verifyIntegrity(
                 const std::filesystem::path& archive_path,
                 std::string_view password) override {
-                
-                return Flux::unexpected<std::string>{"7-Zip integrity verification not yet implemented"};
+
+                try {
+                    SevenZip::ArchiveInput input(archive_path);
+                    const SevenZip::Database db = SevenZip::readDatabase(input);
+
+                    // Decode every folder and check folder and file CRCs without writing anything
+                    std::vector<size_t> folders(db.folders.size());
+                    for (size_t i = 0; i < folders.size(); ++i) {
+                        folders[i] = i;
+                    }
+                    const std::vector<std::optional<std::filesystem::path>> no_targets(db.files.size());
+                    const ExtractOptions options;
+                    const ProgressCallback no_progress;
+                    const ErrorCallback no_error;
+                    ExtractProgress progress(0, no_progress, no_error);
+                    decodeFolders(input, db, folders, no_targets, options, progress, false);
+
+                    if (!progress.first_error.empty()) {
+                        return Flux::unexpected<std::string>(progress.first_error);
+                    }
+                    return {};
+
+                } catch (const std::exception& e) {
+                    return Flux::unexpected<std::string>(fmt::format("Integrity verification failed: {}", e.what()));
+                }
             }
 
             Flux::expected<ArchiveFormat, std::string> detectFormat(
                 const std::filesystem::path& archive_path) override {
-                
+
+                std::ifstream file(archive_path, std::ios::binary);
+                if (!file.is_open()) {
+                    return Flux::unexpected<std::string>{"Cannot open archive file"};
+                }
+
+                std::array<uint8_t, SevenZip::SIGNATURE.size()> signature{};
+                file.read(reinterpret_cast<char*>(signature.data()), static_cast<std::streamsize>(signature.size()));
+                if (static_cast<size_t>(file.gcount()) != signature.size() || signature != SevenZip::SIGNATURE) {
+                    return Flux::unexpected<std::string>{"Invalid 7-Zip file signature"};
+                }
                 return ArchiveFormat::SEVEN_ZIP;
             }
 
             void cancel() override {
                 m_cancelled = true;
+                spdlog::info("7z extraction cancellation requested");
             }
 
             bool supportsFormat(ArchiveFormat format) const override {
                 return format == ArchiveFormat::SEVEN_ZIP;
             }
+
+        private:
+            // Shared extraction state; counters are updated by all workers
+            struct ExtractProgress {
+                ExtractProgress(uint64_t bytes, const ProgressCallback& progress_cb, const ErrorCallback& error_cb)
+                    : channel(progress_cb, "Extracting", bytes), on_error(error_cb) {}
+
+                Utils::ProgressChannel channel;  // Counts bytes decoded
+                const ErrorCallback& on_error;
+                std::atomic<size_t> files_extracted{0};
+                std::atomic<size_t> total_size{0};
+                std::mutex callback_mutex;       // Serializes error callbacks and first_error
+                std::string first_error;         // First data or worker-level failure
+            };
+
+            // Per-thread extraction state
+            struct WorkerContext {
+                std::unique_ptr<IO::AsyncFileWriter> writer;    // Batched writer for small files
+                std::filesystem::path last_parent;              // Last directory ensured to exist
+            };
+
+            static WorkerContext createWorkerContext(ExtractProgress& progress) {
+                WorkerContext context;
+                context.writer = IO::createAsyncFileWriter(
+                    [&progress](const IO::FileWriteRequest& request, std::string_view error) {
+                        if (!error.empty()) {
+                            spdlog::warn("{}", error);
+                            reportError(progress, std::string(error));
+                            return;
+                        }
+                        progress.files_extracted++;
+                        progress.total_size += request.data.size();
+                    });
+                return context;
+            }
+
+            /**
+             * Consumes a folder's decoded stream and splits it into its files
+             *
+             * Files without a target are only checksummed. Small files are
+             * collected in memory for the batched writer; larger ones stream
+             * through a BufferedWriter.
+             */
+            class FolderOutput {
+            public:
+                FolderOutput(const SevenZip::Database& db,
+                             size_t folder,
+                             const std::vector<std::optional<std::filesystem::path>>& targets,
+                             const ExtractOptions& options,
+                             WorkerContext& context,
+                             ExtractProgress& progress)
+                    : m_db(db), m_files(db.folder_files[folder]), m_targets(targets),
+                      m_options(options), m_context(context), m_progress(progress) {}
+
+                void consume(std::span<const std::byte> chunk) {
+                    while (!chunk.empty()) {
+                        if (!m_active) {
+                            beginNext();
+                        }
+                        const auto take = static_cast<size_t>(std::min<uint64_t>(m_remaining, chunk.size()));
+                        write(chunk.first(take));
+                        m_progress.channel.advance(take);
+                        m_remaining -= take;
+                        chunk = chunk.subspan(take);
+                        if (m_remaining == 0) {
+                            finishCurrent();
+                        }
+                    }
+                }
+
+                /**
+                 * Finish trailing empty files once the folder is fully decoded
+                 */
+                void complete() {
+                    while (m_active || m_next < m_files.size()) {
+                        if (!m_active) {
+                            beginNext();
+                        }
+                        if (m_remaining != 0) {
+                            throw CorruptedArchiveException("7z folder is shorter than its files");
+                        }
+                        finishCurrent();
+                    }
+                }
+
+            private:
+                void beginNext() {
+                    if (m_next >= m_files.size()) {
+                        throw CorruptedArchiveException("7z folder is longer than its files");
+                    }
+                    m_current = m_files[m_next++];
+                    const auto& file = m_db.files[m_current];
+                    m_remaining = file.size;
+                    m_crc = 0;
+                    m_active = true;
+                    m_request = {};
+                    m_writer.reset();
+
+                    const auto& target = m_targets[m_current];
+                    m_writing = target.has_value();
+                    if (!m_writing) {
+                        return;
+                    }
+
+                    m_progress.channel.entry(file.name);
+
+                    // Files of one directory are usually adjacent; skip the repeated stat
+                    if (target->parent_path() != m_context.last_parent) {
+                        m_context.last_parent = target->parent_path();
+                        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                        Utils::countSyscalls();
+                        std::error_code ec;
+                        std::filesystem::create_directories(m_context.last_parent, ec);
+                    }
+
+                    if (file.size < Constants::SMALL_FILE_THRESHOLD) {
+                        m_request.path = *target;
+                        m_request.data.reserve(static_cast<size_t>(file.size));
+                        return;
+                    }
+                    try {
+                        m_writer.emplace(*target, file.size);
+                    } catch (const std::exception& e) {
+                        fail(fmt::format("Cannot write output file {}: {}", target->string(), e.what()));
+                    }
+                }
+
+                void write(std::span<const std::byte> data) {
+                    m_crc = lzma_crc32(reinterpret_cast<const uint8_t*>(data.data()), data.size(), m_crc);
+                    if (!m_writing) {
+                        return;
+                    }
+                    if (!m_writer) {
+                        m_request.data.insert(m_request.data.end(), data.begin(), data.end());
+                        return;
+                    }
+                    try {
+                        m_writer->write(data);
+                    } catch (const std::exception& e) {
+                        fail(fmt::format("Cannot write output file {}: {}", m_targets[m_current]->string(), e.what()));
+                    }
+                }
+
+                void finishCurrent() {
+                    m_active = false;
+                    const auto& file = m_db.files[m_current];
+                    if (file.crc && m_crc != *file.crc) {
+                        const std::string message = fmt::format("CRC mismatch for file: {}", file.name);
+                        spdlog::warn("{}", message);
+                        reportError(m_progress, message);
+                        std::lock_guard<std::mutex> lock(m_progress.callback_mutex);
+                        if (m_progress.first_error.empty()) {
+                            m_progress.first_error = message;
+                        }
+                    }
+                    if (!m_writing) {
+                        return;
+                    }
+
+                    std::optional<uint32_t> permissions;
+                    if (m_options.preserve_permissions) {
+                        if (auto mode = file.unixMode()) {
+                            permissions = *mode & IO::RESTORABLE_MODE_BITS;
+                        }
+                    }
+                    std::optional<std::chrono::system_clock::time_point> mtime;
+                    if (m_options.preserve_timestamps) {
+                        mtime = file.modificationTime();
+                    }
+
+                    if (!m_writer) {
+                        m_request.permissions = permissions;
+                        m_request.mtime = mtime;
+                        m_context.writer->submit(std::move(m_request));
+                        return;
+                    }
+
+                    const std::filesystem::path& target = *m_targets[m_current];
+                    try {
+                        m_writer->close();
+                    } catch (const std::exception& e) {
+                        fail(fmt::format("Cannot write output file {}: {}", target.string(), e.what()));
+                        return;
+                    }
+                    Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+                    Utils::countSyscalls((permissions ? 1u : 0u) + (mtime ? 1u : 0u));
+                    std::error_code ec;
+                    if (permissions) {
+                        std::filesystem::permissions(target, static_cast<std::filesystem::perms>(*permissions),
+                                                     std::filesystem::perm_options::replace, ec);
+                    }
+                    if (mtime) {
+                        std::filesystem::last_write_time(target, std::filesystem::file_time_type::clock::from_sys(*mtime), ec);
+                    }
+                    m_progress.files_extracted++;
+                    m_progress.total_size += static_cast<size_t>(file.size);
+                    spdlog::debug("Extracted file: {} ({} bytes)", file.name, file.size);
+                }
+
+                // Report a write failure and keep decoding without output for this file
+                void fail(const std::string& message) {
+                    spdlog::warn("{}", message);
+                    reportError(m_progress, message);
+                    m_writer.reset();
+                    m_writing = false;
+                }
+
+                const SevenZip::Database& m_db;
+                const std::vector<size_t>& m_files;
+                const std::vector<std::optional<std::filesystem::path>>& m_targets;
+                const ExtractOptions& m_options;
+                WorkerContext& m_context;
+                ExtractProgress& m_progress;
+
+                size_t m_next = 0;              // Next position in m_files
+                size_t m_current = 0;           // File index being produced
+                uint64_t m_remaining = 0;       // Bytes still due for the current file
+                uint32_t m_crc = 0;
+                bool m_active = false;
+                bool m_writing = false;
+                IO::FileWriteRequest m_request;
+                std::optional<IO::BufferedWriter> m_writer;
+            };
+
+            /**
+             * Extract all files, or those matching one of the patterns, subject to
+             * the include/exclude patterns of the options
+             */
+            ExtractResult extractMatching(const std::filesystem::path& archive_path,
+                                          const std::filesystem::path& output_dir,
+                                          std::span<const std::string> file_patterns,
+                                          const ExtractOptions& options,
+                                          const ProgressCallback& on_progress,
+                                          const ErrorCallback& on_error) {
+                auto start_time = std::chrono::high_resolution_clock::now();
+                ExtractResult result;
+                result.success = false;
+                result.files_extracted = 0;
+                result.total_size = 0;
+
+                try {
+                    SevenZip::ArchiveInput input(archive_path);
+                    const SevenZip::Database db = SevenZip::readDatabase(input);
+                    std::filesystem::create_directories(output_dir);
+
+                    spdlog::info("Extracting {} entries in {} folders from 7z archive: {}",
+                                 db.files.size(), db.folders.size(), archive_path.string());
+
+                    const Utils::PathMatcher selected(file_patterns);
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
+                    auto matches = [&](const std::string& name) {
+                        return (file_patterns.empty() || selected.matches(name)) && filter.accepts(name);
+                    };
+
+                    // Resolve output paths and create directories up front, so workers only create files
+                    std::vector<std::optional<std::filesystem::path>> targets(db.files.size());
+                    std::vector<bool> folder_needed(db.folders.size(), false);
+                    std::vector<size_t> empty_files;
+                    uint64_t total_bytes = 0;
+                    for (size_t i = 0; i < db.files.size(); ++i) {
+                        const auto& file = db.files[i];
+                        if (file.is_anti || !matches(file.name)) {
+                            Utils::countSkippedEntry();
+                            continue;
+                        }
+                        auto target = outputPath(output_dir, file.name);
+                        if (!target) {
+                            spdlog::warn("Skipping unsafe path in archive: {}", file.name);
+                            result.skipped_files.push_back(file.name);
+                            continue;
+                        }
+
+                        if (file.is_directory) {
+                            Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                            Utils::countSyscalls();
+                            std::filesystem::create_directories(*target);
+                            spdlog::debug("Created directory: {}", target->string());
+                        } else if (file.folder == SevenZip::NO_FOLDER) {
+                            targets[i] = std::move(target);
+                            empty_files.push_back(i);
+                        } else {
+                            targets[i] = std::move(target);
+                            folder_needed[file.folder] = true;
+                        }
+                    }
+
+                    std::vector<size_t> folders;
+                    for (size_t i = 0; i < db.folders.size(); ++i) {
+                        if (folder_needed[i]) {
+                            folders.push_back(i);
+                            total_bytes += db.folders[i].unpackSize();
+                        }
+                    }
+
+                    ExtractProgress progress(total_bytes, on_progress, on_error);
+                    {
+                        WorkerContext context = createWorkerContext(progress);
+                        for (size_t i : empty_files) {
+                            IO::FileWriteRequest request;
+                            request.path = *targets[i];
+                            if (options.preserve_permissions) {
+                                if (auto mode = db.files[i].unixMode()) {
+                                    request.permissions = *mode & IO::RESTORABLE_MODE_BITS;
+                                }
+                            }
+                            if (options.preserve_timestamps) {
+                                request.mtime = db.files[i].modificationTime();
+                            }
+                            {
+                                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                                Utils::countSyscalls();
+                                std::error_code ec;
+                                std::filesystem::create_directories(request.path.parent_path(), ec);
+                            }
+                            context.writer->submit(std::move(request));
+                        }
+                        context.writer->drain();
+                    }
+
+                    decodeFolders(input, db, folders, targets, options, progress, true);
+                    progress.channel.finish();
+
+                    result.files_extracted = progress.files_extracted;
+                    result.total_size = progress.total_size;
+
+                    if (m_cancelled) {
+                        result.error_message = "Extraction cancelled by user";
+                        spdlog::info("7z extraction cancelled");
+                    } else if (!progress.first_error.empty()) {
+                        result.error_message = progress.first_error;
+                    } else {
+                        result.success = true;
+                        spdlog::info("Successfully extracted {} files from 7z archive", result.files_extracted);
+                    }
+
+                } catch (const std::exception& e) {
+                    result.error_message = fmt::format("7z extraction failed: {}", e.what());
+                    spdlog::error("7z extraction error: {}", e.what());
+                    if (on_error) {
+                        on_error(result.error_message, true);
+                    }
+                }
+
+                auto end_time = std::chrono::high_resolution_clock::now();
+                result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+                return result;
+            }
+
+            /**
+             * Decode folders on as many threads as the options and memory allow
+             *
+             * Workers take folders largest first so one huge solid block does not
+             * end up last. Each LZMA decoder holds a full dictionary, so the worker
+             * count is also capped to keep the decoders within MEMORY_LIMIT_MB.
+             */
+            void decodeFolders(const SevenZip::ArchiveInput& input,
+                               const SevenZip::Database& db,
+                               std::vector<size_t> folders,
+                               const std::vector<std::optional<std::filesystem::path>>& targets,
+                               const ExtractOptions& options,
+                               ExtractProgress& progress,
+                               bool writes_files) {
+                if (folders.empty()) {
+                    return;
+                }
+
+                std::stable_sort(folders.begin(), folders.end(), [&db](size_t a, size_t b) {
+                    return db.folders[a].unpackSize() > db.folders[b].unpackSize();
+                });
+
+                uint64_t peak_memory = 0;
+                for (size_t folder : folders) {
+                    peak_memory = std::max(peak_memory, SevenZip::decoderMemoryUsage(db.folders[folder]));
+                }
+                size_t workers = std::min<size_t>(Utils::resolveThreadCount(options.num_threads), folders.size());
+                if (peak_memory > 0) {
+                    const uint64_t budget = static_cast<uint64_t>(Constants::Performance::MEMORY_LIMIT_MB) * 1024 * 1024;
+                    workers = std::clamp<size_t>(static_cast<size_t>(budget / peak_memory), 1, workers);
+                }
+                spdlog::debug("Decoding {} 7z folders on {} threads", folders.size(), workers);
+
+                std::atomic<size_t> next_folder{0};
+                auto worker = [&, metrics = Utils::currentMetrics()]() {
+                    Utils::MetricsScope scope(metrics);
+                    WorkerContext context;
+                    if (writes_files) {
+                        context = createWorkerContext(progress);
+                    }
+
+                    for (size_t i = next_folder++; i < folders.size() && !m_cancelled; i = next_folder++) {
+                        const size_t folder = folders[i];
+                        // A folder is decoded as one stream; label it by its first file
+                        FLUX_TRACE_SPAN("7z.extract_folder", db.folder_files[folder].empty()
+                            ? std::string_view{} : std::string_view(db.files[db.folder_files[folder].front()].name));
+                        try {
+                            FolderOutput output(db, folder, targets, options, context, progress);
+                            SevenZip::decodeFolder(input, db, folder,
+                                                   [&output](std::span<const std::byte> chunk) { output.consume(chunk); },
+                                                   &m_cancelled);
+                            output.complete();
+                        } catch (const OperationCancelledException&) {
+                            break;
+                        } catch (const std::exception& e) {
+                            const std::string message = fmt::format("Cannot decode 7z folder {}: {}", folder, e.what());
+                            spdlog::warn("{}", message);
+                            reportError(progress, message);
+                            std::lock_guard<std::mutex> lock(progress.callback_mutex);
+                            if (progress.first_error.empty()) {
+                                progress.first_error = message;
+                            }
+                        }
+                    }
+
+                    if (context.writer) {
+                        context.writer->drain();
+                    }
+                };
+
+                if (workers <= 1) {
+                    worker();
+                    return;
+                }
+
+                std::vector<std::future<void>> tasks;
+                tasks.reserve(workers);
+                for (size_t i = 0; i < workers; ++i) {
+                    tasks.emplace_back(std::async(std::launch::async, worker));
+                }
+                for (auto& task : tasks) {
+                    task.get();
+                }
+            }
+
+            /**
+             * Output path for an archive name, or nothing if it would escape output_dir
+             */
+            static std::optional<std::filesystem::path> outputPath(const std::filesystem::path& output_dir,
+                                                                   const std::string& name) {
+                const std::filesystem::path relative = std::filesystem::path(name).lexically_normal();
+                if (name.empty() || relative.has_root_path() ||
+                    (!relative.empty() && *relative.begin() == "..")) {
+                    return std::nullopt;
+                }
+                return output_dir / relative;
+            }
+
+            static void reportError(ExtractProgress& progress, const std::string& message) {
+                if (progress.on_error) {
+                    std::lock_guard<std::mutex> lock(progress.callback_mutex);
+                    progress.on_error(message, false);
+                }
+            }
         };
 
         // Factory function to create 7-Zip extractor
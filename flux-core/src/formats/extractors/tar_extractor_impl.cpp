@@ -1,5 +1,18 @@
 #include "flux-core/extractor.h"
+#include "flux-core/archive_index.h"
 #include "flux-core/exceptions.h"
+#include "flux-core/incremental.h"
+#include "flux-core/trace.h"
+#include "io/async_file_writer.h"
+#include "io/buffered_io.h"
+#include "io/decompression_source.h"
+#include "io/mapped_file.h"
+#include "io/zstd_dictionary.h"
+#include "flux-core/constants.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
 #include <archive.h>
 #include <archive_entry.h>
 #include <spdlog/spdlog.h>
@@ -7,6 +20,18 @@
 #include <fstream>
 #include <chrono>
 #include <filesystem>
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 namespace Flux {
     namespace Formats {
@@ -47,7 +72,17 @@ namespace Flux {
                 archive_write_disk_set_options(ext, flags);
                 archive_write_disk_set_standard_lookup(ext);
 
-                int r = archive_read_open_filename(a, archive_path.string().c_str(), 10240);
+#ifdef _WIN32
+                const bool restores_owner = false;
+#else
+                // Ownership can only be restored by root; otherwise archive_write_disk skips it too
+                const bool restores_owner = (flags & ARCHIVE_EXTRACT_OWNER) && geteuid() == 0;
+#endif
+                AsyncOutput async_output;
+
+                const unsigned threads = Utils::resolveThreadCount(options.num_threads);
+                ReadInput input;
+                int r = openArchive(a, archive_path, threads, input);
                 if (r != ARCHIVE_OK) {
                     result.error_message = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
                     archive_read_free(a);
@@ -61,37 +96,54 @@ namespace Flux {
                     std::filesystem::create_directories(output_dir);
                     
                     struct archive_entry* entry;
-                    size_t total_entries = 0;
-                    size_t processed_entries = 0;
 
-                    spdlog::info("Extracting TAR archive: {}", archive_path.string());
+                    // Progress follows compressed input consumed, so a single streaming pass suffices
+                    std::error_code size_ec;
+                    const auto archive_size = static_cast<size_t>(std::filesystem::file_size(archive_path, size_ec));
+                    Utils::ProgressChannel progress(on_progress, "Extracting", archive_size);
 
-                    // First pass: count entries for progress reporting
-                    while (archive_read_next_header(a, &entry) == ARCHIVE_OK) {
-                        total_entries++;
-                        archive_read_data_skip(a);
-                    }
-                    
-                    // Reset archive for actual extraction
-                    archive_read_free(a);
-                    a = archive_read_new();
-                    archive_read_support_format_all(a);
-                    archive_read_support_filter_all(a);
-                    archive_read_open_filename(a, archive_path.string().c_str(), 10240);
+                    spdlog::info("Extracting TAR archive: {}", archive_path.string());
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
 
                     // Extract each entry
-                    while (archive_read_next_header(a, &entry) == ARCHIVE_OK && !m_cancelled) {
-                        if (on_progress) {
-                            float progress = static_cast<float>(processed_entries) / static_cast<float>(total_entries);
-                            on_progress(fmt::format("Extracting: {}", archive_entry_pathname(entry)), 
-                                      progress, processed_entries, total_entries);
+                    while (readHeader(a, &entry) == ARCHIVE_OK && !m_cancelled) {
+                        async_output.reportErrors(on_error);
+
+                        if (!filter.accepts(archive_entry_pathname(entry)) || isManifestMember(entry)) {
+                            Utils::countSkippedEntry();
+                            archive_read_data_skip(a);
+                            continue;
+                        }
+                        FLUX_TRACE_SPAN("tar.extract_entry", archive_entry_pathname(entry));
+
+                        if (progress.enabled()) {
+                            progress.update(std::min(compressedBytesRead(a, input.source.get()), archive_size));
+                            progress.entry(archive_entry_pathname(entry));
                         }
 
                         // Construct full output path
                         std::filesystem::path entry_path = output_dir / archive_entry_pathname(entry);
                         archive_entry_set_pathname(entry, entry_path.string().c_str());
 
-                        r = archive_write_header(ext, entry);
+                        // A path written twice must end up with the later entry, so its queued write lands first
+                        if (async_output.inFlight(entry_path)) {
+                            async_output.writer->drain();
+                        }
+
+                        // Small plain files skip archive_write_disk's per-file syscalls
+                        if (isSimpleFile(entry, restores_owner)) {
+                            async_output.queue(a, entry, std::move(entry_path));
+                            continue;
+                        }
+                        if (archive_entry_hardlink(entry)) {
+                            // The link target may still be in flight
+                            async_output.writer->drain();
+                        }
+                        if (archive_entry_filetype(entry) == AE_IFLNK) {
+                            async_output.noteSymlink(entry_path);
+                        }
+
+                        r = writeHeader(ext, entry);
                         if (r < ARCHIVE_OK) {
                             spdlog::warn("Warning writing header: {}", archive_error_string(ext));
                         } else if (archive_entry_size(entry) > 0) {
@@ -100,8 +152,8 @@ namespace Flux {
                             size_t size;
                             la_int64_t offset;
 
-                            while ((r = archive_read_data_block(a, &buff, &size, &offset)) == ARCHIVE_OK) {
-                                r = archive_write_data_block(ext, buff, size, offset);
+                            while ((r = readDataBlock(a, &buff, &size, &offset)) == ARCHIVE_OK) {
+                                r = writeDataBlock(ext, buff, size, offset);
                                 if (r < ARCHIVE_OK) {
                                     spdlog::warn("Warning writing data: {}", archive_error_string(ext));
                                     break;
@@ -110,22 +162,24 @@ namespace Flux {
                             }
                         }
 
-                        r = archive_write_finish_entry(ext);
+                        r = finishEntry(ext);
                         if (r < ARCHIVE_OK) {
                             spdlog::warn("Warning finishing entry: {}", archive_error_string(ext));
                         }
 
                         result.files_extracted++;
-                        processed_entries++;
                         spdlog::debug("Extracted: {}", archive_entry_pathname(entry));
                     }
+                    if (!m_cancelled) {
+                        progress.update(archive_size);
+                    }
+                    progress.finish();
 
                     if (m_cancelled) {
                         result.error_message = "Extraction cancelled by user";
                         spdlog::info("TAR extraction cancelled");
                     } else {
                         result.success = true;
-                        spdlog::info("Successfully extracted {} files from TAR archive", result.files_extracted);
                     }
 
                 } catch (const std::exception& e) {
@@ -133,6 +187,21 @@ namespace Flux {
                     spdlog::error("TAR extraction error: {}", e.what());
                 }
 
+                // Files must land before archive_write_close applies deferred directory times
+                try {
+                    async_output.writer->drain();
+                } catch (const std::exception& e) {
+                    result.success = false;
+                    result.error_message = fmt::format("TAR extraction failed: {}", e.what());
+                }
+                async_output.reportErrors(on_error);
+                result.files_extracted += async_output.files_written;
+                result.total_size += async_output.bytes_written;
+                if (result.success) {
+                    spdlog::info("Successfully extracted {} files from TAR archive", result.files_extracted);
+                }
+
+                countArchiveBytesRead(a, input);
                 archive_read_close(a);
                 archive_read_free(a);
                 archive_write_close(ext);
@@ -157,12 +226,48 @@ namespace Flux {
                 result.files_extracted = 0;
                 result.total_size = 0;
 
-                struct archive* a = archive_read_new();
+                Utils::PathMatcher selected;
+                Utils::PathFilter filter;
+                try {
+                    selected = Utils::PathMatcher(file_patterns);
+                    filter = Utils::PathFilter(options.include_patterns, options.exclude_patterns);
+                } catch (const std::exception& e) {
+                    result.error_message = fmt::format("Partial TAR extraction failed: {}", e.what());
+                    return result;
+                }
+
+                // With an index the matches are known up front, so reading can start
+                // at the frame holding the first one and stop after the last one
+                std::optional<ArchiveIndex> index;
+                if (auto loaded = readArchiveIndex(archive_path)) {
+                    index = std::move(*loaded);
+                }
+                const std::vector<ReadPass> passes = planReadPasses(index ? &*index : nullptr, selected, filter);
+                size_t total_matches = file_patterns.size();
+                if (index) {
+                    total_matches = 0;
+                    for (const auto& pass : passes) {
+                        total_matches += *pass.matches;
+                    }
+                    if (total_matches == 0) {
+                        result.success = true;
+                        spdlog::info("No entries of {} match the requested patterns", archive_path.string());
+                        return result;
+                    }
+                }
+
+                // Frames read from the middle need the dictionary the stream starts with
+                IO::SharedDDict dictionary;
+                if (std::any_of(passes.begin(), passes.end(), [](const ReadPass& pass) { return pass.start; })) {
+                    try {
+                        dictionary = embeddedDictionary(archive_path);
+                    } catch (const std::exception& e) {
+                        result.error_message = fmt::format("Cannot open TAR archive: {}", e.what());
+                        return result;
+                    }
+                }
+
                 struct archive* ext = archive_write_disk_new();
-                
-                archive_read_support_format_all(a);
-                archive_read_support_filter_all(a);
-                
                 int flags = ARCHIVE_EXTRACT_TIME | ARCHIVE_EXTRACT_PERM;
                 if (options.preserve_permissions) {
                     flags |= ARCHIVE_EXTRACT_OWNER;
@@ -170,75 +275,107 @@ namespace Flux {
                 archive_write_disk_set_options(ext, flags);
                 archive_write_disk_set_standard_lookup(ext);
 
-                int r = archive_read_open_filename(a, archive_path.string().c_str(), 10240);
-                if (r != ARCHIVE_OK) {
-                    result.error_message = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
-                    archive_read_free(a);
-                    archive_write_free(ext);
-                    return result;
-                }
+                const unsigned threads = Utils::resolveThreadCount(options.num_threads);
+                Utils::ProgressChannel progress(on_progress, "Extracting", total_matches);
+                result.success = true;
 
-                try {
-                    std::filesystem::create_directories(output_dir);
-                    
-                    struct archive_entry* entry;
-                    size_t matched_files = 0;
-
-                    while (archive_read_next_header(a, &entry) == ARCHIVE_OK && !m_cancelled) {
-                        const char* pathname = archive_entry_pathname(entry);
-                        
-                        // Check if file matches any pattern
-                        bool matches = false;
-                        for (const auto& pattern : file_patterns) {
-                            if (std::string(pathname).find(pattern) != std::string::npos) {
-                                matches = true;
-                                break;
-                            }
-                        }
+                for (const auto& pass : passes) {
+                    if (m_cancelled) {
+                        break;
+                    }
 
-                        if (!matches) {
-                            archive_read_data_skip(a);
-                            continue;
+                    struct archive* a = archive_read_new();
+                    ReadInput input;
+                    int r = ARCHIVE_OK;
+                    if (pass.start) {
+                        // Decoded data begins at an entry header: plain TAR, no filter
+                        archive_read_support_format_tar(a);
+                        archive_read_support_filter_none(a);
+                        try {
+                            input.source = IO::createZstdFrameSource(archive_path, pass.start->compressed_offset, pass.skip,
+                                                                     dictionary);
+                            r = archive_read_open(a, input.source.get(), nullptr, &TarExtractorImpl::readCallback, nullptr);
+                        } catch (const std::exception& e) {
+                            archive_set_error(a, EIO, "%s", e.what());
+                            r = ARCHIVE_FATAL;
                         }
+                    } else {
+                        archive_read_support_format_all(a);
+                        archive_read_support_filter_all(a);
+                        r = openArchive(a, archive_path, threads, input);
+                    }
+                    if (r != ARCHIVE_OK) {
+                        result.success = false;
+                        result.error_message = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
+                        archive_read_free(a);
+                        break;
+                    }
 
-                        matched_files++;
+                    try {
+                        std::filesystem::create_directories(output_dir);
                         
-                        if (on_progress) {
-                            on_progress(fmt::format("Extracting: {}", pathname), 
-                                      static_cast<float>(matched_files) / file_patterns.size(), 
-                                      matched_files, file_patterns.size());
-                        }
+                        struct archive_entry* entry;
+                        size_t pass_matches = 0;
+
+                        while (!(pass.matches && pass_matches == *pass.matches) &&
+                               readHeader(a, &entry) == ARCHIVE_OK && !m_cancelled) {
+                            const char* pathname = archive_entry_pathname(entry);
+                            
+                            if (!selected.matches(pathname) || !filter.accepts(pathname) || isManifestMember(entry)) {
+                                Utils::countSkippedEntry();
+                                archive_read_data_skip(a);
+                                continue;
+                            }
 
-                        // Extract the matching file
-                        std::filesystem::path entry_path = output_dir / pathname;
-                        archive_entry_set_pathname(entry, entry_path.string().c_str());
+                            FLUX_TRACE_SPAN("tar.extract_entry", pathname);
+                            pass_matches++;
+                            progress.entry(pathname);
+                            progress.advance();
 
-                        r = archive_write_header(ext, entry);
-                        if (r >= ARCHIVE_OK && archive_entry_size(entry) > 0) {
-                            const void* buff;
-                            size_t size;
-                            la_int64_t offset;
+                            // Extract the matching file
+                            std::filesystem::path entry_path = output_dir / pathname;
+                            archive_entry_set_pathname(entry, entry_path.string().c_str());
 
-                            while ((r = archive_read_data_block(a, &buff, &size, &offset)) == ARCHIVE_OK) {
-                                archive_write_data_block(ext, buff, size, offset);
-                                result.total_size += size;
+                            r = writeHeader(ext, entry);
+                            if (r >= ARCHIVE_OK && archive_entry_size(entry) > 0) {
+                                const void* buff;
+                                size_t size;
+                                la_int64_t offset;
+
+                                while ((r = readDataBlock(a, &buff, &size, &offset)) == ARCHIVE_OK) {
+                                    writeDataBlock(ext, buff, size, offset);
+                                    result.total_size += size;
+                                }
                             }
+                            
+                            finishEntry(ext);
+                            result.files_extracted++;
                         }
-                        
-                        archive_write_finish_entry(ext);
-                        result.files_extracted++;
+
+                        if (pass.matches && pass_matches < *pass.matches && !m_cancelled) {
+                            throw CorruptedArchiveException(fmt::format("{} indexed entries not found", *pass.matches - pass_matches));
+                        }
+
+                    } catch (const std::exception& e) {
+                        result.success = false;
+                        result.error_message = fmt::format("Partial TAR extraction failed: {}", e.what());
+                        spdlog::error("Partial TAR extraction error: {}", e.what());
                     }
 
-                    result.success = true;
-                    spdlog::info("Partially extracted {} files from TAR archive", result.files_extracted);
+                    countArchiveBytesRead(a, input);
+                    archive_read_close(a);
+                    archive_read_free(a);
+                    if (!result.success) {
+                        break;
+                    }
+                }
+                progress.finish();
 
-                } catch (const std::exception& e) {
-                    result.error_message = fmt::format("Partial TAR extraction failed: {}", e.what());
-                    spdlog::error("Partial TAR extraction error: {}", e.what());
+                if (result.success) {
+                    spdlog::info("Partially extracted {} files from TAR archive in {} pass(es)",
+                                 result.files_extracted, passes.size());
                 }
 
-                archive_read_close(a);
-                archive_read_free(a);
                 archive_write_close(ext);
                 archive_write_free(ext);
                 
@@ -249,16 +386,23 @@ namespace Flux {
                 const std::filesystem::path& archive_path,
                 std::string_view password = "") override {
                 
+                if (auto index = readArchiveIndex(archive_path)) {
+                    spdlog::debug("Listed {} entries from the index of {}", index->entries.size(), archive_path.string());
+                    return index->toArchiveEntries();
+                }
+
                 std::vector<ArchiveEntry> entries;
                 
                 struct archive* a = archive_read_new();
                 archive_read_support_format_all(a);
                 archive_read_support_filter_all(a);
                 
-                int r = archive_read_open_filename(a, archive_path.string().c_str(), 10240);
+                ReadInput input;
+                int r = openArchive(a, archive_path, Utils::resolveThreadCount(0), input);
                 if (r != ARCHIVE_OK) {
+                    std::string error = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
                     archive_read_free(a);
-                    return Flux::unexpected<std::string>(fmt::format("Cannot open TAR archive: {}", archive_error_string(a)));
+                    return Flux::unexpected<std::string>(std::move(error));
                 }
 
                 try {
@@ -317,15 +461,23 @@ namespace Flux {
                 } else {
                     return Flux::unexpected<std::string>("Cannot detect TAR format");
                 }
+
+                if (auto index = readArchiveIndex(archive_path)) {
+                    info.file_count = index->entries.size();
+                    info.uncompressed_size = static_cast<size_t>(index->uncompressedSize());
+                    return info;
+                }
                 
                 struct archive* a = archive_read_new();
                 archive_read_support_format_all(a);
                 archive_read_support_filter_all(a);
                 
-                int r = archive_read_open_filename(a, archive_path.string().c_str(), 10240);
+                ReadInput input;
+                int r = openArchive(a, archive_path, Utils::resolveThreadCount(0), input);
                 if (r != ARCHIVE_OK) {
+                    std::string error = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
                     archive_read_free(a);
-                    return Flux::unexpected<std::string>(fmt::format("Cannot open TAR archive: {}", archive_error_string(a)));
+                    return Flux::unexpected<std::string>(std::move(error));
                 }
 
                 try {
@@ -358,10 +510,12 @@ namespace Flux {
                 archive_read_support_format_all(a);
                 archive_read_support_filter_all(a);
                 
-                int r = archive_read_open_filename(a, archive_path.string().c_str(), 10240);
+                ReadInput input;
+                int r = openArchive(a, archive_path, Utils::resolveThreadCount(0), input);
                 if (r != ARCHIVE_OK) {
+                    std::string error = fmt::format("Cannot open TAR archive: {}", archive_error_string(a));
                     archive_read_free(a);
-                    return Flux::unexpected<std::string>(fmt::format("Cannot open TAR archive: {}", archive_error_string(a)));
+                    return Flux::unexpected<std::string>(std::move(error));
                 }
 
                 try {
@@ -416,6 +570,338 @@ namespace Flux {
                 m_cancelled = true;
             }
 
+        private:
+            /**
+             * One sequential read over (part of) the archive
+             */
+            struct ReadPass {
+                std::optional<SeekPoint> start;   // Frame to start decoding at; nullopt reads the whole archive
+                uint64_t skip = 0;                // Decoded bytes between the frame start and the first entry
+                std::optional<size_t> matches;    // Matching entries in this pass, when known from an index
+            };
+
+            /**
+             * Plan the reads needed to reach the entries matching the patterns
+             *
+             * Without an index this is one pass over everything. With seek points,
+             * each pass starts at the frame holding a matching entry and keeps
+             * going through following matches unless more than a frame's worth of
+             * data separates them.
+             */
+            static std::vector<ReadPass> planReadPasses(const ArchiveIndex* index,
+                                                        const Utils::PathMatcher& selected,
+                                                        const Utils::PathFilter& filter) {
+                if (!index) {
+                    return {ReadPass{}};
+                }
+
+                std::vector<size_t> matched;
+                for (size_t i = 0; i < index->entries.size(); ++i) {
+                    const std::string& path = index->entries[i].path;
+                    if (selected.matches(path) && filter.accepts(path) && path != INCREMENTAL_MANIFEST_NAME) {
+                        matched.push_back(i);
+                    }
+                }
+                if (matched.empty()) {
+                    return {};
+                }
+
+                const auto& points = index->seek_points;
+                if (points.empty() || points.front().uncompressed_offset != 0) {
+                    return {ReadPass{std::nullopt, 0, matched.size()}};
+                }
+
+                std::vector<ReadPass> passes;
+                for (size_t k = 0; k < matched.size(); ++k) {
+                    const uint64_t offset = index->entries[matched[k]].offset;
+                    if (k > 0) {
+                        // The previous match ends where the entry after it starts
+                        const uint64_t previous_end = index->entries[matched[k - 1] + 1].offset;
+                        if (offset - previous_end < Constants::Performance::SEEKABLE_FRAME_SIZE) {
+                            ++*passes.back().matches;
+                            continue;
+                        }
+                    }
+                    const auto next = std::ranges::upper_bound(points, offset, {}, &SeekPoint::uncompressed_offset);
+                    const SeekPoint& point = *std::prev(next);
+                    passes.push_back({point, offset - point.uncompressed_offset, 1});
+                }
+                return passes;
+            }
+
+            /**
+             * Batched output for small files, with errors collected for the calling thread
+             *
+             * Queued files land in no particular order, so the paths still in
+             * flight are tracked; an entry for one of them must drain the
+             * writer before it touches the path.
+             */
+            struct AsyncOutput {
+                std::mutex mutex;                            // Guards errors and pending
+                std::vector<std::string> errors;
+                std::unordered_set<std::string> pending;     // Paths queued but not yet written, as pathKey()
+                std::unordered_set<std::string> symlinks;    // Symlinks this extraction created, as pathKey()
+                std::atomic<size_t> files_written{0};
+                std::atomic<size_t> bytes_written{0};
+                std::filesystem::path last_parent;
+                std::unique_ptr<IO::AsyncFileWriter> writer;
+
+                AsyncOutput() {
+                    writer = IO::createAsyncFileWriter([this](const IO::FileWriteRequest& request, std::string_view error) {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        pending.erase(pathKey(request.path));
+                        if (!error.empty()) {
+                            errors.emplace_back(error);
+                            return;
+                        }
+                        files_written++;
+                        bytes_written += request.data.size();
+                    });
+                }
+
+                /**
+                 * Whether a queued file for this path has not been written yet
+                 */
+                bool inFlight(const std::filesystem::path& path) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    return !pending.empty() && pending.contains(pathKey(path));
+                }
+
+                /**
+                 * A symlink is about to be created at path; a later file there replaces it
+                 */
+                void noteSymlink(const std::filesystem::path& path) {
+                    symlinks.insert(pathKey(path));
+                }
+
+                /**
+                 * Same string for every spelling of a path ("a/./b", "a/b/")
+                 */
+                static std::string pathKey(const std::filesystem::path& path) {
+                    std::string key = path.lexically_normal().string();
+                    while (key.size() > 1 &&
+                           (key.back() == '/' || key.back() == static_cast<char>(std::filesystem::path::preferred_separator))) {
+                        key.pop_back();
+                    }
+                    return key;
+                }
+
+                /**
+                 * Read the entry's data and queue it; a read failure is logged and the entry dropped
+                 */
+                void queue(struct archive* a, struct archive_entry* entry, std::filesystem::path path) {
+                    IO::FileWriteRequest request;
+                    request.data.resize(static_cast<size_t>(archive_entry_size(entry)));
+                    size_t filled = 0;
+                    {
+                        Utils::PhaseTimer timer(Utils::Phase::Codec);
+                        while (filled < request.data.size()) {
+                            const la_ssize_t bytes_read = archive_read_data(a, request.data.data() + filled,
+                                                                            request.data.size() - filled);
+                            if (bytes_read <= 0) {
+                                spdlog::warn("Cannot read {}: {}", path.string(), archive_error_string(a));
+                                return;
+                            }
+                            filled += static_cast<size_t>(bytes_read);
+                        }
+                    }
+
+                    if (path.parent_path() != last_parent) {
+                        last_parent = path.parent_path();
+                        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                        Utils::countSyscalls();
+                        std::error_code ec;
+                        std::filesystem::create_directories(last_parent, ec);
+                    }
+
+                    // The writer opens with O_TRUNC and would write through the link to its target
+                    if (!symlinks.empty() && symlinks.erase(pathKey(path)) > 0) {
+                        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                        Utils::countSyscalls();
+                        std::error_code ec;
+                        std::filesystem::remove(path, ec);
+                    }
+
+                    request.path = std::move(path);
+                    request.permissions = static_cast<uint32_t>(archive_entry_perm(entry)) & IO::RESTORABLE_MODE_BITS;
+                    if (archive_entry_mtime_is_set(entry)) {
+                        request.mtime = std::chrono::system_clock::from_time_t(archive_entry_mtime(entry)) +
+                                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                                            std::chrono::nanoseconds(archive_entry_mtime_nsec(entry)));
+                    }
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        pending.insert(pathKey(request.path));
+                    }
+                    writer->submit(std::move(request));
+                }
+
+                void reportErrors(const ErrorCallback& on_error) {
+                    std::vector<std::string> pending;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        pending.swap(errors);
+                    }
+                    for (const auto& error : pending) {
+                        spdlog::warn("{}", error);
+                        if (on_error) {
+                            on_error(error, false);
+                        }
+                    }
+                }
+            };
+
+            /**
+             * The tree state of an incremental archive, which is not a file to restore
+             */
+            static bool isManifestMember(struct archive_entry* entry) {
+                return archive_entry_pathname(entry) == INCREMENTAL_MANIFEST_NAME;
+            }
+
+            /**
+             * Whether an entry needs nothing but content, mode and mtime restored,
+             * so it can bypass archive_write_disk
+             */
+            static bool isSimpleFile(struct archive_entry* entry, bool restores_owner) {
+                unsigned long fflags_set = 0;
+                unsigned long fflags_clear = 0;
+                archive_entry_fflags(entry, &fflags_set, &fflags_clear);
+                return !restores_owner &&
+                       archive_entry_filetype(entry) == AE_IFREG &&
+                       archive_entry_hardlink(entry) == nullptr &&
+                       archive_entry_size_is_set(entry) &&
+                       archive_entry_size(entry) < static_cast<la_int64_t>(Constants::SMALL_FILE_THRESHOLD) &&
+                       archive_entry_sparse_count(entry) == 0 &&
+                       archive_entry_xattr_count(entry) == 0 &&
+                       archive_entry_acl_count(entry, ARCHIVE_ENTRY_ACL_TYPE_ACCESS | ARCHIVE_ENTRY_ACL_TYPE_DEFAULT |
+                                                      ARCHIVE_ENTRY_ACL_TYPE_NFS4) == 0 &&
+                       fflags_set == 0 && fflags_clear == 0;
+            }
+
+            /**
+             * Compressed bytes consumed so far, from our decoder or libarchive's raw reader
+             */
+            static size_t compressedBytesRead(struct archive* a, const IO::DecompressionSource* source) {
+                if (source) {
+                    return static_cast<size_t>(source->compressedBytesRead());
+                }
+                const la_int64_t bytes = archive_filter_bytes(a, -1);
+                return bytes > 0 ? static_cast<size_t>(bytes) : 0;
+            }
+
+            static la_ssize_t readCallback(struct archive* a, void* client_data, const void** buffer) {
+                auto* source = static_cast<IO::DecompressionSource*>(client_data);
+                try {
+                    const auto chunk = source->read();
+                    *buffer = chunk.data();
+                    return static_cast<la_ssize_t>(chunk.size());
+                } catch (const std::exception& e) {
+                    archive_set_error(a, EIO, "%s", e.what());
+                    return ARCHIVE_FATAL;
+                }
+            }
+
+            // Keeps whatever backs an open archive alive until archive_read_free
+            struct ReadInput {
+                std::unique_ptr<IO::DecompressionSource> source;
+                std::unique_ptr<IO::MappedFile> mapping;
+            };
+
+            /*
+             * libarchive calls of the extraction loops, charged to their OperationMetrics phase.
+             * Decoding by libarchive's own filters happens inside the read calls.
+             */
+
+            static int readHeader(struct archive* a, struct archive_entry** entry) {
+                Utils::PhaseTimer timer(Utils::Phase::HeaderParse);
+                return archive_read_next_header(a, entry);
+            }
+
+            static int readDataBlock(struct archive* a, const void** buff, size_t* size, la_int64_t* offset) {
+                Utils::PhaseTimer timer(Utils::Phase::Codec);
+                return archive_read_data_block(a, buff, size, offset);
+            }
+
+            static int writeHeader(struct archive* ext, struct archive_entry* entry) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                return archive_write_header(ext, entry);
+            }
+
+            static la_ssize_t writeDataBlock(struct archive* ext, const void* buff, size_t size, la_int64_t offset) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                Utils::countSyscalls();
+                return archive_write_data_block(ext, buff, size, offset);
+            }
+
+            static int finishEntry(struct archive* ext) {
+                Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+                return archive_write_finish_entry(ext);
+            }
+
+            /**
+             * Archive bytes libarchive read itself; our decoders count their own
+             */
+            static void countArchiveBytesRead(struct archive* a, const ReadInput& input) {
+                if (!input.source) {
+                    Utils::countBytesRead(compressedBytesRead(a, nullptr));
+                }
+            }
+
+            // Decoder dictionary of a TAR_ZSTD archive that embeds one, else null
+            static IO::SharedDDict embeddedDictionary(const std::filesystem::path& archive_path) {
+                const auto dictionary = IO::readEmbeddedDictionary(archive_path);
+                return dictionary ? IO::createDDict(*dictionary) : nullptr;
+            }
+
+            /**
+             * Open an archive for reading
+             *
+             * Multi-block XZ streams are decoded by flux-core's multi-threaded
+             * decoder and libarchive only parses the TAR stream, as are zstd
+             * streams compressed with an embedded dictionary, which libarchive
+             * cannot decode. Everything else goes through libarchive's own
+             * filters, reading from a memory mapping of the archive when one
+             * is available.
+             */
+            static int openArchive(struct archive* a,
+                                   const std::filesystem::path& archive_path,
+                                   unsigned threads,
+                                   ReadInput& input) {
+                try {
+                    if (auto dictionary = embeddedDictionary(archive_path)) {
+                        input.source = IO::createZstdFrameSource(archive_path, 0, 0, std::move(dictionary));
+                        return archive_read_open(a, input.source.get(), nullptr, &TarExtractorImpl::readCallback, nullptr);
+                    }
+                } catch (const std::exception& e) {
+                    archive_set_error(a, EIO, "%s", e.what());
+                    return ARCHIVE_FATAL;
+                }
+
+                try {
+                    input.source = IO::createParallelDecompressionSource(archive_path, threads);
+                } catch (const std::exception& e) {
+                    spdlog::warn("Parallel decoder unavailable, using libarchive: {}", e.what());
+                    input.source.reset();
+                }
+
+                if (input.source) {
+                    return archive_read_open(a, input.source.get(), nullptr, &TarExtractorImpl::readCallback, nullptr);
+                }
+
+                input.mapping = IO::mapFile(archive_path, IO::AccessPattern::Sequential);
+                if (input.mapping) {
+                    // Blocks point into the mapping; the block size only paces progress reporting
+                    return archive_read_open_memory2(a, input.mapping->data(), input.mapping->size(),
+                                                     Constants::LARGE_BUFFER_SIZE);
+                }
+                std::error_code ec;
+                const auto archive_size = std::filesystem::file_size(archive_path, ec);
+                return archive_read_open_filename(a, archive_path.string().c_str(),
+                                                  IO::chooseBufferSize(ec ? 0 : archive_size));
+            }
+
+        public:
+
             bool supportsFormat(ArchiveFormat format) const override {
                 return format == ArchiveFormat::TAR_GZ || 
                        format == ArchiveFormat::TAR_XZ || 
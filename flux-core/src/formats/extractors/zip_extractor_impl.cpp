@@ -1,11 +1,28 @@
 #include "flux-core/extractor.h"
 #include "flux-core/exceptions.h"
+#include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "io/async_file_writer.h"
+#include "io/buffered_io.h"
+#include "io/codec_pool.h"
+#include "io/mapped_file.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
 #include <zip.h>
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
 #include <fstream>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <future>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace Flux {
     namespace Formats {
@@ -14,7 +31,7 @@ namespace Flux {
          */
         class ZipExtractorImpl : public Extractor {
         private:
-            bool m_cancelled = false;
+            std::atomic<bool> m_cancelled{false};
 
         public:
             ExtractResult extract(
@@ -31,7 +48,8 @@ namespace Flux {
                 result.total_size = 0;
 
                 int error_code = 0;
-                zip_t* archive = zip_open(archive_path.string().c_str(), ZIP_RDONLY, &error_code);
+                const auto mapping = IO::mapFile(archive_path, IO::AccessPattern::Normal);
+                zip_t* archive = openArchive(archive_path, mapping.get(), error_code);
                 
                 if (!archive) {
                     zip_error_t error;
@@ -56,76 +74,58 @@ namespace Flux {
 
                     spdlog::info("Extracting {} entries from ZIP archive: {}", num_entries, archive_path.string());
 
-                    // Extract each entry
+                    // Read the central directory once; directories are created up front so
+                    // workers only ever create files
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
+                    std::vector<zip_uint64_t> files;
+                    files.reserve(static_cast<size_t>(num_entries));
                     for (zip_int64_t i = 0; i < num_entries && !m_cancelled; ++i) {
-                        if (on_progress) {
-                            float progress = static_cast<float>(i) / static_cast<float>(num_entries);
-                            on_progress(fmt::format("Extracting entry {}/{}", i + 1, num_entries), 
-                                      progress, i, num_entries);
-                        }
-
-                        // Get entry info
                         zip_stat_t stat;
-                        if (zip_stat_index(archive, i, 0, &stat) != 0) {
+                        if (statEntry(archive, static_cast<zip_uint64_t>(i), stat) != 0) {
                             spdlog::warn("Cannot get info for entry {}", i);
                             continue;
                         }
-
-                        std::filesystem::path entry_path = output_dir / stat.name;
-                        
-                        // Check if it's a directory
-                        if (stat.name[strlen(stat.name) - 1] == '/') {
-                            // Create directory
-                            std::filesystem::create_directories(entry_path);
-                            spdlog::debug("Created directory: {}", entry_path.string());
-                            continue;
-                        }
-
-                        // Create parent directories
-                        std::filesystem::create_directories(entry_path.parent_path());
-
-                        // Open file in archive
-                        zip_file_t* file = zip_fopen_index(archive, i, 0);
-                        if (!file) {
-                            spdlog::warn("Cannot open file in archive: {}", stat.name);
-                            continue;
-                        }
-
-                        // Create output file
-                        std::ofstream output_file(entry_path, std::ios::binary);
-                        if (!output_file.is_open()) {
-                            spdlog::warn("Cannot create output file: {}", entry_path.string());
-                            zip_fclose(file);
+                        if (!filter.accepts(stat.name)) {
+                            Utils::countSkippedEntry();
                             continue;
                         }
 
-                        // Extract file content
-                        const size_t buffer_size = 8192;
-                        char buffer[buffer_size];
-                        zip_int64_t bytes_read;
-                        
-                        while ((bytes_read = zip_fread(file, buffer, buffer_size)) > 0) {
-                            output_file.write(buffer, bytes_read);
-                            result.total_size += bytes_read;
+                        if (isDirectoryName(stat.name)) {
+                            std::filesystem::path entry_path = output_dir / stat.name;
+                            createDirectories(entry_path);
+                            spdlog::debug("Created directory: {}", entry_path.string());
+                        } else {
+                            files.push_back(static_cast<zip_uint64_t>(i));
                         }
+                    }
 
-                        output_file.close();
-                        zip_fclose(file);
+                    const unsigned threads = Utils::resolveThreadCount(options.num_threads);
+                    const size_t batches = (files.size() + ENTRIES_PER_BATCH - 1) / ENTRIES_PER_BATCH;
+                    const size_t workers = std::min<size_t>(threads, batches);
 
-                        // Set file modification time if available
-                        if (stat.valid & ZIP_STAT_MTIME) {
-                            std::filesystem::file_time_type ftime = 
-                                std::filesystem::file_time_type::clock::from_time_t(stat.mtime);
-                            std::filesystem::last_write_time(entry_path, ftime);
+                    ExtractProgress progress(files.size(), on_progress, on_error);
+                    if (workers > 1) {
+                        extractParallel(archive_path, mapping.get(), output_dir, files, workers, progress);
+                    } else {
+                        WorkerContext context = createWorkerContext(progress);
+                        for (zip_uint64_t index : files) {
+                            if (m_cancelled) {
+                                break;
+                            }
+                            extractFile(archive, index, output_dir, context, progress);
                         }
-
-                        result.files_extracted++;
-                        spdlog::debug("Extracted file: {} ({} bytes)", stat.name, stat.size);
+                        context.writer->drain();
                     }
+                    progress.channel.finish();
+
+                    result.files_extracted = progress.files_extracted;
+                    result.total_size = progress.total_size;
 
                     if (m_cancelled) {
                         result.error_message = "Extraction cancelled by user";
                         spdlog::info("ZIP extraction cancelled");
+                    } else if (!progress.first_error.empty()) {
+                        result.error_message = progress.first_error;
                     } else {
                         result.success = true;
                         spdlog::info("Successfully extracted {} files from ZIP archive", result.files_extracted);
@@ -156,7 +156,8 @@ namespace Flux {
                 result.success = false;
                 
                 int error_code = 0;
-                zip_t* archive = zip_open(archive_path.string().c_str(), ZIP_RDONLY, &error_code);
+                const auto mapping = IO::mapFile(archive_path, IO::AccessPattern::Normal);
+                zip_t* archive = openArchive(archive_path, mapping.get(), error_code);
                 
                 if (!archive) {
                     zip_error_t error;
@@ -170,62 +171,56 @@ namespace Flux {
                     std::filesystem::create_directories(output_dir);
                     
                     zip_int64_t num_entries = zip_get_num_entries(archive, 0);
-                    size_t matched_files = 0;
+                    const Utils::PathMatcher selected(file_patterns);
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
 
-                    for (zip_int64_t i = 0; i < num_entries && !m_cancelled; ++i) {
+                    // The central directory is in memory, so matching up front gives progress its real total
+                    std::vector<std::pair<zip_uint64_t, zip_stat_t>> matches;
+                    for (zip_int64_t i = 0; i < num_entries; ++i) {
                         zip_stat_t stat;
-                        if (zip_stat_index(archive, i, 0, &stat) != 0) {
+                        if (statEntry(archive, static_cast<zip_uint64_t>(i), stat) != 0) {
                             continue;
                         }
-
-                        // Check if file matches any pattern
-                        bool matches = false;
-                        for (const auto& pattern : file_patterns) {
-                            // Simple pattern matching (can be enhanced with regex)
-                            if (std::string(stat.name).find(pattern) != std::string::npos) {
-                                matches = true;
-                                break;
-                            }
-                        }
-
-                        if (!matches) {
+                        if (!selected.matches(stat.name) || !filter.accepts(stat.name)) {
+                            Utils::countSkippedEntry();
                             continue;
                         }
+                        matches.emplace_back(static_cast<zip_uint64_t>(i), stat);
+                    }
 
-                        matched_files++;
-                        
-                        if (on_progress) {
-                            on_progress(fmt::format("Extracting: {}", stat.name), 
-                                      static_cast<float>(matched_files) / file_patterns.size(), 
-                                      matched_files, file_patterns.size());
+                    Utils::ProgressChannel progress(on_progress, "Extracting", matches.size());
+                    for (const auto& [i, stat] : matches) {
+                        if (m_cancelled) {
+                            break;
                         }
 
+                        FLUX_TRACE_SPAN("zip.extract_entry", stat.name);
+                        progress.entry(stat.name);
+                        progress.advance();
+
                         // Extract the matching file (similar to full extraction)
                         std::filesystem::path entry_path = output_dir / stat.name;
-                        std::filesystem::create_directories(entry_path.parent_path());
+                        createDirectories(entry_path.parent_path());
 
                         zip_file_t* file = zip_fopen_index(archive, i, 0);
                         if (!file) continue;
+                        countCompressedBytes(stat);
 
-                        std::ofstream output_file(entry_path, std::ios::binary);
-                        if (!output_file.is_open()) {
-                            zip_fclose(file);
-                            continue;
+                        zip_int64_t bytes_written = -1;
+                        try {
+                            bytes_written = copyEntry(file, entry_path, stat.size);
+                        } catch (const std::exception& e) {
+                            spdlog::warn("Cannot write output file {}: {}", entry_path.string(), e.what());
                         }
-
-                        const size_t buffer_size = 8192;
-                        char buffer[buffer_size];
-                        zip_int64_t bytes_read;
-                        
-                        while ((bytes_read = zip_fread(file, buffer, buffer_size)) > 0) {
-                            output_file.write(buffer, bytes_read);
-                            result.total_size += bytes_read;
+                        zip_fclose(file);
+                        if (bytes_written < 0) {
+                            continue;
                         }
 
-                        output_file.close();
-                        zip_fclose(file);
+                        result.total_size += static_cast<size_t>(bytes_written);
                         result.files_extracted++;
                     }
+                    progress.finish();
 
                     result.success = true;
                     spdlog::info("Partially extracted {} files from ZIP archive", result.files_extracted);
@@ -274,10 +269,6 @@ namespace Flux {
                         if (stat.valid & ZIP_STAT_MTIME) {
                             entry.modification_time = std::to_string(stat.mtime);
                         }
-                        
-                        if (stat.valid & ZIP_STAT_CRC) {
-                            entry.crc32 = stat.crc;
-                        }
 
                         entries.push_back(entry);
                     }
@@ -351,7 +342,8 @@ namespace Flux {
                 std::string_view password = "") override {
                 
                 int error_code = 0;
-                zip_t* archive = zip_open(archive_path.string().c_str(), ZIP_RDONLY, &error_code);
+                const auto mapping = IO::mapFile(archive_path, IO::AccessPattern::Normal);
+                zip_t* archive = openArchive(archive_path, mapping.get(), error_code);
                 
                 if (!archive) {
                     zip_error_t error;
@@ -382,12 +374,12 @@ namespace Flux {
                         }
 
                         // Try to read the entire file to verify integrity
-                        const size_t buffer_size = 8192;
-                        char buffer[buffer_size];
+                        const size_t buffer_size = IO::chooseBufferSize(stat.size);
+                        const IO::PooledBuffer buffer = IO::acquireBuffer(buffer_size);
                         zip_int64_t total_read = 0;
                         zip_int64_t bytes_read;
                         
-                        while ((bytes_read = zip_fread(file, buffer, buffer_size)) > 0) {
+                        while ((bytes_read = zip_fread(file, buffer->data(), buffer_size)) > 0) {
                             total_read += bytes_read;
                         }
 
@@ -422,6 +414,287 @@ namespace Flux {
             bool supportsFormat(ArchiveFormat format) const override {
                 return format == ArchiveFormat::ZIP;
             }
+
+        private:
+            // Number of consecutive entries a worker claims at a time
+            static constexpr size_t ENTRIES_PER_BATCH = 64;
+
+            // Shared extraction state; counters are updated by all workers
+            struct ExtractProgress {
+                ExtractProgress(size_t files, const ProgressCallback& progress_cb, const ErrorCallback& error_cb)
+                    : channel(progress_cb, "Extracting", files), on_error(error_cb) {}
+
+                Utils::ProgressChannel channel;
+                const ErrorCallback& on_error;
+                std::atomic<size_t> files_extracted{0};
+                std::atomic<size_t> total_size{0};
+                std::mutex callback_mutex;       // Serializes error callbacks and first_error
+                std::string first_error;         // First worker-level failure
+            };
+
+            /**
+             * Open an archive read-only, directly from its memory mapping when available
+             */
+            static zip_t* openArchive(const std::filesystem::path& archive_path,
+                                      const IO::MappedFile* mapping,
+                                      int& error_code) {
+                // Opening reads the whole central directory
+                Utils::PhaseTimer timer(Utils::Phase::HeaderParse);
+                if (mapping) {
+                    zip_error_t error;
+                    zip_error_init(&error);
+                    zip_source_t* source = zip_source_buffer_create(mapping->data(), mapping->size(), 0, &error);
+                    if (source) {
+                        zip_t* archive = zip_open_from_source(source, ZIP_RDONLY, &error);
+                        if (archive) {
+                            zip_error_fini(&error);
+                            return archive;
+                        }
+                        zip_source_free(source);
+                    }
+                    spdlog::debug("Cannot open mapped ZIP archive, reading from file: {}", zip_error_strerror(&error));
+                    zip_error_fini(&error);
+                }
+                return zip_open(archive_path.string().c_str(), ZIP_RDONLY, &error_code);
+            }
+
+            // Per-thread extraction state
+            struct WorkerContext {
+                std::unique_ptr<IO::AsyncFileWriter> writer;    // Batched writer for small files
+                std::filesystem::path last_parent;              // Last directory ensured to exist
+            };
+
+            static WorkerContext createWorkerContext(ExtractProgress& progress) {
+                WorkerContext context;
+                context.writer = IO::createAsyncFileWriter(
+                    [&progress](const IO::FileWriteRequest& request, std::string_view error) {
+                        if (!error.empty()) {
+                            spdlog::warn("{}", error);
+                            reportError(progress, std::string(error));
+                            return;
+                        }
+                        progress.files_extracted++;
+                        progress.total_size += request.data.size();
+                    });
+                return context;
+            }
+
+            static bool isDirectoryName(const char* name) {
+                const size_t length = std::strlen(name);
+                return length > 0 && name[length - 1] == '/';
+            }
+
+            /**
+             * Extract entries on several threads
+             *
+             * zip_t is not thread-safe, so every worker opens its own handle over the
+             * shared read-only mapping. Workers claim contiguous batches of central
+             * directory indices, which writers lay out in local header order, so
+             * each handle reads the file mostly front to back.
+             */
+            void extractParallel(const std::filesystem::path& archive_path,
+                                 const IO::MappedFile* mapping,
+                                 const std::filesystem::path& output_dir,
+                                 const std::vector<zip_uint64_t>& files,
+                                 size_t workers,
+                                 ExtractProgress& progress) {
+                spdlog::info("Extracting {} files on {} threads", files.size(), workers);
+
+                std::atomic<size_t> next_batch{0};
+                auto worker = [&, metrics = Utils::currentMetrics()]() {
+                    Utils::MetricsScope scope(metrics);
+                    int error_code = 0;
+                    zip_t* archive = openArchive(archive_path, mapping, error_code);
+                    if (!archive) {
+                        zip_error_t error;
+                        zip_error_init_with_code(&error, error_code);
+                        std::lock_guard<std::mutex> lock(progress.callback_mutex);
+                        if (progress.first_error.empty()) {
+                            progress.first_error = fmt::format("Cannot open ZIP archive: {}", zip_error_strerror(&error));
+                        }
+                        zip_error_fini(&error);
+                        return;
+                    }
+
+                    WorkerContext context = createWorkerContext(progress);
+                    for (size_t batch = next_batch++; !m_cancelled; batch = next_batch++) {
+                        const size_t begin = batch * ENTRIES_PER_BATCH;
+                        if (begin >= files.size()) {
+                            break;
+                        }
+                        const size_t end = std::min(begin + ENTRIES_PER_BATCH, files.size());
+                        for (size_t i = begin; i < end && !m_cancelled; ++i) {
+                            extractFile(archive, files[i], output_dir, context, progress);
+                        }
+                    }
+
+                    context.writer->drain();
+                    zip_discard(archive);
+                };
+
+                std::vector<std::future<void>> tasks;
+                tasks.reserve(workers);
+                for (size_t i = 0; i < workers; ++i) {
+                    tasks.emplace_back(std::async(std::launch::async, worker));
+                }
+                for (auto& task : tasks) {
+                    task.get();
+                }
+            }
+
+            /**
+             * Extract one file entry; failures are reported and skipped
+             */
+            void extractFile(zip_t* archive,
+                             zip_uint64_t index,
+                             const std::filesystem::path& output_dir,
+                             WorkerContext& context,
+                             ExtractProgress& progress) {
+                zip_stat_t stat;
+                if (statEntry(archive, index, stat) != 0) {
+                    spdlog::warn("Cannot get info for entry {}", index);
+                    return;
+                }
+
+                FLUX_TRACE_SPAN("zip.extract_entry", stat.name);
+                progress.channel.entry(stat.name);
+                progress.channel.advance();
+
+                std::filesystem::path entry_path = output_dir / stat.name;
+                std::error_code ec;
+                // Entries of one directory are usually adjacent; skip the repeated stat
+                if (entry_path.parent_path() != context.last_parent) {
+                    context.last_parent = entry_path.parent_path();
+                    createDirectories(context.last_parent, ec);
+                }
+
+                // Open file in archive
+                zip_file_t* file = zip_fopen_index(archive, index, 0);
+                if (!file) {
+                    spdlog::warn("Cannot open file in archive: {}", stat.name);
+                    reportError(progress, fmt::format("Cannot open file in archive: {}", stat.name));
+                    return;
+                }
+                countCompressedBytes(stat);
+
+                // Small files are decoded in memory and handed to the batched writer
+                if (stat.size < Constants::SMALL_FILE_THRESHOLD) {
+                    IO::FileWriteRequest request;
+                    request.path = std::move(entry_path);
+                    request.data.resize(static_cast<size_t>(stat.size));
+                    const bool complete = readEntry(file, request.data);
+                    zip_fclose(file);
+                    if (!complete) {
+                        reportError(progress, fmt::format("Cannot read file in archive: {}", stat.name));
+                        return;
+                    }
+                    if (stat.valid & ZIP_STAT_MTIME) {
+                        request.mtime = std::chrono::system_clock::from_time_t(stat.mtime);
+                    }
+                    context.writer->submit(std::move(request));
+                    return;
+                }
+
+                // Extract file content
+                zip_int64_t bytes_written = -1;
+                try {
+                    bytes_written = copyEntry(file, entry_path, stat.size);
+                } catch (const std::exception& e) {
+                    spdlog::warn("Cannot write output file {}: {}", entry_path.string(), e.what());
+                    reportError(progress, fmt::format("Cannot write output file {}: {}", entry_path.string(), e.what()));
+                    zip_fclose(file);
+                    return;
+                }
+                zip_fclose(file);
+
+                if (bytes_written < 0) {
+                    reportError(progress, fmt::format("Cannot read file in archive: {}", stat.name));
+                    return;
+                }
+
+                // Set file modification time if available
+                if (stat.valid & ZIP_STAT_MTIME) {
+                    Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+                    Utils::countSyscalls();
+                    auto ftime = std::filesystem::file_time_type::clock::from_sys(
+                        std::chrono::system_clock::from_time_t(stat.mtime));
+                    std::filesystem::last_write_time(entry_path, ftime, ec);
+                }
+
+                progress.files_extracted++;
+                progress.total_size += static_cast<size_t>(bytes_written);
+                spdlog::debug("Extracted file: {} ({} bytes)", stat.name, stat.size);
+            }
+
+            /**
+             * Decompress a whole entry into memory
+             * @return true if exactly data.size() bytes were read
+             */
+            static bool readEntry(zip_file_t* file, std::vector<std::byte>& data) {
+                Utils::PhaseTimer timer(Utils::Phase::Codec);
+                size_t filled = 0;
+                while (filled < data.size()) {
+                    const zip_int64_t bytes_read = zip_fread(file, data.data() + filled, data.size() - filled);
+                    if (bytes_read <= 0) {
+                        return false;
+                    }
+                    filled += static_cast<size_t>(bytes_read);
+                }
+                return true;
+            }
+
+            /**
+             * Decompress an open entry straight into the output file's write buffer
+             * @return Bytes written, or -1 if the entry data cannot be read
+             */
+            static zip_int64_t copyEntry(zip_file_t* file, const std::filesystem::path& entry_path, zip_uint64_t size) {
+                IO::BufferedWriter output(entry_path, size);
+                zip_int64_t bytes_read;
+                for (;;) {
+                    auto space = output.prepare();
+                    {
+                        Utils::PhaseTimer timer(Utils::Phase::Codec);
+                        bytes_read = zip_fread(file, space.data(), space.size());
+                    }
+                    if (bytes_read <= 0) {
+                        break;
+                    }
+                    output.commit(static_cast<size_t>(bytes_read));
+                }
+                output.close();
+                return bytes_read < 0 ? -1 : static_cast<zip_int64_t>(output.bytesWritten());
+            }
+
+            static int statEntry(zip_t* archive, zip_uint64_t index, zip_stat_t& stat) {
+                Utils::PhaseTimer timer(Utils::Phase::HeaderParse);
+                return zip_stat_index(archive, index, 0, &stat);
+            }
+
+            static void createDirectories(const std::filesystem::path& path) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                Utils::countSyscalls();
+                std::filesystem::create_directories(path);
+            }
+
+            static void createDirectories(const std::filesystem::path& path, std::error_code& ec) {
+                Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                Utils::countSyscalls();
+                std::filesystem::create_directories(path, ec);
+            }
+
+            // Entry data is read from the archive compressed
+            static void countCompressedBytes(const zip_stat_t& stat) {
+                if (stat.valid & ZIP_STAT_COMP_SIZE) {
+                    Utils::countBytesRead(stat.comp_size);
+                }
+            }
+
+            static void reportError(ExtractProgress& progress, const std::string& message) {
+                if (progress.on_error) {
+                    std::lock_guard<std::mutex> lock(progress.callback_mutex);
+                    progress.on_error(message, false);
+                }
+            }
         };
 
         // Factory function to create ZIP extractor
@@ -0,0 +1,419 @@
+#include "flux-core/packer.h"
+#include "flux-core/exceptions.h"
+#include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "formats/dedup/chunker.h"
+#include "formats/dedup/dedup_archive.h"
+#include "io/codec_pool.h"
+#include "io/file_scanner.h"
+#include "io/zstd_dictionary.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
+#include <zstd.h>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace Flux {
+    namespace Formats {
+        /**
+         * Deduplicating chunk archive packer (FLUX_DEDUP)
+         *
+         * File content is cut into content-defined chunks, each identified by
+         * its SHA-256. Every unique chunk is zstd-compressed once, either into
+         * the archive or into a chunk store shared between archives, and files
+         * are recorded as lists of chunks. Workers take files from a shared
+         * index; only the chunk table is behind a lock, and compression of a
+         * new chunk happens after its slot is claimed, outside the lock.
+         */
+        class DedupPackerImpl : public Packer {
+        private:
+            std::atomic<bool> m_cancelled{false};
+
+            struct HashKey {
+                size_t operator()(const Dedup::ChunkHash& hash) const noexcept {
+                    size_t value;
+                    std::memcpy(&value, hash.data(), sizeof(value));
+                    return value;
+                }
+            };
+
+            // State shared by all workers
+            struct PackState {
+                PackState(const Dedup::ChunkParams& chunk_params,
+                          int zstd_level,
+                          Dedup::ArchiveWriter& archive_writer,
+                          const std::optional<Dedup::ChunkStore>& chunk_store,
+                          uint64_t bytes,
+                          const ProgressCallback& progress_cb,
+                          const ErrorCallback& error_cb)
+                    : params(chunk_params), level(zstd_level), writer(archive_writer), store(chunk_store),
+                      progress(progress_cb, "Packing", bytes), on_error(error_cb) {}
+
+                const Dedup::ChunkParams& params;
+                const int level;
+                Dedup::ArchiveWriter& writer;
+                const std::optional<Dedup::ChunkStore>& store;
+                Utils::ProgressChannel progress;  // Counts bytes chunked
+                const ErrorCallback& on_error;
+
+                std::mutex chunk_mutex;          // Guards chunks and chunk_ids
+                std::vector<Dedup::ChunkRecord> chunks;
+                std::unordered_map<Dedup::ChunkHash, uint32_t, HashKey> chunk_ids;
+
+                std::atomic<uint64_t> unique_bytes{0};
+                std::mutex callback_mutex;       // Serializes error callbacks and first_error
+                std::string first_error;         // Chunk write failure that ended the pack
+                std::atomic<bool> aborted{false};
+            };
+
+            // Per-thread state, reused across files
+            struct Worker {
+                IO::PooledZstdCCtx cctx = IO::acquireZstdCCtx();
+                std::vector<std::byte> window;   // File data not yet cut into chunks
+                std::vector<std::byte> frame;    // Compressed chunk
+            };
+
+        public:
+            PackResult pack(
+                std::span<const std::filesystem::path> inputs,
+                const std::filesystem::path& output,
+                const PackOptions& options,
+                const ProgressCallback& on_progress = nullptr,
+                const ErrorCallback& on_error = nullptr) override {
+
+                auto start_time = std::chrono::high_resolution_clock::now();
+                PackResult result;
+                result.success = false;
+                result.files_processed = 0;
+                result.total_compressed_size = 0;
+                result.total_uncompressed_size = 0;
+                result.compression_ratio = 0.0;
+
+                try {
+                    // Validate inputs
+                    auto validation_result = validateInputs(inputs);
+                    if (!validation_result.has_value()) {
+                        result.error_message = validation_result.error();
+                        return result;
+                    }
+                    if (!options.password.empty()) {
+                        result.error_message = "Dedup archive encryption is not supported";
+                        return result;
+                    }
+
+                    // Create output directory if needed
+                    std::filesystem::create_directories(output.parent_path());
+
+                    const unsigned threads = Utils::resolveThreadCount(options.num_threads);
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
+                    const IO::FileManifest manifest = IO::scanInputs(inputs, filter, threads);
+
+                    Dedup::Catalog catalog;
+                    std::optional<Dedup::ChunkStore> store;
+                    if (!options.chunk_store.empty()) {
+                        std::filesystem::create_directories(options.chunk_store);
+                        catalog.chunk_store = std::filesystem::absolute(options.chunk_store).lexically_normal();
+                        store.emplace(catalog.chunk_store);
+                    }
+                    // Chunks in a store are shared between archives, so they must decode without one
+                    if (store && (options.train_dictionary || !options.zstd_dictionary.empty())) {
+                        spdlog::warn("Dictionaries are not used with a chunk store, ignoring");
+                    } else {
+                        catalog.dictionary = IO::prepareZstdDictionary(options, manifest);
+                    }
+                    IO::CDictPtr cdict(nullptr, &ZSTD_freeCDict);
+                    if (!catalog.dictionary.empty()) {
+                        cdict = IO::createCDict(catalog.dictionary, options.compression_level);
+                    }
+
+                    std::vector<const std::filesystem::path*> sources;   // Parallel to catalog.files
+                    std::vector<size_t> content_files;                   // Indices into catalog.files
+                    uint64_t total_bytes = 0;
+                    for (const auto& entry : manifest.entries) {
+                        auto record = makeRecord(entry, options);
+                        if (!record) {
+                            continue;
+                        }
+                        if (record->type == Dedup::EntryType::File) {
+                            content_files.push_back(catalog.files.size());
+                            total_bytes += entry.size;
+                        }
+                        catalog.files.push_back(std::move(*record));
+                        sources.push_back(&entry.source);
+                    }
+
+                    const auto params = Dedup::ChunkParams::forAverage(
+                        options.chunk_size > 0 ? options.chunk_size : Dedup::DEFAULT_AVERAGE_CHUNK_SIZE);
+                    const size_t workers = std::clamp<size_t>(content_files.size(), 1, threads);
+                    spdlog::info("Creating dedup archive: {} ({} entries, {} KiB average chunks, {} threads{})",
+                                 output.string(), catalog.files.size(), params.avg_size / 1024, workers,
+                                 store ? fmt::format(", chunk store {}", store->root().string()) : "");
+
+                    Dedup::ArchiveWriter writer(output);
+                    PackState state(params, options.compression_level, writer, store, total_bytes, on_progress, on_error);
+                    std::vector<uint8_t> failed(catalog.files.size(), 0);   // Written by workers; not vector<bool>
+
+                    std::atomic<size_t> next_file{0};
+                    auto worker = [&, metrics = Utils::currentMetrics()]() {
+                        Utils::MetricsScope scope(metrics);
+                        Worker context;
+                        if (cdict && ZSTD_isError(ZSTD_CCtx_refCDict(context.cctx.get(), cdict.get()))) {
+                            throw CompressionException("Cannot load zstd dictionary");
+                        }
+                        for (size_t i = next_file++; i < content_files.size() && !m_cancelled && !state.aborted;
+                             i = next_file++) {
+                            const size_t index = content_files[i];
+                            try {
+                                packFile(*sources[index], catalog.files[index], context, state);
+                            } catch (const std::exception& e) {
+                                if (state.aborted) {
+                                    break;
+                                }
+                                const std::string message = fmt::format("Cannot pack {}: {}", sources[index]->string(), e.what());
+                                spdlog::warn("{}", message);
+                                failed[index] = 1;
+                                if (state.on_error) {
+                                    std::lock_guard<std::mutex> lock(state.callback_mutex);
+                                    state.on_error(message, false);
+                                }
+                            }
+                        }
+                    };
+
+                    if (workers <= 1) {
+                        worker();
+                    } else {
+                        std::vector<std::future<void>> tasks;
+                        tasks.reserve(workers);
+                        for (size_t i = 0; i < workers; ++i) {
+                            tasks.emplace_back(std::async(std::launch::async, worker));
+                        }
+                        for (auto& task : tasks) {
+                            task.get();
+                        }
+                    }
+                    state.progress.finish();
+
+                    if (state.aborted) {
+                        throw FluxException(state.first_error);
+                    }
+                    if (m_cancelled) {
+                        result.error_message = "Packing cancelled by user";
+                        spdlog::info("Dedup packing cancelled");
+                    } else {
+                        // Files that could not be read are left out rather than stored truncated
+                        size_t kept = 0;
+                        for (size_t i = 0; i < catalog.files.size(); ++i) {
+                            if (failed[i]) {
+                                continue;
+                            }
+                            if (catalog.files[i].type == Dedup::EntryType::File) {
+                                result.files_processed++;
+                                result.total_uncompressed_size += static_cast<size_t>(catalog.files[i].size);
+                            }
+                            if (kept != i) {
+                                catalog.files[kept] = std::move(catalog.files[i]);
+                            }
+                            kept++;
+                        }
+                        catalog.files.resize(kept);
+                        catalog.chunks = std::move(state.chunks);
+                        writer.finish(catalog, Dedup::CATALOG_LEVEL);
+
+                        result.success = true;
+                        result.total_compressed_size = static_cast<size_t>(writer.bytesWritten());
+                        if (result.total_uncompressed_size > 0) {
+                            result.compression_ratio = static_cast<double>(result.total_compressed_size) /
+                                                     static_cast<double>(result.total_uncompressed_size);
+                        }
+                        spdlog::info("Successfully packed {} files into dedup archive: {} unique chunks, {} of {} bytes unique",
+                                     result.files_processed, catalog.chunks.size(),
+                                     state.unique_bytes.load(), result.total_uncompressed_size);
+                    }
+
+                } catch (const std::exception& e) {
+                    result.error_message = fmt::format("Dedup packing failed: {}", e.what());
+                    spdlog::error("Dedup packing error: {}", e.what());
+                }
+
+                if (!result.success) {
+                    std::error_code ec;
+                    std::filesystem::remove(output, ec);
+                }
+
+                auto end_time = std::chrono::high_resolution_clock::now();
+                result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+                return result;
+            }
+
+            void cancel() override {
+                m_cancelled = true;
+                spdlog::info("Dedup packing cancellation requested");
+            }
+
+            bool supportsFormat(ArchiveFormat format) const override {
+                return format == ArchiveFormat::FLUX_DEDUP;
+            }
+
+        private:
+            /**
+             * Catalog record for a scanned entry, without chunks; nothing for
+             * entries that cannot be stored
+             */
+            static std::optional<Dedup::FileRecord> makeRecord(const IO::ManifestEntry& entry, const PackOptions& options) {
+                Dedup::FileRecord record;
+                record.path = entry.archive_path;
+                switch (entry.type) {
+                    case IO::EntryType::Directory:
+                        record.type = Dedup::EntryType::Directory;
+                        break;
+                    case IO::EntryType::File:
+                        record.type = Dedup::EntryType::File;
+                        record.size = entry.size;
+                        break;
+                    case IO::EntryType::Symlink: {
+                        std::error_code ec;
+                        const auto target = std::filesystem::read_symlink(entry.source, ec);
+                        if (ec) {
+                            spdlog::warn("Cannot read symlink {}: {}", entry.source.string(), ec.message());
+                            return std::nullopt;
+                        }
+                        record.type = Dedup::EntryType::Symlink;
+                        record.link_target = target.generic_string();
+                        break;
+                    }
+                    default:
+                        return std::nullopt;
+                }
+
+                const bool is_directory = record.type == Dedup::EntryType::Directory;
+                record.mode = options.preserve_permissions ? entry.mode : (is_directory ? 0755 : 0644);
+                record.mtime_ns = options.preserve_timestamps ? entry.mtime_ns : 0;
+                return record;
+            }
+
+            /**
+             * Chunk one file and add its new chunks
+             *
+             * The file is read into a window at least one maximum chunk ahead of
+             * the cut point, so every boundary search sees as much data as the
+             * chunker may need and boundaries do not depend on read sizes.
+             */
+            void packFile(const std::filesystem::path& source, Dedup::FileRecord& file,
+                          Worker& context, PackState& state) {
+                FLUX_TRACE_SPAN("dedup.pack_entry", file.path);
+                state.progress.entry(file.path);
+
+                std::ifstream input;
+                input.rdbuf()->pubsetbuf(nullptr, 0);
+                Utils::countSyscalls();
+                input.open(source, std::ios::binary);
+                if (!input.is_open()) {
+                    throw FluxException("cannot open file");
+                }
+
+                const size_t window_size = std::max(2 * state.params.max_size, Constants::LARGE_BUFFER_SIZE);
+                context.window.resize(window_size);
+                size_t begin = 0;
+                size_t end = 0;
+                bool at_eof = false;
+                uint64_t size = 0;
+                file.chunks.clear();
+
+                while (!m_cancelled && !state.aborted) {
+                    if (!at_eof && end - begin < state.params.max_size) {
+                        std::memmove(context.window.data(), context.window.data() + begin, end - begin);
+                        end -= begin;
+                        begin = 0;
+                        Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+                        Utils::countSyscalls();
+                        input.read(reinterpret_cast<char*>(context.window.data() + end),
+                                   static_cast<std::streamsize>(window_size - end));
+                        end += static_cast<size_t>(input.gcount());
+                        Utils::countBytesRead(static_cast<uint64_t>(input.gcount()));
+                        if (input.bad()) {
+                            throw FluxException("read error");
+                        }
+                        at_eof = input.eof();
+                    }
+                    if (begin == end) {
+                        break;
+                    }
+
+                    // Chunking and hashing count as codec work, like the compression of new chunks
+                    Utils::PhaseTimer timer(Utils::Phase::Codec);
+                    const auto available = std::span<const std::byte>(context.window).subspan(begin, end - begin);
+                    const size_t length = Dedup::findChunkBoundary(available, state.params);
+                    const auto chunk = available.first(length);
+                    file.chunks.push_back(addChunk(chunk, context, state));
+                    begin += length;
+                    size += length;
+                    state.progress.advance(length);
+                }
+                file.size = size;
+            }
+
+            /**
+             * Index of a chunk in the chunk table, adding and storing it if new
+             */
+            static uint32_t addChunk(std::span<const std::byte> chunk, Worker& context, PackState& state) {
+                const Dedup::ChunkHash hash = Utils::sha256(chunk);
+                uint32_t id;
+                {
+                    std::lock_guard<std::mutex> lock(state.chunk_mutex);
+                    const auto [it, inserted] = state.chunk_ids.try_emplace(hash, static_cast<uint32_t>(state.chunks.size()));
+                    if (!inserted) {
+                        return it->second;
+                    }
+                    id = it->second;
+                    state.chunks.push_back({hash, static_cast<uint32_t>(chunk.size()), 0, 0});
+                }
+                state.unique_bytes += chunk.size();
+
+                // Claimed: this thread is the only one writing the chunk. Other
+                // files may already refer to it, so failing here fails the archive.
+                try {
+                    if (state.store) {
+                        if (!state.store->contains(hash)) {
+                            Dedup::compressChunk(context.cctx.get(), chunk, state.level, context.frame);
+                            state.store->put(hash, context.frame);
+                        }
+                        return id;
+                    }
+                    Dedup::compressChunk(context.cctx.get(), chunk, state.level, context.frame);
+                    const uint64_t offset = state.writer.appendChunk(context.frame);
+                    std::lock_guard<std::mutex> lock(state.chunk_mutex);
+                    state.chunks[id].offset = offset;
+                    state.chunks[id].stored_size = static_cast<uint32_t>(context.frame.size());
+                    return id;
+                } catch (const std::exception& e) {
+                    std::lock_guard<std::mutex> lock(state.callback_mutex);
+                    if (!state.aborted) {
+                        state.first_error = e.what();
+                        state.aborted = true;
+                    }
+                    throw;
+                }
+            }
+        };
+
+        // Factory function to create the dedup packer
+        std::unique_ptr<Packer> createDedupPacker() {
+            return std::make_unique<DedupPackerImpl>();
+        }
+    }
+}
@@ -1,51 +1,47 @@
 #include "flux-core/packer.h"
+#include "flux-core/archive_index.h"
+#include "flux-core/incremental.h"
 #include "flux-core/exceptions.h"
 #include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "io/buffered_io.h"
+#include "io/compression_sink.h"
+#include "io/file_scanner.h"
+#include "io/zstd_dictionary.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
+#include <archive.h>
+#include <archive_entry.h>
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
 #include <fstream>
 #include <chrono>
 #include <filesystem>
-#include <cstring>
-#include <iomanip>
-#include <sstream>
+#include <cerrno>
 #include <algorithm>
+#include <optional>
+#include <unordered_map>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
 
 namespace Flux {
     namespace Formats {
         /**
-         * TAR format packer implementation with basic TAR structure
-         * Note: This is a basic implementation without compression libraries
-         * For production use, integrate with libarchive or similar
+         * TAR format packer implementation using libarchive for TAR framing
+         *
+         * Data flows directory walk -> libarchive (pax TAR framing) -> compression
+         * sink (gzip/xz/zstd) -> output file, so memory use stays bounded and no
+         * uncompressed intermediate file is ever written.
          */
         class TarPackerImpl : public Packer {
         private:
             bool m_cancelled = false;
             ArchiveFormat m_format = ArchiveFormat::TAR_GZ;
 
-            // TAR header structure (POSIX.1-1988 format)
-            struct TarHeader {
-                char name[100];      // File name
-                char mode[8];        // File mode (octal)
-                char uid[8];         // Owner user ID (octal)
-                char gid[8];         // Owner group ID (octal)
-                char size[12];       // File size (octal)
-                char mtime[12];      // Modification time (octal)
-                char checksum[8];    // Header checksum (octal)
-                char typeflag;       // File type
-                char linkname[100];  // Link name
-                char magic[6];       // Magic number "ustar"
-                char version[2];     // Version "00"
-                char uname[32];      // Owner user name
-                char gname[32];      // Owner group name
-                char devmajor[8];    // Device major number
-                char devminor[8];    // Device minor number
-                char prefix[155];    // Path prefix
-                char padding[12];    // Padding to 512 bytes
-            };
-
-            static_assert(sizeof(TarHeader) == 512, "TAR header must be exactly 512 bytes");
-
         public:
             explicit TarPackerImpl(ArchiveFormat format = ArchiveFormat::TAR_GZ) : m_format(format) {}
 
@@ -55,7 +51,7 @@ namespace Flux {
                 const PackOptions& options,
                 const ProgressCallback& on_progress = nullptr,
                 const ErrorCallback& on_error = nullptr) override {
-                
+
                 auto start_time = std::chrono::high_resolution_clock::now();
                 PackResult result;
                 result.success = false;
@@ -64,6 +60,22 @@ namespace Flux {
                 result.total_uncompressed_size = 0;
                 result.compression_ratio = 0.0;
 
+                // The packer serves all TAR variants; the requested format selects the filter
+                PackOptions effective_options = options;
+                if (!supportsFormat(effective_options.format)) {
+                    effective_options.format = m_format;
+                }
+                // Frames are only useful with an index saying which of them holds each member
+                if (effective_options.seekable && effective_options.format == ArchiveFormat::TAR_ZSTD &&
+                    effective_options.index_mode == IndexMode::NONE) {
+                    effective_options.index_mode = IndexMode::EMBEDDED;
+                }
+
+                struct archive* a = nullptr;
+                struct archive* disk = nullptr;
+                struct archive_entry* entry = nullptr;
+                std::unique_ptr<IO::CompressionSink> sink;
+
                 try {
                     // Validate inputs
                     auto validation_result = validateInputs(inputs);
@@ -75,102 +87,153 @@ namespace Flux {
                     // Create output directory if needed
                     std::filesystem::create_directories(output.parent_path());
 
-                    spdlog::info("Creating TAR archive: {} (format: {})", 
-                               output.string(), formatToString(m_format));
-
-                    // Collect all files to pack
-                    std::vector<std::filesystem::path> all_files;
-                    size_t total_files = 0;
-                    
-                    for (const auto& input : inputs) {
-                        if (std::filesystem::is_directory(input)) {
-                            for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
-                                if (entry.is_regular_file()) {
-                                    all_files.push_back(entry.path());
-                                    total_files++;
-                                }
-                            }
-                        } else if (std::filesystem::is_regular_file(input)) {
-                            all_files.push_back(input);
-                            total_files++;
+                    // An index left from a previous archive at this path would describe the wrong data
+                    std::error_code remove_ec;
+                    std::filesystem::remove(indexSidecarPath(output), remove_ec);
+
+                    spdlog::info("Creating TAR archive: {} (format: {})",
+                               output.string(), formatToString(effective_options.format));
+
+                    // Collect all entries to pack
+                    const Utils::PathFilter filter(effective_options.include_patterns, effective_options.exclude_patterns);
+                    IO::FileManifest manifest = IO::scanInputs(inputs, filter,
+                                                               Utils::resolveThreadCount(effective_options.num_threads));
+
+                    // Read before the output is created, which may replace the base
+                    std::optional<ArchiveIndex> tree_state;
+                    if (!effective_options.incremental_base.empty()) {
+                        auto base_state = readTreeState(effective_options.incremental_base);
+                        if (!base_state.has_value()) {
+                            throw FluxException(base_state.error());
                         }
+                        tree_state = selectChanges(manifest, *base_state, effective_options.format);
+                        spdlog::info("{} of {} entries changed since {}", manifest.entries.size(),
+                                     tree_state->entries.size(), effective_options.incremental_base.string());
                     }
+                    const auto& items = manifest.entries;
+                    const size_t total_files = items.size();
 
-                    spdlog::info("Found {} files to pack", total_files);
+                    spdlog::info("Found {} entries to pack", total_files);
 
-                    // Open output file
-                    std::ofstream tar_file(output, std::ios::binary);
-                    if (!tar_file.is_open()) {
-                        result.error_message = fmt::format("Cannot create TAR file: {}", output.string());
-                        return result;
+                    std::vector<std::byte> dictionary;
+                    if (effective_options.format == ArchiveFormat::TAR_ZSTD) {
+                        dictionary = IO::prepareZstdDictionary(effective_options, manifest);
+                    } else if (!effective_options.zstd_dictionary.empty() || effective_options.train_dictionary) {
+                        spdlog::warn("Dictionaries only apply to zstd, ignoring for {}",
+                                     formatToString(effective_options.format));
+                    }
+                    sink = IO::createCompressionSink(output, effective_options, dictionary);
+
+                    a = archive_write_new();
+                    archive_write_set_format_pax_restricted(a);
+                    archive_write_add_filter_none(a);
+                    // Compressed output: no need to pad the final record to a full block
+                    archive_write_set_bytes_in_last_block(a, 1);
+                    if (archive_write_open(a, sink.get(), nullptr, &TarPackerImpl::writeCallback, nullptr) != ARCHIVE_OK) {
+                        throw FluxException(fmt::format("Cannot open TAR writer: {}", archive_error_string(a)));
+                    }
+
+                    disk = archive_read_disk_new();
+                    archive_read_disk_set_symlink_physical(disk);
+                    archive_read_disk_set_standard_lookup(disk);
+                    entry = archive_entry_new();
+
+                    ArchiveIndex index;
+                    index.format = effective_options.format;
+
+                    if (tree_state) {
+                        const la_int64_t header_offset = archive_filter_bytes(a, 0);
+                        IndexEntry manifest_entry = writeManifestMember(a, entry, *tree_state);
+                        if (effective_options.index_mode != IndexMode::NONE) {
+                            manifest_entry.offset = static_cast<uint64_t>(header_offset);
+                            index.entries.push_back(std::move(manifest_entry));
+                        }
                     }
 
-                    // Pack each file
-                    size_t processed_files = 0;
-                    for (const auto& file_path : all_files) {
+                    // Pack each entry
+                    Utils::ProgressChannel progress(on_progress, "Packing", total_files);
+                    for (const auto& item : items) {
                         if (m_cancelled) {
                             break;
                         }
+                        FLUX_TRACE_SPAN("tar.pack_entry", item.archive_path);
 
-                        if (on_progress) {
-                            float progress = static_cast<float>(processed_files) / static_cast<float>(total_files);
-                            on_progress(fmt::format("Packing: {}", file_path.filename().string()), 
-                                      progress, processed_files, total_files);
-                        }
+                        progress.entry(item.archive_path);
 
                         try {
-                            if (!packFileToTar(tar_file, file_path, inputs)) {
-                                spdlog::warn("Failed to pack file: {}", file_path.string());
+                            // Bytes handed to the first filter: the entry's offset in the uncompressed stream
+                            const la_int64_t header_offset = archive_filter_bytes(a, 0);
+                            if (!packEntry(a, disk, entry, item, effective_options)) {
+                                // The manifest already records it as current, so later increments would skip it
+                                if (tree_state) {
+                                    throw FluxException(fmt::format("Failed to pack changed file: {}", item.source.string()));
+                                }
+                                spdlog::warn("Failed to pack file: {}", item.source.string());
                                 if (on_error) {
-                                    on_error(fmt::format("Failed to pack file: {}", file_path.string()), false);
+                                    on_error(fmt::format("Failed to pack file: {}", item.source.string()), false);
                                 }
                                 continue;
                             }
 
-                            result.files_processed++;
-                            result.total_uncompressed_size += std::filesystem::file_size(file_path);
-                            processed_files++;
+                            if (archive_entry_filetype(entry) == AE_IFREG) {
+                                result.files_processed++;
+                                result.total_uncompressed_size += static_cast<size_t>(archive_entry_size(entry));
+                            }
+                            if (effective_options.index_mode != IndexMode::NONE) {
+                                index.entries.push_back(makeIndexEntry(entry, item, header_offset));
+                            }
+                            progress.advance();
 
+                        } catch (const CompressionException&) {
+                            throw;
                         } catch (const std::exception& e) {
-                            spdlog::warn("Error packing file {}: {}", file_path.string(), e.what());
+                            if (tree_state) {
+                                throw;
+                            }
+                            spdlog::warn("Error packing file {}: {}", item.source.string(), e.what());
                             if (on_error) {
-                                on_error(fmt::format("Error packing file {}: {}", file_path.string(), e.what()), false);
+                                on_error(fmt::format("Error packing file {}: {}", item.source.string(), e.what()), false);
                             }
                         }
                     }
 
-                    // Write TAR end-of-archive marker (two 512-byte blocks of zeros)
-                    std::vector<char> zero_block(512, 0);
-                    tar_file.write(zero_block.data(), 512);
-                    tar_file.write(zero_block.data(), 512);
-
-                    tar_file.close();
+                    // Writes the end-of-archive marker and flushes the last block into the sink
+                    if (archive_write_close(a) != ARCHIVE_OK) {
+                        throw FluxException(fmt::format("Cannot finalize TAR archive: {}", archive_error_string(a)));
+                    }
+                    sink->finish();
+                    progress.finish();
 
                     if (m_cancelled) {
                         result.error_message = "Packing cancelled by user";
                         spdlog::info("TAR packing cancelled");
                     } else {
                         result.success = true;
-                        
-                        // Calculate compressed size and compression ratio
-                        result.total_compressed_size = std::filesystem::file_size(output);
+
+                        // The archive is usable without its index, so a failure here only warns
+                        index.seek_points = sink->seekPoints();
+                        auto index_result = writeArchiveIndex(output, index, effective_options.index_mode);
+                        if (!index_result.has_value()) {
+                            spdlog::warn("{}", index_result.error());
+                            if (on_error) {
+                                on_error(index_result.error(), false);
+                            }
+                        }
+
+                        // Calculate compressed size (including an embedded index) and compression ratio
+                        std::error_code size_ec;
+                        const auto output_size = std::filesystem::file_size(output, size_ec);
+                        result.total_compressed_size = static_cast<size_t>(size_ec ? sink->bytesOut() : output_size);
                         if (result.total_uncompressed_size > 0) {
-                            result.compression_ratio = static_cast<double>(result.total_compressed_size) / 
+                            result.compression_ratio = static_cast<double>(result.total_compressed_size) /
                                                      static_cast<double>(result.total_uncompressed_size);
                         }
 
                         spdlog::info("Successfully packed {} files into TAR archive", result.files_processed);
-                        spdlog::info("TAR compression ratio: {:.2f}% ({} -> {} bytes)", 
-                                   result.compression_ratio * 100.0, 
-                                   result.total_uncompressed_size, 
+                        spdlog::info("TAR compression ratio: {:.2f}% ({} -> {} bytes)",
+                                   result.compression_ratio * 100.0,
+                                   result.total_uncompressed_size,
                                    result.total_compressed_size);
-
-                        // Note: This creates uncompressed TAR files
-                        // For production, integrate compression libraries
-                        if (m_format != ArchiveFormat::TAR_GZ) {
-                            result.error_message = fmt::format("Compression format {} requires additional libraries (not yet integrated)", 
-                                                             formatToString(m_format));
-                        }
                     }
 
                 } catch (const std::exception& e) {
@@ -178,9 +241,26 @@ namespace Flux {
                     spdlog::error("TAR packing error: {}", e.what());
                 }
 
+                if (entry) {
+                    archive_entry_free(entry);
+                }
+                if (disk) {
+                    archive_read_free(disk);
+                }
+                if (a) {
+                    archive_write_free(a);
+                }
+                sink.reset();
+
+                // Do not leave a truncated archive behind
+                if (!result.success) {
+                    std::error_code ec;
+                    std::filesystem::remove(output, ec);
+                }
+
                 auto end_time = std::chrono::high_resolution_clock::now();
                 result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                
+
                 return result;
             }
 
@@ -190,124 +270,226 @@ namespace Flux {
             }
 
             bool supportsFormat(ArchiveFormat format) const override {
-                return format == ArchiveFormat::TAR_GZ || 
-                       format == ArchiveFormat::TAR_XZ || 
+                return format == ArchiveFormat::TAR_GZ ||
+                       format == ArchiveFormat::TAR_XZ ||
                        format == ArchiveFormat::TAR_ZSTD;
             }
 
         private:
-            bool packFileToTar(std::ofstream& tar_file, 
-                             const std::filesystem::path& file_path,
-                             std::span<const std::filesystem::path> inputs) {
+            static la_ssize_t writeCallback(struct archive* a, void* client_data,
+                                            const void* buffer, size_t length) {
+                auto* sink = static_cast<IO::CompressionSink*>(client_data);
                 try {
-                    // Determine archive path (relative to input root)
-                    std::string archive_path = file_path.filename().string();
-                    
-                    // Find the input root for this file
-                    for (const auto& input : inputs) {
-                        if (file_path.string().starts_with(input.string())) {
-                            auto relative_path = std::filesystem::relative(file_path, input.parent_path());
-                            archive_path = relative_path.string();
-                            // Convert Windows path separators to forward slashes
-                            std::replace(archive_path.begin(), archive_path.end(), '\\', '/');
-                            break;
-                        }
-                    }
+                    sink->write({static_cast<const std::byte*>(buffer), length});
+                    return static_cast<la_ssize_t>(length);
+                } catch (const std::exception& e) {
+                    archive_set_error(a, EIO, "%s", e.what());
+                    return -1;
+                }
+            }
 
-                    // Truncate path if too long for TAR header
-                    if (archive_path.length() >= 100) {
-                        archive_path = archive_path.substr(0, 99);
+            static IndexEntry makeIndexEntry(struct archive_entry* entry,
+                                             const IO::ManifestEntry& item,
+                                             la_int64_t header_offset) {
+                IndexEntry index_entry;
+                index_entry.path = item.archive_path;
+                index_entry.is_directory = archive_entry_filetype(entry) == AE_IFDIR;
+                // Matches the name the TAR writer stores and readers report
+                if (index_entry.is_directory && !index_entry.path.ends_with('/')) {
+                    index_entry.path += '/';
+                }
+                index_entry.size = static_cast<uint64_t>(archive_entry_size(entry));
+                index_entry.permissions = static_cast<uint32_t>(archive_entry_perm(entry));
+                index_entry.mtime = archive_entry_mtime_is_set(entry) ? archive_entry_mtime(entry) : 0;
+                index_entry.offset = static_cast<uint64_t>(header_offset);
+                return index_entry;
+            }
+
+            /**
+             * How an entry appears in the tree state of an incremental archive
+             */
+            static IndexEntry makeStateEntry(const IO::ManifestEntry& item) {
+                IndexEntry state_entry;
+                state_entry.path = item.archive_path;
+                state_entry.is_directory = item.type == IO::EntryType::Directory;
+                if (state_entry.is_directory) {
+                    state_entry.path += '/';
+                }
+                // Symlinks are stored as links, which TAR gives no size
+                state_entry.size = item.type == IO::EntryType::File ? item.size : 0;
+                state_entry.permissions = item.mode;
+                // Whole seconds as TAR headers and listings have them, rounded down before 1970 too
+                state_entry.mtime = item.mtime_ns / 1'000'000'000 - (item.mtime_ns % 1'000'000'000 < 0 ? 1 : 0);
+                return state_entry;
+            }
+
+            /**
+             * Drop entries whose size and mtime match the base, like GNU tar's
+             * --listed-incremental; contents are not hashed, so unchanged files
+             * are never read
+             * @return Complete state of the scanned tree
+             */
+            static ArchiveIndex selectChanges(IO::FileManifest& manifest,
+                                              const ArchiveIndex& base_state,
+                                              ArchiveFormat format) {
+                std::unordered_map<std::string_view, const IndexEntry*> base_entries;
+                base_entries.reserve(base_state.entries.size());
+                for (const auto& base_entry : base_state.entries) {
+                    base_entries.emplace(base_entry.path, &base_entry);
+                }
+
+                ArchiveIndex tree_state;
+                tree_state.format = format;
+                tree_state.entries.reserve(manifest.entries.size());
+                std::vector<IO::ManifestEntry> changed;
+                for (auto& item : manifest.entries) {
+                    IndexEntry state_entry = makeStateEntry(item);
+                    const auto base = base_entries.find(state_entry.path);
+                    if (base == base_entries.end() ||
+                        base->second->is_directory != state_entry.is_directory ||
+                        base->second->size != state_entry.size ||
+                        base->second->mtime != state_entry.mtime) {
+                        changed.push_back(std::move(item));
                     }
+                    tree_state.entries.push_back(std::move(state_entry));
+                }
+                manifest.entries = std::move(changed);
+                return tree_state;
+            }
 
-                    // Create TAR header
-                    TarHeader header = {};
-                    
-                    // File name
-                    std::strncpy(header.name, archive_path.c_str(), sizeof(header.name) - 1);
-                    
-                    // File mode (644 for regular files)
-                    std::snprintf(header.mode, sizeof(header.mode), "%07o", 0644);
-                    
-                    // UID/GID (0 for root)
-                    std::snprintf(header.uid, sizeof(header.uid), "%07o", 0);
-                    std::snprintf(header.gid, sizeof(header.gid), "%07o", 0);
-                    
-                    // File size
-                    auto file_size = std::filesystem::file_size(file_path);
-                    std::snprintf(header.size, sizeof(header.size), "%011lo", file_size);
-                    
-                    // Modification time
-                    auto ftime = std::filesystem::last_write_time(file_path);
-                    auto sctp = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
-                        ftime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
-                    auto time_t_val = std::chrono::system_clock::to_time_t(sctp);
-                    std::snprintf(header.mtime, sizeof(header.mtime), "%011lo", time_t_val);
-                    
-                    // File type (regular file)
-                    header.typeflag = '0';
-                    
-                    // Magic and version
-                    std::strcpy(header.magic, "ustar");
-                    std::strcpy(header.version, "00");
-                    
-                    // User and group names
-                    std::strcpy(header.uname, "root");
-                    std::strcpy(header.gname, "root");
-                    
-                    // Calculate checksum
-                    calculateChecksum(header);
-                    
-                    // Write header
-                    tar_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
-                    
-                    // Write file content
-                    std::ifstream input_file(file_path, std::ios::binary);
-                    if (!input_file.is_open()) {
+            /**
+             * Write the INCREMENTAL_MANIFEST_NAME member holding the tree state
+             * @return Index entry for it, without offset
+             */
+            static IndexEntry writeManifestMember(struct archive* a,
+                                                  struct archive_entry* entry,
+                                                  const ArchiveIndex& tree_state) {
+                const std::vector<uint8_t> data = encodeArchiveIndex(tree_state);
+                IndexEntry index_entry;
+                index_entry.path = std::string(INCREMENTAL_MANIFEST_NAME);
+                index_entry.size = data.size();
+                index_entry.permissions = 0644;
+                index_entry.mtime = std::chrono::duration_cast<std::chrono::seconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+
+                archive_entry_clear(entry);
+                archive_entry_copy_pathname(entry, index_entry.path.c_str());
+                archive_entry_set_filetype(entry, AE_IFREG);
+                archive_entry_set_perm(entry, 0644);
+                archive_entry_set_size(entry, static_cast<la_int64_t>(data.size()));
+                archive_entry_set_mtime(entry, static_cast<time_t>(index_entry.mtime), 0);
+                if (archive_write_header(a, entry) != ARCHIVE_OK ||
+                    archive_write_data(a, data.data(), data.size()) < 0 ||
+                    archive_write_finish_entry(a) != ARCHIVE_OK) {
+                    throw CompressionException(archive_error_string(a));
+                }
+                return index_entry;
+            }
+
+#ifndef _WIN32
+            /**
+             * Scanner results in the form libarchive takes, so it does not stat again
+             */
+            static struct stat toStat(const IO::ManifestEntry& item) {
+                struct stat st{};
+                switch (item.type) {
+                    case IO::EntryType::Directory: st.st_mode = S_IFDIR; break;
+                    case IO::EntryType::Symlink: st.st_mode = S_IFLNK; break;
+                    default: st.st_mode = S_IFREG; break;
+                }
+                st.st_mode |= static_cast<mode_t>(item.mode);
+                st.st_size = static_cast<off_t>(item.size);
+                st.st_ino = static_cast<ino_t>(item.inode);
+                st.st_dev = static_cast<dev_t>(item.device);
+                st.st_nlink = static_cast<nlink_t>(item.links);
+                st.st_uid = static_cast<uid_t>(item.uid);
+                st.st_gid = static_cast<gid_t>(item.gid);
+#ifdef __APPLE__
+                auto& mtime = st.st_mtimespec;
+#else
+                auto& mtime = st.st_mtim;
+#endif
+                // Floor division keeps the nanoseconds positive before 1970
+                const int64_t nanoseconds = ((item.mtime_ns % 1'000'000'000) + 1'000'000'000) % 1'000'000'000;
+                mtime.tv_sec = static_cast<time_t>((item.mtime_ns - nanoseconds) / 1'000'000'000);
+                mtime.tv_nsec = static_cast<long>(nanoseconds);
+                return st;
+            }
+#endif
+
+            bool packEntry(struct archive* a,
+                           struct archive* disk,
+                           struct archive_entry* entry,
+                           const IO::ManifestEntry& item,
+                           const PackOptions& options) {
+                archive_entry_clear(entry);
+                archive_entry_copy_sourcepath(entry, item.source.string().c_str());
+                archive_entry_copy_pathname(entry, item.archive_path.c_str());
+
+#ifndef _WIN32
+                const struct stat st = toStat(item);
+                const struct stat* known_stat = &st;
+#else
+                const struct stat* known_stat = nullptr;
+#endif
+                {
+                    // Extended attributes and ACLs are read here, completing the scan's metadata
+                    Utils::PhaseTimer timer(Utils::Phase::DirectoryScan);
+                    if (archive_read_disk_entry_from_file(disk, entry, -1, known_stat) != ARCHIVE_OK) {
+                        spdlog::warn("Cannot stat {}: {}", item.source.string(), archive_error_string(disk));
                         return false;
                     }
-                    
-                    // Copy file content
-                    constexpr size_t buffer_size = 8192;
-                    std::vector<char> buffer(buffer_size);
-                    size_t bytes_written = 0;
-                    
-                    while (input_file.read(buffer.data(), buffer_size) || input_file.gcount() > 0) {
-                        auto bytes_read = input_file.gcount();
-                        tar_file.write(buffer.data(), bytes_read);
-                        bytes_written += bytes_read;
-                    }
-                    
-                    // Pad to 512-byte boundary
-                    size_t padding = (512 - (bytes_written % 512)) % 512;
-                    if (padding > 0) {
-                        std::vector<char> pad(padding, 0);
-                        tar_file.write(pad.data(), padding);
+                }
+
+                const bool is_regular = archive_entry_filetype(entry) == AE_IFREG;
+                if (!options.preserve_permissions) {
+                    archive_entry_set_perm(entry, archive_entry_filetype(entry) == AE_IFDIR ? 0755 : 0644);
+                    archive_entry_set_uid(entry, 0);
+                    archive_entry_set_gid(entry, 0);
+                    archive_entry_set_uname(entry, "root");
+                    archive_entry_set_gname(entry, "root");
+                }
+                if (!options.preserve_timestamps) {
+                    archive_entry_unset_mtime(entry);
+                }
+                archive_entry_unset_atime(entry);
+                archive_entry_unset_ctime(entry);
+                archive_entry_unset_birthtime(entry);
+
+                std::optional<IO::BufferedReader> input_file;
+                if (is_regular) {
+                    try {
+                        input_file.emplace(item.source, IO::chooseBufferSize(static_cast<uint64_t>(archive_entry_size(entry))));
+                    } catch (const FileNotFoundException&) {
+                        return false;
                     }
-                    
-                    spdlog::debug("Added file to TAR: {} -> {} ({} bytes)", 
-                                file_path.string(), archive_path, file_size);
-                    
-                    return true;
-                    
-                } catch (const std::exception& e) {
-                    spdlog::error("Error packing file to TAR: {}", e.what());
+                }
+
+                const int header_status = archive_write_header(a, entry);
+                if (header_status == ARCHIVE_FATAL) {
+                    throw CompressionException(archive_error_string(a));
+                }
+                if (header_status < ARCHIVE_WARN) {
+                    spdlog::warn("Cannot write TAR header for {}: {}", item.archive_path, archive_error_string(a));
                     return false;
                 }
-            }
 
-            void calculateChecksum(TarHeader& header) {
-                // Clear checksum field and fill with spaces
-                std::memset(header.checksum, ' ', sizeof(header.checksum));
-                
-                // Calculate checksum as sum of all header bytes
-                unsigned int checksum = 0;
-                const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&header);
-                for (size_t i = 0; i < sizeof(header); ++i) {
-                    checksum += bytes[i];
+                if (is_regular) {
+                    // Stream file content through libarchive into the compressor
+                    for (auto block = input_file->read(); !block.empty(); block = input_file->read()) {
+                        if (archive_write_data(a, block.data(), block.size()) < 0) {
+                            throw CompressionException(archive_error_string(a));
+                        }
+                    }
                 }
-                
-                // Write checksum in octal format
-                std::snprintf(header.checksum, sizeof(header.checksum), "%06o", checksum);
+
+                if (archive_write_finish_entry(a) == ARCHIVE_FATAL) {
+                    throw CompressionException(archive_error_string(a));
+                }
+
+                spdlog::debug("Added entry to TAR: {} -> {} ({} bytes)",
+                            item.source.string(), item.archive_path, archive_entry_size(entry));
+                return true;
             }
         };
 
@@ -1,20 +1,76 @@
 #include "flux-core/packer.h"
 #include "flux-core/exceptions.h"
+#include "flux-core/constants.h"
+#include "flux-core/trace.h"
+#include "io/file_scanner.h"
+#include "utils/concurrency.h"
+#include "utils/content_classifier.h"
+#include "utils/operation_metrics.h"
+#include "utils/pattern_matcher.h"
+#include "utils/progress_channel.h"
 #include <zip.h>
 #include <spdlog/spdlog.h>
 #include <fmt/format.h>
 #include <fstream>
 #include <chrono>
 #include <filesystem>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <numeric>
+#include <queue>
+#include <set>
 
 namespace Flux {
     namespace Formats {
         /**
          * Real ZIP format packer implementation using libzip
+         *
+         * Large inputs are deflated in parallel: each worker compresses a share of
+         * the files into its own spill archive next to the output, then a single
+         * writer appends the already-compressed members to the final archive in
+         * input order. The central directory is therefore identical for any
+         * thread count.
+         *
+         * Each file is stored or deflated as the content classifier decides, so
+         * media and nested archives cost a few KB of reading instead of a
+         * deflate pass that gains nothing.
          */
         class ZipPackerImpl : public Packer {
         private:
-            bool m_cancelled = false;
+            std::atomic<bool> m_cancelled{false};
+
+            // Input file discovered by the directory walk
+            struct PackItem {
+                std::filesystem::path source;    // Path on disk
+                std::string archive_path;        // Path stored in the archive
+                size_t size = 0;                 // File size in bytes
+            };
+
+            // Worker spill archives; discarded and deleted once the output is closed
+            struct ShardSet {
+                std::vector<std::filesystem::path> paths;
+                std::vector<zip_t*> archives;
+
+                ~ShardSet() {
+                    for (zip_t* shard : archives) {
+                        if (shard) {
+                            zip_discard(shard);
+                        }
+                    }
+                    for (const auto& path : paths) {
+                        std::error_code ec;
+                        std::filesystem::remove(path, ec);
+                    }
+                }
+            };
+
+            // Location of a compressed member inside a shard
+            struct Placement {
+                size_t shard = 0;
+                zip_int64_t index = -1;
+            };
 
         public:
             PackResult pack(
@@ -23,7 +79,7 @@ namespace Flux {
                 const PackOptions& options,
                 const ProgressCallback& on_progress = nullptr,
                 const ErrorCallback& on_error = nullptr) override {
-                
+
                 auto start_time = std::chrono::high_resolution_clock::now();
                 PackResult result;
                 result.success = false;
@@ -37,7 +93,7 @@ namespace Flux {
 
                 int error_code = 0;
                 zip_t* archive = zip_open(output.string().c_str(), ZIP_CREATE | ZIP_TRUNCATE, &error_code);
-                
+
                 if (!archive) {
                     zip_error_t error;
                     zip_error_init_with_code(&error, error_code);
@@ -47,6 +103,9 @@ namespace Flux {
                     return result;
                 }
 
+                // Must outlive zip_close(archive): members are copied from the shards at close time
+                ShardSet shards;
+
                 try {
                     // Set compression level
                     int compression_level = ZIP_CM_DEFAULT;
@@ -54,104 +113,35 @@ namespace Flux {
                         compression_level = options.compression_level;
                     }
 
-                    spdlog::info("Creating ZIP archive: {} with compression level {}", 
+                    spdlog::info("Creating ZIP archive: {} with compression level {}",
                                output.string(), compression_level);
 
                     // Collect all files to pack
-                    std::vector<std::filesystem::path> all_files;
-                    size_t total_files = 0;
-                    
-                    for (const auto& input : inputs) {
-                        if (std::filesystem::is_directory(input)) {
-                            for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
-                                if (entry.is_regular_file()) {
-                                    all_files.push_back(entry.path());
-                                    total_files++;
-                                }
-                            }
-                        } else if (std::filesystem::is_regular_file(input)) {
-                            all_files.push_back(input);
-                            total_files++;
-                        }
-                    }
+                    const Utils::PathFilter filter(options.include_patterns, options.exclude_patterns);
+                    const IO::FileManifest manifest = IO::scanInputs(inputs, filter,
+                                                                     Utils::resolveThreadCount(options.num_threads));
+                    std::vector<PackItem> items = collectFiles(manifest);
+                    const size_t total_bytes = std::accumulate(items.begin(), items.end(), size_t{0},
+                        [](size_t sum, const PackItem& item) { return sum + item.size; });
 
-                    spdlog::info("Found {} files to pack", total_files);
+                    spdlog::info("Found {} files to pack", items.size());
 
-                    // Pack each file
-                    size_t processed_files = 0;
-                    for (const auto& file_path : all_files) {
-                        if (m_cancelled) {
-                            break;
-                        }
-
-                        if (on_progress) {
-                            float progress = static_cast<float>(processed_files) / static_cast<float>(total_files);
-                            on_progress(fmt::format("Packing: {}", file_path.filename().string()), 
-                                      progress, processed_files, total_files);
-                        }
-
-                        try {
-                            // Determine archive path (relative to input root)
-                            std::string archive_path = file_path.filename().string();
-                            
-                            // Find the input root for this file
-                            for (const auto& input : inputs) {
-                                if (file_path.string().starts_with(input.string())) {
-                                    auto relative_path = std::filesystem::relative(file_path, input.parent_path());
-                                    archive_path = relative_path.string();
-                                    // Convert Windows path separators to forward slashes
-                                    std::replace(archive_path.begin(), archive_path.end(), '\\', '/');
-                                    break;
-                                }
-                            }
-
-                            // Create zip source from file
-                            zip_source_t* source = zip_source_file(archive, file_path.string().c_str(), 0, 0);
-                            if (!source) {
-                                spdlog::warn("Cannot create source for file: {}", file_path.string());
-                                continue;
-                            }
-
-                            // Add file to archive
-                            zip_int64_t index = zip_file_add(archive, archive_path.c_str(), source, ZIP_FL_OVERWRITE);
-                            if (index < 0) {
-                                spdlog::warn("Cannot add file to archive: {}", archive_path);
-                                zip_source_free(source);
-                                continue;
-                            }
-
-                            // Set compression method and level
-                            if (zip_set_file_compression(archive, index, ZIP_CM_DEFLATE, compression_level) < 0) {
-                                spdlog::warn("Cannot set compression for file: {}", archive_path);
-                            }
-
-                            // Update statistics
-                            result.files_processed++;
-                            result.total_uncompressed_size += std::filesystem::file_size(file_path);
-                            processed_files++;
-
-                            spdlog::debug("Added file to ZIP: {} -> {}", file_path.string(), archive_path);
-
-                        } catch (const std::exception& e) {
-                            spdlog::warn("Error packing file {}: {}", file_path.string(), e.what());
-                            if (on_error) {
-                                on_error(fmt::format("Error packing file {}: {}", file_path.string(), e.what()));
-                            }
-                        }
+                    const unsigned threads = Utils::resolveThreadCount(options.num_threads);
+                    if (threads > 1 && items.size() > 1 && total_bytes >= Constants::Performance::MIN_PARALLEL_SIZE) {
+                        packParallel(archive, output, items, compression_level, options.compression_strategy,
+                                     threads, shards, result, on_progress, on_error);
+                    } else {
+                        packSerial(archive, items, compression_level, options.compression_strategy,
+                                   result, on_progress, on_error);
                     }
 
                     // Add directories if needed
-                    std::set<std::string> added_dirs;
-                    for (const auto& input : inputs) {
-                        if (std::filesystem::is_directory(input)) {
-                            addDirectoryStructure(archive, input, input.parent_path(), added_dirs);
-                        }
-                    }
+                    addDirectories(archive, manifest);
 
                     if (m_cancelled) {
                         result.error_message = "Packing cancelled by user";
                         spdlog::info("ZIP packing cancelled");
-                    } else {
+                    } else if (result.error_message.empty()) {
                         result.success = true;
                         spdlog::info("Successfully packed {} files into ZIP archive", result.files_processed);
                     }
@@ -161,31 +151,38 @@ namespace Flux {
                     spdlog::error("ZIP packing error: {}", e.what());
                 }
 
-                // Close archive
-                if (zip_close(archive) < 0) {
+                // Close archive; libzip reads, compresses and writes every member here
+                int close_status = 0;
+                {
+                    FLUX_TRACE_SPAN("zip.write_archive");
+                    Utils::PhaseTimer timer(Utils::Phase::Codec);
+                    close_status = zip_close(archive);
+                }
+                if (close_status < 0) {
                     result.error_message = fmt::format("Cannot close ZIP archive: {}", zip_strerror(archive));
                     result.success = false;
                     spdlog::error("Failed to close ZIP archive: {}", result.error_message);
+                    zip_discard(archive);
                 } else if (result.success) {
                     // Calculate final compressed size and compression ratio
                     try {
                         result.total_compressed_size = std::filesystem::file_size(output);
                         if (result.total_uncompressed_size > 0) {
-                            result.compression_ratio = static_cast<double>(result.total_compressed_size) / 
+                            result.compression_ratio = static_cast<double>(result.total_compressed_size) /
                                                      static_cast<double>(result.total_uncompressed_size);
                         }
-                        spdlog::info("ZIP compression ratio: {:.2f}% ({} -> {} bytes)", 
-                                   result.compression_ratio * 100.0, 
-                                   result.total_uncompressed_size, 
+                        spdlog::info("ZIP compression ratio: {:.2f}% ({} -> {} bytes)",
+                                   result.compression_ratio * 100.0,
+                                   result.total_uncompressed_size,
                                    result.total_compressed_size);
                     } catch (const std::exception& e) {
                         spdlog::warn("Cannot calculate compressed size: {}", e.what());
                     }
                 }
-                
+
                 auto end_time = std::chrono::high_resolution_clock::now();
                 result.duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
-                
+
                 return result;
             }
 
@@ -199,37 +196,283 @@ namespace Flux {
             }
 
         private:
-            void addDirectoryStructure(zip_t* archive, 
-                                     const std::filesystem::path& dir_path,
-                                     const std::filesystem::path& base_path,
-                                     std::set<std::string>& added_dirs) {
-                try {
-                    for (const auto& entry : std::filesystem::recursive_directory_iterator(dir_path)) {
-                        if (entry.is_directory()) {
-                            auto relative_path = std::filesystem::relative(entry.path(), base_path);
-                            std::string archive_path = relative_path.string();
-                            
-                            // Convert Windows path separators to forward slashes and add trailing slash
-                            std::replace(archive_path.begin(), archive_path.end(), '\\', '/');
-                            if (!archive_path.empty() && archive_path.back() != '/') {
-                                archive_path += '/';
-                            }
-
-                            // Check if directory already added
-                            if (added_dirs.find(archive_path) != added_dirs.end()) {
-                                continue;
-                            }
-
-                            // Add directory entry
-                            zip_int64_t index = zip_dir_add(archive, archive_path.c_str(), ZIP_FL_ENC_UTF_8);
-                            if (index >= 0) {
-                                added_dirs.insert(archive_path);
-                                spdlog::debug("Added directory to ZIP: {}", archive_path);
-                            }
+            /**
+             * Files of the manifest, with symlinks to files followed
+             */
+            static std::vector<PackItem> collectFiles(const IO::FileManifest& manifest) {
+                std::vector<PackItem> items;
+                for (const auto& entry : manifest.entries) {
+                    if (entry.hasFileContent()) {
+                        items.push_back({entry.source, entry.archive_path, static_cast<size_t>(entry.target_size)});
+                    }
+                }
+                return items;
+            }
+
+            /**
+             * Store or deflate a member as chooseCompression decides for its source
+             */
+            static void setCompression(zip_t* archive,
+                                       zip_int64_t index,
+                                       const PackItem& item,
+                                       int compression_level,
+                                       CompressionStrategy strategy) {
+                const auto choice = Utils::chooseCompression(item.source, compression_level, strategy);
+                const zip_int32_t method = choice.store ? ZIP_CM_STORE : ZIP_CM_DEFLATE;
+                if (zip_set_file_compression(archive, static_cast<zip_uint64_t>(index), method,
+                                             static_cast<zip_uint32_t>(choice.level)) < 0) {
+                    spdlog::warn("Cannot set compression for file: {}", item.archive_path);
+                } else if (choice.store) {
+                    spdlog::debug("Storing {} uncompressed", item.archive_path);
+                }
+            }
+
+            void packSerial(zip_t* archive,
+                            const std::vector<PackItem>& items,
+                            int compression_level,
+                            CompressionStrategy strategy,
+                            PackResult& result,
+                            const ProgressCallback& on_progress,
+                            const ErrorCallback& on_error) {
+                Utils::ProgressChannel progress(on_progress, "Packing", items.size());
+
+                for (const auto& item : items) {
+                    if (m_cancelled) {
+                        break;
+                    }
+                    FLUX_TRACE_SPAN("zip.add_entry", item.archive_path);
+
+                    progress.entry(item.archive_path);
+
+                    try {
+                        // Create zip source from file
+                        zip_source_t* source = zip_source_file(archive, item.source.string().c_str(), 0, 0);
+                        if (!source) {
+                            spdlog::warn("Cannot create source for file: {}", item.source.string());
+                            continue;
+                        }
+
+                        // Add file to archive
+                        zip_int64_t index = zip_file_add(archive, item.archive_path.c_str(), source,
+                                                         ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8);
+                        if (index < 0) {
+                            spdlog::warn("Cannot add file to archive: {}", item.archive_path);
+                            zip_source_free(source);
+                            continue;
+                        }
+
+                        setCompression(archive, index, item, compression_level, strategy);
+
+                        // Update statistics
+                        result.files_processed++;
+                        result.total_uncompressed_size += item.size;
+                        Utils::countBytesRead(item.size);    // Read by libzip when the archive is closed
+                        progress.advance();
+
+                        spdlog::debug("Added file to ZIP: {} -> {}", item.source.string(), item.archive_path);
+
+                    } catch (const std::exception& e) {
+                        spdlog::warn("Error packing file {}: {}", item.source.string(), e.what());
+                        if (on_error) {
+                            on_error(fmt::format("Error packing file {}: {}", item.source.string(), e.what()), false);
                         }
                     }
-                } catch (const std::exception& e) {
-                    spdlog::warn("Error adding directory structure: {}", e.what());
+                }
+                progress.finish();
+            }
+
+            /**
+             * Split items into shards with roughly equal byte counts
+             * (largest-first greedy assignment, deterministic for a given input)
+             */
+            static std::vector<std::vector<size_t>> planShards(const std::vector<PackItem>& items,
+                                                               size_t shard_count) {
+                std::vector<size_t> order(items.size());
+                std::iota(order.begin(), order.end(), size_t{0});
+                std::stable_sort(order.begin(), order.end(), [&items](size_t lhs, size_t rhs) {
+                    return items[lhs].size > items[rhs].size;
+                });
+
+                using Load = std::pair<size_t, size_t>;  // (bytes assigned, shard)
+                std::priority_queue<Load, std::vector<Load>, std::greater<>> loads;
+                for (size_t shard = 0; shard < shard_count; ++shard) {
+                    loads.emplace(0, shard);
+                }
+
+                std::vector<std::vector<size_t>> plan(shard_count);
+                for (size_t item_index : order) {
+                    auto [bytes, shard] = loads.top();
+                    loads.pop();
+                    plan[shard].push_back(item_index);
+                    // Count a minimum per file so thousands of empty files still spread out
+                    loads.emplace(bytes + std::max<size_t>(items[item_index].size, 4096), shard);
+                }
+                return plan;
+            }
+
+            void packParallel(zip_t* archive,
+                              const std::filesystem::path& output,
+                              const std::vector<PackItem>& items,
+                              int compression_level,
+                              CompressionStrategy strategy,
+                              unsigned threads,
+                              ShardSet& shards,
+                              PackResult& result,
+                              const ProgressCallback& on_progress,
+                              const ErrorCallback& on_error) {
+                const size_t shard_count = std::min<size_t>(threads, items.size());
+                const auto plan = planShards(items, shard_count);
+
+                spdlog::info("Deflating {} files on {} threads", items.size(), shard_count);
+
+                for (size_t shard = 0; shard < shard_count; ++shard) {
+                    shards.paths.push_back(output.parent_path() /
+                                           fmt::format(".{}.part{}", output.filename().string(), shard));
+                }
+
+                std::vector<Placement> placements(items.size());
+                std::vector<std::string> shard_errors(shard_count);
+                Utils::ProgressChannel progress(on_progress, "Compressed", items.size());
+
+                // Phase 1: every worker deflates its share into a spill archive
+                auto compress_shard = [&, metrics = Utils::currentMetrics()](size_t shard) {
+                    Utils::MetricsScope scope(metrics);
+                    int error_code = 0;
+                    zip_t* spill = zip_open(shards.paths[shard].string().c_str(), ZIP_CREATE | ZIP_TRUNCATE, &error_code);
+                    if (!spill) {
+                        zip_error_t error;
+                        zip_error_init_with_code(&error, error_code);
+                        shard_errors[shard] = fmt::format("Cannot create spill archive: {}", zip_error_strerror(&error));
+                        zip_error_fini(&error);
+                        return;
+                    }
+
+                    for (size_t item_index : plan[shard]) {
+                        if (m_cancelled) {
+                            break;
+                        }
+                        const auto& item = items[item_index];
+                        FLUX_TRACE_SPAN("zip.add_entry", item.archive_path);
+                        zip_source_t* source = zip_source_file(spill, item.source.string().c_str(), 0, 0);
+                        if (!source) {
+                            spdlog::warn("Cannot create source for file: {}", item.source.string());
+                            continue;
+                        }
+                        zip_int64_t index = zip_file_add(spill, item.archive_path.c_str(), source, ZIP_FL_ENC_UTF_8);
+                        if (index < 0) {
+                            spdlog::warn("Cannot add file to archive: {}", item.archive_path);
+                            zip_source_free(source);
+                            continue;
+                        }
+                        setCompression(spill, index, item, compression_level, strategy);
+                        placements[item_index] = {shard, index};
+                        Utils::countBytesRead(item.size);
+                    }
+
+                    // libzip compresses while writing the archive, so this is where the CPU work happens
+                    int close_status = 0;
+                    {
+                        FLUX_TRACE_SPAN("zip.compress_shard");
+                        Utils::PhaseTimer timer(Utils::Phase::Codec);
+                        close_status = zip_close(spill);
+                    }
+                    if (close_status < 0) {
+                        shard_errors[shard] = fmt::format("Cannot write spill archive: {}", zip_strerror(spill));
+                        zip_discard(spill);
+                        return;
+                    }
+
+                    if (!plan[shard].empty()) {
+                        progress.entry(items[plan[shard].back()].archive_path);
+                        progress.advance(plan[shard].size());
+                    }
+                };
+
+                std::vector<std::future<void>> workers;
+                workers.reserve(shard_count);
+                for (size_t shard = 0; shard < shard_count; ++shard) {
+                    workers.emplace_back(std::async(std::launch::async, compress_shard, shard));
+                }
+                for (auto& worker : workers) {
+                    worker.get();
+                }
+                progress.finish();
+
+                for (const auto& error : shard_errors) {
+                    if (!error.empty()) {
+                        result.error_message = error;
+                        return;
+                    }
+                }
+                if (m_cancelled) {
+                    return;
+                }
+
+                // Phase 2: append pre-compressed members in input order
+                shards.archives.resize(shard_count, nullptr);
+                for (size_t shard = 0; shard < shard_count; ++shard) {
+                    int error_code = 0;
+                    shards.archives[shard] = zip_open(shards.paths[shard].string().c_str(), ZIP_RDONLY, &error_code);
+                    if (!shards.archives[shard]) {
+                        result.error_message = fmt::format("Cannot reopen spill archive {}", shards.paths[shard].string());
+                        return;
+                    }
+                }
+
+                for (size_t item_index = 0; item_index < items.size(); ++item_index) {
+                    const auto& item = items[item_index];
+                    const auto& placement = placements[item_index];
+                    FLUX_TRACE_SPAN("zip.merge_entry", item.archive_path);
+                    if (placement.index < 0) {
+                        if (on_error) {
+                            on_error(fmt::format("Failed to pack file: {}", item.source.string()), false);
+                        }
+                        continue;
+                    }
+
+                    // ZIP_FL_COMPRESSED copies the member data as-is, stored or deflated, without recompressing
+                    zip_t* spill = shards.archives[placement.shard];
+                    const auto spill_index = static_cast<zip_uint64_t>(placement.index);
+#if LIBZIP_VERSION_MAJOR > 1 || (LIBZIP_VERSION_MAJOR == 1 && LIBZIP_VERSION_MINOR >= 10)
+                    zip_source_t* source = zip_source_zip_file(archive, spill, spill_index, ZIP_FL_COMPRESSED,
+                                                               0, -1, nullptr);
+#else
+                    zip_source_t* source = zip_source_zip(archive, spill, spill_index, ZIP_FL_COMPRESSED, 0, -1);
+#endif
+                    if (!source) {
+                        spdlog::warn("Cannot read compressed member: {}", item.archive_path);
+                        continue;
+                    }
+
+                    if (zip_file_add(archive, item.archive_path.c_str(), source,
+                                     ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) < 0) {
+                        spdlog::warn("Cannot add file to archive: {}", item.archive_path);
+                        zip_source_free(source);
+                        continue;
+                    }
+
+                    result.files_processed++;
+                    result.total_uncompressed_size += item.size;
+                }
+            }
+
+            /**
+             * Add entries for the directories below the inputs (the inputs themselves are implied)
+             */
+            void addDirectories(zip_t* archive, const IO::FileManifest& manifest) {
+                std::set<std::string> added_dirs;
+                for (const auto& entry : manifest.entries) {
+                    if (entry.type != IO::EntryType::Directory || entry.archive_path.find('/') == std::string::npos) {
+                        continue;
+                    }
+
+                    const std::string archive_path = entry.archive_path + '/';
+                    if (!added_dirs.insert(archive_path).second) {
+                        continue;
+                    }
+                    if (zip_dir_add(archive, archive_path.c_str(), ZIP_FL_ENC_UTF_8) >= 0) {
+                        spdlog::debug("Added directory to ZIP: {}", archive_path);
+                    }
                 }
             }
         };
@@ -0,0 +1,1003 @@
+#include "formats/sevenzip/sevenzip_archive.h"
+#include "flux-core/constants.h"
+#include "flux-core/exceptions.h"
+#include "io/codec_pool.h"
+#include "utils/operation_metrics.h"
+#include <lzma.h>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+
+namespace Flux::Formats::SevenZip {
+    namespace {
+        // Upper bounds that reject absurd counts before allocating for them
+        constexpr uint64_t MAX_HEADER_SIZE = 1ULL << 30;
+        constexpr uint64_t MAX_CODERS_PER_FOLDER = 64;
+        constexpr size_t MAX_FILTERS = LZMA_FILTERS_MAX;
+        constexpr size_t MAX_HEADER_ENCODING_DEPTH = 4;     // 7-Zip itself encodes once
+
+        // Seconds between 1601-01-01 (FILETIME epoch) and 1970-01-01
+        constexpr int64_t FILETIME_UNIX_OFFSET = 11644473600LL;
+
+        [[noreturn]] void corrupted(std::string_view reason) {
+            throw CorruptedArchiveException(fmt::format("7z {}", reason));
+        }
+
+        uint32_t readUint32(const uint8_t* data) {
+            return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                   (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+
+        uint64_t readUint64(const uint8_t* data) {
+            return static_cast<uint64_t>(readUint32(data)) | (static_cast<uint64_t>(readUint32(data + 4)) << 32);
+        }
+
+        uint32_t crc32(std::span<const uint8_t> data, uint32_t crc = 0) {
+            return lzma_crc32(data.data(), data.size(), crc);
+        }
+
+        /**
+         * Bounds-checked cursor over a decoded header
+         */
+        class HeaderReader {
+        public:
+            explicit HeaderReader(std::span<const uint8_t> data) : m_data(data) {}
+
+            uint8_t byte() {
+                require(1);
+                return m_data[m_pos++];
+            }
+
+            uint32_t uint32() {
+                require(4);
+                const uint32_t value = readUint32(m_data.data() + m_pos);
+                m_pos += 4;
+                return value;
+            }
+
+            uint64_t uint64() {
+                require(8);
+                const uint64_t value = readUint64(m_data.data() + m_pos);
+                m_pos += 8;
+                return value;
+            }
+
+            /**
+             * 7z variable-length integer: the leading 1 bits of the first byte
+             * give the number of extra little-endian bytes
+             */
+            uint64_t number() {
+                const uint8_t first = byte();
+                uint8_t mask = 0x80;
+                uint64_t value = 0;
+                for (int i = 0; i < 8; ++i) {
+                    if ((first & mask) == 0) {
+                        const uint64_t high = first & (mask - 1u);
+                        return value | (high << (8 * i));
+                    }
+                    value |= static_cast<uint64_t>(byte()) << (8 * i);
+                    mask >>= 1;
+                }
+                return value;
+            }
+
+            /**
+             * number() constrained to a count that fits in memory
+             */
+            size_t count(uint64_t limit) {
+                const uint64_t value = number();
+                if (value > limit) {
+                    corrupted("header count out of range");
+                }
+                return static_cast<size_t>(value);
+            }
+
+            std::span<const uint8_t> bytes(uint64_t size) {
+                require(size);
+                auto result = m_data.subspan(m_pos, static_cast<size_t>(size));
+                m_pos += static_cast<size_t>(size);
+                return result;
+            }
+
+            void skip(uint64_t size) { bytes(size); }
+
+            std::vector<bool> bitField(size_t count) {
+                std::vector<bool> bits(count);
+                uint8_t current = 0;
+                for (size_t i = 0; i < count; ++i) {
+                    if (i % 8 == 0) {
+                        current = byte();
+                    }
+                    bits[i] = (current & (0x80 >> (i % 8))) != 0;
+                }
+                return bits;
+            }
+
+            /**
+             * "AllAreDefined" byte followed by an optional bit field
+             */
+            std::vector<bool> definedField(size_t count) {
+                if (byte() != 0) {
+                    return std::vector<bool>(count, true);
+                }
+                return bitField(count);
+            }
+
+            std::vector<std::optional<uint32_t>> digests(size_t count) {
+                const auto defined = definedField(count);
+                std::vector<std::optional<uint32_t>> result(count);
+                for (size_t i = 0; i < count; ++i) {
+                    if (defined[i]) {
+                        result[i] = uint32();
+                    }
+                }
+                return result;
+            }
+
+            // Remaining bytes, used to sanity-check declared counts
+            size_t remaining() const noexcept { return m_data.size() - m_pos; }
+
+        private:
+            void require(uint64_t size) const {
+                if (size > m_data.size() - m_pos) {
+                    corrupted("header truncated");
+                }
+            }
+
+            std::span<const uint8_t> m_data;
+            size_t m_pos = 0;
+        };
+
+        void expectProperty(HeaderReader& reader, uint8_t expected) {
+            if (reader.byte() != expected) {
+                corrupted("header has an unexpected property");
+            }
+        }
+
+        /**
+         * Streams info as read from a header, before files are attached
+         */
+        struct StreamsInfo {
+            uint64_t pack_pos = 0;
+            std::vector<uint64_t> pack_sizes;
+            std::vector<std::optional<uint32_t>> pack_crcs;
+            std::vector<Folder> folders;
+            std::vector<uint64_t> substream_sizes;
+            std::vector<std::optional<uint32_t>> substream_crcs;
+        };
+
+        void readPackInfo(HeaderReader& reader, StreamsInfo& info) {
+            info.pack_pos = reader.number();
+            const size_t count = reader.count(reader.remaining());
+            info.pack_sizes.assign(count, 0);
+            info.pack_crcs.assign(count, std::nullopt);
+
+            for (uint8_t id = reader.byte(); id != Property::END; id = reader.byte()) {
+                if (id == Property::SIZE) {
+                    for (auto& size : info.pack_sizes) {
+                        size = reader.number();
+                    }
+                } else if (id == Property::CRC) {
+                    info.pack_crcs = reader.digests(count);
+                } else {
+                    reader.skip(reader.number());
+                }
+            }
+        }
+
+        Folder readFolder(HeaderReader& reader) {
+            Folder folder;
+            const size_t num_coders = reader.count(MAX_CODERS_PER_FOLDER);
+            if (num_coders == 0) {
+                corrupted("folder has no coders");
+            }
+
+            for (size_t i = 0; i < num_coders; ++i) {
+                const uint8_t flags = reader.byte();
+                if (flags & 0x80) {
+                    throw UnsupportedFormatException("7z alternative coder methods");
+                }
+                Coder coder;
+                for (uint8_t byte : reader.bytes(flags & 0x0F)) {
+                    coder.method = (coder.method << 8) | byte;
+                }
+                if (flags & 0x10) {
+                    coder.num_in_streams = reader.count(MAX_CODERS_PER_FOLDER);
+                    coder.num_out_streams = reader.count(MAX_CODERS_PER_FOLDER);
+                }
+                if (flags & 0x20) {
+                    auto properties = reader.bytes(reader.number());
+                    coder.properties.assign(properties.begin(), properties.end());
+                }
+                folder.coders.push_back(std::move(coder));
+            }
+
+            const uint64_t total_out = folder.totalOutStreams();
+            const uint64_t total_in = folder.totalInStreams();
+            if (total_out == 0 || total_in < total_out - 1) {
+                corrupted("folder has an invalid coder graph");
+            }
+
+            folder.bind_pairs.resize(total_out - 1);
+            for (auto& pair : folder.bind_pairs) {
+                pair.in_index = reader.number();
+                pair.out_index = reader.number();
+                if (pair.in_index >= total_in || pair.out_index >= total_out) {
+                    corrupted("folder bind pair out of range");
+                }
+            }
+
+            const uint64_t num_packed = total_in - folder.bind_pairs.size();
+            if (num_packed == 1) {
+                for (uint64_t in = 0; in < total_in; ++in) {
+                    const bool bound = std::any_of(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                                                   [in](const BindPair& pair) { return pair.in_index == in; });
+                    if (!bound) {
+                        folder.packed_streams.push_back(in);
+                        break;
+                    }
+                }
+            } else {
+                for (uint64_t i = 0; i < num_packed; ++i) {
+                    folder.packed_streams.push_back(reader.number());
+                }
+            }
+            if (folder.packed_streams.size() != num_packed) {
+                corrupted("folder has no packed stream");
+            }
+            return folder;
+        }
+
+        void readUnpackInfo(HeaderReader& reader, StreamsInfo& info) {
+            expectProperty(reader, Property::FOLDER);
+            const size_t num_folders = reader.count(reader.remaining());
+            if (reader.byte() != 0) {
+                throw UnsupportedFormatException("7z external folder definitions");
+            }
+            info.folders.reserve(num_folders);
+            for (size_t i = 0; i < num_folders; ++i) {
+                info.folders.push_back(readFolder(reader));
+            }
+
+            expectProperty(reader, Property::CODERS_UNPACK_SIZE);
+            for (auto& folder : info.folders) {
+                folder.unpack_sizes.resize(folder.totalOutStreams());
+                for (auto& size : folder.unpack_sizes) {
+                    size = reader.number();
+                }
+            }
+
+            for (uint8_t id = reader.byte(); id != Property::END; id = reader.byte()) {
+                if (id == Property::CRC) {
+                    auto crcs = reader.digests(num_folders);
+                    for (size_t i = 0; i < num_folders; ++i) {
+                        info.folders[i].crc = crcs[i];
+                    }
+                } else {
+                    reader.skip(reader.number());
+                }
+            }
+        }
+
+        void readSubStreamsInfo(HeaderReader& reader, StreamsInfo& info) {
+            for (auto& folder : info.folders) {
+                folder.num_unpack_streams = 1;
+            }
+
+            uint8_t id = reader.byte();
+            if (id == Property::NUM_UNPACK_STREAM) {
+                for (auto& folder : info.folders) {
+                    folder.num_unpack_streams = reader.count(reader.remaining() + 1);
+                }
+                id = reader.byte();
+            }
+
+            // Every stream but the last of a folder has an explicit size;
+            // the last one takes the remainder
+            const bool has_sizes = (id == Property::SIZE);
+            for (const auto& folder : info.folders) {
+                if (folder.num_unpack_streams == 0) {
+                    continue;
+                }
+                uint64_t sum = 0;
+                for (uint64_t i = 1; i < folder.num_unpack_streams && has_sizes; ++i) {
+                    const uint64_t size = reader.number();
+                    info.substream_sizes.push_back(size);
+                    sum += size;
+                }
+                if (sum > folder.unpackSize()) {
+                    corrupted("substream sizes exceed folder size");
+                }
+                info.substream_sizes.push_back(folder.unpackSize() - sum);
+            }
+            if (has_sizes) {
+                id = reader.byte();
+            }
+
+            // Streams alone in a folder with a known CRC reuse the folder CRC
+            size_t unknown = 0;
+            for (const auto& folder : info.folders) {
+                if (folder.num_unpack_streams != 1 || !folder.crc) {
+                    unknown += folder.num_unpack_streams;
+                }
+            }
+
+            for (; id != Property::END; id = reader.byte()) {
+                if (id == Property::CRC) {
+                    auto crcs = reader.digests(unknown);
+                    size_t next = 0;
+                    for (const auto& folder : info.folders) {
+                        if (folder.num_unpack_streams == 1 && folder.crc) {
+                            info.substream_crcs.push_back(folder.crc);
+                        } else {
+                            for (uint64_t i = 0; i < folder.num_unpack_streams; ++i) {
+                                info.substream_crcs.push_back(crcs[next++]);
+                            }
+                        }
+                    }
+                } else {
+                    reader.skip(reader.number());
+                }
+            }
+
+            if (info.substream_crcs.empty()) {
+                for (const auto& folder : info.folders) {
+                    for (uint64_t i = 0; i < folder.num_unpack_streams; ++i) {
+                        info.substream_crcs.push_back(folder.num_unpack_streams == 1 ? folder.crc : std::nullopt);
+                    }
+                }
+            }
+        }
+
+        StreamsInfo readStreamsInfo(HeaderReader& reader) {
+            StreamsInfo info;
+            bool has_substreams = false;
+            for (uint8_t id = reader.byte(); id != Property::END; id = reader.byte()) {
+                switch (id) {
+                    case Property::PACK_INFO:
+                        readPackInfo(reader, info);
+                        break;
+                    case Property::UNPACK_INFO:
+                        readUnpackInfo(reader, info);
+                        break;
+                    case Property::SUBSTREAMS_INFO:
+                        readSubStreamsInfo(reader, info);
+                        has_substreams = true;
+                        break;
+                    default:
+                        corrupted("streams info has an unknown property");
+                }
+            }
+
+            if (!has_substreams) {
+                for (const auto& folder : info.folders) {
+                    info.substream_sizes.push_back(folder.unpackSize());
+                    info.substream_crcs.push_back(folder.crc);
+                }
+            }
+            return info;
+        }
+
+        /**
+         * Copy streams info into the database and lay out the pack streams
+         */
+        void attachStreams(Database& db, StreamsInfo& info, uint64_t archive_size) {
+            db.pack_sizes = std::move(info.pack_sizes);
+            db.pack_crcs = std::move(info.pack_crcs);
+            db.pack_offsets.resize(db.pack_sizes.size());
+
+            uint64_t offset = SIGNATURE_HEADER_SIZE + info.pack_pos;
+            for (size_t i = 0; i < db.pack_sizes.size(); ++i) {
+                db.pack_offsets[i] = offset;
+                offset += db.pack_sizes[i];
+                if (offset < db.pack_sizes[i] || offset > archive_size) {
+                    corrupted("pack stream extends past end of archive");
+                }
+            }
+
+            size_t next_pack = 0;
+            for (auto& folder : info.folders) {
+                folder.first_pack_stream = next_pack;
+                next_pack += folder.packed_streams.size();
+            }
+            if (next_pack > db.pack_sizes.size()) {
+                corrupted("folders reference missing pack streams");
+            }
+            db.folders = std::move(info.folders);
+        }
+
+        /**
+         * Convert a NUL-terminated UTF-16LE name to UTF-8
+         */
+        std::string utf16ToUtf8(std::span<const uint8_t> data, size_t& pos) {
+            std::string result;
+            auto unit = [&]() -> uint32_t {
+                if (pos + 2 > data.size()) {
+                    corrupted("file name truncated");
+                }
+                const uint32_t value = data[pos] | (static_cast<uint32_t>(data[pos + 1]) << 8);
+                pos += 2;
+                return value;
+            };
+
+            for (uint32_t code = unit(); code != 0; code = unit()) {
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    const uint32_t low = unit();
+                    if (low < 0xDC00 || low > 0xDFFF) {
+                        corrupted("file name has an invalid surrogate pair");
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+
+                if (code < 0x80) {
+                    result += static_cast<char>(code);
+                } else if (code < 0x800) {
+                    result += static_cast<char>(0xC0 | (code >> 6));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                } else if (code < 0x10000) {
+                    result += static_cast<char>(0xE0 | (code >> 12));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                } else {
+                    result += static_cast<char>(0xF0 | (code >> 18));
+                    result += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    result += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    result += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+            return result;
+        }
+
+        void readFilesInfo(HeaderReader& reader, Database& db) {
+            const size_t num_files = reader.count(reader.remaining());
+            db.files.assign(num_files, FileEntry{});
+
+            std::vector<bool> empty_stream(num_files, false);
+            std::vector<bool> empty_file;
+            std::vector<bool> anti;
+            size_t num_empty_streams = 0;
+
+            for (uint8_t id = reader.byte(); id != Property::END; id = reader.byte()) {
+                const uint64_t size = reader.number();
+                auto data = reader.bytes(size);
+                HeaderReader property(data);
+
+                switch (id) {
+                    case Property::EMPTY_STREAM:
+                        empty_stream = property.bitField(num_files);
+                        num_empty_streams = static_cast<size_t>(std::count(empty_stream.begin(), empty_stream.end(), true));
+                        break;
+                    case Property::EMPTY_FILE:
+                        empty_file = property.bitField(num_empty_streams);
+                        break;
+                    case Property::ANTI:
+                        anti = property.bitField(num_empty_streams);
+                        break;
+                    case Property::NAME: {
+                        if (property.byte() != 0) {
+                            throw UnsupportedFormatException("7z external file names");
+                        }
+                        size_t pos = 1;
+                        for (auto& file : db.files) {
+                            file.name = utf16ToUtf8(data, pos);
+                        }
+                        break;
+                    }
+                    case Property::MTIME: {
+                        const auto defined = property.definedField(num_files);
+                        if (property.byte() != 0) {
+                            throw UnsupportedFormatException("7z external file times");
+                        }
+                        for (size_t i = 0; i < num_files; ++i) {
+                            if (defined[i]) {
+                                db.files[i].mtime = property.uint64();
+                            }
+                        }
+                        break;
+                    }
+                    case Property::WIN_ATTRIBUTES: {
+                        const auto defined = property.definedField(num_files);
+                        if (property.byte() != 0) {
+                            throw UnsupportedFormatException("7z external file attributes");
+                        }
+                        for (size_t i = 0; i < num_files; ++i) {
+                            if (defined[i]) {
+                                db.files[i].attributes = property.uint32();
+                            }
+                        }
+                        break;
+                    }
+                    default:
+                        // CTime, ATime, StartPos, Dummy padding and unknown properties
+                        break;
+                }
+            }
+
+            size_t empty_index = 0;
+            for (size_t i = 0; i < num_files; ++i) {
+                auto& file = db.files[i];
+                file.has_stream = !empty_stream[i];
+                if (!file.has_stream) {
+                    const bool is_empty_file = empty_index < empty_file.size() && empty_file[empty_index];
+                    file.is_anti = empty_index < anti.size() && anti[empty_index];
+                    file.is_directory = !is_empty_file;
+                    ++empty_index;
+                }
+                if (file.attributes && (*file.attributes & ATTRIBUTE_DIRECTORY)) {
+                    file.is_directory = true;
+                }
+            }
+        }
+
+        /**
+         * Assign file streams to folders in order
+         */
+        void mapFilesToFolders(Database& db, const StreamsInfo& info) {
+            db.folder_files.assign(db.folders.size(), {});
+            size_t folder = 0;
+            size_t stream_in_folder = 0;
+            size_t substream = 0;
+
+            for (size_t i = 0; i < db.files.size(); ++i) {
+                auto& file = db.files[i];
+                if (!file.has_stream) {
+                    continue;
+                }
+                while (folder < db.folders.size() && stream_in_folder >= db.folders[folder].num_unpack_streams) {
+                    ++folder;
+                    stream_in_folder = 0;
+                }
+                if (folder >= db.folders.size() || substream >= info.substream_sizes.size()) {
+                    corrupted("more file streams than folder data");
+                }
+
+                file.folder = folder;
+                file.size = info.substream_sizes[substream];
+                if (substream < info.substream_crcs.size()) {
+                    file.crc = info.substream_crcs[substream];
+                }
+                db.folder_files[folder].push_back(i);
+                ++stream_in_folder;
+                ++substream;
+            }
+        }
+
+        void readHeader(HeaderReader& reader, Database& db, uint64_t archive_size) {
+            StreamsInfo main;
+            for (uint8_t id = reader.byte(); id != Property::END; id = reader.byte()) {
+                switch (id) {
+                    case Property::ARCHIVE_PROPERTIES:
+                        for (uint8_t type = reader.byte(); type != Property::END; type = reader.byte()) {
+                            reader.skip(reader.number());
+                        }
+                        break;
+                    case Property::ADDITIONAL_STREAMS_INFO:
+                        readStreamsInfo(reader);    // Not used by current writers
+                        break;
+                    case Property::MAIN_STREAMS_INFO:
+                        main = readStreamsInfo(reader);
+                        break;
+                    case Property::FILES_INFO:
+                        readFilesInfo(reader, db);
+                        break;
+                    default:
+                        corrupted("header has an unknown property");
+                }
+            }
+
+            attachStreams(db, main, archive_size);
+            mapFilesToFolders(db, main);
+        }
+
+        /**
+         * Translate a coder into a liblzma filter, or LZMA_VLI_UNKNOWN for Copy
+         */
+        lzma_filter toFilter(const Coder& coder) {
+            lzma_filter filter{LZMA_VLI_UNKNOWN, nullptr};
+            switch (coder.method) {
+                case Method::COPY:
+                    return filter;
+                case Method::LZMA:
+                    filter.id = LZMA_FILTER_LZMA1;
+                    break;
+                case Method::LZMA2:
+                    filter.id = LZMA_FILTER_LZMA2;
+                    break;
+                case Method::DELTA:
+                    filter.id = LZMA_FILTER_DELTA;
+                    break;
+                case Method::BCJ_X86:
+                    filter.id = LZMA_FILTER_X86;
+                    break;
+                case Method::BCJ_PPC:
+                    filter.id = LZMA_FILTER_POWERPC;
+                    break;
+                case Method::BCJ_IA64:
+                    filter.id = LZMA_FILTER_IA64;
+                    break;
+                case Method::BCJ_ARM:
+                    filter.id = LZMA_FILTER_ARM;
+                    break;
+                case Method::BCJ_ARMT:
+                    filter.id = LZMA_FILTER_ARMTHUMB;
+                    break;
+                case Method::BCJ_SPARC:
+                    filter.id = LZMA_FILTER_SPARC;
+                    break;
+#ifdef LZMA_FILTER_ARM64
+                case Method::ARM64:
+                    filter.id = LZMA_FILTER_ARM64;
+                    break;
+#endif
+                case Method::AES256_SHA256:
+                    throw UnsupportedFormatException("encrypted 7z archives");
+                default:
+                    throw UnsupportedFormatException(fmt::format("7z coder {:X}", coder.method));
+            }
+
+            if (lzma_properties_decode(&filter, nullptr, coder.properties.data(), coder.properties.size()) != LZMA_OK) {
+                corrupted(fmt::format("coder {:X} has invalid properties", coder.method));
+            }
+            return filter;
+        }
+
+        /**
+         * liblzma filter chain for a folder, outermost coder first
+         *
+         * Only linear graphs are supported: every coder has one input and one
+         * output and the folder reads a single pack stream (this excludes BCJ2).
+         */
+        class FilterChain {
+        public:
+            explicit FilterChain(const Folder& folder) {
+                if (folder.packed_streams.size() != 1 ||
+                    folder.totalInStreams() != folder.coders.size() ||
+                    folder.totalOutStreams() != folder.coders.size()) {
+                    const bool bcj2 = std::any_of(folder.coders.begin(), folder.coders.end(),
+                                                  [](const Coder& coder) { return coder.method == Method::BCJ2; });
+                    throw UnsupportedFormatException(bcj2 ? "7z BCJ2 coder" : "7z multi-stream folders");
+                }
+
+                // Walk from the unbound output (the folder result) towards the pack stream
+                uint64_t coder = folder.coders.size();
+                for (uint64_t out = 0; out < folder.coders.size(); ++out) {
+                    const bool bound = std::any_of(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                                                   [out](const BindPair& pair) { return pair.out_index == out; });
+                    if (!bound) {
+                        coder = out;
+                        break;
+                    }
+                }
+                m_main_out = coder;
+
+                for (size_t steps = 0; coder < folder.coders.size(); ++steps) {
+                    if (steps >= folder.coders.size() || m_count >= MAX_FILTERS) {
+                        release();
+                        corrupted("folder coder graph has a cycle");
+                    }
+                    lzma_filter filter;
+                    try {
+                        filter = toFilter(folder.coders[coder]);
+                    } catch (...) {
+                        release();
+                        throw;
+                    }
+                    if (filter.id != LZMA_VLI_UNKNOWN) {
+                        m_filters[m_count++] = filter;
+                    }
+
+                    const auto next = std::find_if(folder.bind_pairs.begin(), folder.bind_pairs.end(),
+                                                   [coder](const BindPair& pair) { return pair.in_index == coder; });
+                    coder = next == folder.bind_pairs.end() ? folder.coders.size() : next->out_index;
+                }
+                m_filters[m_count] = lzma_filter{LZMA_VLI_UNKNOWN, nullptr};
+            }
+
+            ~FilterChain() { release(); }
+
+            FilterChain(const FilterChain&) = delete;
+            FilterChain& operator=(const FilterChain&) = delete;
+
+            bool isCopy() const noexcept { return m_count == 0; }
+            const lzma_filter* filters() const noexcept { return m_filters; }
+            uint64_t mainOutput() const noexcept { return m_main_out; }
+
+        private:
+            void release() {
+                for (size_t i = 0; i < m_count; ++i) {
+                    std::free(m_filters[i].options);
+                    m_filters[i].options = nullptr;
+                }
+                m_count = 0;
+            }
+
+            lzma_filter m_filters[MAX_FILTERS + 1]{};
+            size_t m_count = 0;
+            uint64_t m_main_out = 0;
+        };
+
+        /**
+         * Decode a folder entirely into memory (used for encoded headers)
+         */
+        std::vector<uint8_t> decodeToMemory(const ArchiveInput& input, const Database& db, size_t folder) {
+            std::vector<uint8_t> output;
+            const uint64_t size = db.folders[folder].unpackSize();
+            if (size > MAX_HEADER_SIZE) {
+                corrupted("encoded header too large");
+            }
+            output.reserve(static_cast<size_t>(size));
+            decodeFolder(input, db, folder, [&output](std::span<const std::byte> chunk) {
+                const auto* bytes = reinterpret_cast<const uint8_t*>(chunk.data());
+                output.insert(output.end(), bytes, bytes + chunk.size());
+            });
+            return output;
+        }
+    }
+
+    uint64_t Folder::totalInStreams() const {
+        return std::accumulate(coders.begin(), coders.end(), uint64_t{0},
+                               [](uint64_t sum, const Coder& coder) { return sum + coder.num_in_streams; });
+    }
+
+    uint64_t Folder::totalOutStreams() const {
+        return std::accumulate(coders.begin(), coders.end(), uint64_t{0},
+                               [](uint64_t sum, const Coder& coder) { return sum + coder.num_out_streams; });
+    }
+
+    uint64_t Folder::unpackSize() const {
+        // The folder output is the one coder output that no bind pair consumes
+        for (uint64_t out = unpack_sizes.size(); out-- > 0;) {
+            const bool bound = std::any_of(bind_pairs.begin(), bind_pairs.end(),
+                                           [out](const BindPair& pair) { return pair.out_index == out; });
+            if (!bound) {
+                return unpack_sizes[out];
+            }
+        }
+        return 0;
+    }
+
+    std::optional<uint32_t> FileEntry::unixMode() const {
+        if (attributes && (*attributes & ATTRIBUTE_UNIX_EXTENSION)) {
+            return *attributes >> 16;
+        }
+        return std::nullopt;
+    }
+
+    std::optional<std::chrono::system_clock::time_point> FileEntry::modificationTime() const {
+        if (!mtime) {
+            return std::nullopt;
+        }
+        const auto since_1601 = std::chrono::duration<int64_t, std::ratio<1, 10'000'000>>(static_cast<int64_t>(*mtime));
+        const auto since_epoch = since_1601 - std::chrono::seconds(FILETIME_UNIX_OFFSET);
+        return std::chrono::system_clock::time_point(
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(since_epoch));
+    }
+
+    uint64_t Database::packSize(size_t folder) const {
+        const auto& f = folders[folder];
+        uint64_t total = 0;
+        for (size_t i = 0; i < f.packed_streams.size(); ++i) {
+            total += pack_sizes[f.first_pack_stream + i];
+        }
+        return total;
+    }
+
+    bool Database::isEncrypted() const {
+        return std::any_of(folders.begin(), folders.end(), [](const Folder& folder) {
+            return std::any_of(folder.coders.begin(), folder.coders.end(),
+                               [](const Coder& coder) { return coder.method == Method::AES256_SHA256; });
+        });
+    }
+
+    ArchiveInput::ArchiveInput(const std::filesystem::path& path)
+        : m_path(path),
+          m_mapping(IO::mapFile(path, IO::AccessPattern::Normal)) {
+        if (m_mapping) {
+            m_size = m_mapping->size();
+            return;
+        }
+
+        m_file.open(path, std::ios::binary);
+        if (!m_file.is_open()) {
+            throw FileNotFoundException(path.string());
+        }
+        m_file.seekg(0, std::ios::end);
+        m_size = static_cast<uint64_t>(m_file.tellg());
+    }
+
+    void ArchiveInput::readAt(uint64_t offset, std::span<std::byte> buffer) const {
+        if (offset > m_size || buffer.size() > m_size - offset) {
+            corrupted("read past end of archive");
+        }
+        Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+        Utils::countBytesRead(buffer.size());
+        if (m_mapping) {
+            std::memcpy(buffer.data(), m_mapping->data() + offset, buffer.size());
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_file_mutex);
+        Utils::countSyscalls(2);    // seek and read
+        m_file.clear();
+        m_file.seekg(static_cast<std::streamoff>(offset));
+        m_file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+        if (static_cast<size_t>(m_file.gcount()) != buffer.size()) {
+            throw FluxException(fmt::format("Error reading archive: {}", m_path.string()));
+        }
+    }
+
+    Database readDatabase(const ArchiveInput& input) {
+        Utils::PhaseTimer timer(Utils::Phase::HeaderParse);
+        std::array<uint8_t, SIGNATURE_HEADER_SIZE> start{};
+        if (input.size() < start.size()) {
+            corrupted("archive too small");
+        }
+        input.readAt(0, std::as_writable_bytes(std::span(start)));
+
+        if (!std::equal(SIGNATURE.begin(), SIGNATURE.end(), start.begin())) {
+            throw UnsupportedFormatException("not a 7z archive");
+        }
+        if (start[6] != 0) {
+            throw UnsupportedFormatException(fmt::format("7z format version {}.{}", start[6], start[7]));
+        }
+        if (crc32(std::span(start).subspan(12)) != readUint32(start.data() + 8)) {
+            corrupted("start header CRC mismatch");
+        }
+
+        const uint64_t next_offset = readUint64(start.data() + 12);
+        const uint64_t next_size = readUint64(start.data() + 20);
+        const uint32_t next_crc = readUint32(start.data() + 28);
+
+        Database db;
+        if (next_size == 0) {
+            return db;    // Empty archive
+        }
+        if (next_size > MAX_HEADER_SIZE || next_offset > input.size() - SIGNATURE_HEADER_SIZE ||
+            next_size > input.size() - SIGNATURE_HEADER_SIZE - next_offset) {
+            corrupted("header extends past end of archive");
+        }
+
+        std::vector<uint8_t> header(static_cast<size_t>(next_size));
+        input.readAt(SIGNATURE_HEADER_SIZE + next_offset, std::as_writable_bytes(std::span(header)));
+        if (crc32(header) != next_crc) {
+            corrupted("header CRC mismatch");
+        }
+
+        // Encoded headers are themselves stored in a folder; 7-Zip compresses
+        // the header by default, and may in principle nest it. The depth is
+        // bounded: an encoded header can point back at its own bytes.
+        for (size_t depth = 0;; ++depth) {
+            HeaderReader reader(header);
+            const uint8_t id = reader.byte();
+            if (id == Property::HEADER) {
+                readHeader(reader, db, input.size());
+                break;
+            }
+            if (id != Property::ENCODED_HEADER) {
+                corrupted("unknown header type");
+            }
+            if (depth == MAX_HEADER_ENCODING_DEPTH) {
+                corrupted("header encoded too many times");
+            }
+
+            Database encoded;
+            StreamsInfo streams = readStreamsInfo(reader);
+            attachStreams(encoded, streams, input.size());
+            if (encoded.folders.empty()) {
+                corrupted("encoded header has no data");
+            }
+            header = decodeToMemory(input, encoded, 0);
+        }
+
+        spdlog::debug("7z archive {}: {} files in {} folders", input.path().string(), db.files.size(), db.folders.size());
+        return db;
+    }
+
+    uint64_t decoderMemoryUsage(const Folder& folder) {
+        try {
+            FilterChain chain(folder);
+            if (chain.isCopy()) {
+                return 0;
+            }
+            const uint64_t usage = lzma_raw_decoder_memusage(chain.filters());
+            return usage == UINT64_MAX ? 0 : usage;
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+
+    void decodeFolder(const ArchiveInput& input,
+                      const Database& database,
+                      size_t folder_index,
+                      const ChunkSink& sink,
+                      const std::atomic<bool>* cancelled) {
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        const Folder& folder = database.folders.at(folder_index);
+        FilterChain chain(folder);
+
+        const uint64_t pack_offset = database.pack_offsets.at(folder.first_pack_stream);
+        const uint64_t pack_size = database.pack_sizes.at(folder.first_pack_stream);
+        const uint64_t unpack_size = folder.unpack_sizes.at(chain.mainOutput());
+
+        // Folders are decoded one after another per worker; the pool hands back the last one's decoder
+        const IO::PooledLzma pooled_stream = IO::acquireLzmaStream();
+        lzma_stream& stream = *pooled_stream;
+        if (!chain.isCopy()) {
+            const lzma_ret ret = lzma_raw_decoder(&stream, chain.filters());
+            if (ret != LZMA_OK) {
+                throw CompressionException(fmt::format("Cannot initialize 7z decoder (liblzma error {})", static_cast<int>(ret)));
+            }
+        }
+
+        const auto in_size = static_cast<size_t>(std::min<uint64_t>(pack_size, Constants::LARGE_BUFFER_SIZE));
+        const IO::PooledBuffer in_buffer = IO::acquireBuffer(in_size);
+        const IO::PooledBuffer out_buffer = IO::acquireBuffer(Constants::LARGE_BUFFER_SIZE);
+        const auto in = IO::bufferSpan(in_buffer, in_size);
+        const auto out = IO::bufferSpan(out_buffer, Constants::LARGE_BUFFER_SIZE);
+        uint64_t read = 0;
+        uint64_t produced = 0;
+        uint32_t crc = 0;
+
+        auto emit = [&](std::span<const std::byte> chunk) {
+            if (chunk.size() > unpack_size - produced) {
+                chunk = chunk.first(static_cast<size_t>(unpack_size - produced));
+            }
+            if (chunk.empty()) {
+                return;
+            }
+            crc = lzma_crc32(reinterpret_cast<const uint8_t*>(chunk.data()), chunk.size(), crc);
+            produced += chunk.size();
+            sink(chunk);
+        };
+
+        while (produced < unpack_size) {
+            if (cancelled && *cancelled) {
+                throw OperationCancelledException();
+            }
+
+            if (stream.avail_in == 0 && read < pack_size) {
+                const auto chunk = static_cast<size_t>(std::min<uint64_t>(in.size(), pack_size - read));
+                input.readAt(pack_offset + read, std::span(in).first(chunk));
+                read += chunk;
+                stream.next_in = reinterpret_cast<const uint8_t*>(in.data());
+                stream.avail_in = chunk;
+            }
+
+            if (chain.isCopy()) {
+                if (stream.avail_in == 0) {
+                    corrupted("folder data truncated");
+                }
+                emit({reinterpret_cast<const std::byte*>(stream.next_in), stream.avail_in});
+                stream.avail_in = 0;
+                continue;
+            }
+
+            stream.next_out = reinterpret_cast<uint8_t*>(out.data());
+            stream.avail_out = out.size();
+            // LZMA1 streams usually lack an end marker, so decoding stops on size
+            const lzma_ret ret = lzma_code(&stream, read < pack_size ? LZMA_RUN : LZMA_FINISH);
+            const size_t decoded = out.size() - stream.avail_out;
+            emit(std::span(out).first(decoded));
+
+            if (ret == LZMA_STREAM_END) {
+                break;
+            }
+            if (ret != LZMA_OK) {
+                corrupted(fmt::format("folder {} data error (liblzma error {})", folder_index, static_cast<int>(ret)));
+            }
+            if (decoded == 0 && stream.avail_in == 0 && read >= pack_size) {
+                break;
+            }
+        }
+
+        if (produced != unpack_size) {
+            corrupted(fmt::format("folder {} is truncated", folder_index));
+        }
+        if (folder.crc && crc != *folder.crc) {
+            corrupted(fmt::format("folder {} CRC mismatch", folder_index));
+        }
+    }
+}
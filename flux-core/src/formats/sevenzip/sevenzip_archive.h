@@ -0,0 +1,188 @@
+#pragma once
+#include "io/mapped_file.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Flux::Formats::SevenZip {
+    inline constexpr std::array<uint8_t, 6> SIGNATURE = {'7', 'z', 0xBC, 0xAF, 0x27, 0x1C};
+    inline constexpr size_t SIGNATURE_HEADER_SIZE = 32;
+    inline constexpr size_t NO_FOLDER = std::numeric_limits<size_t>::max();
+
+    // Header property IDs (7zFormat.txt)
+    namespace Property {
+        inline constexpr uint8_t END = 0x00;
+        inline constexpr uint8_t HEADER = 0x01;
+        inline constexpr uint8_t ARCHIVE_PROPERTIES = 0x02;
+        inline constexpr uint8_t ADDITIONAL_STREAMS_INFO = 0x03;
+        inline constexpr uint8_t MAIN_STREAMS_INFO = 0x04;
+        inline constexpr uint8_t FILES_INFO = 0x05;
+        inline constexpr uint8_t PACK_INFO = 0x06;
+        inline constexpr uint8_t UNPACK_INFO = 0x07;
+        inline constexpr uint8_t SUBSTREAMS_INFO = 0x08;
+        inline constexpr uint8_t SIZE = 0x09;
+        inline constexpr uint8_t CRC = 0x0A;
+        inline constexpr uint8_t FOLDER = 0x0B;
+        inline constexpr uint8_t CODERS_UNPACK_SIZE = 0x0C;
+        inline constexpr uint8_t NUM_UNPACK_STREAM = 0x0D;
+        inline constexpr uint8_t EMPTY_STREAM = 0x0E;
+        inline constexpr uint8_t EMPTY_FILE = 0x0F;
+        inline constexpr uint8_t ANTI = 0x10;
+        inline constexpr uint8_t NAME = 0x11;
+        inline constexpr uint8_t CTIME = 0x12;
+        inline constexpr uint8_t ATIME = 0x13;
+        inline constexpr uint8_t MTIME = 0x14;
+        inline constexpr uint8_t WIN_ATTRIBUTES = 0x15;
+        inline constexpr uint8_t COMMENT = 0x16;
+        inline constexpr uint8_t ENCODED_HEADER = 0x17;
+        inline constexpr uint8_t START_POS = 0x18;
+        inline constexpr uint8_t DUMMY = 0x19;
+    }
+
+    // Coder method IDs (Methods.txt)
+    namespace Method {
+        inline constexpr uint64_t COPY = 0x00;
+        inline constexpr uint64_t DELTA = 0x03;
+        inline constexpr uint64_t ARM64 = 0x0A;
+        inline constexpr uint64_t LZMA2 = 0x21;
+        inline constexpr uint64_t LZMA = 0x030101;
+        inline constexpr uint64_t BCJ_X86 = 0x03030103;
+        inline constexpr uint64_t BCJ2 = 0x0303011B;
+        inline constexpr uint64_t BCJ_PPC = 0x03030205;
+        inline constexpr uint64_t BCJ_IA64 = 0x03030401;
+        inline constexpr uint64_t BCJ_ARM = 0x03030501;
+        inline constexpr uint64_t BCJ_ARMT = 0x03030701;
+        inline constexpr uint64_t BCJ_SPARC = 0x03030805;
+        inline constexpr uint64_t AES256_SHA256 = 0x06F10701;
+    }
+
+    // Windows attribute bits used by 7z
+    inline constexpr uint32_t ATTRIBUTE_DIRECTORY = 0x10;
+    inline constexpr uint32_t ATTRIBUTE_UNIX_EXTENSION = 0x8000;    // High 16 bits hold st_mode
+
+    struct Coder {
+        uint64_t method = 0;
+        uint64_t num_in_streams = 1;
+        uint64_t num_out_streams = 1;
+        std::vector<uint8_t> properties;
+    };
+
+    struct BindPair {
+        uint64_t in_index = 0;     // Coder input stream fed by...
+        uint64_t out_index = 0;    // ...this coder output stream
+    };
+
+    /**
+     * Independently decodable unit: a coder graph reading pack streams
+     * and producing the concatenated data of one or more files
+     */
+    struct Folder {
+        std::vector<Coder> coders;
+        std::vector<BindPair> bind_pairs;
+        std::vector<uint64_t> packed_streams;    // Coder input stream index of each pack stream
+        std::vector<uint64_t> unpack_sizes;      // Size of every coder output stream
+        std::optional<uint32_t> crc;             // CRC of the folder output
+        size_t first_pack_stream = 0;            // Index of its first pack stream in the archive
+        uint64_t num_unpack_streams = 1;         // Number of files stored in the folder
+
+        uint64_t unpackSize() const;
+        uint64_t totalInStreams() const;
+        uint64_t totalOutStreams() const;
+    };
+
+    struct FileEntry {
+        std::string name;                        // UTF-8 path with '/' separators
+        uint64_t size = 0;
+        bool has_stream = false;
+        bool is_directory = false;
+        bool is_anti = false;
+        std::optional<uint32_t> crc;
+        std::optional<uint64_t> mtime;           // FILETIME (100ns since 1601-01-01)
+        std::optional<uint32_t> attributes;
+        size_t folder = NO_FOLDER;               // Folder holding the data, if any
+
+        std::optional<uint32_t> unixMode() const;
+        std::optional<std::chrono::system_clock::time_point> modificationTime() const;
+    };
+
+    /**
+     * Parsed archive headers
+     */
+    struct Database {
+        std::vector<uint64_t> pack_sizes;
+        std::vector<uint64_t> pack_offsets;              // Absolute file offset of each pack stream
+        std::vector<std::optional<uint32_t>> pack_crcs;
+        std::vector<Folder> folders;
+        std::vector<FileEntry> files;
+        std::vector<std::vector<size_t>> folder_files;   // Files of each folder, in stream order
+
+        uint64_t packSize(size_t folder) const;
+        bool isEncrypted() const;
+    };
+
+    /**
+     * Random-access, thread-safe read-only view of an archive file
+     */
+    class ArchiveInput {
+    public:
+        explicit ArchiveInput(const std::filesystem::path& path);
+
+        const std::filesystem::path& path() const noexcept { return m_path; }
+        uint64_t size() const noexcept { return m_size; }
+
+        /**
+         * Read exactly buffer.size() bytes at offset
+         * @throws CorruptedArchiveException when the range is past the end
+         */
+        void readAt(uint64_t offset, std::span<std::byte> buffer) const;
+
+    private:
+        std::filesystem::path m_path;
+        uint64_t m_size = 0;
+        std::unique_ptr<IO::MappedFile> m_mapping;
+        mutable std::ifstream m_file;      // Used when the file cannot be mapped
+        mutable std::mutex m_file_mutex;
+    };
+
+    /**
+     * Read and decode the archive headers, including compressed (encoded) headers
+     * @throws CorruptedArchiveException, UnsupportedFormatException
+     */
+    [[nodiscard]] Database readDatabase(const ArchiveInput& input);
+
+    /**
+     * Receives decoded folder output in order
+     */
+    using ChunkSink = std::function<void(std::span<const std::byte>)>;
+
+    /**
+     * Decode one folder, streaming its output into sink
+     *
+     * The folder CRC is verified when the archive stores one. Supported coders:
+     * Copy, LZMA, LZMA2, Delta and the BCJ branch filters, chained linearly.
+     * @param cancelled Optional flag polled between chunks
+     * @throws CorruptedArchiveException, UnsupportedFormatException, OperationCancelledException
+     */
+    void decodeFolder(const ArchiveInput& input,
+                      const Database& database,
+                      size_t folder_index,
+                      const ChunkSink& sink,
+                      const std::atomic<bool>* cancelled = nullptr);
+
+    /**
+     * Estimated decoder memory for a folder in bytes (0 if unknown)
+     */
+    [[nodiscard]] uint64_t decoderMemoryUsage(const Folder& folder);
+}
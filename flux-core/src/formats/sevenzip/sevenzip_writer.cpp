@@ -0,0 +1,427 @@
+#include "formats/sevenzip/sevenzip_writer.h"
+#include "flux-core/exceptions.h"
+#include "io/codec_pool.h"
+#include "utils/operation_metrics.h"
+#include <fmt/format.h>
+#include <algorithm>
+
+namespace Flux::Formats::SevenZip {
+    namespace {
+        constexpr int64_t FILETIME_UNIX_OFFSET = 11644473600LL;
+
+        /**
+         * Append-only buffer with the 7z primitive encodings
+         */
+        class HeaderWriter {
+        public:
+            void byte(uint8_t value) { m_data.push_back(value); }
+
+            void uint32(uint32_t value) {
+                for (int i = 0; i < 4; ++i) {
+                    byte(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            void uint64(uint64_t value) {
+                uint32(static_cast<uint32_t>(value));
+                uint32(static_cast<uint32_t>(value >> 32));
+            }
+
+            /**
+             * 7z variable-length integer (inverse of the reader's number())
+             */
+            void number(uint64_t value) {
+                uint8_t first = 0;
+                uint8_t mask = 0x80;
+                int extra = 0;
+                for (; extra < 8; ++extra) {
+                    if (value < (uint64_t{1} << (7 * (extra + 1)))) {
+                        first |= static_cast<uint8_t>(value >> (8 * extra));
+                        break;
+                    }
+                    first |= mask;
+                    mask >>= 1;
+                }
+                byte(first);
+                for (int i = 0; i < extra; ++i) {
+                    byte(static_cast<uint8_t>(value >> (8 * i)));
+                }
+            }
+
+            void bytes(std::span<const uint8_t> data) { m_data.insert(m_data.end(), data.begin(), data.end()); }
+
+            void bitField(const std::vector<bool>& bits) {
+                uint8_t current = 0;
+                for (size_t i = 0; i < bits.size(); ++i) {
+                    if (bits[i]) {
+                        current |= static_cast<uint8_t>(0x80 >> (i % 8));
+                    }
+                    if (i % 8 == 7) {
+                        byte(current);
+                        current = 0;
+                    }
+                }
+                if (bits.size() % 8 != 0) {
+                    byte(current);
+                }
+            }
+
+            /**
+             * Property id, size and body
+             */
+            void property(uint8_t id, const HeaderWriter& body) {
+                byte(id);
+                number(body.m_data.size());
+                bytes(body.m_data);
+            }
+
+            std::vector<uint8_t>& data() noexcept { return m_data; }
+
+        private:
+            std::vector<uint8_t> m_data;
+        };
+
+        void writeFolder(HeaderWriter& out, const Folder& folder) {
+            out.number(folder.coders.size());
+            for (const auto& coder : folder.coders) {
+                uint8_t id[8];
+                int id_size = 0;
+                for (uint64_t method = coder.method; id_size == 0 || method != 0; method >>= 8) {
+                    id[id_size++] = static_cast<uint8_t>(method);
+                }
+                std::reverse(id, id + id_size);
+
+                const bool complex = coder.num_in_streams != 1 || coder.num_out_streams != 1;
+                uint8_t flags = static_cast<uint8_t>(id_size);
+                if (complex) {
+                    flags |= 0x10;
+                }
+                if (!coder.properties.empty()) {
+                    flags |= 0x20;
+                }
+                out.byte(flags);
+                out.bytes({id, static_cast<size_t>(id_size)});
+                if (complex) {
+                    out.number(coder.num_in_streams);
+                    out.number(coder.num_out_streams);
+                }
+                if (!coder.properties.empty()) {
+                    out.number(coder.properties.size());
+                    out.bytes(coder.properties);
+                }
+            }
+            for (const auto& pair : folder.bind_pairs) {
+                out.number(pair.in_index);
+                out.number(pair.out_index);
+            }
+            if (folder.packed_streams.size() > 1) {
+                for (uint64_t index : folder.packed_streams) {
+                    out.number(index);
+                }
+            }
+        }
+
+        void writeStreamsInfo(HeaderWriter& out,
+                              uint64_t pack_pos,
+                              const std::vector<uint64_t>& pack_sizes,
+                              const std::vector<Folder>& folders,
+                              const std::vector<const FileEntry*>* stream_files) {
+            out.byte(Property::PACK_INFO);
+            out.number(pack_pos);
+            out.number(pack_sizes.size());
+            out.byte(Property::SIZE);
+            for (uint64_t size : pack_sizes) {
+                out.number(size);
+            }
+            out.byte(Property::END);
+
+            out.byte(Property::UNPACK_INFO);
+            out.byte(Property::FOLDER);
+            out.number(folders.size());
+            out.byte(0);    // Not external
+            for (const auto& folder : folders) {
+                writeFolder(out, folder);
+            }
+            out.byte(Property::CODERS_UNPACK_SIZE);
+            for (const auto& folder : folders) {
+                for (uint64_t size : folder.unpack_sizes) {
+                    out.number(size);
+                }
+            }
+            const bool folder_crcs = std::all_of(folders.begin(), folders.end(),
+                                                 [](const Folder& folder) { return folder.crc.has_value(); });
+            if (folder_crcs && !folders.empty()) {
+                out.byte(Property::CRC);
+                out.byte(1);    // All defined
+                for (const auto& folder : folders) {
+                    out.uint32(*folder.crc);
+                }
+            }
+            out.byte(Property::END);
+
+            if (stream_files) {
+                out.byte(Property::SUBSTREAMS_INFO);
+                const bool all_single = std::all_of(folders.begin(), folders.end(),
+                                                    [](const Folder& folder) { return folder.num_unpack_streams == 1; });
+                if (!all_single) {
+                    out.byte(Property::NUM_UNPACK_STREAM);
+                    for (const auto& folder : folders) {
+                        out.number(folder.num_unpack_streams);
+                    }
+                    out.byte(Property::SIZE);
+                    size_t next = 0;
+                    for (const auto& folder : folders) {
+                        for (uint64_t i = 0; i < folder.num_unpack_streams; ++i, ++next) {
+                            if (i + 1 < folder.num_unpack_streams) {
+                                out.number((*stream_files)[next]->size);
+                            }
+                        }
+                    }
+                }
+
+                // Digests for streams whose CRC the folder does not already give
+                std::vector<uint32_t> crcs;
+                std::vector<bool> defined;
+                size_t next = 0;
+                for (const auto& folder : folders) {
+                    const bool implied = folder.num_unpack_streams == 1 && folder.crc;
+                    for (uint64_t i = 0; i < folder.num_unpack_streams; ++i, ++next) {
+                        if (!implied) {
+                            const auto& crc = (*stream_files)[next]->crc;
+                            defined.push_back(crc.has_value());
+                            crcs.push_back(crc.value_or(0));
+                        }
+                    }
+                }
+                if (!crcs.empty()) {
+                    out.byte(Property::CRC);
+                    const bool all_defined = std::all_of(defined.begin(), defined.end(), [](bool d) { return d; });
+                    out.byte(all_defined ? 1 : 0);
+                    if (!all_defined) {
+                        out.bitField(defined);
+                    }
+                    for (size_t i = 0; i < crcs.size(); ++i) {
+                        if (defined[i]) {
+                            out.uint32(crcs[i]);
+                        }
+                    }
+                }
+                out.byte(Property::END);
+            }
+            out.byte(Property::END);
+        }
+
+        void writeFilesInfo(HeaderWriter& out, const std::vector<FileEntry>& files) {
+            out.byte(Property::FILES_INFO);
+            out.number(files.size());
+
+            std::vector<bool> empty_stream;
+            std::vector<bool> empty_file;
+            for (const auto& file : files) {
+                empty_stream.push_back(!file.has_stream);
+                if (!file.has_stream) {
+                    empty_file.push_back(!file.is_directory);
+                }
+            }
+            if (!empty_file.empty()) {
+                HeaderWriter body;
+                body.bitField(empty_stream);
+                out.property(Property::EMPTY_STREAM, body);
+                if (std::find(empty_file.begin(), empty_file.end(), true) != empty_file.end()) {
+                    HeaderWriter files_body;
+                    files_body.bitField(empty_file);
+                    out.property(Property::EMPTY_FILE, files_body);
+                }
+            }
+
+            {
+                HeaderWriter body;
+                body.byte(0);    // Not external
+                for (const auto& file : files) {
+                    // UTF-8 -> NUL-terminated UTF-16LE
+                    const auto& name = file.name;
+                    for (size_t i = 0; i < name.size();) {
+                        uint32_t code = static_cast<uint8_t>(name[i]);
+                        int extra = code >= 0xF0 ? 3 : code >= 0xE0 ? 2 : code >= 0xC0 ? 1 : 0;
+                        if (extra > 0) {
+                            code &= 0x3Fu >> extra;
+                        }
+                        ++i;
+                        for (; extra > 0 && i < name.size(); --extra, ++i) {
+                            code = (code << 6) | (static_cast<uint8_t>(name[i]) & 0x3F);
+                        }
+                        auto unit = [&body](uint32_t value) {
+                            body.byte(static_cast<uint8_t>(value));
+                            body.byte(static_cast<uint8_t>(value >> 8));
+                        };
+                        if (code >= 0x10000) {
+                            code -= 0x10000;
+                            unit(0xD800 + (code >> 10));
+                            unit(0xDC00 + (code & 0x3FF));
+                        } else {
+                            unit(code);
+                        }
+                    }
+                    body.byte(0);
+                    body.byte(0);
+                }
+                out.property(Property::NAME, body);
+            }
+
+            if (std::any_of(files.begin(), files.end(), [](const FileEntry& file) { return file.mtime.has_value(); })) {
+                HeaderWriter body;
+                std::vector<bool> defined;
+                for (const auto& file : files) {
+                    defined.push_back(file.mtime.has_value());
+                }
+                const bool all_defined = std::all_of(defined.begin(), defined.end(), [](bool d) { return d; });
+                body.byte(all_defined ? 1 : 0);
+                if (!all_defined) {
+                    body.bitField(defined);
+                }
+                body.byte(0);    // Not external
+                for (const auto& file : files) {
+                    if (file.mtime) {
+                        body.uint64(*file.mtime);
+                    }
+                }
+                out.property(Property::MTIME, body);
+            }
+
+            if (std::any_of(files.begin(), files.end(), [](const FileEntry& file) { return file.attributes.has_value(); })) {
+                HeaderWriter body;
+                std::vector<bool> defined;
+                for (const auto& file : files) {
+                    defined.push_back(file.attributes.has_value());
+                }
+                const bool all_defined = std::all_of(defined.begin(), defined.end(), [](bool d) { return d; });
+                body.byte(all_defined ? 1 : 0);
+                if (!all_defined) {
+                    body.bitField(defined);
+                }
+                body.byte(0);    // Not external
+                for (const auto& file : files) {
+                    if (file.attributes) {
+                        body.uint32(*file.attributes);
+                    }
+                }
+                out.property(Property::WIN_ATTRIBUTES, body);
+            }
+
+            out.byte(Property::END);
+        }
+    }
+
+    std::vector<uint8_t> buildHeader(const Database& db) {
+        HeaderWriter out;
+        out.byte(Property::HEADER);
+
+        if (!db.folders.empty()) {
+            std::vector<const FileEntry*> stream_files;
+            for (const auto& file : db.files) {
+                if (file.has_stream) {
+                    stream_files.push_back(&file);
+                }
+            }
+            out.byte(Property::MAIN_STREAMS_INFO);
+            writeStreamsInfo(out, 0, db.pack_sizes, db.folders, &stream_files);
+        }
+        if (!db.files.empty()) {
+            writeFilesInfo(out, db.files);
+        }
+
+        out.byte(Property::END);
+        return std::move(out.data());
+    }
+
+    std::vector<uint8_t> buildEncodedHeader(uint64_t pack_pos, uint64_t pack_size, const Folder& folder) {
+        HeaderWriter out;
+        out.byte(Property::ENCODED_HEADER);
+        writeStreamsInfo(out, pack_pos, {pack_size}, {folder}, nullptr);
+        return std::move(out.data());
+    }
+
+    std::array<uint8_t, SIGNATURE_HEADER_SIZE> buildSignatureHeader(uint64_t next_header_offset,
+                                                                    uint64_t next_header_size,
+                                                                    uint32_t next_header_crc) {
+        HeaderWriter start;
+        start.uint64(next_header_offset);
+        start.uint64(next_header_size);
+        start.uint32(next_header_crc);
+
+        std::array<uint8_t, SIGNATURE_HEADER_SIZE> header{};
+        std::copy(SIGNATURE.begin(), SIGNATURE.end(), header.begin());
+        header[6] = 0;    // Format version 0.4
+        header[7] = 4;
+        const uint32_t start_crc = lzma_crc32(start.data().data(), start.data().size(), 0);
+        for (size_t i = 0; i < 4; ++i) {
+            header[8 + i] = static_cast<uint8_t>(start_crc >> (8 * i));
+        }
+        std::copy(start.data().begin(), start.data().end(), header.begin() + 12);
+        return header;
+    }
+
+    uint64_t toFileTime(std::chrono::system_clock::time_point time) {
+        using FileTimeTicks = std::chrono::duration<int64_t, std::ratio<1, 10'000'000>>;
+        const auto ticks = std::chrono::duration_cast<FileTimeTicks>(time.time_since_epoch()) +
+                           std::chrono::duration_cast<FileTimeTicks>(std::chrono::seconds(FILETIME_UNIX_OFFSET));
+        return ticks.count() < 0 ? 0 : static_cast<uint64_t>(ticks.count());
+    }
+
+    Coder lzma2Coder(const lzma_options_lzma& options) {
+        lzma_filter filter{LZMA_FILTER_LZMA2, const_cast<lzma_options_lzma*>(&options)};
+        uint32_t size = 0;
+        Coder coder;
+        coder.method = Method::LZMA2;
+        if (lzma_properties_size(&size, &filter) != LZMA_OK) {
+            throw CompressionException("Cannot size LZMA2 properties");
+        }
+        coder.properties.resize(size);
+        if (lzma_properties_encode(&filter, coder.properties.data()) != LZMA_OK) {
+            throw CompressionException("Cannot encode LZMA2 properties");
+        }
+        return coder;
+    }
+
+    std::vector<uint8_t> encodeLzma2Piece(std::span<const std::byte> data, const lzma_options_lzma& options) {
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        if (data.empty()) {
+            return {};
+        }
+
+        lzma_filter filters[] = {
+            {LZMA_FILTER_LZMA2, const_cast<lzma_options_lzma*>(&options)},
+            {LZMA_VLI_UNKNOWN, nullptr}
+        };
+        // Each worker encodes piece after piece; the pooled stream keeps its match finder allocated
+        const IO::PooledLzma pooled_stream = IO::acquireLzmaStream();
+        lzma_stream& stream = *pooled_stream;
+        lzma_ret ret = lzma_raw_encoder(&stream, filters);
+        if (ret != LZMA_OK) {
+            throw CompressionException(fmt::format("Cannot initialize LZMA2 encoder (liblzma error {})", static_cast<int>(ret)));
+        }
+
+        // Incompressible data grows by about 3 bytes per 64KB chunk
+        std::vector<uint8_t> output(data.size() + data.size() / 1024 + 64);
+        stream.next_in = reinterpret_cast<const uint8_t*>(data.data());
+        stream.avail_in = data.size();
+        stream.next_out = output.data();
+        stream.avail_out = output.size();
+        do {
+            if (stream.avail_out == 0) {
+                const size_t used = output.size();
+                output.resize(used * 2);
+                stream.next_out = output.data() + used;
+                stream.avail_out = output.size() - used;
+            }
+            ret = lzma_code(&stream, LZMA_FINISH);
+        } while (ret == LZMA_OK);
+        output.resize(output.size() - stream.avail_out);
+
+        if (ret != LZMA_STREAM_END || output.empty() || output.back() != LZMA2_END_MARKER) {
+            throw CompressionException(fmt::format("LZMA2 encoding failed (liblzma error {})", static_cast<int>(ret)));
+        }
+        output.pop_back();
+        return output;
+    }
+}
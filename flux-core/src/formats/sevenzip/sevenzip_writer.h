@@ -0,0 +1,55 @@
+#pragma once
+#include "formats/sevenzip/sevenzip_archive.h"
+#include <lzma.h>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace Flux::Formats::SevenZip {
+    /**
+     * Serialize a plain header (kHeader)
+     *
+     * Uses db.pack_sizes, the folders' coders, unpack sizes and stream counts,
+     * and db.files. Files with a stream must be listed in folder order.
+     */
+    [[nodiscard]] std::vector<uint8_t> buildHeader(const Database& db);
+
+    /**
+     * Serialize an encoded header (kEncodedHeader) pointing at a compressed header
+     * @param pack_pos Offset of the compressed header after the signature header
+     * @param pack_size Size of the compressed header
+     * @param folder Folder that decodes it; its CRC should be set
+     */
+    [[nodiscard]] std::vector<uint8_t> buildEncodedHeader(uint64_t pack_pos, uint64_t pack_size, const Folder& folder);
+
+    /**
+     * Signature header pointing at the next (plain or encoded) header
+     */
+    [[nodiscard]] std::array<uint8_t, SIGNATURE_HEADER_SIZE> buildSignatureHeader(
+        uint64_t next_header_offset, uint64_t next_header_size, uint32_t next_header_crc);
+
+    /**
+     * Convert to FILETIME (100ns since 1601-01-01)
+     */
+    [[nodiscard]] uint64_t toFileTime(std::chrono::system_clock::time_point time);
+
+    /**
+     * Coder entry describing raw LZMA2 with the given options
+     */
+    [[nodiscard]] Coder lzma2Coder(const lzma_options_lzma& options);
+
+    /**
+     * Compress data as a self-contained run of LZMA2 chunks
+     *
+     * The output starts with a dictionary reset and has no end marker, so
+     * independently encoded pieces can be concatenated into one stream; the
+     * writer terminates each folder with LZMA2_END_MARKER.
+     * @throws CompressionException
+     */
+    [[nodiscard]] std::vector<uint8_t> encodeLzma2Piece(std::span<const std::byte> data, const lzma_options_lzma& options);
+
+    inline constexpr uint8_t LZMA2_END_MARKER = 0x00;
+}
@@ -0,0 +1,383 @@
+#include "io/async_file_writer.h"
+#include "flux-core/trace.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <thread>
+
+#ifdef FLUX_HAVE_IO_URING
+#include <liburing.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace Flux::IO {
+    namespace {
+        /**
+         * Apply permissions and modification time after the content is written
+         * @return Error description, empty on success
+         */
+        std::string applyMetadata(const FileWriteRequest& request) {
+            Utils::PhaseTimer timer(Utils::Phase::MetadataApply);
+            std::error_code ec;
+            if (request.permissions) {
+                Utils::countSyscalls();
+                std::filesystem::permissions(request.path,
+                                             static_cast<std::filesystem::perms>(*request.permissions & RESTORABLE_MODE_BITS),
+                                             std::filesystem::perm_options::replace, ec);
+                if (ec) {
+                    return fmt::format("Cannot set permissions: {}", ec.message());
+                }
+            }
+            if (request.mtime) {
+                Utils::countSyscalls();
+                std::filesystem::last_write_time(request.path,
+                                                 std::filesystem::file_time_type::clock::from_sys(*request.mtime), ec);
+                if (ec) {
+                    return fmt::format("Cannot set modification time: {}", ec.message());
+                }
+            }
+            return {};
+        }
+
+        /**
+         * Portable backend: a few threads perform the blocking syscalls
+         *
+         * The caller keeps decoding while up to queue_depth files are written in
+         * the background, which hides most of the per-file syscall latency.
+         */
+        class ThreadedFileWriter final : public AsyncFileWriter {
+        public:
+            ThreadedFileWriter(CompletionHandler on_complete, unsigned queue_depth)
+                : m_on_complete(std::move(on_complete)),
+                  m_queue_depth(std::max(queue_depth, 1u)),
+                  m_metrics(Utils::currentMetrics()) {
+                const unsigned threads = std::min(Utils::resolveThreadCount(0), 4u);
+                for (unsigned i = 0; i < threads; ++i) {
+                    m_threads.emplace_back([this] { run(); });
+                }
+            }
+
+            ~ThreadedFileWriter() override {
+                drain();
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    m_stopping = true;
+                }
+                m_work_available.notify_all();
+                for (auto& thread : m_threads) {
+                    thread.join();
+                }
+            }
+
+            void submit(FileWriteRequest request) override {
+                if (m_metrics) {
+                    m_metrics->bufferAcquired(request.data.size());
+                }
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_space_available.wait(lock, [this] { return m_queue.size() < m_queue_depth; });
+                m_queue.push_back(std::move(request));
+                ++m_pending;
+                lock.unlock();
+                m_work_available.notify_one();
+            }
+
+            void drain() override {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_all_done.wait(lock, [this] { return m_pending == 0; });
+            }
+
+            std::string_view backendName() const noexcept override { return "threads"; }
+
+        private:
+            void run() {
+                Utils::MetricsScope scope(m_metrics);
+                for (;;) {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_work_available.wait(lock, [this] { return m_stopping || !m_queue.empty(); });
+                    if (m_queue.empty()) {
+                        return;
+                    }
+                    FileWriteRequest request = std::move(m_queue.front());
+                    m_queue.pop_front();
+                    lock.unlock();
+                    m_space_available.notify_one();
+
+                    std::string error = write(request);
+                    if (m_metrics) {
+                        m_metrics->bufferReleased(request.data.size());
+                    }
+                    if (m_on_complete) {
+                        m_on_complete(request, error);
+                    }
+
+                    lock.lock();
+                    if (--m_pending == 0) {
+                        m_all_done.notify_all();
+                    }
+                }
+            }
+
+            static std::string write(const FileWriteRequest& request) {
+                FLUX_TRACE_SPAN("io.write_file", request.path);
+                {
+                    Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+                    Utils::countSyscalls(3);    // open, write, close
+                    std::ofstream file(request.path, std::ios::binary | std::ios::trunc);
+                    if (!file.is_open()) {
+                        return fmt::format("Cannot create output file: {}", request.path.string());
+                    }
+                    file.write(reinterpret_cast<const char*>(request.data.data()),
+                               static_cast<std::streamsize>(request.data.size()));
+                    file.close();
+                    if (file.fail()) {
+                        return fmt::format("Cannot write output file: {}", request.path.string());
+                    }
+                }
+                return applyMetadata(request);
+            }
+
+            CompletionHandler m_on_complete;
+            const size_t m_queue_depth;
+            std::mutex m_mutex;
+            std::condition_variable m_work_available;
+            std::condition_variable m_space_available;
+            std::condition_variable m_all_done;
+            std::deque<FileWriteRequest> m_queue;
+            size_t m_pending = 0;
+            bool m_stopping = false;
+            Utils::MetricsRecorder* m_metrics;    // Operation the writer threads work for
+            std::vector<std::thread> m_threads;
+        };
+
+#ifdef FLUX_HAVE_IO_URING
+        /**
+         * Process umask, read without the racy umask() set-and-restore
+         */
+        mode_t processUmask() {
+            static const mode_t mask = [] {
+                std::ifstream status("/proc/self/status");
+                std::string line;
+                while (std::getline(status, line)) {
+                    if (line.starts_with("Umask:")) {
+                        return static_cast<mode_t>(std::stoul(line.substr(6), nullptr, 8));
+                    }
+                }
+                return static_cast<mode_t>(022);
+            }();
+            return mask;
+        }
+
+        /**
+         * io_uring backend
+         *
+         * Every file is one hard-linked chain openat(direct) -> write -> close on
+         * a registered file slot, so no file descriptor ever reaches user space.
+         * Chains accumulate until all slots are busy and then go to the kernel in
+         * one io_uring_enter, which also reaps the previous batch.
+         * Not thread-safe: use one writer per thread.
+         */
+        class UringFileWriter final : public AsyncFileWriter {
+        public:
+            static std::unique_ptr<UringFileWriter> create(CompletionHandler on_complete, unsigned queue_depth) {
+                std::unique_ptr<UringFileWriter> writer(new UringFileWriter(std::move(on_complete), queue_depth));
+                if (io_uring_queue_init(OPS_PER_FILE * writer->m_slots.size(), &writer->m_ring, 0) < 0) {
+                    return nullptr;
+                }
+                writer->m_ring_ready = true;
+                // Sparse tables need Linux 5.19, which also guarantees direct open/close (5.15)
+                if (io_uring_register_files_sparse(&writer->m_ring, static_cast<unsigned>(writer->m_slots.size())) < 0) {
+                    return nullptr;
+                }
+                return writer;
+            }
+
+            ~UringFileWriter() override {
+                if (m_ring_ready) {
+                    try {
+                        drain();
+                    } catch (const std::exception& e) {
+                        spdlog::warn("Error draining io_uring writer: {}", e.what());
+                    }
+                    io_uring_queue_exit(&m_ring);
+                }
+            }
+
+            void submit(FileWriteRequest request) override {
+                while (m_free_slots.empty()) {
+                    reap(1);
+                }
+                const unsigned slot = m_free_slots.back();
+                m_free_slots.pop_back();
+
+                Slot& entry = m_slots[slot];
+                entry.request = std::move(request);
+                entry.error.clear();
+                if (m_metrics) {
+                    m_metrics->bufferAcquired(entry.request.data.size());
+                }
+                entry.remaining = OPS_PER_FILE;
+
+                const mode_t mode = entry.request.permissions ? static_cast<mode_t>(*entry.request.permissions & RESTORABLE_MODE_BITS) : 0666;
+
+                io_uring_sqe* open_sqe = io_uring_get_sqe(&m_ring);
+                io_uring_prep_openat_direct(open_sqe, AT_FDCWD, entry.request.path.c_str(),
+                                            O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode, slot);
+                io_uring_sqe_set_flags(open_sqe, IOSQE_IO_HARDLINK);
+                io_uring_sqe_set_data64(open_sqe, userData(slot, Op::Open));
+
+                io_uring_sqe* write_sqe = io_uring_get_sqe(&m_ring);
+                io_uring_prep_write(write_sqe, static_cast<int>(slot), entry.request.data.data(),
+                                    static_cast<unsigned>(entry.request.data.size()), 0);
+                io_uring_sqe_set_flags(write_sqe, IOSQE_FIXED_FILE | IOSQE_IO_HARDLINK);
+                io_uring_sqe_set_data64(write_sqe, userData(slot, Op::Write));
+
+                io_uring_sqe* close_sqe = io_uring_get_sqe(&m_ring);
+                io_uring_prep_close_direct(close_sqe, slot);
+                io_uring_sqe_set_data64(close_sqe, userData(slot, Op::Close));
+
+                ++m_in_flight;
+            }
+
+            void drain() override {
+                while (m_in_flight > 0) {
+                    reap(m_in_flight);
+                }
+            }
+
+            std::string_view backendName() const noexcept override { return "io_uring"; }
+
+        private:
+            static constexpr unsigned OPS_PER_FILE = 3;
+
+            enum class Op : uint64_t { Open = 0, Write = 1, Close = 2 };
+
+            struct Slot {
+                FileWriteRequest request;
+                std::string error;
+                unsigned remaining = 0;
+            };
+
+            UringFileWriter(CompletionHandler on_complete, unsigned queue_depth)
+                : m_on_complete(std::move(on_complete)),
+                  m_slots(std::max(queue_depth, 1u)),
+                  m_metrics(Utils::currentMetrics()) {
+                for (unsigned slot = static_cast<unsigned>(m_slots.size()); slot-- > 0;) {
+                    m_free_slots.push_back(slot);
+                }
+            }
+
+            static uint64_t userData(unsigned slot, Op op) {
+                return (static_cast<uint64_t>(slot) << 2) | static_cast<uint64_t>(op);
+            }
+
+            /**
+             * Submit queued chains and wait until at least min_files files complete
+             */
+            void reap(size_t min_files) {
+                Utils::PhaseTimer timer(m_metrics, Utils::Phase::DiskWrite);
+                size_t completed = 0;
+                while (completed < min_files) {
+                    if (m_metrics) {
+                        m_metrics->addSyscalls(1);
+                    }
+                    const int submitted = io_uring_submit_and_wait(&m_ring, 1);
+                    if (submitted < 0 && submitted != -EINTR) {
+                        throw std::system_error(-submitted, std::generic_category(), "io_uring_submit_and_wait");
+                    }
+
+                    io_uring_cqe* cqe = nullptr;
+                    unsigned head = 0;
+                    unsigned seen = 0;
+                    io_uring_for_each_cqe(&m_ring, head, cqe) {
+                        ++seen;
+                        if (complete(cqe)) {
+                            ++completed;
+                        }
+                    }
+                    io_uring_cq_advance(&m_ring, seen);
+                }
+            }
+
+            /**
+             * Record one operation result
+             * @return true when this finished the whole file
+             */
+            bool complete(const io_uring_cqe* cqe) {
+                const uint64_t data = io_uring_cqe_get_data64(cqe);
+                const auto slot = static_cast<unsigned>(data >> 2);
+                const auto op = static_cast<Op>(data & 3);
+                Slot& entry = m_slots[slot];
+
+                if (entry.error.empty()) {
+                    if (cqe->res < 0) {
+                        static constexpr const char* OP_NAMES[] = {"open", "write", "close"};
+                        entry.error = fmt::format("Cannot {} {}: {}", OP_NAMES[static_cast<unsigned>(op)],
+                                                  entry.request.path.string(), std::strerror(-cqe->res));
+                    } else if (op == Op::Write && static_cast<size_t>(cqe->res) != entry.request.data.size()) {
+                        entry.error = fmt::format("Short write to {}", entry.request.path.string());
+                    }
+                }
+
+                if (--entry.remaining > 0) {
+                    return false;
+                }
+
+                finish(entry);
+                if (m_metrics) {
+                    m_metrics->bufferReleased(entry.request.data.size());
+                }
+                entry.request = {};
+                m_free_slots.push_back(slot);
+                --m_in_flight;
+                return true;
+            }
+
+            void finish(Slot& entry) {
+                if (entry.error.empty()) {
+                    // open() honoured the umask; restore exact bits only when it stripped some
+                    FileWriteRequest& request = entry.request;
+                    const bool mode_masked = request.permissions &&
+                                             ((*request.permissions & RESTORABLE_MODE_BITS) & processUmask()) != 0;
+                    if (!mode_masked) {
+                        request.permissions.reset();
+                    }
+                    entry.error = applyMetadata(request);
+                }
+                if (m_on_complete) {
+                    m_on_complete(entry.request, entry.error);
+                }
+            }
+
+            CompletionHandler m_on_complete;
+            io_uring m_ring{};
+            bool m_ring_ready = false;
+            std::vector<Slot> m_slots;
+            std::vector<unsigned> m_free_slots;
+            Utils::MetricsRecorder* m_metrics;
+            size_t m_in_flight = 0;
+        };
+#endif
+    }
+
+    std::unique_ptr<AsyncFileWriter> createAsyncFileWriter(AsyncFileWriter::CompletionHandler on_complete,
+                                                           unsigned queue_depth) {
+#ifdef FLUX_HAVE_IO_URING
+        if (auto writer = UringFileWriter::create(on_complete, queue_depth)) {
+            return writer;
+        }
+        spdlog::debug("io_uring unavailable, using threaded file writer");
+#endif
+        return std::make_unique<ThreadedFileWriter>(std::move(on_complete), queue_depth);
+    }
+}
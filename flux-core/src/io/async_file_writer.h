@@ -0,0 +1,77 @@
+#pragma once
+#include "flux-core/constants.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Flux::IO {
+    /**
+     * Mode bits an extractor restores for files whose owner it does not restore
+     *
+     * setuid and setgid are dropped, as archive_write_disk does without
+     * ARCHIVE_EXTRACT_OWNER: they would grant the extracting user's identity.
+     */
+    inline constexpr uint32_t RESTORABLE_MODE_BITS = 01777;
+
+    /**
+     * A complete small file to be created on disk
+     */
+    struct FileWriteRequest {
+        std::filesystem::path path;                                    // Output path (parent must exist)
+        std::vector<std::byte> data;                                   // Entire file content
+        std::optional<uint32_t> permissions;                           // Exact mode bits, within RESTORABLE_MODE_BITS (default: 0666 minus umask)
+        std::optional<std::chrono::system_clock::time_point> mtime;    // Modification time to restore
+    };
+
+    /**
+     * Writer that creates many small files without blocking the caller
+     *
+     * Requests are batched: on Linux with io_uring, open/write/close of up to
+     * queue-depth files go to the kernel in a single submission; elsewhere a
+     * small thread pool performs the syscalls. Files are created with O_TRUNC,
+     * so a request replaces any existing file.
+     */
+    class AsyncFileWriter {
+    public:
+        /**
+         * Called once per request when it finishes, possibly on another thread
+         * @param request The completed request
+         * @param error Empty on success, otherwise a description of the failure
+         */
+        using CompletionHandler = std::function<void(const FileWriteRequest& request, std::string_view error)>;
+
+        virtual ~AsyncFileWriter() = default;
+
+        /**
+         * Queue a file; blocks only while the queue is full
+         */
+        virtual void submit(FileWriteRequest request) = 0;
+
+        /**
+         * Wait until every submitted file has completed
+         */
+        virtual void drain() = 0;
+
+        /**
+         * @return Backend name for diagnostics ("io_uring" or "threads")
+         */
+        virtual std::string_view backendName() const noexcept = 0;
+    };
+
+    /**
+     * Create the fastest available writer
+     * @param on_complete Completion handler
+     * @param queue_depth Maximum number of files in flight
+     * @return Writer; never null (falls back to the portable backend)
+     */
+    [[nodiscard]] std::unique_ptr<AsyncFileWriter> createAsyncFileWriter(
+        AsyncFileWriter::CompletionHandler on_complete,
+        unsigned queue_depth = static_cast<unsigned>(Constants::Performance::IO_QUEUE_DEPTH)
+    );
+}
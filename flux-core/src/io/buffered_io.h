@@ -0,0 +1,103 @@
+#pragma once
+#include "io/codec_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace Flux::IO {
+    /**
+     * Pick the transfer block size for a file
+     *
+     * Small files get a buffer no larger than themselves, medium files
+     * LARGE_BUFFER_SIZE, and files past LARGE_FILE_THRESHOLD a few megabytes
+     * so per-call overhead disappears without pinning MAX_BUFFER_SIZE per thread.
+     * @param file_size File size in bytes (0 if unknown)
+     * @return Buffer size in bytes
+     */
+    [[nodiscard]] size_t chooseBufferSize(uint64_t file_size) noexcept;
+
+    /**
+     * Block reader for whole-file sequential reads
+     * Errors are reported by throwing FluxException.
+     */
+    class BufferedReader {
+    public:
+        /**
+         * @param path File to read
+         * @param buffer_size Block size (0 = chooseBufferSize of the file size)
+         */
+        explicit BufferedReader(const std::filesystem::path& path, size_t buffer_size = 0);
+
+        BufferedReader(const BufferedReader&) = delete;
+        BufferedReader& operator=(const BufferedReader&) = delete;
+
+        /**
+         * Read the next block
+         * @return Bytes read, valid until the next call; empty at end of file
+         */
+        std::span<const std::byte> read();
+
+        uint64_t fileSize() const noexcept { return m_file_size; }
+
+    private:
+        std::ifstream m_file;
+        PooledBuffer m_storage;
+        std::span<std::byte> m_buffer;   // Block-sized view of m_storage
+        uint64_t m_file_size = 0;
+    };
+
+    /**
+     * Block writer coalescing small writes into large ones
+     *
+     * Producers may either copy into the writer with write() or decode straight
+     * into its buffer with prepare()/commit(), which saves a copy.
+     * Errors are reported by throwing FluxException.
+     */
+    class BufferedWriter {
+    public:
+        /**
+         * @param path File to create (truncated if it exists)
+         * @param expected_size Expected final size, used to size the buffer (0 if unknown)
+         * @param buffer_size Block size (0 = chooseBufferSize of expected_size)
+         */
+        explicit BufferedWriter(const std::filesystem::path& path,
+                                uint64_t expected_size = 0,
+                                size_t buffer_size = 0);
+        ~BufferedWriter();
+
+        BufferedWriter(const BufferedWriter&) = delete;
+        BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+        /**
+         * @return Free buffer space to fill; never empty
+         */
+        std::span<std::byte> prepare();
+
+        /**
+         * Mark bytes written into the span from prepare() as used
+         */
+        void commit(size_t bytes);
+
+        void write(std::span<const std::byte> data);
+
+        /**
+         * Flush buffered data and close the file
+         */
+        void close();
+
+        uint64_t bytesWritten() const noexcept { return m_bytes_written + m_used; }
+
+    private:
+        void flush();
+
+        std::ofstream m_file;
+        PooledBuffer m_storage;
+        std::span<std::byte> m_buffer;   // Block-sized view of m_storage
+        size_t m_used = 0;
+        uint64_t m_bytes_written = 0;
+        bool m_closed = false;
+    };
+}
@@ -0,0 +1,341 @@
+#include "io/codec_pool.h"
+#include "flux-core/constants.h"
+#include "flux-core/exceptions.h"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+namespace Flux::IO {
+    namespace {
+        // Larger objects (long-distance zstd windows, xz presets past 6) are freed, not cached
+        constexpr size_t POOLED_MEMORY_LIMIT = 64 * 1024 * 1024;
+        // Smaller buffers come cheaply from malloc's arenas
+        constexpr size_t MIN_POOLED_BUFFER = 64 * 1024;
+
+        std::atomic<uint64_t> g_created{0};
+        std::atomic<uint64_t> g_reused{0};
+
+        /**
+         * Thread-local caches in front of one shared pool, for the kind of object Traits describes
+         *
+         * Traits provides Object, LOCAL_LIMIT, SHARED_LIMIT, destroy(), keep()
+         * (reset an object coming back, false to free it instead) and fits()
+         * (whether a cached object serves a request).
+         */
+        template <typename Traits>
+        class ObjectPool {
+        public:
+            using Object = typename Traits::Object;
+
+            // Never destroyed: thread caches may flush into it during exit, after static destructors ran
+            static ObjectPool& instance() {
+                static ObjectPool* const pool = new ObjectPool();
+                return *pool;
+            }
+
+            Object* take(size_t request) noexcept {
+                if (LocalCache* cache = localCache()) {
+                    if (Object* object = takeFrom(cache->items, request)) {
+                        return object;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return takeFrom(m_shared, request);
+            }
+
+            void give(Object* object) noexcept {
+                if (!Traits::keep(object)) {
+                    Traits::destroy(object);
+                    return;
+                }
+                LocalCache* cache = localCache();
+                if (cache && cache->items.size() < Traits::LOCAL_LIMIT) {
+                    cache->items.push_back(object);
+                    return;
+                }
+                giveShared(object);
+            }
+
+            void clear() noexcept {
+                if (LocalCache* cache = localCache()) {
+                    destroyAll(cache->items);
+                }
+                std::vector<Object*> shared;
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    shared.swap(m_shared);
+                    m_shared.reserve(Traits::SHARED_LIMIT);
+                }
+                destroyAll(shared);
+            }
+
+            size_t cached() noexcept {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_shared.size();
+            }
+
+        private:
+            struct LocalCache {
+                std::vector<Object*> items;
+
+                LocalCache() {
+                    items.reserve(Traits::LOCAL_LIMIT);
+                    t_cache = this;
+                }
+
+                // Runs at thread exit: later threads pick the objects up from the shared pool
+                ~LocalCache() {
+                    t_cache = nullptr;
+                    for (Object* object : items) {
+                        instance().giveShared(object);
+                    }
+                }
+            };
+
+            ObjectPool() {
+                m_shared.reserve(Traits::SHARED_LIMIT);
+            }
+
+            // Null once the thread's cache is destroyed, so releases during thread exit go to the shared pool
+            static LocalCache* localCache() noexcept {
+                thread_local LocalCache cache;
+                return t_cache;
+            }
+
+            static Object* takeFrom(std::vector<Object*>& items, size_t request) noexcept {
+                const auto found = std::find_if(items.begin(), items.end(),
+                                                [request](const Object* object) { return Traits::fits(object, request); });
+                if (found == items.end()) {
+                    return nullptr;
+                }
+                Object* object = *found;
+                *found = items.back();
+                items.pop_back();
+                g_reused.fetch_add(1, std::memory_order_relaxed);
+                return object;
+            }
+
+            void giveShared(Object* object) noexcept {
+                {
+                    std::lock_guard<std::mutex> lock(m_mutex);
+                    if (m_shared.size() < Traits::SHARED_LIMIT) {
+                        m_shared.push_back(object);
+                        return;
+                    }
+                }
+                Traits::destroy(object);
+            }
+
+            static void destroyAll(std::vector<Object*>& items) noexcept {
+                for (Object* object : items) {
+                    Traits::destroy(object);
+                }
+                items.clear();
+            }
+
+            static inline thread_local LocalCache* t_cache = nullptr;
+
+            std::mutex m_mutex;
+            std::vector<Object*> m_shared;
+        };
+
+        struct ZstdCCtxTraits {
+            using Object = ZSTD_CCtx;
+            static constexpr size_t LOCAL_LIMIT = 2;
+            static constexpr size_t SHARED_LIMIT = 16;
+
+            static void destroy(ZSTD_CCtx* cctx) noexcept { ZSTD_freeCCtx(cctx); }
+            static bool keep(ZSTD_CCtx* cctx) noexcept {
+                return !ZSTD_isError(ZSTD_CCtx_reset(cctx, ZSTD_reset_session_and_parameters)) &&
+                       ZSTD_sizeof_CCtx(cctx) <= POOLED_MEMORY_LIMIT;
+            }
+            static bool fits(const ZSTD_CCtx*, size_t) noexcept { return true; }
+        };
+
+        struct ZstdDCtxTraits {
+            using Object = ZSTD_DCtx;
+            static constexpr size_t LOCAL_LIMIT = 2;
+            static constexpr size_t SHARED_LIMIT = 16;
+
+            static void destroy(ZSTD_DCtx* dctx) noexcept { ZSTD_freeDCtx(dctx); }
+            static bool keep(ZSTD_DCtx* dctx) noexcept {
+                return !ZSTD_isError(ZSTD_DCtx_reset(dctx, ZSTD_reset_session_and_parameters)) &&
+                       ZSTD_sizeof_DCtx(dctx) <= POOLED_MEMORY_LIMIT;
+            }
+            static bool fits(const ZSTD_DCtx*, size_t) noexcept { return true; }
+        };
+
+        struct DeflateTraits {
+            using Object = z_stream;
+            static constexpr size_t LOCAL_LIMIT = 1;
+            static constexpr size_t SHARED_LIMIT = 8;
+
+            static void destroy(z_stream* stream) noexcept {
+                deflateEnd(stream);
+                delete stream;
+            }
+            // Reset when handed out, where the level is known
+            static bool keep(z_stream*) noexcept { return true; }
+            static bool fits(const z_stream*, size_t) noexcept { return true; }
+        };
+
+        struct LzmaTraits {
+            using Object = lzma_stream;
+            static constexpr size_t LOCAL_LIMIT = 1;
+            static constexpr size_t SHARED_LIMIT = 4;
+
+            static void destroy(lzma_stream* stream) noexcept {
+                lzma_end(stream);
+                delete stream;
+            }
+            static bool keep(lzma_stream* stream) noexcept {
+                return lzma_memusage(stream) <= POOLED_MEMORY_LIMIT;
+            }
+            static bool fits(const lzma_stream*, size_t) noexcept { return true; }
+        };
+
+        struct BufferTraits {
+            using Object = std::vector<std::byte>;
+            static constexpr size_t LOCAL_LIMIT = 4;
+            static constexpr size_t SHARED_LIMIT = 16;
+
+            static void destroy(std::vector<std::byte>* buffer) noexcept { delete buffer; }
+            static bool keep(std::vector<std::byte>* buffer) noexcept {
+                return buffer->size() >= MIN_POOLED_BUFFER && buffer->size() <= Constants::MAX_BUFFER_SIZE;
+            }
+            // Not so large that a small request pins a big buffer
+            static bool fits(const std::vector<std::byte>* buffer, size_t request) noexcept {
+                return buffer->size() >= request && buffer->size() / 4 <= request;
+            }
+        };
+
+        template <typename Traits>
+        ObjectPool<Traits>& pool() {
+            return ObjectPool<Traits>::instance();
+        }
+    }
+
+    void ZstdCCtxRelease::operator()(ZSTD_CCtx* cctx) const noexcept {
+        if (multithreaded) {
+            ZstdCCtxTraits::destroy(cctx);
+            return;
+        }
+        pool<ZstdCCtxTraits>().give(cctx);
+    }
+
+    void ZstdDCtxRelease::operator()(ZSTD_DCtx* dctx) const noexcept {
+        pool<ZstdDCtxTraits>().give(dctx);
+    }
+
+    void DeflateRelease::operator()(z_stream* stream) const noexcept {
+        pool<DeflateTraits>().give(stream);
+    }
+
+    void LzmaRelease::operator()(lzma_stream* stream) const noexcept {
+        pool<LzmaTraits>().give(stream);
+    }
+
+    void BufferRelease::operator()(std::vector<std::byte>* buffer) const noexcept {
+        if (metrics) {
+            metrics->bufferReleased(buffer->size());
+        }
+        pool<BufferTraits>().give(buffer);
+    }
+
+    PooledZstdCCtx acquireZstdCCtx() {
+        if (ZSTD_CCtx* cctx = pool<ZstdCCtxTraits>().take(0)) {
+            return PooledZstdCCtx(cctx);
+        }
+        PooledZstdCCtx cctx(ZSTD_createCCtx());
+        if (!cctx) {
+            throw CompressionException("Cannot initialize zstd compressor");
+        }
+        g_created.fetch_add(1, std::memory_order_relaxed);
+        return cctx;
+    }
+
+    PooledZstdDCtx acquireZstdDCtx() {
+        if (ZSTD_DCtx* dctx = pool<ZstdDCtxTraits>().take(0)) {
+            return PooledZstdDCtx(dctx);
+        }
+        PooledZstdDCtx dctx(ZSTD_createDCtx());
+        if (!dctx) {
+            throw CompressionException("Cannot initialize zstd decoder");
+        }
+        g_created.fetch_add(1, std::memory_order_relaxed);
+        return dctx;
+    }
+
+    PooledDeflate acquireGzipDeflate(int level) {
+        level = std::clamp(level, 0, 9);
+        if (z_stream* stream = pool<DeflateTraits>().take(0)) {
+            // Straight after a reset the level changes without flushing anything
+            PooledDeflate pooled(stream);
+            if (deflateReset(stream) == Z_OK && deflateParams(stream, level, Z_DEFAULT_STRATEGY) == Z_OK) {
+                return pooled;
+            }
+            DeflateTraits::destroy(pooled.release());
+        }
+
+        auto* stream = new z_stream{};
+        if (deflateInit2(stream, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+            delete stream;
+            throw CompressionException("Cannot initialize gzip compressor");
+        }
+        g_created.fetch_add(1, std::memory_order_relaxed);
+        return PooledDeflate(stream);
+    }
+
+    PooledLzma acquireLzmaStream() {
+        if (lzma_stream* stream = pool<LzmaTraits>().take(0)) {
+            // Coder initialization leaves the buffer pointers to the caller
+            stream->next_in = nullptr;
+            stream->avail_in = 0;
+            stream->next_out = nullptr;
+            stream->avail_out = 0;
+            return PooledLzma(stream);
+        }
+        g_created.fetch_add(1, std::memory_order_relaxed);
+        return PooledLzma(new lzma_stream(LZMA_STREAM_INIT));
+    }
+
+    PooledBuffer acquireBuffer(size_t size) {
+        std::vector<std::byte>* buffer = nullptr;
+        if (size >= MIN_POOLED_BUFFER) {
+            buffer = pool<BufferTraits>().take(size);
+            if (!buffer) {
+                g_created.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (!buffer) {
+            buffer = new std::vector<std::byte>(size);
+        }
+        Utils::MetricsRecorder* metrics = Utils::currentMetrics();
+        if (metrics) {
+            metrics->bufferAcquired(buffer->size());
+        }
+        return PooledBuffer(buffer, BufferRelease{metrics});
+    }
+}
+
+namespace Flux {
+    CodecPoolStats codecPoolStats() noexcept {
+        using namespace IO;
+        CodecPoolStats stats;
+        stats.created = g_created.load(std::memory_order_relaxed);
+        stats.reused = g_reused.load(std::memory_order_relaxed);
+        stats.cached = pool<ZstdCCtxTraits>().cached() + pool<ZstdDCtxTraits>().cached() +
+                       pool<DeflateTraits>().cached() + pool<LzmaTraits>().cached() +
+                       pool<BufferTraits>().cached();
+        return stats;
+    }
+
+    void releaseCodecPools() noexcept {
+        using namespace IO;
+        pool<ZstdCCtxTraits>().clear();
+        pool<ZstdDCtxTraits>().clear();
+        pool<DeflateTraits>().clear();
+        pool<LzmaTraits>().clear();
+        pool<BufferTraits>().clear();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "flux-core/codec_pool.h"
+#include "utils/operation_metrics.h"
+#include <lzma.h>
+#include <zlib.h>
+#include <zstd.h>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Flux::IO {
+    /*
+     * Pools of codec contexts and I/O buffers
+     *
+     * Every thread keeps a few released objects of each kind, so a worker
+     * moving from entry to entry or archive to archive gets its context back
+     * without locking. When a thread ends, its cache moves to a process-wide
+     * pool, where the workers of later operations (new threads each time)
+     * look before allocating. Objects over POOLED_MEMORY_LIMIT are freed
+     * instead of cached. Everything handed out is reset: contexts have
+     * default parameters and no dictionary.
+     */
+
+    struct ZstdCCtxRelease {
+        bool multithreaded = false;   // ZSTD_c_nbWorkers was set: free it, a reset keeps the worker threads
+        void operator()(ZSTD_CCtx* cctx) const noexcept;
+    };
+    struct ZstdDCtxRelease {
+        void operator()(ZSTD_DCtx* dctx) const noexcept;
+    };
+    struct DeflateRelease {
+        void operator()(z_stream* stream) const noexcept;
+    };
+    struct LzmaRelease {
+        void operator()(lzma_stream* stream) const noexcept;
+    };
+    struct BufferRelease {
+        Utils::MetricsRecorder* metrics = nullptr;   // Operation the buffer counts towards
+        void operator()(std::vector<std::byte>* buffer) const noexcept;
+    };
+
+    using PooledZstdCCtx = std::unique_ptr<ZSTD_CCtx, ZstdCCtxRelease>;
+    using PooledZstdDCtx = std::unique_ptr<ZSTD_DCtx, ZstdDCtxRelease>;
+    using PooledDeflate = std::unique_ptr<z_stream, DeflateRelease>;
+    using PooledLzma = std::unique_ptr<lzma_stream, LzmaRelease>;
+    using PooledBuffer = std::unique_ptr<std::vector<std::byte>, BufferRelease>;
+
+    /**
+     * @throws CompressionException if a new context cannot be allocated
+     */
+    [[nodiscard]] PooledZstdCCtx acquireZstdCCtx();
+
+    /**
+     * @throws CompressionException if a new context cannot be allocated
+     */
+    [[nodiscard]] PooledZstdDCtx acquireZstdDCtx();
+
+    /**
+     * Deflate stream producing gzip output (window 15, memLevel 8), ready for input
+     * @throws CompressionException
+     */
+    [[nodiscard]] PooledDeflate acquireGzipDeflate(int level);
+
+    /**
+     * Stream to initialize a coder on (lzma_easy_encoder, lzma_raw_decoder, ...)
+     *
+     * It may still hold the coder of its previous user; liblzma reuses that
+     * memory when the new coder fits in it, and replaces it otherwise.
+     * There is no pending input or output.
+     */
+    [[nodiscard]] PooledLzma acquireLzmaStream();
+
+    /**
+     * Buffer of at least size bytes with unspecified content
+     *
+     * Its size() may exceed the request; use the first size bytes.
+     */
+    [[nodiscard]] PooledBuffer acquireBuffer(size_t size);
+
+    /**
+     * The first size bytes of a pooled buffer
+     */
+    [[nodiscard]] inline std::span<std::byte> bufferSpan(const PooledBuffer& buffer, size_t size) noexcept {
+        return {buffer->data(), size};
+    }
+}
@@ -0,0 +1,376 @@
+#include "io/compression_sink.h"
+#include "flux-core/constants.h"
+#include "flux-core/exceptions.h"
+#include "flux-core/packer.h"
+#include "io/codec_pool.h"
+#include "io/zstd_dictionary.h"
+#include "utils/concurrency.h"
+#include "utils/operation_metrics.h"
+#include <zlib.h>
+#include <lzma.h>
+#include <zstd.h>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <climits>
+
+namespace Flux::IO {
+    CompressionSink::CompressionSink(const std::filesystem::path& output)
+        : m_out_buffer(Constants::DEFAULT_BUFFER_SIZE),
+          m_file(output, std::ios::binary | std::ios::trunc) {
+        if (!m_file.is_open()) {
+            throw FluxException(fmt::format("Cannot create output file: {}", output.string()));
+        }
+    }
+
+    void CompressionSink::write(std::span<const std::byte> data) {
+        if (data.empty()) {
+            return;
+        }
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        compress(data);
+        m_bytes_in += data.size();
+    }
+
+    void CompressionSink::finish() {
+        if (m_finished) {
+            return;
+        }
+        m_finished = true;
+        {
+            Utils::PhaseTimer timer(Utils::Phase::Codec);
+            flushStream();
+        }
+        Utils::countSyscalls();
+        m_file.close();
+        if (m_file.fail()) {
+            throw FluxException("Failed to close compressed output file");
+        }
+    }
+
+    void CompressionSink::emit(const void* data, size_t size) {
+        if (size == 0) {
+            return;
+        }
+        Utils::PhaseTimer timer(Utils::Phase::DiskWrite);
+        Utils::countSyscalls();
+        m_file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        if (!m_file) {
+            throw FluxException("Failed to write compressed output (disk full?)");
+        }
+        m_bytes_out += size;
+    }
+
+    namespace {
+        /**
+         * GZIP stream compressor (zlib deflate with gzip wrapper)
+         */
+        class GzipSink final : public CompressionSink {
+        public:
+            GzipSink(const std::filesystem::path& output, int level)
+                : CompressionSink(output), m_stream(acquireGzipDeflate(level)) {}
+
+        protected:
+            void compress(std::span<const std::byte> data) override {
+                while (!data.empty()) {
+                    const size_t chunk = std::min<size_t>(data.size(), UINT_MAX);
+                    m_stream->next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data.data()));
+                    m_stream->avail_in = static_cast<uInt>(chunk);
+                    run(Z_NO_FLUSH);
+                    data = data.subspan(chunk);
+                }
+            }
+
+            void flushStream() override {
+                m_stream->next_in = nullptr;
+                m_stream->avail_in = 0;
+                run(Z_FINISH);
+            }
+
+        private:
+            void run(int flush) {
+                int ret = Z_OK;
+                do {
+                    m_stream->next_out = reinterpret_cast<Bytef*>(m_out_buffer.data());
+                    m_stream->avail_out = static_cast<uInt>(m_out_buffer.size());
+                    ret = deflate(m_stream.get(), flush);
+                    if (ret == Z_STREAM_ERROR) {
+                        throw CompressionException("gzip stream error");
+                    }
+                    emit(m_out_buffer.data(), m_out_buffer.size() - m_stream->avail_out);
+                } while (m_stream->avail_out == 0 || (flush == Z_FINISH && ret != Z_STREAM_END));
+            }
+
+            PooledDeflate m_stream;
+        };
+
+        /**
+         * XZ stream compressor (liblzma)
+         *
+         * With more than one thread the multi-threaded encoder splits the input
+         * into independent blocks (3x the dictionary size each) that record their
+         * sizes in the block headers, which also lets readers decode in parallel.
+         */
+        class XzSink final : public CompressionSink {
+        public:
+            XzSink(const std::filesystem::path& output, int level, unsigned threads)
+                : CompressionSink(output), m_stream(acquireLzmaStream()) {
+                const auto preset = static_cast<uint32_t>(std::clamp(level, 0, 9));
+                lzma_ret ret = LZMA_OK;
+                if (threads > 1) {
+                    lzma_mt mt{};
+                    mt.threads = threads;
+                    mt.block_size = 0;  // liblzma default: 3x dictionary size
+                    mt.timeout = 0;
+                    mt.preset = preset;
+                    mt.check = LZMA_CHECK_CRC64;
+                    ret = lzma_stream_encoder_mt(m_stream.get(), &mt);
+                    spdlog::debug("xz compression using {} threads", threads);
+                } else {
+                    ret = lzma_easy_encoder(m_stream.get(), preset, LZMA_CHECK_CRC64);
+                }
+                if (ret != LZMA_OK) {
+                    throw CompressionException("Cannot initialize xz compressor");
+                }
+                m_threaded = threads > 1;
+            }
+
+            // A threaded encoder keeps its worker threads until lzma_end; only the bare stream goes back to the pool
+            ~XzSink() override {
+                if (m_threaded) {
+                    lzma_end(m_stream.get());
+                }
+            }
+
+        protected:
+            void compress(std::span<const std::byte> data) override {
+                m_stream->next_in = reinterpret_cast<const uint8_t*>(data.data());
+                m_stream->avail_in = data.size();
+                run(LZMA_RUN);
+            }
+
+            void flushStream() override {
+                m_stream->next_in = nullptr;
+                m_stream->avail_in = 0;
+                run(LZMA_FINISH);
+            }
+
+        private:
+            void run(lzma_action action) {
+                lzma_ret ret = LZMA_OK;
+                do {
+                    m_stream->next_out = reinterpret_cast<uint8_t*>(m_out_buffer.data());
+                    m_stream->avail_out = m_out_buffer.size();
+                    ret = lzma_code(m_stream.get(), action);
+                    if (ret != LZMA_OK && ret != LZMA_STREAM_END) {
+                        throw CompressionException(fmt::format("xz encoder error {}", static_cast<int>(ret)));
+                    }
+                    emit(m_out_buffer.data(), m_out_buffer.size() - m_stream->avail_out);
+                } while (m_stream->avail_in > 0 || m_stream->avail_out == 0 ||
+                         (action == LZMA_FINISH && ret != LZMA_STREAM_END));
+            }
+
+            PooledLzma m_stream;
+            bool m_threaded = false;
+        };
+
+        /**
+         * Zstandard stream compressor
+         *
+         * With more than one thread the stream is compressed by zstd's worker
+         * pool (ZSTD_c_nbWorkers). Long-distance matching is enabled:
+         * build trees repeat content far apart, and the default 128 MiB LDM
+         * window still decodes with a plain `zstd -d`.
+         *
+         * Seekable output follows the zstd seekable format: the input is cut
+         * into independent frames of SEEKABLE_FRAME_SIZE bytes and a skippable
+         * frame holding the seek table ends the file. `zstd -d` skips the table
+         * and decodes the frames back to back. Long-distance matching is off
+         * in this mode.
+         *
+         * With a dictionary, it is written first in a skippable frame and every
+         * frame is compressed against it, which mostly helps seekable frames
+         * full of small files. The seek table lists the dictionary frame as an
+         * entry with no content, so frame offsets stay right.
+         */
+        class ZstdSink final : public CompressionSink {
+        public:
+            ZstdSink(const std::filesystem::path& output, int level, unsigned threads, bool seekable,
+                     std::span<const std::byte> dictionary)
+                : CompressionSink(output), m_cdict(nullptr, &ZSTD_freeCDict), m_cctx(acquireZstdCCtx()),
+                  m_seekable(seekable) {
+                m_out_buffer.resize(ZSTD_CStreamOutSize());
+                check(ZSTD_CCtx_setParameter(m_cctx.get(), ZSTD_c_compressionLevel,
+                                             std::min(level, ZSTD_maxCLevel())));
+                check(ZSTD_CCtx_setParameter(m_cctx.get(), ZSTD_c_checksumFlag, 1));
+                if (!dictionary.empty()) {
+                    // Digested once, instead of per frame as a raw dictionary would be
+                    m_cdict = createCDict(dictionary, level);
+                    check(ZSTD_CCtx_refCDict(m_cctx.get(), m_cdict.get()));
+                    const auto frame = encodeDictionaryFrame(dictionary);
+                    emit(frame.data(), frame.size());
+                    m_dictionary_frame_size = static_cast<uint32_t>(frame.size());
+                    m_frame_start = bytesOut();
+                }
+                // Matches cannot cross seekable frames, so a long window would only cost memory
+                if (!m_seekable) {
+                    check(ZSTD_CCtx_setParameter(m_cctx.get(), ZSTD_c_enableLongDistanceMatching, 1));
+                }
+
+                if (threads > 1) {
+                    const auto bounds = ZSTD_cParam_getBounds(ZSTD_c_nbWorkers);
+                    const int workers = std::min(static_cast<int>(threads), bounds.upperBound);
+                    // A libzstd built without ZSTD_MULTITHREAD rejects any worker count
+                    if (ZSTD_isError(bounds.error) || workers < 1 ||
+                        ZSTD_isError(ZSTD_CCtx_setParameter(m_cctx.get(), ZSTD_c_nbWorkers, workers))) {
+                        spdlog::warn("libzstd has no multi-threading support, compressing on one thread");
+                    } else {
+                        m_cctx.get_deleter().multithreaded = true;
+                        spdlog::debug("zstd compression using {} worker threads", workers);
+                    }
+                }
+            }
+
+            std::vector<SeekPoint> seekPoints() const override {
+                std::vector<SeekPoint> points;
+                points.reserve(m_frames.size());
+                SeekPoint point;
+                point.compressed_offset = m_dictionary_frame_size;
+                for (const auto& frame : m_frames) {
+                    points.push_back(point);
+                    point.compressed_offset += frame.compressed_size;
+                    point.uncompressed_offset += frame.uncompressed_size;
+                }
+                return points;
+            }
+
+        protected:
+            void compress(std::span<const std::byte> data) override {
+                if (!m_seekable) {
+                    compressChunk(data);
+                    return;
+                }
+                while (!data.empty()) {
+                    const size_t chunk = std::min<size_t>(data.size(), Constants::Performance::SEEKABLE_FRAME_SIZE - m_frame_in);
+                    compressChunk(data.first(chunk));
+                    m_frame_in += chunk;
+                    data = data.subspan(chunk);
+                    if (m_frame_in == Constants::Performance::SEEKABLE_FRAME_SIZE) {
+                        endFrame();
+                    }
+                }
+            }
+
+            void flushStream() override {
+                if (!m_seekable) {
+                    endFrame();
+                    return;
+                }
+                if (m_frame_in > 0 || m_frames.empty()) {
+                    endFrame();
+                }
+                writeSeekTable();
+            }
+
+        private:
+            // Seek table entry of the zstd seekable format
+            struct FrameRecord {
+                uint32_t compressed_size;
+                uint32_t uncompressed_size;
+            };
+
+            static constexpr uint32_t SKIPPABLE_FRAME_MAGIC = 0x184D2A5E;
+            static constexpr uint32_t SEEKABLE_MAGIC = 0x8F92EAB1;
+            static constexpr size_t SEEK_TABLE_FOOTER_SIZE = 9;
+
+            void compressChunk(std::span<const std::byte> data) {
+                ZSTD_inBuffer input{data.data(), data.size(), 0};
+                while (input.pos < input.size) {
+                    ZSTD_outBuffer out{m_out_buffer.data(), m_out_buffer.size(), 0};
+                    check(ZSTD_compressStream2(m_cctx.get(), &out, &input, ZSTD_e_continue));
+                    emit(out.dst, out.pos);
+                }
+            }
+
+            void endFrame() {
+                ZSTD_inBuffer input{nullptr, 0, 0};
+                size_t remaining = 0;
+                do {
+                    ZSTD_outBuffer out{m_out_buffer.data(), m_out_buffer.size(), 0};
+                    remaining = check(ZSTD_compressStream2(m_cctx.get(), &out, &input, ZSTD_e_end));
+                    emit(out.dst, out.pos);
+                } while (remaining != 0);
+
+                if (m_seekable) {
+                    const uint64_t compressed = bytesOut() - m_frame_start;
+                    if (compressed > UINT32_MAX) {
+                        throw CompressionException("zstd frame too large for a seek table");
+                    }
+                    m_frames.push_back({static_cast<uint32_t>(compressed), static_cast<uint32_t>(m_frame_in)});
+                    m_frame_start = bytesOut();
+                    m_frame_in = 0;
+                }
+            }
+
+            void writeSeekTable() {
+                std::vector<uint8_t> table;
+                const auto put32 = [&table](uint32_t value) {
+                    for (int i = 0; i < 4; ++i) {
+                        table.push_back(static_cast<uint8_t>(value >> (8 * i)));
+                    }
+                };
+                const bool has_dictionary = m_dictionary_frame_size > 0;
+                const size_t frame_count = m_frames.size() + (has_dictionary ? 1 : 0);
+                put32(SKIPPABLE_FRAME_MAGIC);
+                put32(static_cast<uint32_t>(frame_count * sizeof(FrameRecord) + SEEK_TABLE_FOOTER_SIZE));
+                if (has_dictionary) {
+                    put32(m_dictionary_frame_size);
+                    put32(0);
+                }
+                for (const auto& frame : m_frames) {
+                    put32(frame.compressed_size);
+                    put32(frame.uncompressed_size);
+                }
+                put32(static_cast<uint32_t>(frame_count));
+                table.push_back(0);  // Descriptor: no per-frame checksums
+                put32(SEEKABLE_MAGIC);
+                emit(table.data(), table.size());
+            }
+
+            static size_t check(size_t code) {
+                if (ZSTD_isError(code)) {
+                    throw CompressionException(fmt::format("zstd: {}", ZSTD_getErrorName(code)));
+                }
+                return code;
+            }
+
+            CDictPtr m_cdict;         // Outlives m_cctx, which references it
+            PooledZstdCCtx m_cctx;
+            bool m_seekable = false;
+            uint32_t m_dictionary_frame_size = 0;
+            std::vector<FrameRecord> m_frames;
+            uint64_t m_frame_start = 0;  // Output offset of the current frame
+            size_t m_frame_in = 0;       // Input bytes in the current frame
+        };
+    }
+
+    std::unique_ptr<CompressionSink> createCompressionSink(
+        const std::filesystem::path& output,
+        const PackOptions& options,
+        std::span<const std::byte> dictionary) {
+
+        switch (options.format) {
+            case ArchiveFormat::TAR_GZ:
+                return std::make_unique<GzipSink>(output, options.compression_level);
+            case ArchiveFormat::TAR_XZ:
+                return std::make_unique<XzSink>(output, options.compression_level,
+                                                Utils::resolveThreadCount(options.num_threads));
+            case ArchiveFormat::TAR_ZSTD:
+                return std::make_unique<ZstdSink>(output, options.compression_level,
+                                                  Utils::resolveThreadCount(options.num_threads),
+                                                  options.seekable, dictionary);
+            default:
+                throw UnsupportedFormatException(std::string{formatToString(options.format)});
+        }
+    }
+}
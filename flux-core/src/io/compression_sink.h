@@ -0,0 +1,78 @@
+#pragma once
+#include "flux-core/archive.h"
+#include "flux-core/archive_index.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace Flux::IO {
+    /**
+     * Streaming compressor writing a compressed byte stream straight to a file.
+     *
+     * Callers push uncompressed data in chunks of any size; memory use is
+     * bounded by the codec state plus one output buffer, so archives of any
+     * size are produced without an uncompressed temporary file.
+     * Errors are reported by throwing FluxException/CompressionException.
+     */
+    class CompressionSink {
+    public:
+        explicit CompressionSink(const std::filesystem::path& output);
+        virtual ~CompressionSink() = default;
+
+        CompressionSink(const CompressionSink&) = delete;
+        CompressionSink& operator=(const CompressionSink&) = delete;
+
+        /**
+         * Compress and write a chunk of data
+         * @param data Uncompressed input bytes
+         */
+        void write(std::span<const std::byte> data);
+
+        /**
+         * Flush the codec, write the stream trailer and close the file
+         */
+        void finish();
+
+        uint64_t bytesIn() const noexcept { return m_bytes_in; }
+        uint64_t bytesOut() const noexcept { return m_bytes_out; }
+
+        /**
+         * Points where decoding can start, for seekable output; empty otherwise
+         */
+        virtual std::vector<SeekPoint> seekPoints() const { return {}; }
+
+    protected:
+        virtual void compress(std::span<const std::byte> data) = 0;
+        virtual void flushStream() = 0;
+
+        /**
+         * Write compressed bytes produced by the codec to the output file
+         */
+        void emit(const void* data, size_t size);
+
+        std::vector<std::byte> m_out_buffer;
+
+    private:
+        std::ofstream m_file;
+        uint64_t m_bytes_in = 0;
+        uint64_t m_bytes_out = 0;
+        bool m_finished = false;
+    };
+
+    /**
+     * Create a compression sink for a TAR-based format
+     * @param output Output file path (created or truncated)
+     * @param options Packing options (format, compression level, threads and seekable are used)
+     * @param dictionary zstd dictionary to embed and compress with (TAR_ZSTD only; empty for none)
+     * @return Sink instance; throws on unsupported format or I/O error
+     */
+    [[nodiscard]] std::unique_ptr<CompressionSink> createCompressionSink(
+        const std::filesystem::path& output,
+        const PackOptions& options,
+        std::span<const std::byte> dictionary = {}
+    );
+}
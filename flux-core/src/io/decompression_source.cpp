@@ -0,0 +1,236 @@
+#include "io/decompression_source.h"
+#include "flux-core/constants.h"
+#include "flux-core/exceptions.h"
+#include "io/codec_pool.h"
+#include "utils/operation_metrics.h"
+#include <lzma.h>
+#include <zstd.h>
+#include <fmt/format.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace Flux::IO {
+    namespace {
+#if LZMA_VERSION >= 50040002  // lzma_stream_decoder_mt is stable since liblzma 5.4.0
+        constexpr std::array<char, 6> XZ_MAGIC = {'\xFD', '7', 'z', 'X', 'Z', '\x00'};
+
+        bool hasXzMagic(const std::filesystem::path& archive_path) {
+            std::ifstream file(archive_path, std::ios::binary);
+            std::array<char, XZ_MAGIC.size()> header{};
+            file.read(header.data(), header.size());
+            return file.gcount() == static_cast<std::streamsize>(header.size()) &&
+                   std::memcmp(header.data(), XZ_MAGIC.data(), header.size()) == 0;
+        }
+
+        /**
+         * Multi-threaded XZ decoder
+         *
+         * liblzma decodes independent blocks in parallel when the block headers
+         * carry their compressed sizes, which is what multi-threaded encoders
+         * (ours, xz -T, pixz) write. Single-block files decode on one thread.
+         */
+        class XzParallelSource final : public DecompressionSource {
+        public:
+            XzParallelSource(const std::filesystem::path& archive_path, unsigned threads)
+                : m_file(archive_path, std::ios::binary),
+                  m_in_buffer(acquireBuffer(Constants::LARGE_BUFFER_SIZE)),
+                  m_out_buffer(acquireBuffer(Constants::LARGE_BUFFER_SIZE)),
+                  m_stream(acquireLzmaStream()) {
+                if (!m_file.is_open()) {
+                    throw FileNotFoundException(archive_path.string());
+                }
+
+                lzma_mt mt{};
+                mt.flags = LZMA_CONCATENATED;
+                mt.threads = threads;
+                mt.timeout = 0;
+                // Fall back to single-threaded decoding rather than exceed a quarter of RAM
+                mt.memlimit_threading = lzma_physmem() / 4;
+                mt.memlimit_stop = UINT64_MAX;
+
+                if (lzma_stream_decoder_mt(m_stream.get(), &mt) != LZMA_OK) {
+                    throw CompressionException("Cannot initialize multi-threaded xz decoder");
+                }
+            }
+
+            // Stops the decoder threads; only the bare stream goes back to the pool
+            ~XzParallelSource() override { lzma_end(m_stream.get()); }
+
+            std::span<const std::byte> read() override {
+                if (m_finished) {
+                    return {};
+                }
+                Utils::PhaseTimer timer(Utils::Phase::Codec);
+
+                m_stream->next_out = reinterpret_cast<uint8_t*>(m_out_buffer->data());
+                m_stream->avail_out = m_out_buffer->size();
+
+                while (m_stream->avail_out == m_out_buffer->size()) {
+                    lzma_action action = LZMA_RUN;
+                    if (m_stream->avail_in == 0) {
+                        const size_t bytes_read = readInput();
+                        m_stream->next_in = reinterpret_cast<const uint8_t*>(m_in_buffer->data());
+                        m_stream->avail_in = bytes_read;
+                        m_compressed_bytes += bytes_read;
+                        if (bytes_read == 0) {
+                            action = LZMA_FINISH;
+                        }
+                    }
+
+                    const lzma_ret ret = lzma_code(m_stream.get(), action);
+                    if (ret == LZMA_STREAM_END) {
+                        m_finished = true;
+                        break;
+                    }
+                    if (ret != LZMA_OK) {
+                        throw CompressionException(fmt::format("xz decoder error {}", static_cast<int>(ret)));
+                    }
+                }
+
+                return {m_out_buffer->data(), m_out_buffer->size() - m_stream->avail_out};
+            }
+
+            uint64_t compressedBytesRead() const noexcept override {
+                return m_compressed_bytes;
+            }
+
+        private:
+            size_t readInput() {
+                Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+                Utils::countSyscalls();
+                m_file.read(reinterpret_cast<char*>(m_in_buffer->data()),
+                            static_cast<std::streamsize>(m_in_buffer->size()));
+                const auto bytes_read = static_cast<size_t>(m_file.gcount());
+                Utils::countBytesRead(bytes_read);
+                return bytes_read;
+            }
+
+            std::ifstream m_file;
+            PooledBuffer m_in_buffer;
+            PooledBuffer m_out_buffer;
+            PooledLzma m_stream;
+            uint64_t m_compressed_bytes = 0;
+            bool m_finished = false;
+        };
+#endif
+
+        /**
+         * Zstandard decoder reading from an arbitrary frame onwards
+         *
+         * Skippable frames (seek tables, embedded indexes, the dictionary frame)
+         * decode to nothing.
+         */
+        class ZstdFrameSource final : public DecompressionSource {
+        public:
+            ZstdFrameSource(const std::filesystem::path& archive_path, uint64_t compressed_offset, uint64_t skip,
+                            std::shared_ptr<const ZSTD_DDict> dictionary)
+                : m_file(archive_path, std::ios::binary),
+                  m_dictionary(std::move(dictionary)),
+                  m_dctx(acquireZstdDCtx()),
+                  m_in_buffer(acquireBuffer(ZSTD_DStreamInSize())),
+                  m_out_buffer(acquireBuffer(std::max(ZSTD_DStreamOutSize(), Constants::LARGE_BUFFER_SIZE))),
+                  m_skip(skip) {
+                if (!m_file.is_open()) {
+                    throw FileNotFoundException(archive_path.string());
+                }
+                if (m_dictionary) {
+                    const size_t ret = ZSTD_DCtx_refDDict(m_dctx.get(), m_dictionary.get());
+                    if (ZSTD_isError(ret)) {
+                        throw CompressionException(fmt::format("zstd: {}", ZSTD_getErrorName(ret)));
+                    }
+                }
+                m_file.seekg(static_cast<std::streamoff>(compressed_offset));
+                if (!m_file) {
+                    throw CorruptedArchiveException(fmt::format("frame offset {} is past the end of {}",
+                                                                compressed_offset, archive_path.string()));
+                }
+            }
+
+            std::span<const std::byte> read() override {
+                Utils::PhaseTimer timer(Utils::Phase::Codec);
+                while (!m_finished) {
+                    if (m_input.pos == m_input.size) {
+                        const size_t bytes_read = readInput();
+                        m_input = {m_in_buffer->data(), bytes_read, 0};
+                        m_compressed_bytes += bytes_read;
+                        if (bytes_read == 0) {
+                            if (m_frame_pending) {
+                                throw CorruptedArchiveException("truncated zstd frame");
+                            }
+                            m_finished = true;
+                            break;
+                        }
+                    }
+
+                    ZSTD_outBuffer out{m_out_buffer->data(), m_out_buffer->size(), 0};
+                    const size_t ret = ZSTD_decompressStream(m_dctx.get(), &out, &m_input);
+                    if (ZSTD_isError(ret)) {
+                        throw CompressionException(fmt::format("zstd: {}", ZSTD_getErrorName(ret)));
+                    }
+                    m_frame_pending = ret != 0;
+
+                    // Drop the part of the first frame that precedes the requested position
+                    const size_t dropped = static_cast<size_t>(std::min<uint64_t>(m_skip, out.pos));
+                    m_skip -= dropped;
+                    if (out.pos > dropped) {
+                        return {m_out_buffer->data() + dropped, out.pos - dropped};
+                    }
+                }
+                return {};
+            }
+
+            uint64_t compressedBytesRead() const noexcept override {
+                return m_compressed_bytes;
+            }
+
+        private:
+            size_t readInput() {
+                Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+                Utils::countSyscalls();
+                m_file.read(reinterpret_cast<char*>(m_in_buffer->data()),
+                            static_cast<std::streamsize>(m_in_buffer->size()));
+                const auto bytes_read = static_cast<size_t>(m_file.gcount());
+                Utils::countBytesRead(bytes_read);
+                return bytes_read;
+            }
+
+            std::ifstream m_file;
+            std::shared_ptr<const ZSTD_DDict> m_dictionary;  // Referenced by m_dctx
+            PooledZstdDCtx m_dctx;
+            PooledBuffer m_in_buffer;
+            PooledBuffer m_out_buffer;
+            ZSTD_inBuffer m_input{nullptr, 0, 0};
+            uint64_t m_skip = 0;
+            uint64_t m_compressed_bytes = 0;
+            bool m_frame_pending = false;
+            bool m_finished = false;
+        };
+    }
+
+    std::unique_ptr<DecompressionSource> createParallelDecompressionSource(
+        const std::filesystem::path& archive_path,
+        unsigned threads) {
+
+        if (threads <= 1) {
+            return nullptr;
+        }
+#if LZMA_VERSION >= 50040002
+        if (hasXzMagic(archive_path)) {
+            return std::make_unique<XzParallelSource>(archive_path, threads);
+        }
+#endif
+        return nullptr;
+    }
+
+    std::unique_ptr<DecompressionSource> createZstdFrameSource(
+        const std::filesystem::path& archive_path,
+        uint64_t compressed_offset,
+        uint64_t skip,
+        std::shared_ptr<const ZSTD_DDict> dictionary) {
+
+        return std::make_unique<ZstdFrameSource>(archive_path, compressed_offset, skip, std::move(dictionary));
+    }
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <zstd.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace Flux::IO {
+    /**
+     * Pull-based decompressor producing the decoded byte stream of an archive
+     *
+     * Used where flux-core can decode faster than libarchive's built-in
+     * single-threaded filters; the decoded stream is then handed to libarchive
+     * for TAR parsing. Errors are reported by throwing FluxException.
+     */
+    class DecompressionSource {
+    public:
+        virtual ~DecompressionSource() = default;
+
+        /**
+         * Decode the next chunk of data
+         * @return Decoded bytes, valid until the next call; empty at end of stream
+         */
+        virtual std::span<const std::byte> read() = 0;
+
+        /**
+         * @return Number of compressed bytes consumed from the file so far
+         */
+        virtual uint64_t compressedBytesRead() const noexcept = 0;
+    };
+
+    /**
+     * Create a multi-threaded decoder for the archive if one applies
+     * @param archive_path Compressed archive path
+     * @param threads Number of decoder threads
+     * @return Decoder, or nullptr when libarchive's own filters should be used
+     */
+    [[nodiscard]] std::unique_ptr<DecompressionSource> createParallelDecompressionSource(
+        const std::filesystem::path& archive_path,
+        unsigned threads
+    );
+
+    /**
+     * Create a Zstandard decoder that starts at a frame boundary inside the archive
+     *
+     * Used with seekable TAR_ZSTD archives to read single members without
+     * decoding the frames before them.
+     * @param archive_path Compressed archive path
+     * @param compressed_offset Offset of the first frame to decode
+     * @param skip Decoded bytes to drop before the first returned chunk
+     * @param dictionary Dictionary the frames were compressed with (see readEmbeddedDictionary), or null
+     * @return Decoder positioned skip bytes into the frame
+     */
+    [[nodiscard]] std::unique_ptr<DecompressionSource> createZstdFrameSource(
+        const std::filesystem::path& archive_path,
+        uint64_t compressed_offset,
+        uint64_t skip,
+        std::shared_ptr<const ZSTD_DDict> dictionary = nullptr
+    );
+}
@@ -0,0 +1,424 @@
+#include "io/file_scanner.h"
+#include "flux-core/exceptions.h"
+#include "utils/operation_metrics.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <system_error>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#endif
+
+namespace Flux::IO {
+    namespace {
+        struct Listing;
+
+        /**
+         * Scanned entry with the contents of a directory
+         */
+        struct ListedEntry {
+            ManifestEntry entry;
+            Listing* contents = nullptr;     // Set for directories that are descended into
+        };
+
+        /**
+         * Entries of one directory, sorted by name once read
+         */
+        struct Listing {
+            std::vector<ListedEntry> entries;
+        };
+
+        /**
+         * Directory waiting to be read
+         */
+        struct DirectoryTask {
+            std::filesystem::path path;
+            std::string archive_path;
+            uint32_t input = 0;
+            Listing* listing = nullptr;      // Where its entries go
+        };
+
+#ifndef _WIN32
+        EntryType typeOf(mode_t mode) noexcept {
+            if (S_ISREG(mode)) {
+                return EntryType::File;
+            }
+            if (S_ISDIR(mode)) {
+                return EntryType::Directory;
+            }
+            if (S_ISLNK(mode)) {
+                return EntryType::Symlink;
+            }
+            return EntryType::Other;
+        }
+
+        void fillFromStat(ManifestEntry& entry, const struct stat& st) noexcept {
+            entry.type = typeOf(st.st_mode);
+            entry.target_type = entry.type;
+            entry.size = static_cast<uint64_t>(st.st_size);
+            entry.target_size = entry.size;
+            entry.mode = static_cast<uint32_t>(st.st_mode & 07777);
+            entry.target_mode = entry.mode;
+#ifdef __APPLE__
+            const auto& mtime = st.st_mtimespec;
+#else
+            const auto& mtime = st.st_mtim;
+#endif
+            entry.mtime_ns = static_cast<int64_t>(mtime.tv_sec) * 1'000'000'000 + mtime.tv_nsec;
+            entry.inode = static_cast<uint64_t>(st.st_ino);
+            entry.device = static_cast<uint64_t>(st.st_dev);
+            entry.links = static_cast<uint32_t>(st.st_nlink);
+            entry.uid = static_cast<uint32_t>(st.st_uid);
+            entry.gid = static_cast<uint32_t>(st.st_gid);
+        }
+
+        void resolveLinkTarget(ManifestEntry& entry, const struct stat* target) noexcept {
+            if (!target) {
+                entry.target_type = EntryType::Other;
+                return;
+            }
+            entry.target_type = typeOf(target->st_mode);
+            entry.target_size = static_cast<uint64_t>(target->st_size);
+            // Packers that follow the link store the target's permissions
+            entry.target_mode = static_cast<uint32_t>(target->st_mode & 07777);
+        }
+#else
+        void fillFromStatus(ManifestEntry& entry, const std::filesystem::directory_entry& dir_entry) {
+            std::error_code ec;
+            auto typeOf = [](std::filesystem::file_type type) {
+                switch (type) {
+                    case std::filesystem::file_type::regular: return EntryType::File;
+                    case std::filesystem::file_type::directory: return EntryType::Directory;
+                    case std::filesystem::file_type::symlink: return EntryType::Symlink;
+                    default: return EntryType::Other;
+                }
+            };
+            entry.type = typeOf(dir_entry.symlink_status(ec).type());
+            entry.target_type = entry.type == EntryType::Symlink ? typeOf(dir_entry.status(ec).type()) : entry.type;
+            if (entry.target_type == EntryType::File) {
+                entry.target_size = dir_entry.file_size(ec);
+                entry.size = entry.type == EntryType::File ? entry.target_size : 0;
+            }
+            entry.mode = static_cast<uint32_t>(dir_entry.symlink_status(ec).permissions()) & 07777;
+            entry.target_mode = static_cast<uint32_t>(dir_entry.status(ec).permissions()) & 07777;
+            const auto mtime = dir_entry.last_write_time(ec);
+            if (!ec) {
+                entry.mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::clock_cast<std::chrono::system_clock>(mtime).time_since_epoch()).count();
+            }
+        }
+#endif
+
+        /**
+         * Name an input is stored under, also for "dir/", "." and ".."
+         */
+        std::string inputName(const std::filesystem::path& input) {
+            auto name = input.filename();
+            if (name.empty() || name == "." || name == "..") {
+                name = std::filesystem::absolute(input).lexically_normal().parent_path().filename();
+            }
+            return name.generic_string();
+        }
+
+        /**
+         * Work-stealing walk over the directories of all inputs
+         */
+        class DirectoryScan {
+        public:
+            DirectoryScan(unsigned workers, const Utils::PathFilter& filter)
+                : m_queues(workers), m_filter(filter) {}
+
+            /**
+             * Record an entry; queues directories that are not excluded
+             * @return false if the filter rejected it
+             */
+            bool record(unsigned worker, Listing& listing, ManifestEntry entry) {
+                Listing* contents = nullptr;
+                if (entry.type == EntryType::Directory) {
+                    if (m_filter.excludes(entry.archive_path)) {
+                        Utils::countSkippedEntry();
+                        return false;
+                    }
+                    contents = newListing();
+                    push(worker, {entry.source, entry.archive_path, entry.input, contents});
+                } else if (entry.type == EntryType::Other || !m_filter.accepts(entry.archive_path)) {
+                    Utils::countSkippedEntry();
+                    return false;
+                }
+                listing.entries.push_back({std::move(entry), contents});
+                m_entry_count.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+
+            /**
+             * Process directories until none are queued or being read anywhere
+             */
+            void run(unsigned worker) {
+                for (;;) {
+                    auto task = take(worker);
+                    if (!task) {
+                        // Sleep until a directory is queued or the last one is done. The count is
+                        // read before the queues are looked at again, so a push in between changes
+                        // it and the wait returns at once.
+                        m_sleeping.fetch_add(1);
+                        const size_t pending = m_pending.load();
+                        if (pending != 0 && !(task = take(worker))) {
+                            m_pending.wait(pending);
+                        }
+                        m_sleeping.fetch_sub(1);
+                        if (pending == 0) {
+                            return;
+                        }
+                        if (!task) {
+                            continue;
+                        }
+                    }
+
+                    try {
+                        scanDirectory(worker, *task);
+                    } catch (...) {
+                        // Let the other workers drain the queues and stop
+                        finishTask();
+                        throw;
+                    }
+                    finishTask();
+                }
+            }
+
+            /**
+             * Flatten the listings below the roots, each directory followed by its contents
+             */
+            std::vector<ManifestEntry> collect(Listing& roots) {
+                std::vector<ManifestEntry> entries;
+                entries.reserve(m_entry_count.load(std::memory_order_relaxed));
+                append(roots, entries);
+                return entries;
+            }
+
+        private:
+            struct WorkQueue {
+                std::mutex mutex;
+                std::deque<DirectoryTask> tasks;
+            };
+
+            Listing* newListing() {
+                // A deque never moves its elements, so workers can keep writing through the pointer
+                std::lock_guard lock(m_listings_mutex);
+                return &m_listings.emplace_back();
+            }
+
+            void push(unsigned worker, DirectoryTask task) {
+                m_pending.fetch_add(1);
+                {
+                    std::lock_guard lock(m_queues[worker].mutex);
+                    m_queues[worker].tasks.push_back(std::move(task));
+                }
+                wakeSleepers();
+            }
+
+            void finishTask() {
+                m_pending.fetch_sub(1);
+                wakeSleepers();
+            }
+
+            void wakeSleepers() {
+                // Only idle workers wait, so a busy scan makes no futex calls
+                if (m_sleeping.load() > 0) {
+                    m_pending.notify_all();
+                }
+            }
+
+            std::optional<DirectoryTask> take(unsigned worker) {
+                // Own queue newest-first keeps the walk depth-first and cache-warm
+                {
+                    auto& own = m_queues[worker];
+                    std::lock_guard lock(own.mutex);
+                    if (!own.tasks.empty()) {
+                        DirectoryTask task = std::move(own.tasks.back());
+                        own.tasks.pop_back();
+                        return task;
+                    }
+                }
+                // Steal the oldest directory, usually the one with the most below it
+                for (size_t i = 1; i < m_queues.size(); ++i) {
+                    auto& victim = m_queues[(worker + i) % m_queues.size()];
+                    std::lock_guard lock(victim.mutex);
+                    if (!victim.tasks.empty()) {
+                        DirectoryTask task = std::move(victim.tasks.front());
+                        victim.tasks.pop_front();
+                        return task;
+                    }
+                }
+                return std::nullopt;
+            }
+
+            void scanDirectory(unsigned worker, const DirectoryTask& task) {
+                Listing& listing = *task.listing;
+#ifndef _WIN32
+                DIR* dir = opendir(task.path.c_str());
+                if (!dir) {
+                    spdlog::warn("Cannot read directory {}: {}", task.path.string(), std::strerror(errno));
+                    return;
+                }
+                const int dir_fd = dirfd(dir);
+                uint64_t syscalls = 2;    // opendir and closedir; readdir batches its getdents
+                while (const dirent* dir_entry = readdir(dir)) {
+                    const char* name = dir_entry->d_name;
+                    if (std::strcmp(name, ".") == 0 || std::strcmp(name, "..") == 0) {
+                        continue;
+                    }
+
+                    struct stat st;
+                    ++syscalls;
+                    if (fstatat(dir_fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                        spdlog::warn("Cannot stat {}: {}", (task.path / name).string(), std::strerror(errno));
+                        continue;
+                    }
+
+                    ManifestEntry entry;
+                    fillFromStat(entry, st);
+                    if (entry.type == EntryType::Symlink) {
+                        struct stat target;
+                        ++syscalls;
+                        resolveLinkTarget(entry, fstatat(dir_fd, name, &target, 0) == 0 ? &target : nullptr);
+                    }
+                    entry.source = task.path / name;
+                    entry.archive_path = task.archive_path + '/' + name;
+                    entry.input = task.input;
+                    record(worker, listing, std::move(entry));
+                }
+                closedir(dir);
+                Utils::countSyscalls(syscalls);
+#else
+                std::error_code ec;
+                for (std::filesystem::directory_iterator it(task.path, std::filesystem::directory_options::skip_permission_denied, ec);
+                     !ec && it != std::filesystem::directory_iterator(); it.increment(ec)) {
+                    ManifestEntry entry;
+                    fillFromStatus(entry, *it);
+                    entry.source = it->path();
+                    entry.archive_path = task.archive_path + '/' + it->path().filename().generic_string();
+                    entry.input = task.input;
+                    record(worker, listing, std::move(entry));
+                }
+                if (ec) {
+                    spdlog::warn("Cannot read directory {}: {}", task.path.string(), ec.message());
+                }
+#endif
+                // Siblings share the parent prefix, so comparing full paths orders them by name
+                std::sort(listing.entries.begin(), listing.entries.end(), [](const ListedEntry& lhs, const ListedEntry& rhs) {
+                    return lhs.entry.archive_path < rhs.entry.archive_path;
+                });
+            }
+
+            static void append(Listing& listing, std::vector<ManifestEntry>& entries) {
+                for (auto& listed : listing.entries) {
+                    entries.push_back(std::move(listed.entry));
+                    if (listed.contents) {
+                        append(*listed.contents, entries);
+                    }
+                }
+            }
+
+            std::vector<WorkQueue> m_queues;
+            std::mutex m_listings_mutex;
+            std::deque<Listing> m_listings;
+            std::atomic<size_t> m_pending{0};         // Directories queued or being read
+            std::atomic<unsigned> m_sleeping{0};      // Workers waiting on m_pending
+            std::atomic<size_t> m_entry_count{0};
+            const Utils::PathFilter& m_filter;
+        };
+    }
+
+    uint64_t FileManifest::totalFileSize() const noexcept {
+        uint64_t total = 0;
+        for (const auto& entry : entries) {
+            if (entry.hasFileContent()) {
+                total += entry.target_size;
+            }
+        }
+        return total;
+    }
+
+    FileManifest scanInputs(std::span<const std::filesystem::path> inputs,
+                            const Utils::PathFilter& filter,
+                            unsigned threads) {
+        const unsigned workers = std::max(1u, threads);
+        DirectoryScan scan(workers, filter);
+        const auto run = [&scan, metrics = Utils::currentMetrics()](unsigned worker) {
+            Utils::MetricsScope scope(metrics);
+            Utils::PhaseTimer timer(Utils::Phase::DirectoryScan);
+            scan.run(worker);
+        };
+        std::optional<Utils::PhaseTimer> roots_timer(std::in_place, Utils::Phase::DirectoryScan);
+
+        // Inputs keep their order; everything else is sorted by name
+        Listing roots;
+        for (uint32_t i = 0; i < inputs.size(); ++i) {
+            // "dir/" is the directory itself, not an empty name inside it
+            const auto& input = inputs[i];
+            const std::filesystem::path source = input.has_filename() ? input : input.parent_path();
+
+            ManifestEntry entry;
+#ifndef _WIN32
+            struct stat st;
+            Utils::countSyscalls();
+            if (lstat(source.c_str(), &st) != 0) {
+                throw FileNotFoundException(input.string());
+            }
+            fillFromStat(entry, st);
+            if (entry.type == EntryType::Symlink) {
+                struct stat target;
+                const bool resolved = stat(source.c_str(), &target) == 0;
+                // A symlinked input directory is packed by content
+                if (resolved && S_ISDIR(target.st_mode)) {
+                    fillFromStat(entry, target);
+                } else {
+                    resolveLinkTarget(entry, resolved ? &target : nullptr);
+                }
+            }
+#else
+            std::error_code ec;
+            const std::filesystem::directory_entry dir_entry(source, ec);
+            if (ec || !dir_entry.exists(ec)) {
+                throw FileNotFoundException(input.string());
+            }
+            fillFromStatus(entry, dir_entry);
+            if (entry.target_type == EntryType::Directory) {
+                entry.type = EntryType::Directory;
+            }
+#endif
+            entry.source = source;
+            entry.archive_path = inputName(source);
+            entry.input = i;
+            scan.record(i % workers, roots, std::move(entry));
+        }
+        roots_timer.reset();
+
+        if (workers == 1) {
+            run(0);
+        } else {
+            std::vector<std::future<void>> tasks;
+            tasks.reserve(workers);
+            for (unsigned worker = 0; worker < workers; ++worker) {
+                tasks.emplace_back(std::async(std::launch::async, run, worker));
+            }
+            for (auto& task : tasks) {
+                task.get();
+            }
+        }
+
+        Utils::PhaseTimer timer(Utils::Phase::DirectoryScan);
+        FileManifest manifest;
+        manifest.entries = scan.collect(roots);
+        return manifest;
+    }
+}
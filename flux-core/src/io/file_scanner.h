@@ -0,0 +1,84 @@
+#pragma once
+#include "utils/pattern_matcher.h"
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace Flux::IO {
+    /**
+     * Kind of filesystem object found by the scanner
+     */
+    enum class EntryType : uint8_t {
+        File,
+        Directory,
+        Symlink,
+        Other       // Dangling link target, device, FIFO, socket
+    };
+
+    /**
+     * One scanned path with the stat fields the packers need
+     */
+    struct ManifestEntry {
+        std::filesystem::path source;        // Path on disk
+        std::string archive_path;            // Path relative to the input's parent, '/'-separated
+        EntryType type = EntryType::File;    // Symlinks are not followed, except for input directories
+        EntryType target_type = EntryType::File;  // For symlinks, what they point to; otherwise type
+        uint64_t size = 0;                   // st_size (link length for symlinks)
+        uint64_t target_size = 0;            // Size of the file a symlink points to; otherwise size
+        uint32_t mode = 0;                   // Permission bits (a symlink's own)
+        uint32_t target_mode = 0;            // Permission bits of what a symlink points to; otherwise mode
+        int64_t mtime_ns = 0;                // Modification time (nanoseconds since epoch)
+        uint64_t inode = 0;
+        uint64_t device = 0;
+        uint32_t links = 1;                  // Hard link count
+        uint32_t uid = 0;
+        uint32_t gid = 0;
+        uint32_t input = 0;                  // Index of the input it was found under
+
+        /**
+         * @return true for regular files and symlinks to them, whose content is packed
+         */
+        [[nodiscard]] bool hasFileContent() const noexcept { return target_type == EntryType::File; }
+
+        [[nodiscard]] std::chrono::system_clock::time_point modificationTime() const noexcept {
+            return std::chrono::system_clock::time_point{
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds{mtime_ns})};
+        }
+    };
+
+    /**
+     * Everything below a set of inputs, stat'ed once
+     */
+    struct FileManifest {
+        // Grouped by input; within one, sorted by path with each directory
+        // directly followed by its contents
+        std::vector<ManifestEntry> entries;
+
+        /**
+         * Total size of all file contents
+         */
+        [[nodiscard]] uint64_t totalFileSize() const noexcept;
+    };
+
+    /**
+     * Scan inputs in parallel
+     *
+     * Directories are distributed over worker threads with work stealing:
+     * each worker takes its newest directory and idle workers steal the
+     * oldest from others. Entries are read with readdir and stat'ed with
+     * fstatat relative to the open directory, so each path is resolved once.
+     * Unreadable entries are skipped with a warning, as are devices, FIFOs
+     * and sockets.
+     * @param inputs Input files and directories
+     * @param filter Excluded directories are not descended into; include
+     *               patterns select files only
+     * @param threads Worker threads
+     * @throws FileNotFoundException if an input does not exist
+     */
+    [[nodiscard]] FileManifest scanInputs(std::span<const std::filesystem::path> inputs,
+                                          const Utils::PathFilter& filter,
+                                          unsigned threads);
+}
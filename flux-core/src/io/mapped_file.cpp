@@ -0,0 +1,85 @@
+#include "io/mapped_file.h"
+#include "utils/operation_metrics.h"
+#include <spdlog/spdlog.h>
+#include <cerrno>
+#include <limits>
+#include <system_error>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Flux::IO {
+    MappedFile::~MappedFile() {
+        if (!m_data) {
+            return;
+        }
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mapping));
+#else
+        munmap(const_cast<std::byte*>(m_data), m_size);
+#endif
+    }
+
+    std::unique_ptr<MappedFile> mapFile(const std::filesystem::path& path, AccessPattern pattern) {
+        std::error_code ec;
+        const auto file_size = std::filesystem::file_size(path, ec);
+        if (ec || file_size == 0 || file_size > std::numeric_limits<size_t>::max()) {
+            return nullptr;
+        }
+
+        std::unique_ptr<MappedFile> mapped(new MappedFile());
+        mapped->m_size = static_cast<size_t>(file_size);
+
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  pattern == AccessPattern::Sequential ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL,
+                                  nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return nullptr;
+        }
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);    // The mapping object keeps the file open
+        Utils::countSyscalls(3);
+        if (!mapping) {
+            spdlog::debug("Cannot map {}: error {}", path.string(), GetLastError());
+            return nullptr;
+        }
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            spdlog::debug("Cannot map {}: error {}", path.string(), GetLastError());
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        mapped->m_mapping = mapping;
+        mapped->m_data = static_cast<const std::byte*>(view);
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            return nullptr;
+        }
+        void* view = mmap(nullptr, mapped->m_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);    // The mapping keeps its own reference to the file
+        Utils::countSyscalls(3);
+        if (view == MAP_FAILED) {
+            spdlog::debug("Cannot map {}: {}", path.string(), std::generic_category().message(errno));
+            return nullptr;
+        }
+        mapped->m_data = static_cast<const std::byte*>(view);
+
+        // Hints only; failure just means default readahead
+        if (pattern == AccessPattern::Sequential) {
+            madvise(view, mapped->m_size, MADV_SEQUENTIAL);
+        }
+        madvise(view, mapped->m_size, MADV_WILLNEED);
+#endif
+
+        return mapped;
+    }
+}
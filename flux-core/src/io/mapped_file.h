@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+
+namespace Flux::IO {
+    /**
+     * Expected access pattern, translated into kernel paging hints
+     */
+    enum class AccessPattern {
+        Sequential,    // Read front to back once (aggressive readahead)
+        Normal         // Several readers at different positions
+    };
+
+    /**
+     * Read-only memory mapping of a whole file
+     *
+     * Archive libraries read straight from the page cache through the mapping,
+     * so there are no intermediate copies and no per-block read() calls.
+     * The mapping is immutable and may be shared between threads.
+     */
+    class MappedFile {
+    public:
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const std::byte* data() const noexcept { return m_data; }
+        size_t size() const noexcept { return m_size; }
+        std::span<const std::byte> bytes() const noexcept { return {m_data, m_size}; }
+
+    private:
+        friend std::unique_ptr<MappedFile> mapFile(const std::filesystem::path&, AccessPattern);
+
+        MappedFile() = default;
+
+        const std::byte* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_mapping = nullptr;    // HANDLE of the file mapping object
+#endif
+    };
+
+    /**
+     * Map a file into memory for reading
+     * @param path File to map
+     * @param pattern Access pattern hint
+     * @return Mapping, or nullptr when the file cannot be mapped (empty,
+     *         special file, address space exhausted); callers then fall back
+     *         to regular reads
+     */
+    [[nodiscard]] std::unique_ptr<MappedFile> mapFile(
+        const std::filesystem::path& path,
+        AccessPattern pattern = AccessPattern::Sequential
+    );
+}
@@ -0,0 +1,171 @@
+#include "io/zstd_dictionary.h"
+#include "flux-core/exceptions.h"
+#include "utils/operation_metrics.h"
+#include <zdict.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fstream>
+
+namespace Flux::IO {
+    namespace {
+        constexpr uint32_t DICTIONARY_FRAME_MAGIC = 0x184D2A5D;   // Skippable; seek tables use 0x184D2A5E
+        constexpr std::array<char, 4> DICTIONARY_TAG = {'F', 'X', 'D', 'C'};
+        constexpr size_t FRAME_HEADER_SIZE = 8;
+
+        // Below this the trainer has too little to find common content
+        constexpr size_t MIN_SAMPLES = 16;
+        constexpr size_t MIN_DICTIONARY_SIZE = 1024;
+
+        void put32(std::vector<std::byte>& out, uint32_t value) {
+            for (int i = 0; i < 4; ++i) {
+                out.push_back(static_cast<std::byte>(value >> (8 * i)));
+            }
+        }
+
+        uint32_t get32(const uint8_t* data) {
+            return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                   (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24);
+        }
+
+        std::vector<std::byte> loadDictionaryFile(const std::filesystem::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                throw FileNotFoundException(path.string());
+            }
+            std::vector<std::byte> dictionary;
+            std::array<char, 64 * 1024> buffer;
+            while (file.read(buffer.data(), buffer.size()) || file.gcount() > 0) {
+                const auto* begin = reinterpret_cast<const std::byte*>(buffer.data());
+                dictionary.insert(dictionary.end(), begin, begin + file.gcount());
+            }
+            if (file.bad() || dictionary.empty()) {
+                throw FluxException(fmt::format("Cannot read zstd dictionary {}", path.string()));
+            }
+            return dictionary;
+        }
+    }
+
+    std::vector<std::byte> prepareZstdDictionary(const PackOptions& options, const FileManifest& manifest) {
+        if (!options.zstd_dictionary.empty()) {
+            auto dictionary = loadDictionaryFile(options.zstd_dictionary);
+            spdlog::info("Using zstd dictionary {} ({} bytes)", options.zstd_dictionary.string(), dictionary.size());
+            return dictionary;
+        }
+        if (options.train_dictionary) {
+            return trainZstdDictionary(manifest);
+        }
+        return {};
+    }
+
+    std::vector<std::byte> trainZstdDictionary(const FileManifest& manifest, size_t dictionary_size) {
+        std::vector<const ManifestEntry*> candidates;
+        uint64_t candidate_bytes = 0;
+        for (const auto& entry : manifest.entries) {
+            if (entry.hasFileContent() && entry.target_size >= 8 &&
+                entry.target_size <= Constants::Performance::DICTIONARY_SAMPLE_FILE_SIZE) {
+                candidates.push_back(&entry);
+                candidate_bytes += entry.target_size;
+            }
+        }
+        if (candidates.size() < MIN_SAMPLES) {
+            spdlog::info("Not training a zstd dictionary: only {} small files", candidates.size());
+            return {};
+        }
+
+        // Every n-th candidate, so the sample is spread over the whole tree
+        const double stride = std::max(1.0, static_cast<double>(candidate_bytes) /
+                                            static_cast<double>(Constants::Performance::DICTIONARY_SAMPLE_BUDGET));
+        std::vector<std::byte> samples;
+        std::vector<size_t> sample_sizes;
+        samples.reserve(static_cast<size_t>(std::min<uint64_t>(candidate_bytes, Constants::Performance::DICTIONARY_SAMPLE_BUDGET)));
+        for (double position = 0; position < static_cast<double>(candidates.size()); position += stride) {
+            const ManifestEntry& entry = *candidates[static_cast<size_t>(position)];
+            Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+            Utils::countSyscalls(3);    // open, read, close
+            std::ifstream file(entry.source, std::ios::binary);
+            const size_t used = samples.size();
+            samples.resize(used + static_cast<size_t>(entry.target_size));
+            file.read(reinterpret_cast<char*>(samples.data() + used), static_cast<std::streamsize>(entry.target_size));
+            const auto bytes_read = static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0));
+            samples.resize(used + bytes_read);
+            Utils::countBytesRead(bytes_read);
+            if (bytes_read > 0) {
+                sample_sizes.push_back(bytes_read);
+            }
+        }
+
+        // A dictionary much larger than a tenth of its samples costs more than it saves
+        dictionary_size = std::min(dictionary_size, samples.size() / 10);
+        if (sample_sizes.size() < MIN_SAMPLES || dictionary_size < MIN_DICTIONARY_SIZE) {
+            spdlog::info("Not training a zstd dictionary: {} bytes of samples is too little", samples.size());
+            return {};
+        }
+
+        std::vector<std::byte> dictionary(dictionary_size);
+        Utils::PhaseTimer timer(Utils::Phase::Codec);
+        const size_t size = ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), samples.data(),
+                                                  sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+        if (ZDICT_isError(size)) {
+            spdlog::warn("zstd dictionary training failed: {}", ZDICT_getErrorName(size));
+            return {};
+        }
+        dictionary.resize(size);
+        spdlog::info("Trained a {} byte zstd dictionary on {} files ({} bytes)",
+                     size, sample_sizes.size(), samples.size());
+        return dictionary;
+    }
+
+    std::vector<std::byte> encodeDictionaryFrame(std::span<const std::byte> dictionary) {
+        std::vector<std::byte> frame;
+        frame.reserve(FRAME_HEADER_SIZE + DICTIONARY_TAG.size() + dictionary.size());
+        put32(frame, DICTIONARY_FRAME_MAGIC);
+        put32(frame, static_cast<uint32_t>(DICTIONARY_TAG.size() + dictionary.size()));
+        for (const char c : DICTIONARY_TAG) {
+            frame.push_back(static_cast<std::byte>(c));
+        }
+        frame.insert(frame.end(), dictionary.begin(), dictionary.end());
+        return frame;
+    }
+
+    std::optional<std::vector<std::byte>> readEmbeddedDictionary(const std::filesystem::path& archive_path) {
+        std::ifstream file(archive_path, std::ios::binary);
+        std::array<uint8_t, FRAME_HEADER_SIZE + DICTIONARY_TAG.size()> header{};
+        if (!file.read(reinterpret_cast<char*>(header.data()), header.size()) ||
+            get32(header.data()) != DICTIONARY_FRAME_MAGIC ||
+            std::memcmp(header.data() + FRAME_HEADER_SIZE, DICTIONARY_TAG.data(), DICTIONARY_TAG.size()) != 0) {
+            return std::nullopt;
+        }
+
+        const uint32_t payload_size = get32(header.data() + 4);
+        if (payload_size <= DICTIONARY_TAG.size()) {
+            throw CorruptedArchiveException("Empty embedded zstd dictionary");
+        }
+        std::vector<std::byte> dictionary(payload_size - DICTIONARY_TAG.size());
+        file.read(reinterpret_cast<char*>(dictionary.data()), static_cast<std::streamsize>(dictionary.size()));
+        if (static_cast<size_t>(file.gcount()) != dictionary.size()) {
+            throw CorruptedArchiveException("Truncated embedded zstd dictionary");
+        }
+        return dictionary;
+    }
+
+    CDictPtr createCDict(std::span<const std::byte> dictionary, int level) {
+        CDictPtr cdict(ZSTD_createCDict(dictionary.data(), dictionary.size(), std::min(level, ZSTD_maxCLevel())),
+                       &ZSTD_freeCDict);
+        if (!cdict) {
+            throw CompressionException("Cannot load zstd dictionary");
+        }
+        return cdict;
+    }
+
+    SharedDDict createDDict(std::span<const std::byte> dictionary) {
+        SharedDDict ddict(ZSTD_createDDict(dictionary.data(), dictionary.size()),
+                          [](const ZSTD_DDict* d) { ZSTD_freeDDict(const_cast<ZSTD_DDict*>(d)); });
+        if (!ddict) {
+            throw CompressionException("Cannot load zstd dictionary");
+        }
+        return ddict;
+    }
+}
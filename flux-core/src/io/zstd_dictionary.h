@@ -0,0 +1,66 @@
+#pragma once
+#include "flux-core/archive.h"
+#include "flux-core/constants.h"
+#include "io/file_scanner.h"
+#include <zstd.h>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Flux::IO {
+    /**
+     * Dictionary to compress a pack with
+     *
+     * The file named by options.zstd_dictionary if set, else one trained from
+     * the manifest if options.train_dictionary is set, else nothing.
+     * @return Dictionary, or empty for none (also when training found too few samples)
+     * @throws FluxException if the dictionary file cannot be read
+     */
+    [[nodiscard]] std::vector<std::byte> prepareZstdDictionary(const PackOptions& options, const FileManifest& manifest);
+
+    /**
+     * Train a dictionary on small files of a manifest
+     *
+     * Files up to DICTIONARY_SAMPLE_FILE_SIZE are the samples; when they add
+     * up to more than DICTIONARY_SAMPLE_BUDGET an evenly spaced subset is
+     * read, so the sample covers every directory of the tree.
+     * @return Dictionary, or empty if there is too little to train on
+     */
+    [[nodiscard]] std::vector<std::byte> trainZstdDictionary(
+        const FileManifest& manifest,
+        size_t dictionary_size = Constants::Performance::DICTIONARY_SIZE
+    );
+
+    /**
+     * Skippable frame carrying a dictionary, written first in a TAR_ZSTD archive
+     *
+     * Readers without flux-core skip it; they then need the dictionary
+     * (`zstd -D`) for the frames that follow.
+     */
+    [[nodiscard]] std::vector<std::byte> encodeDictionaryFrame(std::span<const std::byte> dictionary);
+
+    /**
+     * Dictionary embedded at the start of a zstd-compressed archive
+     * @return Dictionary, or nothing if the archive does not start with one
+     */
+    [[nodiscard]] std::optional<std::vector<std::byte>> readEmbeddedDictionary(const std::filesystem::path& archive_path);
+
+    using CDictPtr = std::unique_ptr<ZSTD_CDict, size_t (*)(ZSTD_CDict*)>;
+    using SharedDDict = std::shared_ptr<const ZSTD_DDict>;
+
+    /**
+     * Digested compression dictionary; read-only, so any number of contexts may reference it
+     * @throws CompressionException
+     */
+    [[nodiscard]] CDictPtr createCDict(std::span<const std::byte> dictionary, int level);
+
+    /**
+     * Digested decompression dictionary, shareable between threads
+     * @throws CompressionException
+     */
+    [[nodiscard]] SharedDDict createDDict(std::span<const std::byte> dictionary);
+}
@@ -33,6 +33,11 @@ namespace Flux {
                 return ArchiveFormat::SEVEN_ZIP;
             }
 
+            // Flux dedup archive ("FLUXDDP1")
+            if (std::string(reinterpret_cast<const char*>(header.data()), 8) == "FLUXDDP1") {
+                return ArchiveFormat::FLUX_DEDUP;
+            }
+
             // TAR format detection (via ustar identifier at offset 257)
             file.seekg(257);
             std::vector<char> ustar(6);
@@ -82,6 +87,8 @@ namespace Flux {
                     return "application/zstd";
                 case ArchiveFormat::SEVEN_ZIP:
                     return "application/x-7z-compressed";
+                case ArchiveFormat::FLUX_DEDUP:
+                    return "application/x-flux-dedup";
                 default:
                     return "application/octet-stream";
             }
@@ -102,6 +109,8 @@ namespace Flux {
                     return ".tar.zst";
                 case ArchiveFormat::SEVEN_ZIP:
                     return ".7z";
+                case ArchiveFormat::FLUX_DEDUP:
+                    return ".fxd";
                 default:
                     return ".archive";
             }
@@ -120,6 +129,7 @@ namespace Flux {
                     case ArchiveFormat::SEVEN_ZIP:
                         return 9;
                     case ArchiveFormat::TAR_ZSTD:
+                    case ArchiveFormat::FLUX_DEDUP:
                         return 22; // ZSTD supports higher compression levels
                     default:
                         return -1; // Invalid format
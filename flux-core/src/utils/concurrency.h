@@ -0,0 +1,17 @@
+#pragma once
+#include <thread>
+
+namespace Flux::Utils {
+    /**
+     * Resolve a user-facing thread count setting
+     * @param requested Requested thread count (0 = use all hardware threads)
+     * @return Effective thread count, always at least 1
+     */
+    [[nodiscard]] inline unsigned resolveThreadCount(int requested) noexcept {
+        if (requested > 0) {
+            return static_cast<unsigned>(requested);
+        }
+        const unsigned hardware_threads = std::thread::hardware_concurrency();
+        return hardware_threads > 0 ? hardware_threads : 1;
+    }
+}
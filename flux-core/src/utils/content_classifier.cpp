@@ -0,0 +1,145 @@
+#include "utils/content_classifier.h"
+#include "flux-core/constants.h"
+#include "utils/operation_metrics.h"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace Flux::Utils {
+    namespace {
+        // Above this many bits per byte deflate gains nothing; random data measures ~7.95
+        constexpr double INCOMPRESSIBLE_ENTROPY = 7.5;
+        // Above this the fastest level finds nearly everything a slow one would
+        constexpr double DENSE_ENTROPY = 7.0;
+        // Shorter samples measure too low to tell random data from text
+        constexpr size_t MIN_ENTROPY_SAMPLE = 1024;
+        constexpr int DENSE_LEVEL = 1;
+
+        struct Signature {
+            size_t offset;
+            std::string_view magic;
+        };
+
+        constexpr auto SIGNATURES = std::to_array<Signature>({
+            {0, std::string_view("\xFF\xD8\xFF", 3)},                      // JPEG
+            {0, std::string_view("\x89PNG\r\n\x1A\n", 8)},                 // PNG
+            {0, "GIF8"},                                                   // GIF
+            {8, "WEBP"},                                                   // WebP (RIFF container)
+            {4, "ftyp"},                                                   // MP4, MOV, HEIC, AVIF
+            {0, std::string_view("\x1A\x45\xDF\xA3", 4)},                  // Matroska, WebM
+            {0, "OggS"},                                                   // Ogg, Opus
+            {0, "fLaC"},                                                   // FLAC
+            {0, "ID3"},                                                    // MP3
+            {0, "wOF2"},                                                   // WOFF2
+            {0, std::string_view("PK\x03\x04", 4)},                        // ZIP, JAR, OOXML, EPUB
+            {0, std::string_view("\x1F\x8B", 2)},                          // gzip
+            {0, std::string_view("\x28\xB5\x2F\xFD", 4)},                  // zstd
+            {0, std::string_view("\xFD" "7zXZ\x00", 6)},                   // xz
+            {0, "BZh"},                                                    // bzip2
+            {0, std::string_view("\x04\x22\x4D\x18", 4)},                  // LZ4
+            {0, std::string_view("7z\xBC\xAF\x27\x1C", 6)},                // 7-Zip
+            {0, std::string_view("Rar!\x1A\x07", 6)},                      // RAR
+        });
+
+        constexpr auto COMPRESSED_EXTENSIONS = std::to_array<std::string_view>({
+            ".jpg", ".jpeg", ".png", ".gif", ".webp", ".heic", ".avif",
+            ".mp3", ".m4a", ".aac", ".ogg", ".opus", ".flac",
+            ".mp4", ".m4v", ".mov", ".mkv", ".webm", ".avi",
+            ".zip", ".jar", ".apk", ".docx", ".xlsx", ".pptx", ".odt", ".epub",
+            ".gz", ".tgz", ".bz2", ".xz", ".zst", ".lz4", ".br", ".7z", ".rar", ".fxd",
+            ".woff", ".woff2",
+        });
+
+        bool hasCompressedExtension(std::string_view extension) {
+            std::string lower(extension);
+            std::transform(lower.begin(), lower.end(), lower.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return std::find(COMPRESSED_EXTENSIONS.begin(), COMPRESSED_EXTENSIONS.end(), lower) !=
+                   COMPRESSED_EXTENSIONS.end();
+        }
+
+        bool hasCompressedMagic(std::span<const std::byte> head) {
+            return std::any_of(SIGNATURES.begin(), SIGNATURES.end(), [head](const Signature& signature) {
+                return head.size() >= signature.offset + signature.magic.size() &&
+                       std::memcmp(head.data() + signature.offset, signature.magic.data(), signature.magic.size()) == 0;
+            });
+        }
+    }
+
+    double byteEntropy(std::span<const std::byte> sample) noexcept {
+        if (sample.empty()) {
+            return 0.0;
+        }
+        std::array<uint32_t, 256> counts{};
+        for (const std::byte b : sample) {
+            ++counts[static_cast<uint8_t>(b)];
+        }
+        const double total = static_cast<double>(sample.size());
+        double entropy = 0.0;
+        for (const uint32_t count : counts) {
+            if (count > 0) {
+                const double p = static_cast<double>(count) / total;
+                entropy -= p * std::log2(p);
+            }
+        }
+        return entropy;
+    }
+
+    ContentClass classifyContent(std::span<const std::byte> head, std::string_view extension) noexcept {
+        if (hasCompressedExtension(extension) || hasCompressedMagic(head)) {
+            return ContentClass::Incompressible;
+        }
+        if (head.size() < MIN_ENTROPY_SAMPLE) {
+            return ContentClass::Compressible;
+        }
+        const double entropy = byteEntropy(head);
+        if (entropy >= INCOMPRESSIBLE_ENTROPY) {
+            return ContentClass::Incompressible;
+        }
+        return entropy >= DENSE_ENTROPY ? ContentClass::Dense : ContentClass::Compressible;
+    }
+
+    ContentClass classifyFile(const std::filesystem::path& path) {
+        const std::string extension = path.extension().string();
+        // The extension alone avoids opening the file
+        if (hasCompressedExtension(extension)) {
+            return ContentClass::Incompressible;
+        }
+
+        std::vector<std::byte> head(Constants::Performance::ENTROPY_SAMPLE_SIZE);
+        {
+            Utils::PhaseTimer timer(Utils::Phase::DiskRead);
+            Utils::countSyscalls(3);    // open, read, close
+            std::ifstream file(path, std::ios::binary);
+            file.read(reinterpret_cast<char*>(head.data()), static_cast<std::streamsize>(head.size()));
+            head.resize(static_cast<size_t>(std::max<std::streamsize>(file.gcount(), 0)));
+            Utils::countBytesRead(head.size());
+        }
+        return classifyContent(head, extension);
+    }
+
+    CompressionChoice chooseCompression(const std::filesystem::path& path, int level, CompressionStrategy strategy) {
+        switch (strategy) {
+            case CompressionStrategy::STORE:
+                return {true, 0};
+            case CompressionStrategy::COMPRESS:
+                return {false, level};
+            case CompressionStrategy::AUTO:
+                break;
+        }
+        switch (classifyFile(path)) {
+            case ContentClass::Incompressible:
+                return {true, 0};
+            case ContentClass::Dense:
+                return {false, std::min(level, DENSE_LEVEL)};
+            case ContentClass::Compressible:
+                break;
+        }
+        return {false, level};
+    }
+}
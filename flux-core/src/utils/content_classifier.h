@@ -0,0 +1,58 @@
+#pragma once
+#include "flux-core/archive.h"
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string_view>
+
+namespace Flux::Utils {
+    /**
+     * How much a file is expected to shrink
+     */
+    enum class ContentClass {
+        Compressible,    // Text, source code, uncompressed binaries
+        Dense,           // Shrinks a little; a slow level does not pay off
+        Incompressible   // Already compressed (media, archives) or random
+    };
+
+    /**
+     * Shannon entropy of a sample in bits per byte (0 to 8)
+     */
+    [[nodiscard]] double byteEntropy(std::span<const std::byte> sample) noexcept;
+
+    /**
+     * Classify content from its first bytes and its file extension
+     *
+     * A known extension or magic number of a compressed format decides
+     * first; otherwise the entropy of the sample does. Samples too short
+     * to measure count as compressible.
+     * @param head Start of the content, up to ENTROPY_SAMPLE_SIZE bytes
+     * @param extension File extension including the dot, any case
+     */
+    [[nodiscard]] ContentClass classifyContent(std::span<const std::byte> head, std::string_view extension) noexcept;
+
+    /**
+     * Classify a file by reading up to ENTROPY_SAMPLE_SIZE bytes from its start
+     *
+     * Files that cannot be read count as compressible; the error surfaces
+     * when the packer reads them.
+     */
+    [[nodiscard]] ContentClass classifyFile(const std::filesystem::path& path);
+
+    /**
+     * Per-file compression decision
+     */
+    struct CompressionChoice {
+        bool store = false;   // Store without compression
+        int level = 0;        // Level to compress at otherwise
+    };
+
+    /**
+     * Decide how to compress one file
+     * @param level Requested level, used for compressible content
+     * @param strategy AUTO classifies the file; STORE and COMPRESS apply to every file
+     */
+    [[nodiscard]] CompressionChoice chooseCompression(const std::filesystem::path& path,
+                                                      int level,
+                                                      CompressionStrategy strategy);
+}
@@ -27,6 +27,9 @@ namespace Flux {
             
             // 7-Zip format
             {{0x37, 0x7A, 0xBC, 0xAF, 0x27, 0x1C}, 0, ArchiveFormat::SEVEN_ZIP, "7-Zip"},
+
+            // Flux deduplicating archive
+            {{0x46, 0x4C, 0x55, 0x58, 0x44, 0x44, 0x50, 0x31}, 0, ArchiveFormat::FLUX_DEDUP, "Flux dedup"},
             
             // GZIP format (for TAR.GZ)
             {{0x1F, 0x8B}, 0, ArchiveFormat::TAR_GZ, "GZIP"},
@@ -36,6 +39,7 @@ namespace Flux {
             
             // ZSTD format (for TAR.ZSTD)
             {{0x28, 0xB5, 0x2F, 0xFD}, 0, ArchiveFormat::TAR_ZSTD, "ZSTD"},
+            {{0x5D, 0x2A, 0x4D, 0x18}, 0, ArchiveFormat::TAR_ZSTD, "ZSTD (dictionary)"},
         };
 
         /**
@@ -113,7 +117,8 @@ namespace Flux {
                 std::pair{".tar.zst", ArchiveFormat::TAR_ZSTD},
                 std::pair{".tar.zstd", ArchiveFormat::TAR_ZSTD},
                 std::pair{".zip", ArchiveFormat::ZIP},
-                std::pair{".7z", ArchiveFormat::SEVEN_ZIP}
+                std::pair{".7z", ArchiveFormat::SEVEN_ZIP},
+                std::pair{".fxd", ArchiveFormat::FLUX_DEDUP}
             };
             
             // Check compound extensions first
@@ -163,6 +168,8 @@ namespace Flux {
                     return "TAR+ZSTD - High performance compression format (recommended)";
                 case ArchiveFormat::SEVEN_ZIP:
                     return "7-Zip - Professional high compression ratio format";
+                case ArchiveFormat::FLUX_DEDUP:
+                    return "FXD - Deduplicating chunk archive, optionally sharing a chunk store";
                 default:
                     return "Unknown format";
             }
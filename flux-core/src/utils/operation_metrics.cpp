@@ -0,0 +1,29 @@
+#include "utils/operation_metrics.h"
+
+namespace Flux::Utils {
+    void MetricsRecorder::bufferAcquired(size_t bytes) noexcept {
+        const uint64_t held = m_buffer_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        uint64_t peak = m_peak_buffer_bytes.load(std::memory_order_relaxed);
+        while (held > peak && !m_peak_buffer_bytes.compare_exchange_weak(peak, held, std::memory_order_relaxed)) {
+        }
+    }
+
+    OperationMetrics MetricsRecorder::snapshot() const noexcept {
+        const auto phase = [this](Phase p) {
+            return std::chrono::nanoseconds(m_phases[static_cast<size_t>(p)].load(std::memory_order_relaxed));
+        };
+        OperationMetrics metrics;
+        metrics.directory_scan = phase(Phase::DirectoryScan);
+        metrics.header_parse = phase(Phase::HeaderParse);
+        metrics.disk_read = phase(Phase::DiskRead);
+        metrics.codec = phase(Phase::Codec);
+        metrics.disk_write = phase(Phase::DiskWrite);
+        metrics.metadata_apply = phase(Phase::MetadataApply);
+        metrics.callbacks = phase(Phase::Callbacks);
+        metrics.syscalls = m_syscalls.load(std::memory_order_relaxed);
+        metrics.bytes_read = m_bytes_read.load(std::memory_order_relaxed);
+        metrics.entries_skipped = m_entries_skipped.load(std::memory_order_relaxed);
+        metrics.peak_buffer_bytes = m_peak_buffer_bytes.load(std::memory_order_relaxed);
+        return metrics;
+    }
+}
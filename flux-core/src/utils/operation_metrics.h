@@ -0,0 +1,191 @@
+#pragma once
+#include "flux-core/archive.h"
+#include "flux-core/packer.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace Flux::Utils {
+    /**
+     * Phases of OperationMetrics
+     */
+    enum class Phase : uint8_t {
+        DirectoryScan,
+        HeaderParse,
+        DiskRead,
+        Codec,
+        DiskWrite,
+        MetadataApply,
+        Callbacks,
+        Count
+    };
+
+    /**
+     * Collects OperationMetrics for one operation from any number of threads
+     *
+     * Code does not pass a recorder around: the operation installs it on its
+     * thread with MetricsScope, workers install the one they were started
+     * with, and instrumented code looks it up with currentMetrics(). With no
+     * recorder installed every hook is a thread-local load and a branch.
+     */
+    class MetricsRecorder {
+    public:
+        void addTime(Phase phase, std::chrono::nanoseconds time) noexcept {
+            m_phases[static_cast<size_t>(phase)].fetch_add(time.count(), std::memory_order_relaxed);
+        }
+        void addSyscalls(uint64_t count) noexcept { m_syscalls.fetch_add(count, std::memory_order_relaxed); }
+        void addBytesRead(uint64_t bytes) noexcept { m_bytes_read.fetch_add(bytes, std::memory_order_relaxed); }
+        void addEntriesSkipped(uint64_t count) noexcept { m_entries_skipped.fetch_add(count, std::memory_order_relaxed); }
+
+        /**
+         * Buffer memory taken and given back, for the peak
+         */
+        void bufferAcquired(size_t bytes) noexcept;
+        void bufferReleased(size_t bytes) noexcept {
+            m_buffer_bytes.fetch_sub(bytes, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] OperationMetrics snapshot() const noexcept;
+
+    private:
+        std::array<std::atomic<int64_t>, static_cast<size_t>(Phase::Count)> m_phases{};
+        std::atomic<uint64_t> m_syscalls{0};
+        std::atomic<uint64_t> m_bytes_read{0};
+        std::atomic<uint64_t> m_entries_skipped{0};
+        std::atomic<uint64_t> m_buffer_bytes{0};
+        std::atomic<uint64_t> m_peak_buffer_bytes{0};
+    };
+
+    inline thread_local MetricsRecorder* t_metrics = nullptr;
+
+    /**
+     * Recorder of the operation running on this thread, or null
+     */
+    [[nodiscard]] inline MetricsRecorder* currentMetrics() noexcept {
+        return t_metrics;
+    }
+
+    /**
+     * Install a recorder (possibly null) on this thread for the scope's lifetime
+     */
+    class MetricsScope {
+    public:
+        explicit MetricsScope(MetricsRecorder* recorder) noexcept : m_previous(t_metrics) {
+            t_metrics = recorder;
+        }
+        ~MetricsScope() { t_metrics = m_previous; }
+
+        MetricsScope(const MetricsScope&) = delete;
+        MetricsScope& operator=(const MetricsScope&) = delete;
+
+    private:
+        MetricsRecorder* m_previous;
+    };
+
+    /**
+     * Charges the time until destruction to a phase
+     *
+     * Timers nest: while an inner timer runs, the outer one is paused, so
+     * writing compressed output from inside compression counts as disk write
+     * only.
+     */
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer(Phase phase) noexcept : PhaseTimer(currentMetrics(), phase) {}
+
+        PhaseTimer(MetricsRecorder* recorder, Phase phase) noexcept : m_recorder(recorder), m_phase(phase) {
+            if (!m_recorder) {
+                return;
+            }
+            m_start = Clock::now();
+            m_outer = t_active;
+            if (m_outer) {
+                m_outer->charge(m_start);
+            }
+            t_active = this;
+        }
+
+        ~PhaseTimer() {
+            if (!m_recorder) {
+                return;
+            }
+            const auto now = Clock::now();
+            charge(now);
+            t_active = m_outer;
+            if (m_outer) {
+                m_outer->m_start = now;
+            }
+        }
+
+        PhaseTimer(const PhaseTimer&) = delete;
+        PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        void charge(Clock::time_point now) noexcept {
+            m_recorder->addTime(m_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_start));
+        }
+
+        static inline thread_local PhaseTimer* t_active = nullptr;
+
+        MetricsRecorder* m_recorder;
+        Phase m_phase;
+        Clock::time_point m_start{};
+        PhaseTimer* m_outer = nullptr;
+    };
+
+    /*
+     * Counters for the current operation; no-ops without a recorder
+     */
+
+    inline void countSyscalls(uint64_t count = 1) noexcept {
+        if (MetricsRecorder* recorder = currentMetrics()) {
+            recorder->addSyscalls(count);
+        }
+    }
+
+    inline void countBytesRead(uint64_t bytes) noexcept {
+        if (MetricsRecorder* recorder = currentMetrics()) {
+            recorder->addBytesRead(bytes);
+        }
+    }
+
+    inline void countSkippedEntry() noexcept {
+        if (MetricsRecorder* recorder = currentMetrics()) {
+            recorder->addEntriesSkipped(1);
+        }
+    }
+
+    /**
+     * Run a pack or extract operation with a recorder installed and its result's metrics filled
+     *
+     * operation receives the callbacks to use, wrapped to time themselves.
+     */
+    template <typename Operation>
+    auto runWithMetrics(const ProgressCallback& on_progress, const ErrorCallback& on_error, Operation&& operation) {
+        MetricsRecorder recorder;
+        MetricsScope scope(&recorder);
+
+        ProgressCallback timed_progress;
+        if (on_progress) {
+            timed_progress = [&](std::string_view name, float progress, size_t done, size_t total) {
+                PhaseTimer timer(&recorder, Phase::Callbacks);
+                on_progress(name, progress, done, total);
+            };
+        }
+        ErrorCallback timed_error;
+        if (on_error) {
+            timed_error = [&](std::string_view message, bool fatal) {
+                PhaseTimer timer(&recorder, Phase::Callbacks);
+                on_error(message, fatal);
+            };
+        }
+
+        auto result = operation(timed_progress, timed_error);
+        result.metrics = recorder.snapshot();
+        return result;
+    }
+}
@@ -0,0 +1,260 @@
+#include "utils/pattern_matcher.h"
+#include "flux-core/exceptions.h"
+#include <fmt/format.h>
+
+namespace Flux::Utils {
+    namespace {
+        using ByteSet = std::bitset<256>;
+
+        /**
+         * One element of a parsed pattern
+         */
+        struct Token {
+            enum class Kind {
+                Byte,       // One byte from the set
+                Star,       // `*`: any run of bytes except '/'
+                GlobStar,   // `**`: any run of bytes
+                GlobDir     // `**/`: zero or more directories (two states)
+            };
+            Kind kind = Kind::Byte;
+            ByteSet bytes;
+        };
+
+        constexpr unsigned char SEPARATOR = '/';
+
+        ByteSet anyButSeparator() {
+            ByteSet bytes;
+            bytes.set();
+            bytes.reset(SEPARATOR);
+            return bytes;
+        }
+
+        Token literal(unsigned char c) {
+            Token token;
+            token.bytes.set(c);
+            return token;
+        }
+
+        /**
+         * Drop the parts of a path or pattern that do not affect matching
+         */
+        std::string_view normalize(std::string_view path) noexcept {
+            while (path.starts_with("./")) {
+                path.remove_prefix(2);
+            }
+            while (path.starts_with('/')) {
+                path.remove_prefix(1);
+            }
+            while (path.ends_with('/')) {
+                path.remove_suffix(1);
+            }
+            return path;
+        }
+
+        /**
+         * Parse a bracket expression starting after '['
+         * @return Position after the closing ']', or npos if it is not terminated
+         */
+        size_t parseClass(std::string_view pattern, size_t pos, ByteSet& bytes) {
+            bool negated = false;
+            if (pos < pattern.size() && (pattern[pos] == '!' || pattern[pos] == '^')) {
+                negated = true;
+                ++pos;
+            }
+
+            // A ']' right after the opening bracket is a member
+            bool first = true;
+            while (pos < pattern.size() && (first || pattern[pos] != ']')) {
+                first = false;
+                unsigned char low = static_cast<unsigned char>(pattern[pos++]);
+                if (low == '\\' && pos < pattern.size()) {
+                    low = static_cast<unsigned char>(pattern[pos++]);
+                }
+                unsigned char high = low;
+                if (pos + 1 < pattern.size() && pattern[pos] == '-' && pattern[pos + 1] != ']') {
+                    high = static_cast<unsigned char>(pattern[pos + 1]);
+                    pos += 2;
+                }
+                for (unsigned c = low; c <= high; ++c) {
+                    bytes.set(c);
+                }
+            }
+            if (pos >= pattern.size()) {
+                return std::string_view::npos;
+            }
+
+            if (negated) {
+                bytes.flip();
+            }
+            bytes.reset(SEPARATOR);
+            return pos + 1;
+        }
+
+        std::vector<Token> parse(std::string_view pattern) {
+            std::vector<Token> tokens;
+
+            // Plain names keep the substring semantics of earlier releases
+            if (pattern.find_first_of("*?[\\") == std::string_view::npos) {
+                tokens.push_back({Token::Kind::GlobStar, {}});
+                for (const char c : pattern) {
+                    tokens.push_back(literal(static_cast<unsigned char>(c)));
+                }
+                tokens.push_back({Token::Kind::GlobStar, {}});
+                return tokens;
+            }
+
+            // Without a directory part the pattern applies to the last component
+            if (pattern.find('/') == std::string_view::npos) {
+                tokens.push_back({Token::Kind::GlobDir, {}});
+            }
+
+            size_t pos = 0;
+            while (pos < pattern.size()) {
+                const char c = pattern[pos++];
+                switch (c) {
+                    case '\\':
+                        tokens.push_back(literal(static_cast<unsigned char>(pos < pattern.size() ? pattern[pos++] : '\\')));
+                        break;
+                    case '?':
+                        tokens.push_back({Token::Kind::Byte, anyButSeparator()});
+                        break;
+                    case '*': {
+                        if (pos == pattern.size() || pattern[pos] != '*') {
+                            tokens.push_back({Token::Kind::Star, {}});
+                            break;
+                        }
+                        const bool segment_start = (pos == 1 || pattern[pos - 2] == '/');
+                        while (pos < pattern.size() && pattern[pos] == '*') {
+                            ++pos;
+                        }
+                        if (segment_start && pos < pattern.size() && pattern[pos] == '/') {
+                            ++pos;
+                            tokens.push_back({Token::Kind::GlobDir, {}});
+                        } else {
+                            tokens.push_back({Token::Kind::GlobStar, {}});
+                        }
+                        break;
+                    }
+                    case '[': {
+                        Token token;
+                        const size_t end = parseClass(pattern, pos, token.bytes);
+                        if (end == std::string_view::npos) {
+                            tokens.push_back(literal('['));
+                        } else {
+                            tokens.push_back(token);
+                            pos = end;
+                        }
+                        break;
+                    }
+                    default:
+                        tokens.push_back(literal(static_cast<unsigned char>(c)));
+                        break;
+                }
+            }
+            return tokens;
+        }
+
+        size_t stateCount(const std::vector<Token>& tokens) {
+            size_t count = 1;  // Final state
+            for (const auto& token : tokens) {
+                count += (token.kind == Token::Kind::GlobDir) ? 2 : 1;
+            }
+            return count;
+        }
+    }
+
+    PathMatcher::PathMatcher(std::span<const std::string> patterns) {
+        for (const auto& raw_pattern : patterns) {
+            const std::string_view pattern = normalize(raw_pattern);
+            if (pattern.empty()) {
+                continue;
+            }
+
+            const std::vector<Token> tokens = parse(pattern);
+            const size_t needed = stateCount(tokens);
+            if (needed > MAX_STATES) {
+                throw FluxException(fmt::format("Pattern is too long: {}", raw_pattern));
+            }
+            if (m_programs.empty() || m_programs.back().size + needed > MAX_STATES) {
+                m_programs.emplace_back();
+            }
+
+            Program& program = m_programs.back();
+            size_t state = program.size;
+            program.start.set(state);
+            for (const auto& token : tokens) {
+                switch (token.kind) {
+                    case Token::Kind::Byte:
+                        for (size_t c = 0; c < 256; ++c) {
+                            if (token.bytes.test(c)) {
+                                program.advance[c].set(state);
+                            }
+                        }
+                        break;
+                    case Token::Kind::Star:
+                        for (size_t c = 0; c < 256; ++c) {
+                            if (c != SEPARATOR) {
+                                program.stay[c].set(state);
+                            }
+                        }
+                        program.skip_one.set(state);
+                        break;
+                    case Token::Kind::GlobStar:
+                        for (auto& stay : program.stay) {
+                            stay.set(state);
+                        }
+                        program.skip_one.set(state);
+                        break;
+                    case Token::Kind::GlobDir:
+                        // Entry state: either skip the directories or start on them;
+                        // the loop state only leaves on a separator
+                        program.skip_one.set(state);
+                        program.skip_two.set(state);
+                        ++state;
+                        for (auto& stay : program.stay) {
+                            stay.set(state);
+                        }
+                        program.advance[SEPARATOR].set(state);
+                        break;
+                }
+                ++state;
+            }
+            program.accept.set(state);
+            program.size = state + 1;
+        }
+
+        for (auto& program : m_programs) {
+            closeOver(program.start, program);
+        }
+    }
+
+    void PathMatcher::closeOver(StateSet& states, const Program& program) noexcept {
+        // Empty moves only go forward, so this settles after a few rounds
+        for (;;) {
+            const StateSet closed = states | ((states & program.skip_one) << 1) | ((states & program.skip_two) << 2);
+            if (closed == states) {
+                return;
+            }
+            states = closed;
+        }
+    }
+
+    bool PathMatcher::matches(std::string_view path) const noexcept {
+        path = normalize(path);
+        for (const auto& program : m_programs) {
+            StateSet states = program.start;
+            for (const char c : path) {
+                const auto byte = static_cast<unsigned char>(c);
+                states = ((states & program.advance[byte]) << 1) | (states & program.stay[byte]);
+                if (states.none()) {
+                    break;
+                }
+                closeOver(states, program);
+            }
+            if ((states & program.accept).any()) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Flux::Utils {
+    /**
+     * Set of path patterns compiled once and matched without allocating
+     *
+     * Pattern syntax:
+     *  - `*` matches any run of characters except '/', `?` a single one
+     *  - `[abc]`, `[a-z]` and `[!a]` / `[^a]` match one character except '/'
+     *  - `**` also crosses '/'; as a whole segment (`**` + '/') it matches
+     *    zero or more directories
+     *  - `\` makes the next character literal
+     * Patterns without '/' match the last path component ("*.txt" matches
+     * "docs/a.txt"); others match the whole path, a leading '/' is ignored.
+     * Patterns without any wildcard match paths that contain them, which is
+     * how extractPartial has always treated plain names.
+     *
+     * All patterns are compiled into bit-parallel NFAs of up to MAX_STATES
+     * states each, so a path is matched in one pass regardless of the number
+     * of patterns. Paths are compared with leading "./" and a trailing '/'
+     * removed.
+     */
+    class PathMatcher {
+    public:
+        static constexpr size_t MAX_STATES = 256;
+
+        /**
+         * Matcher for no patterns; matches nothing
+         */
+        PathMatcher() = default;
+
+        /**
+         * Compile patterns; empty patterns are ignored
+         * @throws FluxException if a single pattern needs more than MAX_STATES states
+         */
+        explicit PathMatcher(std::span<const std::string> patterns);
+
+        /**
+         * @return true if no pattern was compiled
+         */
+        [[nodiscard]] bool empty() const noexcept { return m_programs.empty(); }
+
+        /**
+         * @return true if any pattern matches the path
+         */
+        [[nodiscard]] bool matches(std::string_view path) const noexcept;
+
+    private:
+        using StateSet = std::bitset<MAX_STATES>;
+
+        /**
+         * NFA over several patterns laid out one after another
+         */
+        struct Program {
+            std::array<StateSet, 256> advance{};  // States that consume the byte and move to the next state
+            std::array<StateSet, 256> stay{};     // States that consume the byte and stay
+            StateSet skip_one;                    // States with an empty move to the next state
+            StateSet skip_two;                    // States with an empty move over the next state
+            StateSet start;                       // Initial states, closed over empty moves
+            StateSet accept;                      // Final state of each pattern
+            size_t size = 0;                      // States in use
+        };
+
+        static void closeOver(StateSet& states, const Program& program) noexcept;
+
+        std::vector<Program> m_programs;
+    };
+
+    /**
+     * Include/exclude selection as used by ExtractOptions and PackOptions
+     *
+     * A path is accepted when there are no include patterns or one of them
+     * matches, and no exclude pattern matches.
+     */
+    class PathFilter {
+    public:
+        PathFilter() = default;
+        PathFilter(std::span<const std::string> include_patterns,
+                   std::span<const std::string> exclude_patterns)
+            : m_include(include_patterns), m_exclude(exclude_patterns) {}
+
+        /**
+         * @return true if every path is accepted
+         */
+        [[nodiscard]] bool acceptsAll() const noexcept { return m_include.empty() && m_exclude.empty(); }
+
+        [[nodiscard]] bool accepts(std::string_view path) const noexcept {
+            return (m_include.empty() || m_include.matches(path)) && !m_exclude.matches(path);
+        }
+
+        /**
+         * Exclusion alone, for directories that are walked regardless of includes
+         */
+        [[nodiscard]] bool excludes(std::string_view path) const noexcept {
+            return m_exclude.matches(path);
+        }
+
+    private:
+        PathMatcher m_include;
+        PathMatcher m_exclude;
+    };
+}
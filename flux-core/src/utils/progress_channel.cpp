@@ -0,0 +1,105 @@
+#include "utils/progress_channel.h"
+#include "flux-core/constants.h"
+#include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+namespace Flux::Utils {
+    ProgressChannel::ProgressChannel(const ProgressCallback& on_progress, std::string_view verb, uint64_t total)
+        : m_on_progress(on_progress), m_label(verb), m_verb_size(verb.size()), m_total(total) {
+        if (enabled()) {
+            // Names are appended in place from here on
+            m_label.reserve(verb.size() + 2 + MAX_NAME_SIZE);
+            m_reporter = std::jthread([this](std::stop_token stop) { run(std::move(stop)); });
+        }
+    }
+
+    ProgressChannel::~ProgressChannel() {
+        finish();
+    }
+
+    void ProgressChannel::offerName(std::string_view name) noexcept {
+        // Only the worker that takes the request writes the name
+        if (!m_name_wanted.exchange(false, std::memory_order_acquire)) {
+            return;
+        }
+        size_t size = std::min(name.size(), MAX_NAME_SIZE);
+        // A cut name ends before the character it cut into
+        while (size < name.size() && size > 0 && (static_cast<unsigned char>(name[size]) & 0xC0) == 0x80) {
+            --size;
+        }
+        std::memcpy(m_name, name.data(), size);
+        m_name_size = size;
+        m_name_ready.store(true, std::memory_order_release);
+    }
+
+    void ProgressChannel::offerName(const std::filesystem::path& path) noexcept {
+        if constexpr (std::is_same_v<std::filesystem::path::value_type, char>) {
+            offerName(std::string_view(path.native()));
+        } else {
+            try {
+                offerName(std::string_view(path.string()));
+            } catch (...) {
+            }
+        }
+    }
+
+    void ProgressChannel::finish() noexcept {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_finished) {
+                return;
+            }
+            m_finished = true;
+        }
+        if (m_reporter.joinable()) {
+            m_reporter.request_stop();
+            m_wakeup.notify_all();
+            m_reporter.join();
+        }
+        if (enabled()) {
+            report(true);
+        }
+    }
+
+    void ProgressChannel::run(std::stop_token stop) {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wakeup.wait_for(lock, stop, Constants::PROGRESS_UPDATE_TIME, [&stop] { return stop.stop_requested(); })) {
+            lock.unlock();
+            report(false);
+            lock.lock();
+        }
+    }
+
+    void ProgressChannel::report(bool final) noexcept {
+        const uint64_t done = m_done.load(std::memory_order_relaxed);
+        const uint64_t total = m_total.load(std::memory_order_relaxed);
+        const float fraction = total > 0
+            ? std::min(1.0f, static_cast<float>(done) / static_cast<float>(total))
+            : 0.0f;
+
+        const bool fresh_name = m_name_ready.load(std::memory_order_acquire);
+        if (fresh_name) {
+            m_label.resize(m_verb_size);
+            m_label.append(": ");
+            m_label.append(m_name, m_name_size);
+            m_name_ready.store(false, std::memory_order_relaxed);
+            m_name_wanted.store(true, std::memory_order_release);
+        }
+
+        if (!final && !fresh_name && std::fabs(fraction - m_reported) < Constants::PROGRESS_UPDATE_INTERVAL) {
+            return;
+        }
+        m_reported = fraction;
+        // The operation cannot see a failure on the reporter thread, so none is passed on from here either
+        try {
+            m_on_progress(m_label, fraction, static_cast<size_t>(done), static_cast<size_t>(total));
+        } catch (const std::exception& e) {
+            spdlog::warn("Progress callback failed: {}", e.what());
+        } catch (...) {
+            spdlog::warn("Progress callback failed");
+        }
+    }
+}
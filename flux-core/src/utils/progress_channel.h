@@ -0,0 +1,102 @@
+#pragma once
+#include "flux-core/packer.h"
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Flux::Utils {
+    /**
+     * Progress of one operation, updated by workers and reported at a fixed rate
+     *
+     * Workers bump atomic counters and offer entry names; neither allocates
+     * nor locks. A reporter thread samples the counters every
+     * Constants::PROGRESS_UPDATE_TIME and calls the operation's callback when
+     * a new entry name came in or the fraction moved by at least
+     * Constants::PROGRESS_UPDATE_INTERVAL. The callback therefore never runs
+     * concurrently with itself. finish() stops the reporter and delivers the
+     * final state on the calling thread.
+     *
+     * Names are handed over on request: the reporter raises a flag and the
+     * next entry() call to see it copies its name into the channel. Between
+     * requests entry() is a relaxed load and a branch.
+     */
+    class ProgressChannel {
+    public:
+        /**
+         * @param on_progress Callback to report to; an empty one makes every call a no-op
+         * @param verb Prefix of reported names, "Extracting" gives "Extracting: a/b.txt"
+         * @param total Units expected, files or bytes as the operation counts them
+         */
+        ProgressChannel(const ProgressCallback& on_progress, std::string_view verb, uint64_t total);
+        ~ProgressChannel();
+
+        ProgressChannel(const ProgressChannel&) = delete;
+        ProgressChannel& operator=(const ProgressChannel&) = delete;
+
+        [[nodiscard]] bool enabled() const noexcept { return static_cast<bool>(m_on_progress); }
+
+        void setTotal(uint64_t total) noexcept { m_total.store(total, std::memory_order_relaxed); }
+
+        /**
+         * Count units done; update() sets the count for operations that track a position
+         */
+        void advance(uint64_t units = 1) noexcept { m_done.fetch_add(units, std::memory_order_relaxed); }
+        void update(uint64_t done) noexcept { m_done.store(done, std::memory_order_relaxed); }
+
+        /**
+         * Offer the name of the entry being worked on
+         */
+        void entry(std::string_view name) noexcept {
+            if (m_name_wanted.load(std::memory_order_relaxed)) {
+                offerName(name);
+            }
+        }
+
+        template <typename Path>
+            requires std::same_as<Path, std::filesystem::path>
+        void entry(const Path& path) noexcept {
+            if (m_name_wanted.load(std::memory_order_relaxed)) {
+                offerName(path);
+            }
+        }
+
+        /**
+         * Stop the reporter and report the final state; later calls do nothing
+         *
+         * Exceptions thrown by the callback are logged, not passed on.
+         */
+        void finish() noexcept;
+
+    private:
+        static constexpr size_t MAX_NAME_SIZE = 512;    // Longer names are cut
+
+        void offerName(std::string_view name) noexcept;
+        void offerName(const std::filesystem::path& path) noexcept;
+        void run(std::stop_token stop);
+        void report(bool final) noexcept;
+
+        const ProgressCallback& m_on_progress;
+        std::string m_label;                 // Verb and latest name, owned by the reporting thread
+        size_t m_verb_size;
+        float m_reported = -1.0f;
+
+        std::atomic<uint64_t> m_done{0};
+        std::atomic<uint64_t> m_total;
+        std::atomic<bool> m_name_wanted{true};
+        std::atomic<bool> m_name_ready{false};
+        size_t m_name_size = 0;
+        char m_name[MAX_NAME_SIZE];
+
+        std::mutex m_mutex;
+        std::condition_variable_any m_wakeup;
+        std::jthread m_reporter;
+        bool m_finished = false;
+    };
+}
@@ -0,0 +1,184 @@
+#include "utils/sha256.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define FLUX_SHA256_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+namespace Flux::Utils {
+    namespace {
+        constexpr uint32_t K[64] = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+            0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+            0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+            0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+            0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+            0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+            0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+        };
+
+        constexpr uint32_t INITIAL_STATE[8] = {
+            0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+        };
+
+        constexpr uint32_t rotr(uint32_t x, int n) noexcept {
+            return (x >> n) | (x << (32 - n));
+        }
+
+        uint32_t loadBigEndian(const uint8_t* p) noexcept {
+            return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                   (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+        }
+
+        void compressPortable(uint32_t state[8], const uint8_t* data, size_t blocks) noexcept {
+            uint32_t w[64];
+            for (; blocks > 0; --blocks, data += 64) {
+                for (size_t i = 0; i < 16; ++i) {
+                    w[i] = loadBigEndian(data + 4 * i);
+                }
+                for (size_t i = 16; i < 64; ++i) {
+                    const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                    const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+
+                uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+                uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+                for (size_t i = 0; i < 64; ++i) {
+                    const uint32_t t1 = h + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) + K[i] + w[i];
+                    const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                    h = g; g = f; f = e; e = d + t1;
+                    d = c; c = b; b = a; a = t1 + t2;
+                }
+                state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+                state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+            }
+        }
+
+#ifdef FLUX_SHA256_SHANI
+        /**
+         * Four rounds per sha256rnds2 pair; the message schedule for the next
+         * four words is derived from the previous sixteen with sha256msg1/2
+         */
+        __attribute__((target("sha,sse4.1")))
+        void compressShaNi(uint32_t state[8], const uint8_t* data, size_t blocks) noexcept {
+            const __m128i byte_swap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+            // The instructions keep the state as ABEF and CDGH
+            __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[0])), 0xB1);
+            __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(&state[4])), 0x1B);
+            __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+            state1 = _mm_blend_epi16(state1, tmp, 0xF0);
+
+            for (; blocks > 0; --blocks, data += 64) {
+                const __m128i abef = state0;
+                const __m128i cdgh = state1;
+
+                __m128i message[4];
+                for (size_t i = 0; i < 4; ++i) {
+                    message[i] = _mm_shuffle_epi8(
+                        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16 * i)), byte_swap);
+                }
+
+                for (size_t i = 0; i < 16; ++i) {
+                    __m128i& words = message[i % 4];
+                    if (i >= 4) {
+                        // words holds W[4i-16..4i-13] and becomes W[4i..4i+3]
+                        words = _mm_sha256msg1_epu32(words, message[(i - 3) % 4]);
+                        words = _mm_add_epi32(words, _mm_alignr_epi8(message[(i - 1) % 4], message[(i - 2) % 4], 4));
+                        words = _mm_sha256msg2_epu32(words, message[(i - 1) % 4]);
+                    }
+                    __m128i scheduled = _mm_add_epi32(words, _mm_loadu_si128(reinterpret_cast<const __m128i*>(&K[4 * i])));
+                    state1 = _mm_sha256rnds2_epu32(state1, state0, scheduled);
+                    scheduled = _mm_shuffle_epi32(scheduled, 0x0E);
+                    state0 = _mm_sha256rnds2_epu32(state0, state1, scheduled);
+                }
+
+                state0 = _mm_add_epi32(state0, abef);
+                state1 = _mm_add_epi32(state1, cdgh);
+            }
+
+            tmp = _mm_shuffle_epi32(state0, 0x1B);
+            state1 = _mm_shuffle_epi32(state1, 0xB1);
+            state0 = _mm_blend_epi16(tmp, state1, 0xF0);
+            state1 = _mm_alignr_epi8(state1, tmp, 8);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+        }
+
+        bool detectShaNi() noexcept {
+            unsigned eax = 0, ebx = 0, ecx = 0, edx = 0;
+            if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            const bool has_sse41 = (ecx & bit_SSE4_1) != 0;
+            if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+                return false;
+            }
+            return has_sse41 && (ebx & (1u << 29)) != 0;
+        }
+#endif
+
+        using CompressFunction = void (*)(uint32_t*, const uint8_t*, size_t) noexcept;
+
+        CompressFunction selectCompress() noexcept {
+#ifdef FLUX_SHA256_SHANI
+            if (detectShaNi()) {
+                return &compressShaNi;
+            }
+#endif
+            return &compressPortable;
+        }
+
+        const CompressFunction compress = selectCompress();
+
+        Sha256Digest digest(CompressFunction compress_blocks, std::span<const std::byte> data) noexcept {
+            uint32_t state[8];
+            std::memcpy(state, INITIAL_STATE, sizeof(state));
+
+            const auto* bytes = reinterpret_cast<const uint8_t*>(data.data());
+            const size_t full_blocks = data.size() / 64;
+            if (full_blocks > 0) {
+                compress_blocks(state, bytes, full_blocks);
+            }
+
+            // Remaining bytes, the 0x80 terminator and the bit length fill one or two blocks
+            uint8_t tail[128] = {};
+            const size_t remaining = data.size() % 64;
+            if (remaining > 0) {
+                std::memcpy(tail, bytes + full_blocks * 64, remaining);
+            }
+            tail[remaining] = 0x80;
+            const size_t tail_size = remaining < 56 ? 64 : 128;
+            const uint64_t bit_length = static_cast<uint64_t>(data.size()) * 8;
+            for (size_t i = 0; i < 8; ++i) {
+                tail[tail_size - 1 - i] = static_cast<uint8_t>(bit_length >> (8 * i));
+            }
+            compress_blocks(state, tail, tail_size / 64);
+
+            Sha256Digest result;
+            for (size_t i = 0; i < 8; ++i) {
+                result[4 * i] = static_cast<uint8_t>(state[i] >> 24);
+                result[4 * i + 1] = static_cast<uint8_t>(state[i] >> 16);
+                result[4 * i + 2] = static_cast<uint8_t>(state[i] >> 8);
+                result[4 * i + 3] = static_cast<uint8_t>(state[i]);
+            }
+            return result;
+        }
+    }
+
+    Sha256Digest sha256(std::span<const std::byte> data) noexcept {
+        return digest(compress, data);
+    }
+
+    Sha256Digest sha256Portable(std::span<const std::byte> data) noexcept {
+        return digest(&compressPortable, data);
+    }
+
+    bool sha256Accelerated() noexcept {
+        return compress != &compressPortable;
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace Flux::Utils {
+    using Sha256Digest = std::array<uint8_t, 32>;
+
+    /**
+     * SHA-256 of a buffer
+     *
+     * Uses the x86 SHA extensions when the CPU has them (checked once at
+     * run time), a portable implementation otherwise.
+     */
+    [[nodiscard]] Sha256Digest sha256(std::span<const std::byte> data) noexcept;
+
+    /**
+     * SHA-256 on the portable implementation only, whatever the CPU
+     *
+     * sha256 must match it bit for bit; tests compare the two.
+     */
+    [[nodiscard]] Sha256Digest sha256Portable(std::span<const std::byte> data) noexcept;
+
+    /**
+     * Whether sha256 runs on the SHA extensions on this machine
+     */
+    [[nodiscard]] bool sha256Accelerated() noexcept;
+}
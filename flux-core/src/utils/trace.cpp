@@ -0,0 +1,249 @@
+#include "flux-core/trace.h"
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace Flux::Trace {
+    namespace {
+        // About 1 MiB per recording thread; older spans are overwritten past this
+        constexpr size_t RING_CAPACITY = 16384;
+
+        struct Event {
+            const char* name;
+            int64_t start;
+            int64_t duration;
+            uint32_t thread_id;
+            uint32_t label_size;
+            char label[detail::MAX_LABEL_SIZE];
+        };
+
+        /**
+         * Spans of one thread: written only by that thread, read by writeChromeTrace
+         *
+         * The writer fills a slot, then publishes it by bumping written with
+         * release order; readers take the last RING_CAPACITY published slots
+         * not older than the recording's start.
+         */
+        struct RingBuffer {
+            std::array<Event, RING_CAPACITY> events;
+            std::atomic<uint64_t> written{0};
+            std::atomic<uint64_t> recording_start{0};
+        };
+
+        /**
+         * All ring buffers; a thread takes one on its first span and hands it back when it exits
+         *
+         * Buffers are reused rather than freed, so spans of exited threads
+         * (workers of finished operations) survive until the next start().
+         */
+        class Registry {
+        public:
+            // Never destroyed: threads hand buffers back during exit, after static destructors ran
+            static Registry& instance() {
+                static Registry* const registry = new Registry();
+                return *registry;
+            }
+
+            RingBuffer* acquire() {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (!m_free.empty()) {
+                    RingBuffer* buffer = m_free.back();
+                    m_free.pop_back();
+                    return buffer;
+                }
+                m_buffers.push_back(std::make_unique<RingBuffer>());
+                return m_buffers.back().get();
+            }
+
+            void release(RingBuffer* buffer) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_free.push_back(buffer);
+            }
+
+            template <typename Visitor>
+            void forEach(Visitor&& visit) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                for (const auto& buffer : m_buffers) {
+                    visit(*buffer);
+                }
+            }
+
+        private:
+            std::mutex m_mutex;
+            std::vector<std::unique_ptr<RingBuffer>> m_buffers;
+            std::vector<RingBuffer*> m_free;
+        };
+
+        std::atomic<uint32_t> g_next_thread_id{1};
+        std::atomic<int64_t> g_epoch{0};
+
+        struct ThreadState {
+            RingBuffer* buffer = nullptr;
+            uint32_t id = 0;
+
+            ~ThreadState() {
+                if (buffer) {
+                    Registry::instance().release(buffer);
+                }
+            }
+        };
+
+        thread_local ThreadState t_state;
+
+        // Strings end at a whole UTF-8 character after labels were cut short
+        std::string_view completeUtf8(std::string_view text) {
+            size_t end = text.size();
+            size_t lead = end;
+            while (lead > 0 && lead + 4 > end && (static_cast<unsigned char>(text[lead - 1]) & 0xC0) == 0x80) {
+                --lead;
+            }
+            if (lead == 0) {
+                return text;
+            }
+            const auto first = static_cast<unsigned char>(text[lead - 1]);
+            const size_t length = first >= 0xF0 ? 4 : first >= 0xE0 ? 3 : first >= 0xC0 ? 2 : 1;
+            if (end - (lead - 1) < length) {
+                end = lead - 1;
+            }
+            return text.substr(0, end);
+        }
+
+        void appendJsonString(std::string& out, std::string_view text) {
+            out += '"';
+            for (const char c : completeUtf8(text)) {
+                switch (c) {
+                    case '"': out += "\\\""; break;
+                    case '\\': out += "\\\\"; break;
+                    case '\n': out += "\\n"; break;
+                    case '\r': out += "\\r"; break;
+                    case '\t': out += "\\t"; break;
+                    default:
+                        if (static_cast<unsigned char>(c) < 0x20) {
+                            out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+                        } else {
+                            out += c;
+                        }
+                }
+            }
+            out += '"';
+        }
+    }
+
+    namespace detail {
+        int64_t now() noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        void record(const char* name, int64_t start, const char* label, size_t label_size) noexcept {
+            const int64_t end = now();
+            if (!g_recording.load(std::memory_order_relaxed)) {
+                return;
+            }
+            ThreadState& state = t_state;
+            if (!state.buffer) {
+                try {
+                    state.buffer = Registry::instance().acquire();
+                } catch (...) {
+                    return;
+                }
+                state.id = g_next_thread_id.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            RingBuffer& buffer = *state.buffer;
+            const uint64_t index = buffer.written.load(std::memory_order_relaxed);
+            Event& event = buffer.events[index % RING_CAPACITY];
+            event.name = name;
+            event.start = start;
+            event.duration = end - start;
+            event.thread_id = state.id;
+            event.label_size = static_cast<uint32_t>(std::min(label_size, detail::MAX_LABEL_SIZE));
+            std::memcpy(event.label, label, event.label_size);
+            buffer.written.store(index + 1, std::memory_order_release);
+        }
+    }
+
+    void Span::setLabel(const std::filesystem::path& path) noexcept {
+        if constexpr (std::is_same_v<std::filesystem::path::value_type, char>) {
+            setLabel(std::string_view(path.native()));
+        } else {
+            try {
+                setLabel(std::string_view(path.string()));
+            } catch (...) {
+            }
+        }
+    }
+
+    void start() {
+        stop();
+        Registry::instance().forEach([](RingBuffer& buffer) {
+            buffer.recording_start.store(buffer.written.load(std::memory_order_acquire), std::memory_order_relaxed);
+        });
+        g_epoch.store(detail::now(), std::memory_order_relaxed);
+        detail::g_recording.store(true, std::memory_order_release);
+    }
+
+    void stop() noexcept {
+        detail::g_recording.store(false, std::memory_order_release);
+    }
+
+    Flux::expected<size_t, std::string> writeChromeTrace(const std::filesystem::path& path) {
+        stop();
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file) {
+            return Flux::unexpected<std::string>{fmt::format("Cannot create trace file: {}", path.string())};
+        }
+
+        const int64_t epoch = g_epoch.load(std::memory_order_relaxed);
+        size_t written = 0;
+        uint64_t dropped = 0;
+        std::string json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+        Registry::instance().forEach([&](RingBuffer& buffer) {
+            const uint64_t end = buffer.written.load(std::memory_order_acquire);
+            uint64_t begin = buffer.recording_start.load(std::memory_order_relaxed);
+            if (end - begin > RING_CAPACITY) {
+                dropped += end - begin - RING_CAPACITY;
+                begin = end - RING_CAPACITY;
+            }
+            for (uint64_t i = begin; i < end; ++i) {
+                const Event& event = buffer.events[i % RING_CAPACITY];
+                if (written > 0) {
+                    json += ',';
+                }
+                // Chrome trace timestamps are microseconds
+                json += fmt::format("{{\"ph\":\"X\",\"cat\":\"flux\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"name\":",
+                                    event.thread_id,
+                                    static_cast<double>(event.start - epoch) / 1000.0,
+                                    static_cast<double>(event.duration) / 1000.0);
+                appendJsonString(json, event.name);
+                if (event.label_size > 0) {
+                    json += ",\"args\":{\"entry\":";
+                    appendJsonString(json, std::string_view(event.label, event.label_size));
+                    json += '}';
+                }
+                json += '}';
+                ++written;
+            }
+        });
+        json += "]}\n";
+
+        if (dropped > 0) {
+            spdlog::warn("Trace buffers wrapped, {} oldest spans were dropped", dropped);
+        }
+
+        file.write(json.data(), static_cast<std::streamsize>(json.size()));
+        file.close();
+        if (!file) {
+            return Flux::unexpected<std::string>{fmt::format("Failed to write trace file: {}", path.string())};
+        }
+        return written;
+    }
+}
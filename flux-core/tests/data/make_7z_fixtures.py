@@ -0,0 +1,89 @@
+#!/usr/bin/env python3
+"""Regenerate the 7z fixtures used by test_extractor.cpp.
+
+solid_encoded.7z: two files in one solid LZMA2 folder, with the header
+LZMA2-encoded as 7-Zip writes it by default.
+
+self_encoded_header.7z: an encoded header whose Copy-coded pack stream is
+the encoded header itself, so decoding it yields it again.
+"""
+import lzma
+import pathlib
+import struct
+import zlib
+
+HERE = pathlib.Path(__file__).resolve().parent
+LZMA2 = [{"id": lzma.FILTER_LZMA2, "dict_size": 1 << 20}]
+LZMA2_DICT_PROP = 16    # 1 MiB
+
+
+def number(value):
+    """7z variable-length number"""
+    for extra in range(8):
+        if value < 1 << (8 * extra + 7 - extra):
+            first = (0xFF00 >> extra) & 0xFF
+            high = value >> (8 * extra)
+            return bytes([first | high]) + value.to_bytes(8, "little")[:extra]
+    return b"\xFF" + value.to_bytes(8, "little")
+
+
+def lzma2(data):
+    return lzma.compress(data, format=lzma.FORMAT_RAW, filters=LZMA2)
+
+
+def folder(method, unpack_size, properties=b""):
+    flags = len(method) | (0x20 if properties else 0)
+    coder = bytes([flags]) + method + (number(len(properties)) + properties if properties else b"")
+    return coder, number(unpack_size)
+
+
+def streams_info(pack_pos, pack_size, method, unpack_size, properties=b"", substreams=b""):
+    coder, size = folder(method, unpack_size, properties)
+    return (b"\x06" + number(pack_pos) + number(1) + b"\x09" + number(pack_size) + b"\x00"
+            + b"\x07\x0B" + number(1) + b"\x00" + number(1) + coder
+            + b"\x0C" + size + b"\x00"
+            + substreams + b"\x00")
+
+
+def archive(packed, next_header):
+    next_offset = len(packed)
+    start = struct.pack("<QQI", next_offset, len(next_header), zlib.crc32(next_header))
+    return (b"7z\xBC\xAF\x27\x1C\x00\x04" + struct.pack("<I", zlib.crc32(start)) + start
+            + packed + next_header)
+
+
+def solid_encoded():
+    files = [("docs/a.txt", b"alpha " * 200), ("docs/b.txt", b"bravo " * 300)]
+    data = b"".join(content for _, content in files)
+    packed = lzma2(data)
+
+    substreams = (b"\x08\x0D" + number(len(files))
+                  + b"\x09" + number(len(files[0][1]))
+                  + b"\x0A\x01" + b"".join(struct.pack("<I", zlib.crc32(c)) for _, c in files)
+                  + b"\x00")
+    names = b"\x00" + b"".join(name.encode("utf-16-le") + b"\x00\x00" for name, _ in files)
+    header = (b"\x01\x04"
+              + streams_info(0, len(packed), b"\x21", len(data), bytes([LZMA2_DICT_PROP]), substreams)
+              + b"\x05" + number(len(files)) + b"\x11" + number(len(names)) + names + b"\x00"
+              + b"\x00")
+
+    packed_header = lzma2(header)
+    encoded = b"\x17" + streams_info(len(packed), len(packed_header), b"\x21", len(header),
+                                     bytes([LZMA2_DICT_PROP]))
+    return archive(packed + packed_header, encoded)
+
+
+def self_encoded_header():
+    # The pack stream covers the encoded header's own bytes; its size field
+    # is part of those bytes, so iterate until the length is stable
+    size = 0
+    while True:
+        encoded = b"\x17" + streams_info(0, size, b"\x00", size)
+        if len(encoded) == size:
+            return archive(b"", encoded)
+        size = len(encoded)
+
+
+if __name__ == "__main__":
+    (HERE / "solid_encoded.7z").write_bytes(solid_encoded())
+    (HERE / "self_encoded_header.7z").write_bytes(self_encoded_header())
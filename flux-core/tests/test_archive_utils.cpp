@@ -47,6 +47,7 @@ TEST_F(ArchiveUtilsTest, FormatToStringConversion) {
     EXPECT_EQ(Flux::formatToString(Flux::ArchiveFormat::TAR_XZ), "tar.xz");
     EXPECT_EQ(Flux::formatToString(Flux::ArchiveFormat::TAR_ZSTD), "tar.zst");
     EXPECT_EQ(Flux::formatToString(Flux::ArchiveFormat::SEVEN_ZIP), "7z");
+    EXPECT_EQ(Flux::formatToString(Flux::ArchiveFormat::FLUX_DEDUP), "fxd");
 }
 
 TEST_F(ArchiveUtilsTest, LibraryVersionInfo) {
@@ -218,11 +219,11 @@ TEST_F(ArchiveUtilsTest, ExtractOptionsConfiguration) {
 // Test supported formats
 TEST_F(ArchiveUtilsTest, SupportedFormats) {
     auto formats = Flux::getSupportedFormats();
-    EXPECT_EQ(formats.size(), 5);
+    EXPECT_EQ(formats.size(), 6);
     
     // Verify all expected formats are present
     bool has_zip = false, has_tar_gz = false, has_tar_xz = false, 
-         has_tar_zstd = false, has_7z = false;
+         has_tar_zstd = false, has_7z = false, has_fxd = false;
     
     for (const auto& format : formats) {
         switch (format) {
@@ -231,6 +232,7 @@ TEST_F(ArchiveUtilsTest, SupportedFormats) {
             case Flux::ArchiveFormat::TAR_XZ: has_tar_xz = true; break;
             case Flux::ArchiveFormat::TAR_ZSTD: has_tar_zstd = true; break;
             case Flux::ArchiveFormat::SEVEN_ZIP: has_7z = true; break;
+            case Flux::ArchiveFormat::FLUX_DEDUP: has_fxd = true; break;
         }
     }
     
@@ -239,6 +241,7 @@ TEST_F(ArchiveUtilsTest, SupportedFormats) {
     EXPECT_TRUE(has_tar_xz);
     EXPECT_TRUE(has_tar_zstd);
     EXPECT_TRUE(has_7z);
+    EXPECT_TRUE(has_fxd);
 }
 
 // Test progress callback functionality
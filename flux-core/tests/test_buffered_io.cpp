@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include <flux-core/constants.h>
+#include <flux-core/exceptions.h>
+#include "io/buffered_io.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+class BufferedIOTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        test_dir = std::filesystem::temp_directory_path() / "flux_buffered_io_test";
+        std::filesystem::create_directories(test_dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(test_dir);
+    }
+
+    static std::string pattern(size_t size) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>('a' + i % 23);
+        }
+        return data;
+    }
+
+    static std::span<const std::byte> bytes(const std::string& data) {
+        return std::as_bytes(std::span(data));
+    }
+
+    void writeFile(const std::filesystem::path& path, const std::string& content) {
+        std::ofstream file(path, std::ios::binary);
+        file << content;
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+    }
+
+    std::filesystem::path test_dir;
+};
+
+TEST_F(BufferedIOTest, BufferSizeFollowsFileSize) {
+    using namespace Flux::Constants;
+
+    // Unknown size
+    EXPECT_EQ(Flux::IO::chooseBufferSize(0), DEFAULT_BUFFER_SIZE);
+
+    // Small files are read in one call, rounded up to a page
+    EXPECT_EQ(Flux::IO::chooseBufferSize(1), 4096u);
+    EXPECT_EQ(Flux::IO::chooseBufferSize(4096), 4096u);
+    EXPECT_EQ(Flux::IO::chooseBufferSize(4097), 8192u);
+    EXPECT_EQ(Flux::IO::chooseBufferSize(SMALL_FILE_THRESHOLD - 1), DEFAULT_BUFFER_SIZE);
+
+    EXPECT_EQ(Flux::IO::chooseBufferSize(SMALL_FILE_THRESHOLD), LARGE_BUFFER_SIZE);
+    EXPECT_EQ(Flux::IO::chooseBufferSize(LARGE_FILE_THRESHOLD - 1), LARGE_BUFFER_SIZE);
+
+    // Huge files get a few megabytes, never more than the cap
+    const size_t huge = Flux::IO::chooseBufferSize(LARGE_FILE_THRESHOLD);
+    EXPECT_GT(huge, LARGE_BUFFER_SIZE);
+    EXPECT_LE(huge, MAX_BUFFER_SIZE);
+    EXPECT_EQ(Flux::IO::chooseBufferSize(uint64_t{1} << 40), huge);
+}
+
+TEST_F(BufferedIOTest, ReaderReturnsFileInBlocks) {
+    const std::string content = pattern(10000);
+    const auto path = test_dir / "input.bin";
+    writeFile(path, content);
+
+    Flux::IO::BufferedReader reader(path, 4096);
+    EXPECT_EQ(reader.fileSize(), content.size());
+
+    std::vector<size_t> block_sizes;
+    std::string read_back;
+    for (auto block = reader.read(); !block.empty(); block = reader.read()) {
+        block_sizes.push_back(block.size());
+        read_back.append(reinterpret_cast<const char*>(block.data()), block.size());
+    }
+    EXPECT_EQ(block_sizes, (std::vector<size_t>{4096, 4096, 1808}));
+    EXPECT_EQ(read_back, content);
+
+    // End of file stays at end of file
+    EXPECT_TRUE(reader.read().empty());
+}
+
+TEST_F(BufferedIOTest, ReaderHandlesEmptyFile) {
+    const auto path = test_dir / "empty.bin";
+    writeFile(path, "");
+
+    Flux::IO::BufferedReader reader(path);
+    EXPECT_EQ(reader.fileSize(), 0u);
+    EXPECT_TRUE(reader.read().empty());
+}
+
+TEST_F(BufferedIOTest, ReaderThrowsForMissingFile) {
+    EXPECT_THROW(Flux::IO::BufferedReader(test_dir / "missing.bin"), Flux::FileNotFoundException);
+}
+
+TEST_F(BufferedIOTest, WriterCoalescesSmallWrites) {
+    const std::string content = pattern(10000);
+    const auto path = test_dir / "small_writes.bin";
+    {
+        Flux::IO::BufferedWriter writer(path, 0, 4096);
+        for (size_t offset = 0; offset < content.size(); offset += 7) {
+            writer.write(bytes(content).subspan(offset, std::min<size_t>(7, content.size() - offset)));
+        }
+        EXPECT_EQ(writer.bytesWritten(), content.size());
+        writer.close();
+    }
+    EXPECT_EQ(readFile(path), content);
+}
+
+TEST_F(BufferedIOTest, WriterPassesLargeWritesThrough) {
+    const std::string head = pattern(100);
+    const std::string block = pattern(20000);
+    const auto path = test_dir / "large_writes.bin";
+    {
+        Flux::IO::BufferedWriter writer(path, 0, 4096);
+        // An empty buffer lets the block skip it; a partly filled one takes it in pieces
+        writer.write(bytes(block));
+        writer.write(bytes(head));
+        writer.write(bytes(block));
+        EXPECT_EQ(writer.bytesWritten(), 2 * block.size() + head.size());
+    }
+    // The destructor flushes and closes
+    EXPECT_EQ(readFile(path), block + head + block);
+}
+
+TEST_F(BufferedIOTest, WriterPrepareAndCommit) {
+    const std::string content = pattern(9000);
+    const auto path = test_dir / "prepared.bin";
+    {
+        Flux::IO::BufferedWriter writer(path, 0, 4096);
+        size_t offset = 0;
+        while (offset < content.size()) {
+            auto space = writer.prepare();
+            ASSERT_FALSE(space.empty());
+            const size_t chunk = std::min({space.size(), content.size() - offset, size_t{1000}});
+            std::memcpy(space.data(), content.data() + offset, chunk);
+            writer.commit(chunk);
+            offset += chunk;
+        }
+        writer.close();
+        // A second close does nothing
+        writer.close();
+        EXPECT_EQ(writer.bytesWritten(), content.size());
+    }
+    EXPECT_EQ(readFile(path), content);
+}
+
+TEST_F(BufferedIOTest, WriterTruncatesExistingFile) {
+    const auto path = test_dir / "existing.bin";
+    writeFile(path, pattern(5000));
+    {
+        Flux::IO::BufferedWriter writer(path);
+        writer.write(bytes(std::string("short")));
+    }
+    EXPECT_EQ(readFile(path), "short");
+}
+
+TEST_F(BufferedIOTest, WriterThrowsForUncreatableFile) {
+    EXPECT_THROW(Flux::IO::BufferedWriter(test_dir / "missing_dir" / "out.bin"), Flux::FluxException);
+}
@@ -1,9 +1,16 @@
 #include <gtest/gtest.h>
+#include <flux-core/flux.h>
 #include <flux-core/extractor.h>
+#include <flux-core/packer.h>
 #include <flux-core/archive.h>
+#include <algorithm>
+#include <atomic>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
 
 class ExtractorTest : public ::testing::Test {
 protected:
@@ -19,6 +26,51 @@ protected:
     std::filesystem::path test_dir;
 };
 
+namespace {
+    // Append one ustar member; typeflag '0' is a file, '2' a symlink to link_target
+    void appendTarMember(std::string& tar, const std::string& name, char typeflag,
+                         const std::string& content, const std::string& link_target = {}, uint64_t mode = 0644) {
+        std::string header(512, '\0');
+        auto put = [&header](size_t offset, const std::string& value) { header.replace(offset, value.size(), value); };
+        auto octal = [](uint64_t value, size_t width) {
+            std::string digits(width - 1, '0');
+            for (size_t i = width - 1; i > 0 && value > 0; --i, value >>= 3) {
+                digits[i - 1] = static_cast<char>('0' + (value & 7));
+            }
+            return digits;
+        };
+        put(0, name);
+        put(100, octal(mode, 8));
+        put(108, octal(0, 8));
+        put(116, octal(0, 8));
+        put(124, octal(content.size(), 12));
+        put(136, octal(1700000000, 12));
+        put(148, std::string(8, ' '));
+        header[156] = typeflag;
+        put(157, link_target);
+        put(257, std::string("ustar\0" "00", 8));
+        unsigned checksum = 0;
+        for (const char c : header) {
+            checksum += static_cast<unsigned char>(c);
+        }
+        put(148, octal(checksum, 7));
+        tar += header;
+        tar += content;
+        tar.append((512 - content.size() % 512) % 512, '\0');
+    }
+
+    void writeTar(const std::filesystem::path& path, std::string tar) {
+        tar.append(1024, '\0');
+        std::ofstream file(path, std::ios::binary);
+        file.write(tar.data(), static_cast<std::streamsize>(tar.size()));
+    }
+
+    std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    }
+}
+
 TEST_F(ExtractorTest, CreateExtractorInstances) {
     // Test creating extractors for all supported formats
     auto zip_extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
@@ -89,6 +141,7 @@ TEST_F(ExtractorTest, ExtractOptionsDefaults) {
     Flux::ExtractOptions options;
     
     EXPECT_EQ(options.overwrite_mode, Flux::OverwriteMode::SKIP);
+    EXPECT_EQ(options.num_threads, 0);
     EXPECT_FALSE(options.hoist_single_folder);
     EXPECT_TRUE(options.preserve_permissions);
     EXPECT_TRUE(options.preserve_timestamps);
@@ -191,6 +244,388 @@ TEST_F(ExtractorTest, ExtractionWithProgressCallback) {
     EXPECT_TRUE(error_called);
 }
 
+TEST_F(ExtractorTest, ParallelZipExtraction) {
+    // Enough entries for several worker batches
+    std::filesystem::path source_dir = test_dir / "source";
+    for (int i = 0; i < 300; ++i) {
+        std::filesystem::path file_path = source_dir / ("dir" + std::to_string(i % 7)) / ("file" + std::to_string(i) + ".txt");
+        std::filesystem::create_directories(file_path.parent_path());
+        std::ofstream file(file_path);
+        file << "content " << i;
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::ZIP);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::ZIP;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "many.zip";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
+    Flux::ExtractOptions options;
+    options.num_threads = 4;
+    auto result = extractor->extract(archive_path, test_dir / "out", options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_extracted, 300u);
+
+    for (int i = 0; i < 300; ++i) {
+        std::ifstream file(test_dir / "out" / "source" / ("dir" + std::to_string(i % 7)) / ("file" + std::to_string(i) + ".txt"));
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, "content " + std::to_string(i));
+    }
+}
+
+TEST_F(ExtractorTest, ProgressIsSampledNotPerEntry) {
+    std::filesystem::path source_dir = test_dir / "source";
+    for (int i = 0; i < 300; ++i) {
+        std::filesystem::create_directories(source_dir);
+        std::ofstream file(source_dir / ("file" + std::to_string(i) + ".txt"));
+        file << "content " << i;
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::ZIP);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::ZIP;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "sampled.zip";
+    ASSERT_TRUE(packer->pack(inputs, archive_path, pack_options).success);
+
+    // Workers only bump counters; the callback runs on one reporter at a time
+    std::atomic<bool> inside{false};
+    size_t calls = 0;
+    std::string last_name;
+    float last_progress = 0.0f;
+    size_t last_done = 0;
+    Flux::ProgressCallback progress_cb = [&](std::string_view name, float progress, size_t done, size_t total) {
+        EXPECT_FALSE(inside.exchange(true));
+        ++calls;
+        last_name = name;
+        last_progress = progress;
+        last_done = done;
+        EXPECT_EQ(total, 300u);
+        inside = false;
+    };
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
+    Flux::ExtractOptions options;
+    options.num_threads = 4;
+    auto result = extractor->extract(archive_path, test_dir / "out", options, progress_cb, nullptr);
+    ASSERT_TRUE(result.success) << result.error_message;
+
+    EXPECT_GT(calls, 0u);
+    EXPECT_LT(calls, 300u);
+    EXPECT_EQ(last_done, 300u);
+    EXPECT_FLOAT_EQ(last_progress, 1.0f);
+    EXPECT_TRUE(last_name.starts_with("Extracting: source/file")) << last_name;
+}
+
+TEST_F(ExtractorTest, ZipPartialProgressCountsMatchedEntries) {
+    std::filesystem::path source_dir = test_dir / "source";
+    std::filesystem::create_directories(source_dir);
+    for (int i = 0; i < 40; ++i) {
+        std::ofstream file(source_dir / ("file" + std::to_string(i) + (i % 4 == 0 ? ".log" : ".txt")));
+        file << "content " << i;
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::ZIP);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::ZIP;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "partial_progress.zip";
+    ASSERT_TRUE(packer->pack(inputs, archive_path, pack_options).success);
+
+    // One pattern matching 30 entries reports 30 units, not one
+    size_t last_done = 0;
+    size_t last_total = 0;
+    Flux::ProgressCallback progress_cb = [&](std::string_view, float, size_t done, size_t total) {
+        last_done = done;
+        last_total = total;
+    };
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
+    std::vector<std::string> patterns = {"source/*.txt"};
+    auto result = extractor->extractPartial(archive_path, test_dir / "out", patterns, Flux::ExtractOptions{}, progress_cb);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_extracted, 30u);
+    EXPECT_EQ(last_total, 30u);
+    EXPECT_EQ(last_done, 30u);
+}
+
+TEST_F(ExtractorTest, TarProgressFollowsCompressedBytes) {
+    std::filesystem::path source_dir = test_dir / "tar_source";
+    for (int i = 0; i < 20; ++i) {
+        std::filesystem::create_directories(source_dir);
+        std::ofstream file(source_dir / ("file" + std::to_string(i) + ".bin"), std::ios::binary);
+        for (int j = 0; j < 4096; ++j) {
+            file << (i * 7919 + j * 104729) % 65521 << ',';
+        }
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_GZ);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::TAR_GZ;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "progress.tar.gz";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+
+    std::vector<size_t> consumed;
+    size_t reported_total = 0;
+    Flux::ProgressCallback progress_cb = [&](std::string_view, float progress, size_t processed, size_t total) {
+        EXPECT_GE(progress, 0.0f);
+        EXPECT_LE(progress, 1.0f);
+        consumed.push_back(processed);
+        reported_total = total;
+    };
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_GZ);
+    auto result = extractor->extract(archive_path, test_dir / "tar_out", Flux::ExtractOptions{}, progress_cb, nullptr);
+    ASSERT_TRUE(result.success) << result.error_message;
+
+    EXPECT_EQ(reported_total, std::filesystem::file_size(archive_path));
+    ASSERT_FALSE(consumed.empty());
+    EXPECT_TRUE(std::is_sorted(consumed.begin(), consumed.end()));
+    EXPECT_EQ(consumed.back(), reported_total);
+}
+
+TEST_F(ExtractorTest, TarSmallFilesKeepModeAndTime) {
+    // Small regular files take the batched writer path
+    std::filesystem::path source_dir = test_dir / "small_files";
+    std::filesystem::create_directories(source_dir);
+    const auto mtime = std::filesystem::file_time_type::clock::now() - std::chrono::hours(48);
+    for (int i = 0; i < 100; ++i) {
+        std::filesystem::path file_path = source_dir / ("file" + std::to_string(i) + ".txt");
+        std::ofstream(file_path) << "small file " << i;
+        std::filesystem::permissions(file_path, std::filesystem::perms::owner_read | std::filesystem::perms::owner_write |
+                                                std::filesystem::perms::group_read | std::filesystem::perms::group_write);
+        std::filesystem::last_write_time(file_path, mtime);
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "small.tar.zst";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    auto result = extractor->extract(archive_path, test_dir / "small_out", Flux::ExtractOptions{}, nullptr, nullptr);
+    ASSERT_TRUE(result.success) << result.error_message;
+
+    for (int i = 0; i < 100; ++i) {
+        std::filesystem::path file_path = test_dir / "small_out" / "small_files" / ("file" + std::to_string(i) + ".txt");
+        std::ifstream file(file_path);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, "small file " + std::to_string(i));
+        EXPECT_EQ(std::filesystem::status(file_path).permissions() & std::filesystem::perms::all,
+                  std::filesystem::perms::owner_read | std::filesystem::perms::owner_write |
+                  std::filesystem::perms::group_read | std::filesystem::perms::group_write);
+        EXPECT_EQ(std::chrono::floor<std::chrono::seconds>(std::filesystem::last_write_time(file_path)),
+                  std::chrono::floor<std::chrono::seconds>(mtime));
+    }
+}
+
+TEST_F(ExtractorTest, TarRepeatedPathKeepsLastEntry) {
+    // Small files go through the batched writer; every copy of dup.txt must land in archive order
+    std::string tar;
+    for (int i = 0; i < 200; ++i) {
+        appendTarMember(tar, "dup.txt", '0', "version " + std::to_string(i));
+        appendTarMember(tar, "other" + std::to_string(i) + ".txt", '0', "other");
+    }
+    writeTar(test_dir / "dup.tar", tar);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_GZ);
+    auto result = extractor->extract(test_dir / "dup.tar", test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_extracted, 400u);
+    EXPECT_EQ(readFile(test_dir / "out" / "dup.txt"), "version 199");
+}
+
+TEST_F(ExtractorTest, TarQueuedFilesDropSetuidWithoutOwner) {
+#ifdef _WIN32
+    GTEST_SKIP() << "No setuid bits on Windows";
+#else
+    if (geteuid() == 0) {
+        GTEST_SKIP() << "Root restores owners, and setuid with them";
+    }
+    // Small enough for the batched writer, which must strip the bits as archive_write_disk does
+    std::string tar;
+    appendTarMember(tar, "suid", '0', "payload", {}, 04755);
+    appendTarMember(tar, "sgid", '0', "payload", {}, 02755);
+    writeTar(test_dir / "suid.tar", tar);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_GZ);
+    auto result = extractor->extract(test_dir / "suid.tar", test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(result.success) << result.error_message;
+    for (const char* name : {"suid", "sgid"}) {
+        const auto perms = std::filesystem::status(test_dir / "out" / name).permissions();
+        EXPECT_EQ(perms & (std::filesystem::perms::set_uid | std::filesystem::perms::set_gid),
+                  std::filesystem::perms::none) << name;
+        EXPECT_EQ(perms & std::filesystem::perms::owner_exec, std::filesystem::perms::owner_exec) << name;
+    }
+#endif
+}
+
+TEST_F(ExtractorTest, TarSymlinkReplacingQueuedFileIsNotWrittenThrough) {
+#ifdef _WIN32
+    GTEST_SKIP() << "Symlinks need extra privileges on Windows";
+#endif
+    std::ofstream(test_dir / "outside.txt") << "keep";
+    std::ofstream(test_dir / "outside2.txt") << "keep";
+
+    std::string tar;
+    // A queued file, then a symlink out of the tree at the same path
+    appendTarMember(tar, "link", '0', "queued data");
+    appendTarMember(tar, "link", '2', "", "../outside.txt");
+    // A symlink, then a small file at the same path
+    appendTarMember(tar, "link2", '2', "", "../outside2.txt");
+    appendTarMember(tar, "link2", '0', "replaced");
+    writeTar(test_dir / "links.tar", tar);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_GZ);
+    auto result = extractor->extract(test_dir / "links.tar", test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(result.success) << result.error_message;
+
+    EXPECT_TRUE(std::filesystem::is_symlink(test_dir / "out" / "link"));
+    EXPECT_FALSE(std::filesystem::is_symlink(test_dir / "out" / "link2"));
+    EXPECT_EQ(readFile(test_dir / "out" / "link2"), "replaced");
+    EXPECT_EQ(readFile(test_dir / "outside.txt"), "keep");
+    EXPECT_EQ(readFile(test_dir / "outside2.txt"), "keep");
+}
+
+TEST_F(ExtractorTest, SevenZipSolidFolderWithEncodedHeader) {
+    // Two files in one solid LZMA2 folder; the header is LZMA2-encoded as 7-Zip writes it
+    const std::filesystem::path archive_path = std::filesystem::path(FLUX_TEST_DATA_DIR) / "solid_encoded.7z";
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::SEVEN_ZIP);
+
+    auto entries = extractor->listContents(archive_path, "");
+    ASSERT_TRUE(entries.has_value()) << entries.error();
+    ASSERT_EQ(entries->size(), 2u);
+    EXPECT_EQ((*entries)[0].path, "docs/a.txt");
+    EXPECT_EQ((*entries)[0].uncompressed_size, 1200u);
+    EXPECT_EQ((*entries)[1].path, "docs/b.txt");
+    EXPECT_EQ((*entries)[1].uncompressed_size, 1800u);
+
+    auto verified = extractor->verifyIntegrity(archive_path, "");
+    EXPECT_TRUE(verified.has_value()) << verified.error();
+
+    auto result = extractor->extract(archive_path, test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_extracted, 2u);
+    std::string expected_a;
+    for (int i = 0; i < 200; ++i) {
+        expected_a += "alpha ";
+    }
+    EXPECT_EQ(readFile(test_dir / "out" / "docs" / "a.txt"), expected_a);
+    EXPECT_EQ(std::filesystem::file_size(test_dir / "out" / "docs" / "b.txt"), 1800u);
+}
+
+TEST_F(ExtractorTest, SevenZipDetectFormatChecksSignature) {
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::SEVEN_ZIP);
+
+    auto detected = extractor->detectFormat(std::filesystem::path(FLUX_TEST_DATA_DIR) / "solid_encoded.7z");
+    ASSERT_TRUE(detected.has_value()) << detected.error();
+    EXPECT_EQ(*detected, Flux::ArchiveFormat::SEVEN_ZIP);
+
+    std::string tar;
+    appendTarMember(tar, "a.txt", '0', "alpha");
+    writeTar(test_dir / "renamed.7z", tar);
+    EXPECT_FALSE(extractor->detectFormat(test_dir / "renamed.7z").has_value());
+    EXPECT_FALSE(extractor->detectFormat(test_dir / "missing.7z").has_value());
+}
+
+TEST_F(ExtractorTest, SevenZipSelfReferencingEncodedHeaderIsRejected) {
+    // The encoded header's Copy-coded pack stream is the encoded header itself
+    const std::filesystem::path archive_path = std::filesystem::path(FLUX_TEST_DATA_DIR) / "self_encoded_header.7z";
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::SEVEN_ZIP);
+
+    EXPECT_FALSE(extractor->listContents(archive_path, "").has_value());
+    EXPECT_FALSE(extractor->verifyIntegrity(archive_path, "").has_value());
+    EXPECT_FALSE(extractor->extract(archive_path, test_dir / "out", Flux::ExtractOptions{}).success);
+}
+
+TEST_F(ExtractorTest, SeekableTarZstdPartialExtraction) {
+    // Several frames' worth of data before and between the requested members
+    std::filesystem::path source_dir = test_dir / "seekable";
+    std::filesystem::create_directories(source_dir);
+    std::string filler;
+    for (int i = 0; filler.size() < 6 * 1024 * 1024; ++i) {
+        filler += "filler " + std::to_string(i) + "\n";
+    }
+    std::ofstream(source_dir / "a_filler.bin") << filler;
+    std::ofstream(source_dir / "b_wanted.txt") << "first";
+    std::ofstream(source_dir / "c_filler.bin") << filler;
+    std::ofstream(source_dir / "d_wanted.txt") << "second";
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    pack_options.seekable = true;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "seekable.tar.zst";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    std::vector<std::string> patterns = {"wanted"};
+    auto result = extractor->extractPartial(archive_path, test_dir / "partial", patterns, Flux::ExtractOptions{});
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_extracted, 2u);
+    EXPECT_FALSE(std::filesystem::exists(test_dir / "partial" / "seekable" / "a_filler.bin"));
+
+    std::ifstream second(test_dir / "partial" / "seekable" / "d_wanted.txt");
+    std::string content((std::istreambuf_iterator<char>(second)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "second");
+
+    // Frames decode back to back like any zstd stream
+    auto full = extractor->extract(archive_path, test_dir / "full", Flux::ExtractOptions{}, nullptr, nullptr);
+    ASSERT_TRUE(full.success) << full.error_message;
+    EXPECT_EQ(std::filesystem::file_size(test_dir / "full" / "seekable" / "c_filler.bin"), filler.size());
+}
+
+TEST_F(ExtractorTest, GlobPatternsSelectEntries) {
+    std::filesystem::path source_dir = test_dir / "project";
+    for (const char* name : {"src/main.cpp", "src/util/str.cpp", "src/util/str.h", "build/main.o", "notes.txt", "run.log"}) {
+        std::filesystem::create_directories((source_dir / name).parent_path());
+        std::ofstream(source_dir / name) << name;
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    pack_options.exclude_patterns = {"project/build", "*.log"};
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "project.tar.zst";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    auto entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    for (const auto& entry : *entries) {
+        EXPECT_EQ(entry.path.string().find("build"), std::string::npos) << entry.path;
+        EXPECT_EQ(entry.path.string().find(".log"), std::string::npos) << entry.path;
+    }
+
+    // `*` stays within a directory, `**/` spans any number of them
+    std::vector<std::string> patterns = {"project/src/*.cpp"};
+    auto shallow = extractor->extractPartial(archive_path, test_dir / "shallow", patterns, Flux::ExtractOptions{});
+    ASSERT_TRUE(shallow.success) << shallow.error_message;
+    EXPECT_EQ(shallow.files_extracted, 1u);
+
+    Flux::ExtractOptions options;
+    options.include_patterns = {"project/**/*.cpp", "*.txt"};
+    options.exclude_patterns = {"str.*"};
+    auto result = extractor->extract(archive_path, test_dir / "out", options, nullptr, nullptr);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_TRUE(std::filesystem::exists(test_dir / "out" / "project" / "src" / "main.cpp"));
+    EXPECT_TRUE(std::filesystem::exists(test_dir / "out" / "project" / "notes.txt"));
+    EXPECT_FALSE(std::filesystem::exists(test_dir / "out" / "project" / "src" / "util" / "str.cpp"));
+    EXPECT_FALSE(std::filesystem::exists(test_dir / "out" / "project" / "src" / "util" / "str.h"));
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include <flux-core/packer.h>
 #include <flux-core/archive.h>
+#include <flux-core/extractor.h>
+#include <flux-core/archive_index.h>
+#include <flux-core/codec_pool.h>
+#include <flux-core/incremental.h>
+#include <flux-core/trace.h>
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <memory>
@@ -155,6 +161,10 @@ TEST_F(PackerTest, PackOptionsDefaults) {
     EXPECT_TRUE(options.preserve_permissions);
     EXPECT_TRUE(options.preserve_timestamps);
     EXPECT_TRUE(options.password.empty());
+    EXPECT_TRUE(options.solid);
+    EXPECT_EQ(options.solid_block_size, 0u);
+    EXPECT_EQ(options.index_mode, Flux::IndexMode::NONE);
+    EXPECT_FALSE(options.seekable);
     EXPECT_TRUE(options.isCompressionLevelValid());
 }
 
@@ -265,10 +275,561 @@ TEST_F(PackerTest, PackWithInvalidOutput) {
     EXPECT_FALSE(result.error_message.empty());
 }
 
+TEST_F(PackerTest, PackTarFormatsStreamsCompressedOutput) {
+    const std::vector<Flux::ArchiveFormat> tar_formats = {
+        Flux::ArchiveFormat::TAR_GZ,
+        Flux::ArchiveFormat::TAR_XZ,
+        Flux::ArchiveFormat::TAR_ZSTD
+    };
+    
+    std::vector<std::filesystem::path> inputs = {
+        test_dir / "file1.txt",
+        test_dir / "subdir"
+    };
+    
+    for (const auto format : tar_formats) {
+        auto packer = Flux::createPacker(format);
+        
+        Flux::PackOptions options;
+        options.format = format;
+        
+        std::filesystem::path output_path = test_dir / ("archive." + std::string(Flux::formatToString(format)));
+        auto result = packer->pack(inputs, output_path, options);
+        
+        ASSERT_TRUE(result.success) << result.error_message;
+        EXPECT_TRUE(result.error_message.empty());
+        EXPECT_EQ(result.files_processed, 2);
+        EXPECT_EQ(result.total_compressed_size, std::filesystem::file_size(output_path));
+        
+        // The archive must be readable by the TAR extractor
+        auto extractor = Flux::createExtractor(format);
+        auto entries = extractor->listContents(output_path);
+        ASSERT_TRUE(entries.has_value()) << entries.error();
+        
+        bool found_nested = false;
+        for (const auto& entry : entries.value()) {
+            if (entry.path == std::filesystem::path("subdir/file3.txt")) {
+                found_nested = true;
+                EXPECT_EQ(entry.uncompressed_size, std::string("File in subdirectory").size());
+            }
+        }
+        EXPECT_TRUE(found_nested);
+    }
+}
+
+TEST_F(PackerTest, TarIndexMatchesListing) {
+    const std::vector<std::pair<Flux::ArchiveFormat, Flux::IndexMode>> cases = {
+        {Flux::ArchiveFormat::TAR_ZSTD, Flux::IndexMode::EMBEDDED},
+        {Flux::ArchiveFormat::TAR_GZ, Flux::IndexMode::SIDECAR}
+    };
+    std::vector<std::filesystem::path> inputs = {test_dir / "subdir", test_dir / "binary.bin"};
+
+    for (const auto& [format, mode] : cases) {
+        auto packer = Flux::createPacker(format);
+        Flux::PackOptions options;
+        options.format = format;
+        options.index_mode = mode;
+
+        std::filesystem::path archive_path = test_dir / ("indexed." + std::string(Flux::formatToString(format)));
+        auto result = packer->pack(inputs, archive_path, options);
+        ASSERT_TRUE(result.success) << result.error_message;
+        EXPECT_EQ(std::filesystem::exists(Flux::indexSidecarPath(archive_path)), mode == Flux::IndexMode::SIDECAR);
+
+        auto index = Flux::readArchiveIndex(archive_path);
+        ASSERT_TRUE(index.has_value()) << index.error();
+        ASSERT_EQ(index->entries.size(), 3u);
+        EXPECT_EQ(index->uncompressedSize(), std::string("File in subdirectory").size() + 512);
+
+        // Listing from the index must agree with a full pass over the stream
+        std::filesystem::path plain_path = test_dir / ("plain." + std::string(Flux::formatToString(format)));
+        options.index_mode = Flux::IndexMode::NONE;
+        ASSERT_TRUE(packer->pack(inputs, plain_path, options).success);
+
+        auto extractor = Flux::createExtractor(format);
+        auto indexed_entries = extractor->listContents(archive_path);
+        auto streamed_entries = extractor->listContents(plain_path);
+        ASSERT_TRUE(indexed_entries.has_value()) << indexed_entries.error();
+        ASSERT_TRUE(streamed_entries.has_value()) << streamed_entries.error();
+        ASSERT_EQ(indexed_entries->size(), streamed_entries->size());
+        for (size_t i = 0; i < indexed_entries->size(); ++i) {
+            EXPECT_EQ((*indexed_entries)[i].path, (*streamed_entries)[i].path);
+            EXPECT_EQ((*indexed_entries)[i].uncompressed_size, (*streamed_entries)[i].uncompressed_size);
+            EXPECT_EQ((*indexed_entries)[i].permissions, (*streamed_entries)[i].permissions);
+        }
+
+        // The embedded frame must not disturb extraction
+        std::vector<std::string> patterns = {"file3"};
+        auto extracted = extractor->extractPartial(archive_path, test_dir / "partial", patterns, Flux::ExtractOptions{});
+        ASSERT_TRUE(extracted.success) << extracted.error_message;
+        EXPECT_EQ(extracted.files_extracted, 1u);
+        EXPECT_TRUE(std::filesystem::exists(test_dir / "partial" / "subdir" / "file3.txt"));
+        std::filesystem::remove_all(test_dir / "partial");
+    }
+}
+
+TEST_F(PackerTest, MultiThreadedXzRoundTrip) {
+    // Large enough for the multi-threaded encoder to emit several blocks at level 0
+    std::string payload;
+    for (int i = 0; payload.size() < 8 * 1024 * 1024; ++i) {
+        payload += "line " + std::to_string(i) + "\n";
+    }
+    createTestFile("large/data.txt", payload);
+    
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_XZ);
+    Flux::PackOptions pack_options;
+    pack_options.format = Flux::ArchiveFormat::TAR_XZ;
+    pack_options.compression_level = 0;
+    pack_options.num_threads = 4;
+    
+    std::vector<std::filesystem::path> inputs = {test_dir / "large"};
+    std::filesystem::path archive_path = test_dir / "large.tar.xz";
+    auto pack_result = packer->pack(inputs, archive_path, pack_options);
+    ASSERT_TRUE(pack_result.success) << pack_result.error_message;
+    
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_XZ);
+    Flux::ExtractOptions extract_options;
+    extract_options.num_threads = 4;
+    
+    auto extract_result = extractor->extract(archive_path, test_dir / "out", extract_options);
+    ASSERT_TRUE(extract_result.success) << extract_result.error_message;
+    
+    std::ifstream extracted(test_dir / "out" / "large" / "data.txt", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(extracted)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, payload);
+}
+
+TEST_F(PackerTest, ParallelZipKeepsInputOrder) {
+    // Past MIN_PARALLEL_SIZE so members are deflated on several threads
+    std::vector<std::string> names;
+    for (int i = 0; i < 8; ++i) {
+        names.push_back("zip/file" + std::to_string(i) + ".txt");
+        createTestFile(names.back(), std::string(2 * 1024 * 1024, static_cast<char>('a' + i)));
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::ZIP);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::ZIP;
+    options.num_threads = 4;
+
+    std::vector<std::filesystem::path> inputs;
+    for (const auto& name : names) {
+        inputs.push_back(test_dir / name);
+    }
+    std::filesystem::path archive_path = test_dir / "parallel.zip";
+    auto result = packer->pack(inputs, archive_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_processed, names.size());
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
+    auto entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    ASSERT_EQ(entries->size(), names.size());
+    for (size_t i = 0; i < names.size(); ++i) {
+        EXPECT_EQ((*entries)[i].path, std::filesystem::path(names[i]).filename());
+        EXPECT_EQ((*entries)[i].uncompressed_size, 2u * 1024 * 1024);
+    }
+}
+
+TEST_F(PackerTest, ZipStoresIncompressibleFiles) {
+    std::string noise(256 * 1024, '\0');
+    uint64_t state = 0x2545F4914F6CDD1DULL;
+    for (auto& c : noise) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        c = static_cast<char>(state >> 56);
+    }
+    std::string text;
+    while (text.size() < noise.size()) {
+        text += "line " + std::to_string(text.size()) + " of a plain text file\n";
+    }
+    createTestFile("mixed/noise.dat", noise);
+    createTestFile("mixed/notes.txt", text);
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::ZIP);
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::ZIP);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::ZIP;
+    std::vector<std::filesystem::path> inputs = {test_dir / "mixed"};
+    std::filesystem::path archive_path = test_dir / "mixed.zip";
+    auto result = packer->pack(inputs, archive_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+
+    auto entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    for (const auto& entry : *entries) {
+        if (entry.name == "noise.dat") {
+            EXPECT_EQ(entry.compressed_size, entry.uncompressed_size);
+        } else if (entry.name == "notes.txt") {
+            EXPECT_LT(entry.compressed_size, entry.uncompressed_size / 4);
+        }
+    }
+
+    std::filesystem::path restore_dir = test_dir / "restore";
+    auto extracted = extractor->extract(archive_path, restore_dir, Flux::ExtractOptions{});
+    ASSERT_TRUE(extracted.success) << extracted.error_message;
+    std::ifstream file(restore_dir / "mixed" / "noise.dat", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, noise);
+
+    // STORE applies to every file
+    options.compression_strategy = Flux::CompressionStrategy::STORE;
+    ASSERT_TRUE(packer->pack(inputs, archive_path, options).success);
+    entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    for (const auto& entry : *entries) {
+        EXPECT_EQ(entry.compressed_size, entry.uncompressed_size);
+    }
+}
+
+TEST_F(PackerTest, SevenZipSolidRoundTrip) {
+    // Small blocks and pieces force several folders, each encoded on several threads
+    std::string text;
+    for (int i = 0; text.size() < 3 * 1024 * 1024; ++i) {
+        text += "record " + std::to_string(i) + "\n";
+    }
+    createTestFile("7z/a.log", text);
+    createTestFile("7z/b.txt", "plain text");
+    createTestFile("7z/c.log", text.substr(0, 4096));
+    createTestFile("7z/empty.txt", "");
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::SEVEN_ZIP);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::SEVEN_ZIP;
+    options.compression_level = 1;
+    options.num_threads = 4;
+    options.solid_block_size = 1024 * 1024;
+
+    std::vector<std::filesystem::path> inputs = {test_dir / "7z"};
+    std::filesystem::path archive_path = test_dir / "solid.7z";
+    auto result = packer->pack(inputs, archive_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_LT(result.total_compressed_size, text.size() / 2);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::SEVEN_ZIP);
+    auto entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    EXPECT_EQ(entries->size(), 5u);
+
+    auto extract_result = extractor->extract(archive_path, test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(extract_result.success) << extract_result.error_message;
+
+    std::ifstream extracted(test_dir / "out" / "7z" / "a.log", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(extracted)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, text);
+    EXPECT_TRUE(std::filesystem::is_regular_file(test_dir / "out" / "7z" / "empty.txt"));
+    EXPECT_EQ(std::filesystem::file_size(test_dir / "out" / "7z" / "c.log"), 4096u);
+}
+
+TEST_F(PackerTest, ParallelScanKeepsDirectoriesBeforeContents) {
+    // Enough directories for several scanner threads to steal from each other
+    std::filesystem::path source_dir = test_dir / "tree";
+    size_t file_count = 0;
+    for (int i = 0; i < 40; ++i) {
+        std::filesystem::path dir = source_dir / ("d" + std::to_string(i % 8)) / ("sub" + std::to_string(i));
+        std::filesystem::create_directories(dir);
+        for (int j = 0; j < 5; ++j) {
+            std::ofstream(dir / ("f" + std::to_string(j) + ".txt")) << i << ':' << j;
+            ++file_count;
+        }
+    }
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_GZ);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::TAR_GZ;
+    options.num_threads = 8;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path archive_path = test_dir / "tree.tar.gz";
+    auto result = packer->pack(inputs, archive_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_processed, file_count);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_GZ);
+    auto entries = extractor->listContents(archive_path);
+    ASSERT_TRUE(entries.has_value());
+    EXPECT_EQ(entries->size(), 1 + 8 + 40 + file_count);
+
+    // Every entry follows its parent directory, whatever order the threads found them in
+    std::vector<std::string> seen;
+    for (const auto& entry : *entries) {
+        std::string path = entry.path.generic_string();
+        if (path.ends_with('/')) {
+            path.pop_back();
+        }
+        const auto parent = std::filesystem::path(path).parent_path().generic_string();
+        if (!parent.empty()) {
+            EXPECT_NE(std::find(seen.begin(), seen.end(), parent), seen.end()) << path;
+        }
+        seen.push_back(path);
+    }
+
+    // Packing the same tree again gives the same entry order
+    std::filesystem::path again_path = test_dir / "tree_again.tar.gz";
+    ASSERT_TRUE(packer->pack(inputs, again_path, options).success);
+    auto again = extractor->listContents(again_path);
+    ASSERT_TRUE(again.has_value());
+    ASSERT_EQ(again->size(), entries->size());
+    for (size_t i = 0; i < entries->size(); ++i) {
+        EXPECT_EQ((*again)[i].path, (*entries)[i].path);
+    }
+}
+
+TEST_F(PackerTest, IncrementalTarChainRestoresLatestTree) {
+    std::filesystem::path source_dir = test_dir / "tree";
+    createTestFile("tree/keep.txt", "unchanged");
+    createTestFile("tree/edit.txt", "first version");
+    createTestFile("tree/gone.txt", "deleted later");
+    createTestFile("tree/old/inner.txt", "deleted with its directory");
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    std::vector<std::filesystem::path> inputs = {source_dir};
+    std::filesystem::path full_path = test_dir / "full.tar.zst";
+    ASSERT_TRUE(packer->pack(inputs, full_path, options).success);
+
+    createTestFile("tree/edit.txt", "second, longer version");
+    createTestFile("tree/added.txt", "new file");
+    std::filesystem::remove(source_dir / "gone.txt");
+    std::filesystem::remove_all(source_dir / "old");
+
+    options.incremental_base = full_path;
+    std::filesystem::path first_path = test_dir / "first.tar.zst";
+    auto result = packer->pack(inputs, first_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_processed, 2u);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    auto entries = extractor->listContents(first_path);
+    ASSERT_TRUE(entries.has_value()) << entries.error();
+    ASSERT_FALSE(entries->empty());
+    EXPECT_EQ((*entries)[0].path, std::string(Flux::INCREMENTAL_MANIFEST_NAME));
+    for (const auto& entry : *entries) {
+        EXPECT_NE(entry.path.generic_string(), "tree/keep.txt");
+    }
+
+    // The state lists everything present, packed or not
+    auto state = Flux::readTreeState(first_path);
+    ASSERT_TRUE(state.has_value()) << state.error();
+    EXPECT_EQ(state->entries.size(), 4u);
+
+    // A second increment only removes a file
+    std::filesystem::remove(source_dir / "added.txt");
+    options.incremental_base = first_path;
+    std::filesystem::path second_path = test_dir / "second.tar.zst";
+    result = packer->pack(inputs, second_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_processed, 0u);
+
+    std::filesystem::path restore_dir = test_dir / "restore";
+    std::vector<std::filesystem::path> chain = {full_path, first_path, second_path};
+    auto restored = Flux::extractIncrementalChain(chain, restore_dir, Flux::ExtractOptions{});
+    ASSERT_TRUE(restored.success) << restored.error_message;
+
+    std::ifstream edited(restore_dir / "tree" / "edit.txt");
+    std::string content((std::istreambuf_iterator<char>(edited)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "second, longer version");
+    EXPECT_TRUE(std::filesystem::exists(restore_dir / "tree" / "keep.txt"));
+    EXPECT_FALSE(std::filesystem::exists(restore_dir / "tree" / "gone.txt"));
+    EXPECT_FALSE(std::filesystem::exists(restore_dir / "tree" / "old"));
+    EXPECT_FALSE(std::filesystem::exists(restore_dir / "tree" / "added.txt"));
+    EXPECT_FALSE(std::filesystem::exists(restore_dir / "tree" / std::string(Flux::INCREMENTAL_MANIFEST_NAME)));
+    EXPECT_FALSE(std::filesystem::exists(restore_dir / std::string(Flux::INCREMENTAL_MANIFEST_NAME)));
+}
+
+TEST_F(PackerTest, DedupStoresSharedContentOnce) {
+    // Pseudo-random content, so only deduplication can shrink it
+    std::string payload(2 * 1024 * 1024, '\0');
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (auto& c : payload) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        c = static_cast<char>(state >> 56);
+    }
+    std::string shifted = payload;
+    shifted.insert(300000, "inserted bytes");
+    createTestFile("dedup/a/original.bin", payload);
+    createTestFile("dedup/b/copy.bin", payload);
+    createTestFile("dedup/b/shifted.bin", shifted);
+
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::FLUX_DEDUP);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::FLUX_DEDUP;
+    options.num_threads = 4;
+    std::vector<std::filesystem::path> inputs = {test_dir / "dedup"};
+    std::filesystem::path archive_path = test_dir / "dedup.fxd";
+    auto result = packer->pack(inputs, archive_path, options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.files_processed, 3u);
+    // Three copies, one insertion: a little over one copy is stored
+    EXPECT_LT(result.total_compressed_size, payload.size() + payload.size() / 4);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::FLUX_DEDUP);
+    EXPECT_TRUE(extractor->verifyIntegrity(archive_path).has_value());
+    auto detected = extractor->detectFormat(archive_path);
+    ASSERT_TRUE(detected.has_value()) << detected.error();
+    EXPECT_EQ(*detected, Flux::ArchiveFormat::FLUX_DEDUP);
+    // Anything without the signature is not a dedup archive, whatever its name
+    EXPECT_FALSE(extractor->detectFormat(test_dir / "dedup" / "a" / "original.bin").has_value());
+
+    // A second archive sharing a chunk store adds nothing new to it
+    options.chunk_store = test_dir / "chunks";
+    std::filesystem::path first_path = test_dir / "first.fxd";
+    std::filesystem::path second_path = test_dir / "second.fxd";
+    ASSERT_TRUE(packer->pack(inputs, first_path, options).success);
+    auto count_chunks = [&] {
+        return std::distance(std::filesystem::recursive_directory_iterator(options.chunk_store),
+                             std::filesystem::recursive_directory_iterator{});
+    };
+    const auto stored = count_chunks();
+    ASSERT_TRUE(packer->pack(inputs, second_path, options).success);
+    EXPECT_EQ(count_chunks(), stored);
+    EXPECT_LT(std::filesystem::file_size(second_path), 64u * 1024);
+
+    for (const auto& path : {archive_path, second_path}) {
+        std::filesystem::path restore_dir = test_dir / "restore";
+        std::filesystem::remove_all(restore_dir);
+        auto extracted = extractor->extract(path, restore_dir, Flux::ExtractOptions{});
+        ASSERT_TRUE(extracted.success) << extracted.error_message;
+        EXPECT_EQ(extracted.files_extracted, 3u);
+
+        std::ifstream file(restore_dir / "dedup" / "b" / "shifted.bin", std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(content, shifted);
+    }
+}
+
+TEST_F(PackerTest, TrainedDictionaryRoundTrip) {
+    // Many small records sharing structure but not content
+    for (int i = 0; i < 400; ++i) {
+        const std::string id = std::to_string(i);
+        const std::string name = std::to_string(1000 + i).substr(1);
+        createTestFile("records/" + name + ".json",
+                       "{\"id\": " + id + ", \"name\": \"user-" + std::to_string(i * 7919 % 1000) +
+                       "\", \"email\": \"user" + id + "@example.com\", \"roles\": [\"reader\", \"writer\"], " +
+                       "\"active\": " + (i % 3 == 0 ? "true" : "false") + ", \"score\": " +
+                       std::to_string(i * 31 % 97) + "}");
+    }
+    std::vector<std::filesystem::path> inputs = {test_dir / "records"};
+
+    for (const auto format : {Flux::ArchiveFormat::TAR_ZSTD, Flux::ArchiveFormat::FLUX_DEDUP}) {
+        auto packer = Flux::createPacker(format);
+        Flux::PackOptions options;
+        options.format = format;
+        options.seekable = true;
+        const std::string extension = format == Flux::ArchiveFormat::TAR_ZSTD ? ".tar.zst" : ".fxd";
+        std::filesystem::path plain_path = test_dir / ("plain" + extension);
+        std::filesystem::path dict_path = test_dir / ("dict" + extension);
+        ASSERT_TRUE(packer->pack(inputs, plain_path, options).success);
+        options.train_dictionary = true;
+        auto result = packer->pack(inputs, dict_path, options);
+        ASSERT_TRUE(result.success) << result.error_message;
+        if (format == Flux::ArchiveFormat::FLUX_DEDUP) {
+            // Every file is a chunk of its own, compressed separately
+            EXPECT_LT(std::filesystem::file_size(dict_path), std::filesystem::file_size(plain_path));
+        }
+
+        auto extractor = Flux::createExtractor(format);
+        EXPECT_TRUE(extractor->verifyIntegrity(dict_path).has_value());
+        std::filesystem::path restore_dir = test_dir / "restore";
+        std::filesystem::remove_all(restore_dir);
+        auto extracted = extractor->extract(dict_path, restore_dir, Flux::ExtractOptions{});
+        ASSERT_TRUE(extracted.success) << extracted.error_message;
+        EXPECT_EQ(extracted.files_extracted, 400u);
+
+        // Seekable TAR_ZSTD starts decoding mid-stream here
+        std::filesystem::remove_all(restore_dir);
+        const std::vector<std::string> patterns = {"records/123.json"};
+        extracted = extractor->extractPartial(dict_path, restore_dir, patterns, Flux::ExtractOptions{});
+        ASSERT_TRUE(extracted.success) << extracted.error_message;
+        std::ifstream file(restore_dir / "records" / "123.json", std::ios::binary);
+        std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_NE(content.find("\"id\": 123,"), std::string::npos);
+    }
+}
+
+TEST_F(PackerTest, RepeatedOperationsReuseCodecContexts) {
+    std::vector<std::filesystem::path> inputs = {test_dir / "file1.txt", test_dir / "subdir"};
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    ASSERT_TRUE(packer->pack(inputs, test_dir / "first.tar.zst", options).success);
+
+    // The second archive gets its zstd context and buffers back from the pools
+    const auto before = Flux::codecPoolStats();
+    auto result = packer->pack(inputs, test_dir / "second.tar.zst", options);
+    ASSERT_TRUE(result.success) << result.error_message;
+    const auto after = Flux::codecPoolStats();
+    EXPECT_GT(after.reused, before.reused);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    auto extracted = extractor->extract(test_dir / "second.tar.zst", test_dir / "out", Flux::ExtractOptions{});
+    ASSERT_TRUE(extracted.success) << extracted.error_message;
+    std::ifstream file(test_dir / "out" / "file1.txt", std::ios::binary);
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(content, "Hello, World!");
+
+    Flux::releaseCodecPools();
+    EXPECT_EQ(Flux::codecPoolStats().cached, 0u);
+}
+
+TEST_F(PackerTest, CollectMetricsFillsPhaseBreakdown) {
+    std::vector<std::filesystem::path> inputs = {test_dir / "file1.txt", test_dir / "subdir"};
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::TAR_ZSTD;
+    EXPECT_FALSE(packer->pack(inputs, test_dir / "plain.tar.zst", options).metrics.has_value());
+
+    options.collect_metrics = true;
+    size_t progress_calls = 0;
+    auto packed = packer->pack(inputs, test_dir / "metered.tar.zst", options,
+                               [&](std::string_view, float, size_t, size_t) { ++progress_calls; });
+    ASSERT_TRUE(packed.success) << packed.error_message;
+    ASSERT_TRUE(packed.metrics.has_value());
+    EXPECT_GT(packed.metrics->directory_scan.count(), 0);
+    EXPECT_GT(packed.metrics->codec.count(), 0);
+    EXPECT_GT(packed.metrics->bytes_read, 0u);
+    EXPECT_GT(packed.metrics->syscalls, 0u);
+    EXPECT_GT(packed.metrics->peak_buffer_bytes, 0u);
+    EXPECT_GT(progress_calls, 0u);
+
+    auto extractor = Flux::createExtractor(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::ExtractOptions extract_options;
+    extract_options.collect_metrics = true;
+    extract_options.include_patterns = {"file1.txt"};
+    auto extracted = extractor->extract(test_dir / "metered.tar.zst", test_dir / "out", extract_options);
+    ASSERT_TRUE(extracted.success) << extracted.error_message;
+    ASSERT_TRUE(extracted.metrics.has_value());
+    EXPECT_GT(extracted.metrics->header_parse.count(), 0);
+    EXPECT_GT(extracted.metrics->bytes_read, 0u);
+    EXPECT_GT(extracted.metrics->entries_skipped, 0u);
+}
+
+TEST_F(PackerTest, TraceRecordsEntrySpans) {
+    std::vector<std::filesystem::path> inputs = {test_dir / "file1.txt", test_dir / "subdir"};
+    auto packer = Flux::createPacker(Flux::ArchiveFormat::TAR_ZSTD);
+    Flux::PackOptions options;
+    options.format = Flux::ArchiveFormat::TAR_ZSTD;
+
+    Flux::Trace::start();
+    auto packed = packer->pack(inputs, test_dir / "traced.tar.zst", options);
+    ASSERT_TRUE(packed.success) << packed.error_message;
+    auto written = Flux::Trace::writeChromeTrace(test_dir / "trace.json");
+    ASSERT_TRUE(written.has_value()) << written.error();
+
+    std::ifstream file(test_dir / "trace.json", std::ios::binary);
+    std::string trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+    if (Flux::Trace::compiled_in) {
+        EXPECT_GT(*written, 0u);
+        EXPECT_NE(trace.find("tar.pack_entry"), std::string::npos);
+        EXPECT_NE(trace.find("file1.txt"), std::string::npos);
+    } else {
+        EXPECT_EQ(*written, 0u);
+    }
+}
+
 TEST_F(PackerTest, GetSupportedFormats) {
     auto formats = Flux::getSupportedFormats();
     
-    EXPECT_EQ(formats.size(), 5);
+    EXPECT_EQ(formats.size(), 6);
     
     // Check that all expected formats are present
     std::vector<Flux::ArchiveFormat> expected_formats = {
@@ -276,7 +837,8 @@ TEST_F(PackerTest, GetSupportedFormats) {
         Flux::ArchiveFormat::TAR_ZSTD,
         Flux::ArchiveFormat::TAR_GZ,
         Flux::ArchiveFormat::TAR_XZ,
-        Flux::ArchiveFormat::SEVEN_ZIP
+        Flux::ArchiveFormat::SEVEN_ZIP,
+        Flux::ArchiveFormat::FLUX_DEDUP
     };
     
     for (const auto& expected_format : expected_formats) {
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "utils/sha256.h"
+#include <cstdio>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string hex(const Flux::Utils::Sha256Digest& digest) {
+        std::string text;
+        for (const uint8_t byte : digest) {
+            char digits[3];
+            std::snprintf(digits, sizeof(digits), "%02x", byte);
+            text += digits;
+        }
+        return text;
+    }
+
+    std::span<const std::byte> bytes(const std::string& data) {
+        return std::as_bytes(std::span(data));
+    }
+
+    // FIPS 180-2 appendix B and the empty message
+    struct KnownAnswer {
+        std::string message;
+        const char* digest;
+    };
+
+    std::vector<KnownAnswer> knownAnswers() {
+        return {
+            {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+            {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+            {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+             "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+            {std::string(1000000, 'a'), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+        };
+    }
+}
+
+TEST(Sha256Test, PortableMatchesKnownAnswers) {
+    for (const auto& answer : knownAnswers()) {
+        EXPECT_EQ(hex(Flux::Utils::sha256Portable(bytes(answer.message))), answer.digest)
+            << answer.message.size() << " byte message";
+    }
+}
+
+TEST(Sha256Test, DispatchedMatchesKnownAnswers) {
+    // The SHA extensions where the CPU has them, the portable path again otherwise
+    RecordProperty("accelerated", Flux::Utils::sha256Accelerated() ? "yes" : "no");
+    for (const auto& answer : knownAnswers()) {
+        EXPECT_EQ(hex(Flux::Utils::sha256(bytes(answer.message))), answer.digest)
+            << answer.message.size() << " byte message";
+    }
+}
+
+TEST(Sha256Test, PathsAgreeAcrossBlockBoundaries) {
+    // Every tail length, with and without full blocks ahead of it
+    std::string message;
+    for (size_t size = 0; size <= 200; ++size) {
+        EXPECT_EQ(Flux::Utils::sha256(bytes(message)), Flux::Utils::sha256Portable(bytes(message)))
+            << size << " byte message";
+        message += static_cast<char>('a' + size % 26);
+    }
+}
@@ -1,4 +1,5 @@
 #include "archive_manager.h"
+#include <flux-core/archive.h>
 
 #include <QApplication>
 #include <QDir>
@@ -149,6 +150,26 @@ ArchiveOperation* ArchiveManager::createArchive(const ArchiveCreationOptions& op
     return operation;
 }
 
+FluxGui::PackOptions ArchiveManager::packOptions(const ArchiveCreationOptions& options) {
+    static const QHash<QString, Flux::ArchiveFormat> formats = {
+        {"zip", Flux::ArchiveFormat::ZIP},
+        {"7z", Flux::ArchiveFormat::SEVEN_ZIP},
+        {"gz", Flux::ArchiveFormat::TAR_GZ},
+        {"tar.gz", Flux::ArchiveFormat::TAR_GZ},
+        {"xz", Flux::ArchiveFormat::TAR_XZ},
+        {"tar.xz", Flux::ArchiveFormat::TAR_XZ},
+        {"zst", Flux::ArchiveFormat::TAR_ZSTD},
+        {"tar.zst", Flux::ArchiveFormat::TAR_ZSTD}
+    };
+    
+    FluxGui::PackOptions packOptions;
+    packOptions.format = static_cast<int>(formats.value(options.format.toLower(), Flux::ArchiveFormat::ZIP));
+    packOptions.compression_level = options.compressionLevel;
+    packOptions.password = options.password;
+    packOptions.solid_archive = options.solidArchive;
+    return packOptions;
+}
+
 ArchiveOperation* ArchiveManager::extractArchive(const ArchiveExtractionOptions& options) {
     if (!m_initialized) {
         qWarning() << "Archive Manager not initialized";
@@ -4,6 +4,7 @@
 #include <QStringList>
 #include <QVariant>
 #include <QHash>
+#include "../async_task_executor.h"
 
 class QMimeDatabase;
 
@@ -216,6 +217,13 @@ public:
      */
     ArchiveOperation* createArchive(const ArchiveCreationOptions& options);
     
+    /**
+     * @brief Task executor options for a creation request
+     * @param options Creation options, as filled in from the widget or a preset
+     * @return Pack options carrying format, level, password and solid mode
+     */
+    static FluxGui::PackOptions packOptions(const ArchiveCreationOptions& options);
+    
     /**
      * @brief Extract an archive
      * @param options Extraction options
@@ -55,6 +55,7 @@ struct PackOptions {
     int num_threads = 0;  // 0 = auto
     bool preserve_permissions = true;
     bool preserve_timestamps = true;
+    bool solid_archive = true;  // Solid blocks (7z)
     QString password;
 };
 
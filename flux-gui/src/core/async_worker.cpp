@@ -19,6 +19,7 @@
 // SOFTWARE.
 
 #include "async_worker.h"
+#include <flux-core/trace.h>
 #include <QMutexLocker>
 #include <QDebug>
 #include <QCoreApplication>
@@ -130,6 +131,7 @@ void AsyncWorker::executeTask(const WorkerTask& task) {
     if (should_stop_) {
         return;
     }
+    FLUX_TRACE_SPAN("gui.execute_task");
     
     is_busy_ = true;
     current_executor_ = task.executor;
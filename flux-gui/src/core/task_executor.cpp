@@ -182,6 +182,7 @@ void TaskExecutor::createArchive(const QStringList& input_paths, const QString&
         flux_options.num_threads = options.num_threads;
         flux_options.preserve_permissions = options.preserve_permissions;
         flux_options.preserve_timestamps = options.preserve_timestamps;
+        flux_options.solid = options.solid_archive;
         flux_options.password = options.password.toStdString();
         
         // Setup progress callback
@@ -369,7 +370,8 @@ void TaskExecutor::benchmarkCompression(const QStringList& input_paths, const QS
             {Flux::ArchiveFormat::TAR_GZ, "TAR.GZ"},
             {Flux::ArchiveFormat::TAR_XZ, "TAR.XZ"},
             {Flux::ArchiveFormat::TAR_ZSTD, "TAR.ZSTD"},
-            {Flux::ArchiveFormat::SEVEN_ZIP, "7Z"}
+            {Flux::ArchiveFormat::SEVEN_ZIP, "7Z"},
+            {Flux::ArchiveFormat::FLUX_DEDUP, "FXD"}
         };
         
         std::vector<int> compression_levels = {1, 3, 6, 9};
@@ -22,6 +22,7 @@ PackView::PackView(QWidget *parent)
     , m_formatCombo(nullptr)
     , m_compressionSpin(nullptr)
     , m_threadsSpin(nullptr)
+    , m_solidCheck(nullptr)
     , m_passwordEdit(nullptr)
     , m_outputEdit(nullptr)
     , m_browseButton(nullptr)
@@ -116,20 +117,25 @@ void PackView::setupSettings() {
     m_threadsSpin->setSpecialValueText("Auto");
     gridLayout->addWidget(m_threadsSpin, 2, 1);
     
+    // Solid blocks (7z only)
+    m_solidCheck = new QCheckBox("Solid archive (better compression)");
+    m_solidCheck->setChecked(true);
+    gridLayout->addWidget(m_solidCheck, 3, 1);
+    
     // Password
-    gridLayout->addWidget(new QLabel("Password (Optional):"), 3, 0);
+    gridLayout->addWidget(new QLabel("Password (Optional):"), 4, 0);
     m_passwordEdit = new QLineEdit();
     m_passwordEdit->setEchoMode(QLineEdit::Password);
-    gridLayout->addWidget(m_passwordEdit, 3, 1);
+    gridLayout->addWidget(m_passwordEdit, 4, 1);
     
     // Output path
-    gridLayout->addWidget(new QLabel("Output File:"), 4, 0);
+    gridLayout->addWidget(new QLabel("Output File:"), 5, 0);
     QHBoxLayout* outputLayout = new QHBoxLayout();
     m_outputEdit = new QLineEdit();
     m_browseButton = new QPushButton("Browse...");
     outputLayout->addWidget(m_outputEdit);
     outputLayout->addWidget(m_browseButton);
-    gridLayout->addLayout(outputLayout, 4, 1);
+    gridLayout->addLayout(outputLayout, 5, 1);
     
     // Connect signals
     connect(m_formatCombo, QOverload<int>::of(&QComboBox::currentIndexChanged),
@@ -294,6 +300,7 @@ void PackView::onStartPacking() {
     config.format = m_formatCombo->currentText();
     config.compressionLevel = m_compressionSpin->value();
     config.threadCount = m_threadsSpin->value();
+    config.solidArchive = m_solidCheck->isChecked();
     config.password = m_passwordEdit->text();
     
     // Create and start worker thread
@@ -341,6 +348,7 @@ void PackView::updateUI() {
     
     m_removeButton->setEnabled(hasSelection);
     m_clearButton->setEnabled(hasFiles);
+    m_solidCheck->setEnabled(m_formatCombo->currentText() == "7z");
     m_packButton->setEnabled(hasFiles && hasOutput);
     
     // Update status label
@@ -467,6 +475,7 @@ void PackWorkerThread::run() {
         Flux::PackOptions options;
         options.compression_level = m_config.compressionLevel;
         options.thread_count = m_config.threadCount;
+        options.solid = m_config.solidArchive;
         if (!m_config.password.isEmpty()) {
             options.password = m_config.password.toStdString();
         }
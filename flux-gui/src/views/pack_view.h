@@ -7,6 +7,7 @@
 #include <QComboBox>
 #include <QSpinBox>
 #include <QLineEdit>
+#include <QCheckBox>
 #include <QPushButton>
 #include <QLabel>
 #include <QProgressBar>
@@ -27,6 +28,7 @@ public:
         QString format;
         int compressionLevel;
         int threadCount;
+        bool solidArchive;
         QString password;
     };
 
@@ -115,6 +117,7 @@ private:
     QComboBox* m_formatCombo;
     QSpinBox* m_compressionSpin;
     QSpinBox* m_threadsSpin;
+    QCheckBox* m_solidCheck;
     QLineEdit* m_passwordEdit;
     QLineEdit* m_outputEdit;
     QPushButton* m_browseButton;